@@ -32,7 +32,7 @@ $build_system_modules[:gtest] = {
     gtest_libs = {
       'common'   => [],
       'propedit' => [ :mtxpropedit ],
-      'merge'    => [ :mtxmerge ],
+      'merge'    => [ :mtxmerge, :mtxinput, :mtxoutput, :mtxmerge, :avi, :rmff, :mpegparser, :vorbis, :ogg ],
     }
 
     #
@@ -0,0 +1,279 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for loading the index of AVI files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include "avilib.h"
+#include "common/avi_index.h"
+#include "common/endian.h"
+#include "common/mm_file_io.h"
+
+namespace {
+
+unsigned int const ODML_FRAMES_PER_IX_CHUNK = 2'000;
+
+// Files with one video & one audio track with 'num_frames' small
+// chunks each, indexed either with 'idx1' or with OpenDML 'ix##'
+// chunks.
+class avi_generator_c {
+protected:
+  std::string m_data;
+
+public:
+  std::string
+  generate(unsigned int num_frames,
+           bool opendml) {
+    m_data.clear();
+
+    auto riff = start_list("RIFF", "AVI ");
+    auto hdrl = start_list("LIST", "hdrl");
+
+    add_chunk("avih", std::string(56, '\0'));
+
+    std::vector<std::size_t> indx_positions;
+
+    for (auto const &type : std::vector<std::string>{ "vids", "auds" }) {
+      auto strl   = start_list("LIST", "strl");
+      auto strh   = type + (type == "vids" ? "XVID"s : std::string(4, '\0')) + std::string(48, '\0');
+      auto is_vid = type == "vids";
+
+      put_uint32_le(&strh[20], 1);
+      put_uint32_le(&strh[24], is_vid ? 25 : 48000);
+      put_uint32_le(&strh[32], num_frames);
+      add_chunk("strh", strh);
+
+      auto strf = std::string(is_vid ? 40 : 18, '\0');
+      if (is_vid) {
+        put_uint32_le(&strf[0],  40);
+        put_uint32_le(&strf[4],  320);
+        put_uint32_le(&strf[8],  240);
+        put_uint16_le(&strf[12], 1);
+        put_uint16_le(&strf[14], 24);
+        std::memcpy(&strf[16], "XVID", 4);
+
+      } else {
+        put_uint16_le(&strf[0],  0x55);
+        put_uint16_le(&strf[2],  2);
+        put_uint32_le(&strf[4],  48000);
+        put_uint16_le(&strf[14], 16);
+      }
+
+      add_chunk("strf", strf);
+
+      if (opendml) {
+        auto num_ix_chunks = (num_frames + ODML_FRAMES_PER_IX_CHUNK - 1) / ODML_FRAMES_PER_IX_CHUNK;
+        auto indx          = std::string(24 + num_ix_chunks * 16, '\0');
+
+        put_uint16_le(&indx[0], 4);
+        put_uint32_le(&indx[4], num_ix_chunks);
+        std::memcpy(&indx[8], is_vid ? "00dc" : "01wb", 4);
+
+        indx_positions.push_back(m_data.size() + 8);
+        add_chunk("indx", indx);
+      }
+
+      end_list(strl);
+    }
+
+    end_list(hdrl);
+
+    auto movi       = start_list("LIST", "movi");
+    auto movi_start = m_data.size();
+    std::vector<uint64_t> video_positions, audio_positions;
+    std::string idx1;
+
+    for (auto frame = 0u; frame < num_frames; ++frame) {
+      for (auto is_vid : std::vector<bool>{ true, false }) {
+        auto tag  = is_vid ? "00dc" : "01wb";
+        auto size = (is_vid ? 24 : 12) + (frame % 4) * 2;
+        auto flag = is_vid && !(frame % 250) ? 0x10 : 0x00;
+        auto entry = std::string{tag} + std::string(12, '\0');
+
+        put_uint32_le(&entry[4],  flag);
+        put_uint32_le(&entry[8],  m_data.size() - movi_start + 4);
+        put_uint32_le(&entry[12], size);
+        idx1 += entry;
+
+        (is_vid ? video_positions : audio_positions).push_back(m_data.size() + 8);
+        add_chunk(tag, std::string(size, 'x'));
+      }
+    }
+
+    if (opendml) {
+      add_ix_chunks("ix00", video_positions, true,  indx_positions[0]);
+      add_ix_chunks("ix01", audio_positions, false, indx_positions[1]);
+    }
+
+    end_list(movi);
+
+    if (!opendml)
+      add_chunk("idx1", idx1);
+
+    end_list(riff);
+
+    return m_data;
+  }
+
+protected:
+  std::size_t
+  start_list(std::string const &id,
+             std::string const &type) {
+    auto position = m_data.size();
+    m_data       += id + std::string(4, '\0') + type;
+
+    return position;
+  }
+
+  void
+  end_list(std::size_t position) {
+    put_uint32_le(&m_data[position + 4], m_data.size() - position - 8);
+  }
+
+  void
+  add_chunk(std::string const &id,
+            std::string const &content) {
+    auto size = std::string(4, '\0');
+    put_uint32_le(&size[0], content.size());
+
+    m_data += id + size + content;
+    if (content.size() % 2)
+      m_data += '\0';
+  }
+
+  void
+  add_ix_chunks(std::string const &id,
+                std::vector<uint64_t> const &positions,
+                bool is_video,
+                std::size_t indx_position) {
+    for (auto first = 0u, ix_idx = 0u; first < positions.size(); first += ODML_FRAMES_PER_IX_CHUNK, ++ix_idx) {
+      auto num_entries = std::min<std::size_t>(positions.size() - first, ODML_FRAMES_PER_IX_CHUNK);
+      auto content     = std::string(24 + num_entries * 8, '\0');
+      auto base_offset = positions[first];
+
+      put_uint16_le(&content[0],  2);
+      content[3] = 1;
+      put_uint32_le(&content[4],  num_entries);
+      std::memcpy(&content[8], id.c_str() + 2, 2);
+      std::memcpy(&content[10], is_video ? "dc" : "wb", 2);
+      put_uint64_le(&content[12], base_offset);
+
+      for (auto idx = 0u; idx < num_entries; ++idx) {
+        auto frame = first + idx;
+        auto size  = is_video ? 24 + (frame % 4) * 2 : 12 + (frame % 4) * 2;
+        auto key   = !is_video || !(frame % 250);
+
+        put_uint32_le(&content[24 + idx * 8],     positions[frame] - base_offset);
+        put_uint32_le(&content[24 + idx * 8 + 4], size | (key ? 0 : 0x80000000));
+      }
+
+      auto entry = &m_data[indx_position + 24 + ix_idx * 16];
+      put_uint64_le(entry,     m_data.size());
+      put_uint32_le(entry + 8, content.size() + 8);
+      put_uint32_le(entry + 12, num_entries);
+
+      add_chunk(id, content);
+    }
+  }
+};
+
+// The generated files are written to the temporary directory once and
+// removed on exit.
+struct generated_files_t {
+  std::map<std::pair<unsigned int, bool>, bfs::path> m_files;
+
+  ~generated_files_t() {
+    boost::system::error_code ec;
+
+    for (auto const &file : m_files)
+      bfs::remove(file.second, ec);
+  }
+};
+
+std::string
+generated_file(unsigned int num_frames,
+               bool opendml) {
+  static generated_files_t s_files;
+
+  auto &file_name = s_files.m_files[{ num_frames, opendml }];
+  if (!file_name.empty())
+    return file_name.string();
+
+  file_name = bfs::temp_directory_path() / fmt::format("mkvtoolnix-benchmark-{0}-{1}.avi", opendml ? "odml" : "idx1", num_frames);
+  mm_file_io_c out{file_name.string(), MODE_CREATE};
+
+  out.write(avi_generator_c{}.generate(num_frames, opendml));
+
+  return file_name.string();
+}
+
+// Opening the file with avilib loading its index the way the AVI
+// reader used to, once for probing & once for reading.
+void
+BM_AviIndexAvilib(benchmark::State &state) {
+  auto file_name = generated_file(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    mm_file_io_c in{file_name};
+
+    for (auto run = 0; run < 2; ++run) {
+      in.setFilePointer(0);
+
+      auto avi = AVI_open_input_file(&in, 1);
+      if (!avi) {
+        state.SkipWithError("avilib could not open the file");
+        break;
+      }
+
+      benchmark::DoNotOptimize(AVI_video_frames(avi));
+      AVI_close(avi);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+// Parsing the headers for probing, then parsing them again & loading
+// the index natively for reading.
+void
+BM_AviIndexNative(benchmark::State &state) {
+  auto file_name = generated_file(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    mm_file_io_c in{file_name};
+    mtx::avi::index_c index;
+
+    for (auto run = 0; run < 2; ++run) {
+      in.setFilePointer(0);
+
+      auto avi = AVI_open_input_file(&in, 0);
+      if (!avi || ((1 == run) && !index.load(in, *avi))) {
+        state.SkipWithError("the index could not be loaded");
+        break;
+      }
+
+      AVI_close(avi);
+    }
+
+    benchmark::DoNotOptimize(index.get_video().size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+}
+
+// 'idx1' & OpenDML indexes of about one minute & about four hours of video
+BENCHMARK(BM_AviIndexAvilib)->Args({ 1'500, false })->Args({ 360'000, false })->Args({ 1'500, true })->Args({ 360'000, true })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AviIndexNative)->Args({ 1'500, false })->Args({ 360'000, false })->Args({ 1'500, true })->Args({ 360'000, true })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,264 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for the bit reader & the codec header parsers built on it
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "common/aac.h"
+#include "common/ac3.h"
+#include "common/avc.h"
+#include "common/bit_reader.h"
+#include "common/bit_writer.h"
+
+namespace {
+
+void
+put_unsigned_golomb(mtx::bits::writer_c &w,
+                    uint64_t value) {
+  auto num_bits = 0u;
+  while ((value + 1) >> (num_bits + 1))
+    ++num_bits;
+
+  w.put_bits(num_bits, 0);
+  w.put_bits(num_bits + 1, value + 1);
+}
+
+// Unsigned Exp-Golomb codes of the sizes typically found in slice
+// headers: mostly small values, some larger ones.
+memory_cptr
+generated_golomb_codes(std::size_t num_codes) {
+  std::mt19937 generator{4711};
+  mtx::bits::writer_c w;
+
+  for (auto idx = 0u; idx < num_codes; ++idx)
+    put_unsigned_golomb(w, (idx % 8) ? generator() % 16 : generator() % 4096);
+
+  w.put_bits(64, 0);
+
+  return w.get_buffer();
+}
+
+// Random data with an emulation prevention byte every 64 bytes.
+memory_cptr
+generated_nalu(std::size_t size) {
+  std::mt19937 generator{4711};
+  auto nalu = memory_c::alloc(size);
+  auto ptr  = nalu->get_buffer();
+
+  for (auto idx = 0u; idx < size; ++idx)
+    ptr[idx] = generator() % 255 + 1;
+
+  for (auto idx = 32u; (idx + 3) < size; idx += 64) {
+    ptr[idx]     = 0;
+    ptr[idx + 1] = 0;
+    ptr[idx + 2] = 3;
+  }
+
+  return nalu;
+}
+
+// A 1920x1080 High profile SPS with VUI timing information.
+memory_cptr
+generated_avc_sps() {
+  mtx::bits::writer_c w;
+
+  w.put_bits(8, 0x67);          // NALU header
+  w.put_bits(8, 100);           // profile_idc
+  w.put_bits(8, 0);             // constraint flags
+  w.put_bits(8, 40);            // level_idc
+  put_unsigned_golomb(w, 0);    // seq_parameter_set_id
+  put_unsigned_golomb(w, 1);    // chroma_format_idc
+  put_unsigned_golomb(w, 0);    // bit_depth_luma_minus8
+  put_unsigned_golomb(w, 0);    // bit_depth_chroma_minus8
+  w.put_bit(0);                 // qpprime_y_zero_transform_bypass_flag
+  w.put_bit(0);                 // seq_scaling_matrix_present_flag
+  put_unsigned_golomb(w, 0);    // log2_max_frame_num_minus4
+  put_unsigned_golomb(w, 0);    // pic_order_cnt_type
+  put_unsigned_golomb(w, 2);    // log2_max_pic_order_cnt_lsb_minus4
+  put_unsigned_golomb(w, 4);    // max_num_ref_frames
+  w.put_bit(0);                 // gaps_in_frame_num_value_allowed_flag
+  put_unsigned_golomb(w, 119);  // pic_width_in_mbs_minus1
+  put_unsigned_golomb(w, 67);   // pic_height_in_map_units_minus1
+  w.put_bit(1);                 // frame_mbs_only_flag
+  w.put_bit(1);                 // direct_8x8_inference_flag
+  w.put_bit(1);                 // frame_cropping_flag
+  put_unsigned_golomb(w, 0);
+  put_unsigned_golomb(w, 0);
+  put_unsigned_golomb(w, 0);
+  put_unsigned_golomb(w, 4);
+  w.put_bit(1);                 // vui_parameters_present_flag
+  w.put_bit(1);                 // aspect_ratio_info_present_flag
+  w.put_bits(8, 1);             // aspect_ratio_idc
+  w.put_bit(0);                 // overscan_info_present_flag
+  w.put_bit(0);                 // video_signal_type_present_flag
+  w.put_bit(0);                 // chroma_loc_info_present_flag
+  w.put_bit(1);                 // timing_info_present_flag
+  w.put_bits(32, 1001);         // num_units_in_tick
+  w.put_bits(32, 48000);        // time_scale
+  w.put_bit(1);                 // fixed_frame_rate_flag
+  w.put_bit(0);                 // nal_hrd_parameters_present_flag
+  w.put_bit(0);                 // vcl_hrd_parameters_present_flag
+  w.put_bit(0);                 // pic_struct_present_flag
+  w.put_bit(0);                 // bitstream_restriction_flag
+  w.put_bit(1);                 // rbsp_stop_one_bit
+  w.byte_align();
+
+  return w.get_buffer();
+}
+
+// A 448 kbit/s 5.1 AC-3 frame header followed by zeros.
+memory_cptr
+generated_ac3_frame() {
+  mtx::bits::writer_c w;
+
+  w.put_bits(16, 0x0b77);       // syncword
+  w.put_bits(16, 0);            // crc1
+  w.put_bits(2,  0);            // fscod: 48 kHz
+  w.put_bits(6,  30);           // frmsizecod: 448 kbit/s
+  w.put_bits(5,  8);            // bsid
+  w.put_bits(3,  0);            // bsmod
+  w.put_bits(3,  7);            // acmod: 3/2
+  w.put_bits(2,  2);            // cmixlev
+  w.put_bits(2,  2);            // surmixlev
+  w.put_bit(1);                 // lfeon
+  w.put_bits(5,  27);           // dialnorm
+  w.put_bits(64, 0);
+  w.byte_align();
+
+  return w.get_buffer();
+}
+
+// HE-AAC with an explicitly signalled SBR extension
+memory_cptr
+generated_aac_audio_specific_config() {
+  mtx::bits::writer_c w;
+
+  w.put_bits(5,  2);            // audioObjectType: AAC LC
+  w.put_bits(4,  6);            // samplingFrequencyIndex: 24 kHz
+  w.put_bits(4,  2);            // channelConfiguration
+  w.put_bits(3,  0);            // GASpecificConfig
+  w.put_bits(11, 0x2b7);        // syncExtensionType
+  w.put_bits(5,  5);            // extensionAudioObjectType: SBR
+  w.put_bit(1);                 // sbrPresentFlag
+  w.put_bits(4,  3);            // extensionSamplingFrequencyIndex: 48 kHz
+  w.byte_align();
+
+  return w.get_buffer();
+}
+
+void
+BM_BitReaderGetBits(benchmark::State &state) {
+  auto data     = generated_nalu(64 * 1024);
+  auto num_bits = static_cast<std::size_t>(state.range(0));
+  auto sum      = uint64_t{};
+
+  for (auto _ : state) {
+    mtx::bits::reader_c r{*data};
+
+    while (r.get_remaining_bits() >= static_cast<int>(num_bits))
+      sum += r.get_bits(num_bits);
+  }
+
+  benchmark::DoNotOptimize(sum);
+  state.SetBytesProcessed(state.iterations() * data->get_size());
+}
+
+void
+BM_BitReaderGetUnsignedGolomb(benchmark::State &state) {
+  auto const num_codes = 100000u;
+  auto data            = generated_golomb_codes(num_codes);
+  auto sum             = uint64_t{};
+
+  for (auto _ : state) {
+    mtx::bits::reader_c r{*data};
+
+    for (auto idx = 0u; idx < num_codes; ++idx)
+      sum += r.get_unsigned_golomb();
+  }
+
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * num_codes);
+}
+
+// Reads a whole NALU containing emulation prevention bytes either in
+// RBSP mode (argument 0) or after stripping them up front (argument 1).
+void
+BM_BitReaderEmulationPrevention(benchmark::State &state) {
+  auto data  = generated_nalu(64 * 1024);
+  auto strip = !!state.range(0);
+  auto sum   = uint64_t{};
+
+  for (auto _ : state) {
+    mtx::bits::reader_c r{*data};
+
+    if (strip)
+      r.strip_emulation_prevention_bytes();
+    else
+      r.enable_rbsp_mode();
+
+    try {
+      while (true)
+        sum += r.get_bits(12);
+    } catch (mtx::mm_io::end_of_file_x &) {
+    }
+  }
+
+  benchmark::DoNotOptimize(sum);
+  state.SetBytesProcessed(state.iterations() * data->get_size());
+}
+
+void
+BM_AvcParseSps(benchmark::State &state) {
+  auto sps = generated_avc_sps();
+
+  for (auto _ : state) {
+    mtx::avc::sps_info_t sps_info;
+    benchmark::DoNotOptimize(mtx::avc::parse_sps(sps, sps_info));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_Ac3DecodeHeader(benchmark::State &state) {
+  auto frame = generated_ac3_frame();
+
+  for (auto _ : state) {
+    mtx::ac3::frame_c header;
+    benchmark::DoNotOptimize(header.decode_header(frame->get_buffer(), frame->get_size()));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_AacParseAudioSpecificConfig(benchmark::State &state) {
+  auto config = generated_aac_audio_specific_config();
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::aac::parse_audio_specific_config(config->get_buffer(), config->get_size()));
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK(BM_BitReaderGetBits)->Arg(1)->Arg(5)->Arg(16)->Arg(32);
+BENCHMARK(BM_BitReaderGetUnsignedGolomb);
+BENCHMARK(BM_BitReaderEmulationPrevention)->Arg(0)->Arg(1);
+BENCHMARK(BM_AvcParseSps);
+BENCHMARK(BM_Ac3DecodeHeader);
+BENCHMARK(BM_AacParseAudioSpecificConfig);
@@ -0,0 +1,103 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for JSON identification output
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include "common/json.h"
+#include "common/json_writer.h"
+
+namespace {
+
+// Properties similar to the ones the MPEG transport stream reader
+// reports for each track.
+nlohmann::json
+track_properties(int64_t track_id) {
+  return nlohmann::json{
+    { "audio_channels",           6                                    },
+    { "audio_sampling_frequency", 48000                                },
+    { "codec_id",                 "A_AC3"                              },
+    { "default_track",            track_id == 0                        },
+    { "enabled_track",            true                                 },
+    { "forced_track",             false                                },
+    { "language",                 "eng"                                },
+    { "number",                   track_id + 1                         },
+    { "program_number",           track_id / 4 + 1                     },
+    { "stream_id",                0x100 + track_id                     },
+    { "track_name",               fmt::format("Track «{0}»", track_id) },
+  };
+}
+
+void
+BM_IdentificationJsonDocument(benchmark::State &state) {
+  std::size_t total_size{};
+
+  for (auto _ : state) {
+    auto json = nlohmann::json{
+      { "identification_format_version", 11                      },
+      { "file_name",                     "synthetic.ts"          },
+      { "tracks",                        nlohmann::json::array() },
+    };
+
+    for (auto track_id = 0; track_id < state.range(0); ++track_id)
+      json["tracks"] += nlohmann::json{
+        { "id",         track_id                  },
+        { "type",       "audio"                   },
+        { "codec",      "AC-3"                    },
+        { "properties", track_properties(track_id) },
+      };
+
+    total_size += mtx::json::dump(json, 2).size();
+  }
+
+  benchmark::DoNotOptimize(total_size);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void
+BM_IdentificationJsonWriter(benchmark::State &state) {
+  std::size_t total_size{};
+
+  for (auto _ : state) {
+    mtx::json::writer_c writer{[&total_size](std::string const &chunk) { total_size += chunk.size(); }};
+
+    writer
+      .start_object()
+      .member("file_name",                     "synthetic.ts")
+      .member("identification_format_version", 11)
+      .key("tracks")
+      .start_array();
+
+    for (auto track_id = 0; track_id < state.range(0); ++track_id)
+      writer
+        .start_object()
+        .member("codec",      "AC-3")
+        .member("id",         track_id)
+        .member("properties", track_properties(track_id))
+        .member("type",       "audio")
+        .end_object();
+
+    writer
+      .end_array()
+      .end_object();
+  }
+
+  benchmark::DoNotOptimize(total_size);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(BM_IdentificationJsonDocument)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_IdentificationJsonWriter)->RangeMultiplier(10)->Range(10, 10000);
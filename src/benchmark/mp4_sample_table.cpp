@@ -0,0 +1,195 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for building the MP4 reader's index from sample tables
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "common/mp4_sample_table.h"
+
+namespace {
+
+// The sample tables of a synthetic 'moov' atom: a 60000/1001 fps
+// video track with B frames ('ctts' runs of one sample each) and 30
+// samples per chunk.
+struct tables_t {
+  std::vector<qt_chunk_t> chunks;
+  std::vector<uint32_t> sample_sizes;
+  std::vector<qt_durmap_t> durations;
+  std::vector<qt_frame_offset_t> frame_offsets;
+};
+
+tables_t const &
+generated_tables(std::size_t num_samples) {
+  static std::map<std::size_t, tables_t> s_tables;
+
+  auto &tables = s_tables[num_samples];
+  if (!tables.sample_sizes.empty())
+    return tables;
+
+  std::mt19937 generator{4711};
+  auto position = uint64_t{48};
+
+  tables.sample_sizes.reserve(num_samples);
+  tables.frame_offsets.reserve(num_samples);
+
+  for (auto idx = 0u; idx < num_samples; ++idx) {
+    if (!(idx % 30)) {
+      tables.chunks.emplace_back(std::min<std::size_t>(30, num_samples - idx), position);
+      position += 4096;
+    }
+
+    tables.sample_sizes.push_back(!(idx % 30) ? 100000 + generator() % 50000 : 5000 + generator() % 20000);
+    tables.frame_offsets.emplace_back(1, (idx % 3) ? 0 : 2002);
+    position += tables.sample_sizes.back();
+  }
+
+  tables.durations.emplace_back(num_samples, 1001);
+
+  return tables;
+}
+
+int64_t
+to_nsecs(int64_t value) {
+  return value * 1'000'000'000ll / 60000;
+}
+
+// The index entry the way it was laid out before.
+struct expanded_index_t {
+  int64_t file_pos, size;
+  int64_t timestamp, duration;
+  bool    is_keyframe;
+};
+
+// The index entry the way it is laid out now.
+struct compact_index_t {
+  int64_t  file_pos, timestamp, duration;
+  uint32_t size;
+  bool     is_keyframe;
+};
+
+struct expanded_sample_t {
+  int64_t  pts;
+  uint32_t size;
+  int64_t  pos;
+};
+
+// Expands all tables into per-sample vectors first, calculates the
+// timestamps & durations into further vectors and builds the index from
+// them afterwards.
+void
+BM_Mp4IndexFromExpandedTables(benchmark::State &state) {
+  auto const &tables = generated_tables(state.range(0));
+  auto num_bytes     = std::size_t{};
+
+  for (auto _ : state) {
+    std::vector<expanded_sample_t> sample_table;
+    std::vector<int32_t> frame_offset_table;
+    std::vector<int64_t> timestamps, timestamps_before_offsets, durations, frame_indices;
+    std::vector<expanded_index_t> index;
+
+    sample_table.reserve(tables.sample_sizes.size());
+    for (auto size : tables.sample_sizes)
+      sample_table.push_back({ 0, size, 0 });
+
+    auto s   = 0u;
+    auto pts = int64_t{};
+    for (auto const &duration : tables.durations)
+      for (auto idx = 0u; (idx < duration.number) && (s < sample_table.size()); ++idx, ++s) {
+        sample_table[s].pts  = pts;
+        pts                 += duration.duration;
+      }
+
+    s = 0;
+    for (auto const &chunk : tables.chunks) {
+      auto pos = chunk.pos;
+      for (auto idx = 0u; (idx < chunk.size) && (s < sample_table.size()); ++idx, ++s) {
+        sample_table[s].pos  = pos;
+        pos                 += sample_table[s].size;
+      }
+    }
+
+    for (auto const &frame_offset : tables.frame_offsets)
+      for (auto idx = 0u; idx < frame_offset.count; ++idx)
+        frame_offset_table.push_back(frame_offset.offset);
+
+    auto num_samples = sample_table.size();
+
+    for (auto frame = 0u; frame < num_samples; ++frame) {
+      auto timestamp = to_nsecs(sample_table[frame].pts);
+
+      frame_indices.push_back(frame);
+      timestamps_before_offsets.push_back(timestamp);
+      timestamps.push_back(timestamp + (frame < frame_offset_table.size() ? to_nsecs(frame_offset_table[frame]) : 0));
+    }
+
+    for (auto frame = 0u; (frame + 1) < num_samples; ++frame)
+      durations.push_back(timestamps_before_offsets[frame + 1] - timestamps_before_offsets[frame]);
+    durations.push_back(0);
+
+    index.reserve(num_samples);
+    for (auto frame = 0u; frame < num_samples; ++frame) {
+      auto const &sample = sample_table[frame_indices[frame]];
+      index.push_back({ sample.pos, sample.size, timestamps[frame], durations[frame], true });
+    }
+
+    num_bytes = sample_table.size()       * sizeof(expanded_sample_t)
+              + frame_offset_table.size() * sizeof(int32_t)
+              + (timestamps.size() + timestamps_before_offsets.size() + durations.size() + frame_indices.size()) * sizeof(int64_t)
+              + index.size()              * sizeof(expanded_index_t);
+
+    benchmark::DoNotOptimize(index.data());
+  }
+
+  state.counters["bytes_per_sample"] = static_cast<double>(num_bytes) / tables.sample_sizes.size();
+  state.SetItemsProcessed(state.iterations() * tables.sample_sizes.size());
+}
+
+// Iterates over the run-length encoded tables and builds the index
+// directly.
+void
+BM_Mp4IndexFromSampleCursor(benchmark::State &state) {
+  auto const &tables = generated_tables(state.range(0));
+  auto num_bytes     = std::size_t{};
+
+  for (auto _ : state) {
+    mtx::mp4::sample_cursor_c cursor{tables.chunks, tables.sample_sizes, 0, tables.durations, tables.frame_offsets};
+    std::vector<compact_index_t> index;
+    mtx::mp4::sample_t sample;
+    auto num_samples = cursor.get_num_samples();
+    auto timestamp   = int64_t{};
+
+    index.reserve(num_samples);
+
+    for (auto frame = 0ull; cursor.get_next(sample); ++frame) {
+      auto next_timestamp = to_nsecs(sample.decoding_time + sample.duration);
+
+      index.push_back({ static_cast<int64_t>(sample.position), timestamp + to_nsecs(sample.composition_offset), (frame + 1) < num_samples ? next_timestamp - timestamp : 0, sample.size, true });
+      timestamp = next_timestamp;
+    }
+
+    num_bytes = index.size() * sizeof(compact_index_t);
+
+    benchmark::DoNotOptimize(index.data());
+  }
+
+  state.counters["bytes_per_sample"] = static_cast<double>(num_bytes) / tables.sample_sizes.size();
+  state.SetItemsProcessed(state.iterations() * tables.sample_sizes.size());
+}
+
+}
+
+BENCHMARK(BM_Mp4IndexFromExpandedTables)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Mp4IndexFromSampleCursor)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
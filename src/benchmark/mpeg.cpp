@@ -0,0 +1,67 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for NALU <-> RBSP conversion
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "common/mpeg.h"
+
+namespace {
+
+// Mostly random data similar to slice data with an emulation
+// prevention byte roughly every 4 KB.
+memory_cptr
+generated_nalu(std::size_t size) {
+  std::mt19937 generator{4711};
+  auto nalu = memory_c::alloc(size);
+  auto ptr  = nalu->get_buffer();
+
+  for (auto idx = 0u; idx < size; ++idx)
+    ptr[idx] = generator() % 255 + 1;
+
+  for (auto idx = 2048u; (idx + 3) < size; idx += 4096) {
+    ptr[idx]     = 0;
+    ptr[idx + 1] = 0;
+    ptr[idx + 2] = 3;
+  }
+
+  return nalu;
+}
+
+void
+BM_NaluToRbsp(benchmark::State &state) {
+  auto nalu = generated_nalu(state.range(0));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::mpeg::nalu_to_rbsp(nalu));
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void
+BM_RbspToNalu(benchmark::State &state) {
+  auto rbsp = mtx::mpeg::nalu_to_rbsp(generated_nalu(state.range(0)));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::mpeg::rbsp_to_nalu(rbsp));
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(BM_NaluToRbsp)->Arg(64)->Arg(64 * 1024)->Arg(1024 * 1024);
+BENCHMARK(BM_RbspToNalu)->Arg(64)->Arg(64 * 1024)->Arg(1024 * 1024);
@@ -0,0 +1,206 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for look-ups done by each run of the programs
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if HAVE_MAGIC_H
+extern "C" {
+#include <magic.h>
+}
+#endif
+
+#if !defined(SYS_WINDOWS)
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include "common/iso639.h"
+#include "common/mime.h"
+#include "common/mm_file_io.h"
+#include "common/strings/editing.h"
+
+namespace {
+
+// A mix of codes, names & unknown strings as given on the command line
+// or found in source files.
+std::vector<std::string> const &
+languages() {
+  static std::vector<std::string> const s_languages{ "ger", "eng", "deu", "fr", "und", "zxx", "jpn", "German", "spanish", "Castilian", "iw", "Zulu", "qqq", "does not exist" };
+  return s_languages;
+}
+
+// The way map_to_iso639_2_code() used to look languages up: searching
+// the table linearly, splitting & lower-casing all English names for
+// each look-up.
+int
+linear_look_up(std::string const &s) {
+  auto lang_code = brng::find_if(g_iso639_languages, [&s](auto const &lang) { return (lang.iso639_2_code == s) || (lang.terminology_abbrev == s) || (lang.iso639_1_code == s); });
+  if (lang_code != g_iso639_languages.end())
+    return std::distance(g_iso639_languages.begin(), lang_code);
+
+  auto s_lower = balg::to_lower_copy(s);
+
+  for (auto idx = 0u; idx < g_iso639_languages.size(); ++idx) {
+    auto names = split(g_iso639_languages[idx].english_name, ";");
+    strip(names);
+
+    for (auto const &name : names)
+      if (balg::to_lower_copy(name) == s_lower)
+        return idx;
+  }
+
+  return -1;
+}
+
+void
+BM_Iso639LinearLookUp(benchmark::State &state) {
+  for (auto _ : state)
+    for (auto const &language : languages())
+      benchmark::DoNotOptimize(linear_look_up(language));
+
+  state.SetItemsProcessed(state.iterations() * languages().size());
+}
+
+void
+BM_Iso639IndexedLookUp(benchmark::State &state) {
+  for (auto _ : state)
+    for (auto const &language : languages())
+      benchmark::DoNotOptimize(map_to_iso639_2_code(language));
+
+  state.SetItemsProcessed(state.iterations() * languages().size());
+}
+
+#if HAVE_MAGIC_H
+
+// A small PNG file as an attachment would be. It's written to the
+// temporary directory and removed on exit.
+struct attachment_t {
+  bfs::path m_file_name;
+
+  attachment_t(std::string const &id = "attachment")
+    : m_file_name{bfs::temp_directory_path() / fmt::format("mkvtoolnix-benchmark-{0}.png", id)}
+  {
+    mm_file_io_c out{m_file_name.string(), MODE_CREATE};
+    out.write("\x89PNG\r\n\x1a\n\0\0\0\x0dIHDR\0\0\0\x10\0\0\0\x10\x08\x06\0\0\0"s);
+    out.write(std::string(4096, '\0'));
+  }
+
+  ~attachment_t() {
+    boost::system::error_code ec;
+    bfs::remove(m_file_name, ec);
+  }
+};
+
+std::string const &
+attachment_file_name() {
+  static attachment_t s_attachment;
+  return s_attachment.m_file_name.string();
+}
+
+// Opening & loading the magic database for each file the way
+// mtx::mime::guess_type() used to.
+void
+BM_MimeLoadMagicPerFile(benchmark::State &state) {
+  auto file_name = attachment_file_name();
+
+  for (auto _ : state) {
+# ifdef MAGIC_MIME_TYPE
+    auto m = magic_open(MAGIC_MIME_TYPE | MAGIC_SYMLINK);
+# else
+    auto m = magic_open(MAGIC_MIME      | MAGIC_SYMLINK);
+# endif
+
+    magic_load(m, nullptr);
+
+    mm_file_io_c file{file_name};
+    std::string content;
+    file.read(content, file.get_size());
+
+    benchmark::DoNotOptimize(magic_buffer(m, content.c_str(), content.size()));
+    magic_close(m);
+  }
+}
+
+void
+BM_MimeGuessType(benchmark::State &state) {
+  auto file_name = attachment_file_name();
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::mime::guess_type(file_name, true));
+}
+
+#endif  // HAVE_MAGIC_H
+
+#if !defined(SYS_WINDOWS)
+
+// What each program does on startup: initializing the common code
+// (range 1) and the first language & MIME type look-ups (range 2) on
+// top of it. Range 0 measures forking & exiting only. Most of this is
+// done only once per process; therefore each iteration runs in a
+// freshly forked one. Run it on its own ('--benchmark_filter=Startup')
+// so that nothing has been initialized before forking.
+void
+BM_StartupCommonInit(benchmark::State &state) {
+  auto what = state.range(0);
+
+# if HAVE_MAGIC_H
+  // Created up front so that writing it isn't measured. The children
+  // exit without running destructors; the parent removes it.
+  attachment_t attachment{"startup"};
+  auto file_name = attachment.m_file_name.string();
+# endif
+
+  for (auto _ : state) {
+    auto pid = fork();
+
+    if (!pid) {
+      if (what >= 1)
+        mtx_common_init("benchmark", nullptr);
+
+      if (what >= 2) {
+        for (auto const &language : languages())
+          benchmark::DoNotOptimize(map_to_iso639_2_code(language));
+
+# if HAVE_MAGIC_H
+        benchmark::DoNotOptimize(mtx::mime::guess_type(file_name, true));
+# endif
+      }
+
+      _exit(0);
+    }
+
+    auto status = 0;
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || WEXITSTATUS(status)) {
+      state.SkipWithError("the child process could not be run");
+      break;
+    }
+  }
+}
+
+#endif  // !SYS_WINDOWS
+
+}
+
+#if !defined(SYS_WINDOWS)
+BENCHMARK(BM_StartupCommonInit)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+#endif
+
+BENCHMARK(BM_Iso639LinearLookUp);
+BENCHMARK(BM_Iso639IndexedLookUp);
+
+#if HAVE_MAGIC_H
+BENCHMARK(BM_MimeLoadMagicPerFile)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MimeGuessType)->Unit(benchmark::kMillisecond);
+#endif
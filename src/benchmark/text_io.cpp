@@ -0,0 +1,136 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for reading text files line by line
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include "common/mm_mem_io.h"
+#include "common/mm_proxy_io.h"
+#include "common/mm_text_io.h"
+#include "common/strings/utf8.h"
+
+namespace {
+
+enum class encoding_e {
+  utf8,
+  utf16le,
+  none,
+};
+
+// An SRT file with about 20,000 entries, mixing ASCII and non-ASCII
+// text, with DOS line endings.
+std::string const &
+generated_srt() {
+  static std::string s_srt;
+
+  if (s_srt.empty())
+    for (auto idx = 0; idx < 20000; ++idx)
+      s_srt += fmt::format("{0}\r\n00:{1:02}:{2:02},000 --> 00:{1:02}:{2:02},500\r\n"
+                           "Das ist die {0}. Zeile mit Umlauten: äöü ÄÖÜ ß.\r\n"
+                           "And this is the second line of entry number {0}.\r\n\r\n",
+                           idx + 1, (idx / 60) % 60, idx % 60);
+
+  return s_srt;
+}
+
+memory_cptr
+encode(encoding_e encoding) {
+  auto const &srt = generated_srt();
+
+  if (encoding_e::none == encoding)
+    return memory_c::clone(srt);
+
+  if (encoding_e::utf8 == encoding)
+    return memory_c::clone("\xef\xbb\xbf"s + srt);
+
+  std::string utf16{"\xff\xfe"};
+
+  for (auto codepoint : to_wide(srt)) {
+    utf16 += static_cast<char>(codepoint & 0xff);
+    utf16 += static_cast<char>((codepoint >> 8) & 0xff);
+  }
+
+  return memory_c::clone(utf16);
+}
+
+void
+BM_TextIoGetline(benchmark::State &state) {
+  auto content   = encode(static_cast<encoding_e>(state.range(0)));
+  auto num_lines = std::size_t{};
+
+  for (auto _ : state) {
+    mm_text_io_c in{std::make_shared<mm_mem_io_c>(*content)};
+    std::string line;
+
+    while (in.getline2(line))
+      ++num_lines;
+  }
+
+  benchmark::DoNotOptimize(num_lines);
+  state.SetBytesProcessed(state.iterations() * content->get_size());
+}
+
+// Assembles lines from individual code points the way getline() used
+// to before it started decoding blocks of text.
+void
+BM_TextIoCodepointLoop(benchmark::State &state) {
+  auto content   = encode(static_cast<encoding_e>(state.range(0)));
+  auto num_lines = std::size_t{};
+
+  for (auto _ : state) {
+    mm_text_io_c in{std::make_shared<mm_mem_io_c>(*content)};
+    std::string line;
+
+    while (true) {
+      in.getFilePointer();
+      auto codepoint = in.read_next_codepoint();
+
+      if (codepoint.empty())
+        break;
+
+      if (codepoint == "\n") {
+        ++num_lines;
+        line.clear();
+
+      } else if (codepoint != "\r")
+        line += codepoint;
+    }
+  }
+
+  benchmark::DoNotOptimize(num_lines);
+  state.SetBytesProcessed(state.iterations() * content->get_size());
+}
+
+void
+BM_MemIoGetline(benchmark::State &state) {
+  auto content   = encode(encoding_e::none);
+  auto num_lines = std::size_t{};
+
+  for (auto _ : state) {
+    mm_mem_io_c in{*content};
+    std::string line;
+
+    while (in.getline2(line))
+      ++num_lines;
+  }
+
+  benchmark::DoNotOptimize(num_lines);
+  state.SetBytesProcessed(state.iterations() * content->get_size());
+}
+
+}
+
+BENCHMARK(BM_TextIoGetline)->Arg(static_cast<int>(encoding_e::utf8))->Arg(static_cast<int>(encoding_e::utf16le))->Arg(static_cast<int>(encoding_e::none));
+BENCHMARK(BM_TextIoCodepointLoop)->Arg(static_cast<int>(encoding_e::utf8))->Arg(static_cast<int>(encoding_e::utf16le))->Arg(static_cast<int>(encoding_e::none));
+BENCHMARK(BM_MemIoGetline);
@@ -0,0 +1,155 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   benchmarks for converting XML tags to EBML and back
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "common/mm_file_io.h"
+#include "common/mm_null_io.h"
+#include "common/xml/ebml_tags_converter.h"
+
+namespace {
+
+// Tag files with one tag of about 450 bytes per track UID. They're
+// written to the temporary directory once and removed on exit.
+struct generated_files_t {
+  std::map<std::size_t, bfs::path> m_files;
+
+  ~generated_files_t() {
+    boost::system::error_code ec;
+
+    for (auto const &file : m_files)
+      bfs::remove(file.second, ec);
+  }
+};
+
+std::string
+generated_file(std::size_t num_tags) {
+  static generated_files_t s_files;
+
+  auto &file_name = s_files.m_files[num_tags];
+  if (!file_name.empty())
+    return file_name.string();
+
+  file_name = bfs::temp_directory_path() / fmt::format("mkvtoolnix-benchmark-tags-{0}.xml", num_tags);
+  mm_file_io_c out{file_name.string(), MODE_CREATE};
+
+  out.puts("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<!DOCTYPE Tags SYSTEM \"matroskatags.dtd\">\n"
+           "<Tags>\n");
+
+  for (auto idx = 0u; idx < num_tags; ++idx)
+    out.puts(fmt::format("  <Tag>\n"
+                         "    <Targets>\n"
+                         "      <TargetTypeValue>50</TargetTypeValue>\n"
+                         "      <TrackUID>{0}</TrackUID>\n"
+                         "    </Targets>\n"
+                         "    <Simple>\n"
+                         "      <Name>TITLE</Name>\n"
+                         "      <String>Title number {0} with umlauts: äöü ÄÖÜ ß</String>\n"
+                         "      <TagLanguage>ger</TagLanguage>\n"
+                         "    </Simple>\n"
+                         "    <Simple>\n"
+                         "      <Name>COMMENT</Name>\n"
+                         "      <String>A longer comment for track {0} &amp; its tag, long enough to be somewhat realistic.</String>\n"
+                         "    </Simple>\n"
+                         "  </Tag>\n",
+                         idx + 1));
+
+  out.puts("</Tags>\n");
+
+  return file_name.string();
+}
+
+libmatroska::KaxTags &
+generated_tags(std::size_t num_tags) {
+  static std::map<std::size_t, std::shared_ptr<libmatroska::KaxTags>> s_tags;
+
+  auto &tags = s_tags[num_tags];
+  if (!tags)
+    tags = mtx::xml::ebml_tags_converter_c::parse_file(generated_file(num_tags), true);
+
+  return *tags;
+}
+
+void
+to_ebml(benchmark::State &state,
+        bool streaming) {
+  auto file_name = generated_file(state.range(0));
+
+  for (auto _ : state) {
+    mtx::xml::ebml_tags_converter_c converter;
+    converter.enable_streaming(streaming);
+
+    auto tags = converter.to_ebml(file_name, "Tags");
+    benchmark::DoNotOptimize(tags.get());
+  }
+
+  state.SetBytesProcessed(state.iterations() * bfs::file_size(file_name));
+}
+
+// Loads the whole file into a DOM and converts that.
+void
+BM_XmlTagsToEbmlWholeDocument(benchmark::State &state) {
+  to_ebml(state, false);
+}
+
+// Converts one <Tag> at a time while reading the file.
+void
+BM_XmlTagsToEbmlStreamed(benchmark::State &state) {
+  to_ebml(state, true);
+}
+
+// Creates a DOM of all tags and saves it the way write_xml() used to.
+void
+BM_XmlTagsToXmlWholeDocument(benchmark::State &state) {
+  auto &tags = generated_tags(state.range(0));
+
+  for (auto _ : state) {
+    mm_null_io_c out{"null"};
+    auto doc = std::make_shared<pugi::xml_document>();
+
+    doc->append_child(pugi::node_comment).set_value(" <!DOCTYPE Tags SYSTEM \"matroskatags.dtd\"> ");
+    mtx::xml::ebml_tags_converter_c{}.to_xml(tags, doc);
+
+    std::stringstream out_stream;
+    doc->save(out_stream, "  ");
+    out.puts(out_stream.str());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Creates the XML for one tag at a time.
+void
+BM_XmlTagsToXmlStreamed(benchmark::State &state) {
+  auto &tags = generated_tags(state.range(0));
+
+  for (auto _ : state) {
+    mm_null_io_c out{"null"};
+    mtx::xml::ebml_tags_converter_c::write_xml(tags, out);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+// About 20 and 200 MB
+BENCHMARK(BM_XmlTagsToEbmlWholeDocument)->Arg(45'000)->Arg(450'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_XmlTagsToEbmlStreamed)->Arg(45'000)->Arg(450'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_XmlTagsToXmlWholeDocument)->Arg(45'000)->Arg(450'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_XmlTagsToXmlStreamed)->Arg(45'000)->Arg(450'000)->Unit(benchmark::kMillisecond);
@@ -420,6 +420,13 @@ frame_c::init() {
   m_garbage_size     = 0;
   m_timestamp.reset();
   m_data.reset();
+  m_data_slice       = memory_slice_t{};
+}
+
+memory_slice_t
+frame_c::get_data_slice()
+  const {
+  return m_data ? memory_slice_t{ m_data, 0, m_data->get_size() } : m_data_slice;
 }
 
 std::string
@@ -452,6 +459,7 @@ parser_c::parser_c()
   , m_abort_after_num_frames{}
   , m_require_frame_at_first_byte{}
   , m_copy_data{true}
+  , m_slice_data{}
   , m_multiplex_type{unknown_multiplex}
   , m_debug{"aac_parser"}
 {
@@ -462,9 +470,47 @@ parser_c::add_timestamp(timestamp_c const &timestamp) {
   m_provided_timestamps.push_back(timestamp);
 }
 
+/* With slicing enabled ADTS frames refer to the added memory instead of
+   being copied. Only frames spanning two added buffers are copied. */
 void
 parser_c::add_bytes(memory_cptr const &mem) {
-  add_bytes(mem->get_buffer(), mem->get_size());
+  if (!m_slice_data || !m_copy_data || !mem->is_owned()) {
+    add_bytes(mem->get_buffer(), mem->get_size());
+    return;
+  }
+
+  // Frame lengths are stored in 13 bits.
+  auto const max_frame_size = std::size_t{(1 << 13) + 3};
+  auto buffer               = mem->get_buffer();
+  auto size                 = mem->get_size();
+  auto position             = std::size_t{};
+
+  m_total_stream_position  += size;
+
+  if (m_buffer.get_size()) {
+    // Complete the frame started in the previous buffer by copying just
+    // enough bytes for it.
+    auto num_buffered = m_buffer.get_size();
+    auto num_copied   = std::min(size, max_frame_size);
+
+    m_buffer.add(buffer, num_copied);
+    auto num_parsed = parse_buffer(m_buffer.get_buffer(), m_buffer.get_size());
+
+    if ((num_copied == size) || (num_parsed < num_buffered)) {
+      m_buffer.remove(num_parsed);
+      m_buffer.add(buffer + num_copied, size - num_copied);
+      return;
+    }
+
+    position = num_parsed - num_buffered;
+    m_buffer.clear();
+  }
+
+  m_sliced_input  = mem;
+  position       += parse_buffer(buffer + position, size - position);
+  m_sliced_input.reset();
+
+  m_buffer.add(buffer + position, size - position);
 }
 
 void
@@ -513,6 +559,11 @@ parser_c::copy_data(bool copy) {
   m_copy_data = copy;
 }
 
+void
+parser_c::slice_data(bool slice) {
+  m_slice_data = slice;
+}
+
 size_t
 parser_c::frames_available()
   const {
@@ -607,7 +658,10 @@ parser_c::decode_adts_header(unsigned char const *buffer,
       frame.m_header.parse_program_config_element(bc);
     bc.set_bit_position(data_start_position);
 
-    if (m_copy_data) {
+    if (m_sliced_input)
+      frame.m_data_slice = { m_sliced_input, static_cast<std::size_t>(buffer - m_sliced_input->get_buffer()) + frame.m_header.header_byte_size, frame.m_header.data_byte_size };
+
+    else if (m_copy_data) {
       frame.m_data = memory_c::alloc(frame.m_header.data_byte_size);
       bc.get_bytes(frame.m_data->get_buffer(), frame.m_header.data_byte_size);
     }
@@ -743,12 +797,20 @@ parser_c::push_frame(frame_c &frame) {
 
 void
 parser_c::parse() {
+  auto position = m_fixed_buffer ? parse_buffer(m_fixed_buffer,         m_fixed_buffer_size)
+                :                  parse_buffer(m_buffer.get_buffer(), m_buffer.get_size());
+
+  if (!m_fixed_buffer)
+    m_buffer.remove(position);
+}
+
+std::size_t
+parser_c::parse_buffer(unsigned char const *buffer,
+                       std::size_t buffer_size) {
   if (m_abort_after_num_frames && (m_num_frames_found >= m_abort_after_num_frames))
-    return;
+    return 0;
 
-  auto buffer      = m_fixed_buffer ? m_fixed_buffer      : m_buffer.get_buffer();
-  auto buffer_size = m_fixed_buffer ? m_fixed_buffer_size : m_buffer.get_size();
-  auto position    = 0u;
+  auto position = std::size_t{};
 
   while (position < buffer_size) {
     auto remaining_bytes = buffer_size - position;
@@ -776,8 +838,7 @@ parser_c::parse() {
       break;
   }
 
-  if (!m_fixed_buffer)
-    m_buffer.remove(position);
+  return position;
 }
 
 std::string
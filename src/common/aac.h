@@ -141,11 +141,16 @@ public:
   size_t m_garbage_size;
   timestamp_c m_timestamp;
   memory_cptr m_data;
+  // Set instead of m_data if the parser referred to the added data
+  // (see parser_c::slice_data()).
+  memory_slice_t m_data_slice;
 
 public:
   frame_c();
   void init();
 
+  memory_slice_t get_data_slice() const;
+
   std::string to_string(bool verbose = false) const;
 };
 
@@ -173,7 +178,8 @@ protected:
   size_t m_fixed_buffer_size;
   uint64_t m_parsed_stream_position, m_total_stream_position;
   size_t m_garbage_size, m_num_frames_found, m_abort_after_num_frames;
-  bool m_require_frame_at_first_byte, m_copy_data;
+  bool m_require_frame_at_first_byte, m_copy_data, m_slice_data;
+  memory_cptr m_sliced_input;
   multiplex_type_e m_multiplex_type;
   header_c m_header;
   latm_parser_c m_latm_parser;
@@ -205,6 +211,7 @@ public:
   void abort_after_num_frames(size_t num_frames);
   void require_frame_at_first_byte(bool require);
   void copy_data(bool copy);
+  void slice_data(bool slice);
 
 public:                         // static functions
   static int find_consecutive_frames(unsigned char const *buffer, size_t buffer_size, size_t num_required_frames);
@@ -212,6 +219,7 @@ public:                         // static functions
 
 protected:
   void parse();
+  std::size_t parse_buffer(unsigned char const *buffer, std::size_t buffer_size);
   std::pair<parse_result_e, size_t> decode_header(unsigned char const *buffer, size_t buffer_size);
   std::pair<parse_result_e, size_t> decode_adts_header(unsigned char const *buffer, size_t buffer_size);
   std::pair<parse_result_e, size_t> decode_loas_latm_header(unsigned char const *buffer, size_t buffer_size);
@@ -453,9 +453,10 @@ es_parser_c::handle_sei_nalu(memory_cptr const &nalu) {
   try {
     ++m_stats.num_sei_nalus;
 
-    auto nalu_as_rbsp = mtx::mpeg::nalu_to_rbsp(nalu);
-
-    mtx::bits::reader_c r(nalu_as_rbsp->get_buffer(), nalu_as_rbsp->get_size());
+    // Only the payload headers are needed; let the bit reader skip the
+    // emulation prevention bytes instead of converting the whole NALU.
+    mtx::bits::reader_c r(nalu->get_buffer(), nalu->get_size());
+    r.enable_rbsp_mode();
 
     r.skip_bits(8);
 
@@ -0,0 +1,306 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   AVI chunk indexes ('idx1' & OpenDML 'ix##' indexes)
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/avi_index.h"
+#include "common/endian.h"
+#include "common/mm_io_x.h"
+
+namespace mtx { namespace avi {
+
+namespace {
+
+// Size of an OpenDML standard index chunk's header including the
+// chunk's ID & size.
+unsigned int const ODML_INDEX_HEADER_SIZE = 32;
+
+uint32_t const NOT_A_KEY_FRAME            = 0x80000000;
+uint32_t const MAX_CHUNK_SIZE             = 0x7fffffff;
+
+// Chunk IDs are compared case-insensitively, and for video chunks
+// only the stream number is compared ("00db" & "00dc").
+bool
+tag_matches(void const *tag,
+            char const *stream_tag,
+            std::size_t length) {
+  auto chars = static_cast<char const *>(tag);
+
+  for (auto idx = 0u; idx < length; ++idx)
+    if (std::tolower(static_cast<unsigned char>(chars[idx])) != std::tolower(static_cast<unsigned char>(stream_tag[idx])))
+      return false;
+
+  return true;
+}
+
+}
+
+void
+chunk_index_c::reserve(std::size_t num_chunks) {
+  m_positions.reserve(num_chunks);
+  m_sizes.reserve(num_chunks);
+}
+
+// Sizes are limited to 2 GB - 1 byte as the size's most significant
+// bit is used for the key frame flag.
+void
+chunk_index_c::add(uint64_t position,
+                   uint64_t size,
+                   bool key) {
+  auto stored_size = static_cast<uint32_t>(std::min<uint64_t>(size, MAX_CHUNK_SIZE));
+
+  m_positions.push_back(position);
+  m_sizes.push_back(stored_size | (key ? 0 : NOT_A_KEY_FRAME));
+  m_total_size += stored_size;
+}
+
+std::size_t
+chunk_index_c::size()
+  const {
+  return m_positions.size();
+}
+
+bool
+chunk_index_c::empty()
+  const {
+  return m_positions.empty();
+}
+
+uint64_t
+chunk_index_c::get_position(std::size_t idx)
+  const {
+  return m_positions[idx];
+}
+
+uint32_t
+chunk_index_c::get_size(std::size_t idx)
+  const {
+  return m_sizes[idx] & MAX_CHUNK_SIZE;
+}
+
+bool
+chunk_index_c::is_key(std::size_t idx)
+  const {
+  return !(m_sizes[idx] & NOT_A_KEY_FRAME);
+}
+
+uint64_t
+chunk_index_c::get_total_size()
+  const {
+  return m_total_size;
+}
+
+// ----------------------------------------------------------------------
+
+chunk_index_c const &
+index_c::get_video()
+  const {
+  return m_video;
+}
+
+chunk_index_c const &
+index_c::get_audio(std::size_t idx)
+  const {
+  return m_audio.at(idx);
+}
+
+chunk_index_c const &
+index_c::get_text(std::size_t idx)
+  const {
+  return m_text.at(idx);
+}
+
+bool
+index_c::load(mm_io_c &in,
+              avi_t const &avi) {
+  m_video = chunk_index_c{};
+  m_audio.assign(std::max(avi.anum, 0), chunk_index_c{});
+  m_text.assign(std::max(avi.tnum, 0),  chunk_index_c{});
+
+  if (!avi.is_opendml)
+    return load_idx1(in, avi);
+
+  load_odml(in, avi.video_superindex, m_video);
+
+  // avilib treats OpenDML files without any video chunk in their
+  // indexes like files with multiple RIFF lists but without an index.
+  if (m_video.empty())
+    return false;
+
+  for (auto idx = 0; idx < avi.anum; ++idx)
+    load_odml(in, avi.track[idx].audio_superindex, m_audio[idx]);
+
+  for (auto idx = 0; idx < avi.tnum; ++idx)
+    load_odml(in, avi.ttrack[idx].audio_superindex, m_text[idx]);
+
+  return true;
+}
+
+/* The offsets in 'idx1' are relative either to the start of the file
+   or to the 'movi' list. Which one is determined by looking at the
+   first video chunk's header. Returns the value to add to an entry's
+   offset in order to get the position of the chunk's data. */
+boost::optional<uint64_t>
+index_c::determine_idx1_data_offset(mm_io_c &in,
+                                    avi_t const &avi) {
+  auto end   = avi.idx + avi.n_idx;
+  auto entry = std::find_if(avi.idx, end, [&avi](uint8_t const *e) { return tag_matches(e, avi.video_tag, 2); });
+
+  if (entry == end)
+    return {};
+
+  auto size            = get_uint32_le(&(*entry)[12]);
+  auto is_chunk_header = [&in, &entry, size](uint64_t position) -> bool {
+    try {
+      unsigned char header[8];
+
+      in.setFilePointer(position);
+      return (in.read(header, 8) == 8) && tag_matches(header, reinterpret_cast<char const *>(*entry), 4) && (get_uint32_le(&header[4]) == size);
+
+    } catch (mtx::mm_io::exception &) {
+      return false;
+    }
+  };
+
+  auto offset = static_cast<uint64_t>(get_uint32_le(&(*entry)[8]));
+
+  if (is_chunk_header(offset))
+    return 8;
+
+  if (is_chunk_header(offset + avi.movi_start - 4))
+    return avi.movi_start + 4;
+
+  return {};
+}
+
+bool
+index_c::load_idx1(mm_io_c &in,
+                   avi_t const &avi) {
+  if (!avi.idx || (0 >= avi.n_idx))
+    return false;
+
+  auto data_offset = determine_idx1_data_offset(in, avi);
+  if (!data_offset)
+    return false;
+
+  std::vector<std::size_t> num_audio_chunks(m_audio.size());
+  std::size_t num_video_chunks{};
+
+  for (auto entry = avi.idx, end = avi.idx + avi.n_idx; entry < end; ++entry) {
+    if (tag_matches(*entry, avi.video_tag, 2))
+      ++num_video_chunks;
+
+    for (auto track = 0u; track < m_audio.size(); ++track)
+      if (tag_matches(*entry, avi.track[track].audio_tag, 4))
+        ++num_audio_chunks[track];
+  }
+
+  m_video.reserve(num_video_chunks);
+  for (auto track = 0u; track < m_audio.size(); ++track)
+    m_audio[track].reserve(num_audio_chunks[track]);
+
+  for (auto entry = avi.idx, end = avi.idx + avi.n_idx; entry < end; ++entry) {
+    auto position = get_uint32_le(&(*entry)[8]) + *data_offset;
+    auto size     = get_uint32_le(&(*entry)[12]);
+
+    if (tag_matches(*entry, avi.video_tag, 2))
+      m_video.add(position, size, get_uint32_le(&(*entry)[4]) & 0x10);
+
+    for (auto track = 0u; track < m_audio.size(); ++track)
+      if (tag_matches(*entry, avi.track[track].audio_tag, 4))
+        m_audio[track].add(position, size, true);
+  }
+
+  return !m_video.empty();
+}
+
+void
+index_c::load_odml(mm_io_c &in,
+                   avisuperindex_chunk const *superindex,
+                   chunk_index_c &index) {
+  if (!superindex || !superindex->aIndex)
+    return;
+
+  // Each entry of a standard index takes up eight bytes.
+  auto file_size       = static_cast<uint64_t>(std::max<int64_t>(in.get_size(), 0));
+  auto max_num_entries = uint64_t{};
+
+  for (auto idx = 0u; idx < superindex->nEntriesInUse; ++idx)
+    max_num_entries += superindex->aIndex[idx].dwSize / 8;
+
+  index.reserve(std::min(max_num_entries, file_size / 8));
+
+  std::vector<unsigned char> buffer;
+
+  for (auto idx = 0u; idx < superindex->nEntriesInUse; ++idx) {
+    auto const &ix_chunk = superindex->aIndex[idx];
+    auto num_read        = std::size_t{};
+
+    buffer.resize(std::min<uint64_t>(ix_chunk.dwSize, file_size) + ODML_INDEX_HEADER_SIZE);
+
+    try {
+      in.setFilePointer(ix_chunk.qwOffset);
+      num_read = in.read(buffer.data(), buffer.size());
+
+    } catch (mtx::mm_io::exception &) {
+      continue;
+    }
+
+    if (num_read < ODML_INDEX_HEADER_SIZE)
+      continue;
+
+    auto entry_size  = std::max<unsigned int>(get_uint16_le(&buffer[8]), 2) * 4;
+    auto num_entries = std::min<uint64_t>(get_uint32_le(&buffer[12]), (num_read - ODML_INDEX_HEADER_SIZE) / entry_size);
+    auto base_offset = get_uint64_le(&buffer[20]);
+    auto entry       = &buffer[ODML_INDEX_HEADER_SIZE];
+
+    for (auto end = entry + num_entries * entry_size; entry < end; entry += entry_size) {
+      auto offset = get_uint32_le(entry);
+      auto size   = get_uint32_le(entry + 4);
+
+      // Completely empty entries are ignored.
+      if (offset || (size & MAX_CHUNK_SIZE))
+        index.add(base_offset + offset, size & MAX_CHUNK_SIZE, !(size & NOT_A_KEY_FRAME));
+    }
+  }
+}
+
+void
+index_c::import(avi_t const &avi) {
+  m_video = chunk_index_c{};
+  m_audio.assign(std::max(avi.anum, 0), chunk_index_c{});
+  m_text.assign(std::max(avi.tnum, 0),  chunk_index_c{});
+
+  auto import_chunks = [](audio_index_entry const *entries, long num_entries, chunk_index_c &index) {
+    if (!entries)
+      return;
+
+    index.reserve(std::max(num_entries, 0l));
+    for (auto idx = 0l; idx < num_entries; ++idx)
+      index.add(entries[idx].pos, entries[idx].len, true);
+  };
+
+  if (avi.video_index) {
+    m_video.reserve(std::max(avi.video_frames, 0l));
+    for (auto idx = 0l; idx < avi.video_frames; ++idx)
+      m_video.add(avi.video_index[idx].pos, avi.video_index[idx].len, avi.video_index[idx].key);
+  }
+
+  for (auto idx = 0; idx < avi.anum; ++idx)
+    import_chunks(avi.track[idx].audio_index, avi.track[idx].audio_chunks, m_audio[idx]);
+
+  for (auto idx = 0; idx < avi.tnum; ++idx)
+    import_chunks(avi.ttrack[idx].audio_index, avi.ttrack[idx].audio_chunks, m_text[idx]);
+}
+
+}}
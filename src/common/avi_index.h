@@ -0,0 +1,77 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   AVI chunk indexes ('idx1' & OpenDML 'ix##' indexes)
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "avilib.h"
+
+namespace mtx { namespace avi {
+
+/* The position & size of each chunk of one stream in the order in
+   which they're listed in the file's index. Positions point to the
+   chunk's data, not to its header. The key frame flag is kept in the
+   size's most significant bit the way OpenDML indexes store it (set for
+   chunks that aren't key frames), so that each chunk takes up 12 bytes
+   instead of the 24 bytes of avilib's index entries. */
+class chunk_index_c {
+protected:
+  std::vector<uint64_t> m_positions;
+  std::vector<uint32_t> m_sizes;
+  uint64_t m_total_size{};
+
+public:
+  void reserve(std::size_t num_chunks);
+  void add(uint64_t position, uint64_t size, bool key);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  uint64_t get_position(std::size_t idx) const;
+  uint32_t get_size(std::size_t idx) const;
+  bool is_key(std::size_t idx) const;
+  uint64_t get_total_size() const;
+};
+
+/* The chunk indexes of the video, audio & text streams of a file whose
+   headers have been parsed by avilib without loading its index
+   (AVI_open_input_file(…, 0)). Streams are numbered the way avilib
+   numbers them, and chunks are assigned to them the way avilib does.
+
+   load() reads the 'idx1' entries avilib has read along with the
+   headers, or the OpenDML 'ix##' chunks listed in the super indexes,
+   reading each 'ix##' chunk with a single read. It returns false if
+   avilib would have to reconstruct the index by scanning the 'movi'
+   list; in that case the file has to be opened with avilib's index, and
+   that index can be copied with import(). */
+class index_c {
+protected:
+  chunk_index_c m_video;
+  std::vector<chunk_index_c> m_audio, m_text;
+
+public:
+  bool load(mm_io_c &in, avi_t const &avi);
+  void import(avi_t const &avi);
+
+  chunk_index_c const &get_video() const;
+  chunk_index_c const &get_audio(std::size_t idx) const;
+  chunk_index_c const &get_text(std::size_t idx) const;
+
+protected:
+  bool load_idx1(mm_io_c &in, avi_t const &avi);
+  void load_odml(mm_io_c &in, avisuperindex_chunk const *superindex, chunk_index_c &index);
+  boost::optional<uint64_t> determine_idx1_data_offset(mm_io_c &in, avi_t const &avi);
+};
+
+}}
@@ -20,14 +20,27 @@
 
 namespace mtx { namespace bits {
 
+/* The reader keeps up to 64 bits in a cache word. The next bit to be
+   read is always the most significant one; bits below the valid ones
+   are zero. Refilling loads whole bytes so that most reads boil down
+   to a shift and a mask.
+
+   In RBSP mode emulation prevention bytes (0x03 following two zero
+   bytes) are dropped while refilling. Alternatively the emulation
+   prevention bytes can be removed up front with
+   strip_emulation_prevention_bytes() which lets the reader use its
+   fast path afterwards. */
+
 class reader_c {
 private:
   const unsigned char *m_end_of_data;
-  const unsigned char *m_byte_position;
+  const unsigned char *m_next_byte;
   const unsigned char *m_start_of_data;
-  std::size_t m_bits_valid;
+  uint64_t m_cache;
+  std::size_t m_cache_bits;
   bool m_out_of_data, m_rbsp_mode;
-  uint16_t m_rbsp_bytes;
+  unsigned int m_num_zero_bytes;
+  memory_cptr m_stripped_data;
 
 public:
   reader_c() {
@@ -43,67 +56,93 @@ public:
   }
 
   void init(const unsigned char *data, std::size_t len) {
-    m_end_of_data   = data + len;
-    m_byte_position = data;
-    m_start_of_data = data;
-    m_bits_valid    = len ? 8 : 0;
-    m_out_of_data   = m_byte_position >= m_end_of_data;
-    m_rbsp_mode     = false;
-    m_rbsp_bytes    = 0xffffu;
+    m_end_of_data    = data + len;
+    m_next_byte      = data;
+    m_start_of_data  = data;
+    m_cache          = 0;
+    m_cache_bits     = 0;
+    m_out_of_data    = !len;
+    m_rbsp_mode      = false;
+    m_num_zero_bytes = 0;
   }
 
   void enable_rbsp_mode() {
-    m_rbsp_mode  = true;
-    m_rbsp_bytes = 0xff00u | (m_bits_valid == 8 ? *m_byte_position : 0u);
-  }
+    // The bytes already in the cache have been loaded without looking
+    // for emulation prevention bytes. Reload them from the current
+    // byte on.
+    auto position = get_bit_position();
 
-  bool eof() {
-    return m_out_of_data;
-  }
+    m_rbsp_mode = true;
 
-  uint64_t get_bits(std::size_t n) {
-    uint64_t r = 0;
+    reload(position);
+  }
 
-    while (n > 0) {
-      if (m_byte_position >= m_end_of_data) {
-        m_out_of_data = true;
-        throw mtx::mm_io::end_of_file_x();
+  /** \brief Removes emulation prevention bytes before reading
+
+     Copies at most \c max_bytes of the remaining data starting at the
+     current byte into a buffer owned by the reader, dropping all
+     emulation prevention bytes, and continues reading from that
+     buffer. This is cheaper than RBSP mode if most of the data is
+     read. Positions are relative to the stripped data afterwards.
+  */
+  void strip_emulation_prevention_bytes(std::size_t max_bytes = std::numeric_limits<std::size_t>::max()) {
+    auto position   = get_bit_position();
+    auto src        = m_start_of_data + position / 8;
+    auto src_end    = src + std::min<std::size_t>(max_bytes, m_end_of_data - src);
+    auto stripped   = memory_c::alloc(src_end - src);
+    auto dst        = stripped->get_buffer();
+    auto dst_start  = dst;
+    auto num_zeros  = 0u;
+
+    for (; src < src_end; ++src) {
+      if ((num_zeros >= 2) && (*src == 0x03)) {
+        num_zeros = 0;
+        continue;
       }
 
-      std::size_t b = 8; // number of bits to extract from the current byte
-      if (b > n)
-        b = n;
-      if (b > m_bits_valid)
-        b = m_bits_valid;
+      num_zeros = *src ? 0 : num_zeros + 1;
+      *dst++    = *src;
+    }
+
+    stripped->set_size(dst - dst_start);
+    m_stripped_data = stripped;
 
-      std::size_t rshift = m_bits_valid - b;
+    init(m_stripped_data->get_buffer(), m_stripped_data->get_size());
+    skip_bits(position % 8);
+  }
 
-      r <<= b;
-      r  |= ((*m_byte_position) >> rshift) & (0xff >> (8 - b));
+  bool eof() {
+    return m_out_of_data;
+  }
 
-      m_bits_valid -= b;
-      if (0 == m_bits_valid) {
-        m_bits_valid     = 8;
-        m_byte_position += 1;
+  uint64_t get_bits(std::size_t n) {
+    if ((n > m_cache_bits) && (n <= 57))
+      refill();
 
-        if (m_rbsp_mode && (m_byte_position < m_end_of_data)) {
-          if ((*m_byte_position == 0x03) && (m_rbsp_bytes == 0x0000)) {
-            ++m_byte_position;
-            m_rbsp_bytes = 0xff00u | *m_byte_position;
+    if (n <= m_cache_bits) {
+      if (!n)
+        return 0;
 
-          } else
-            m_rbsp_bytes = (m_rbsp_bytes << 8) | *m_byte_position;
-        }
-      }
+      auto r = m_cache >> (64 - n);
+      consume(n);
 
-      n -= b;
+      return r;
     }
 
-    return r;
+    return get_bits_slow(n);
   }
 
   inline int get_bit() {
-    return get_bits(1);
+    if (!m_cache_bits) {
+      refill();
+      if (!m_cache_bits)
+        throw_out_of_data();
+    }
+
+    auto r = static_cast<int>(m_cache >> 63);
+    consume(1);
+
+    return r;
   }
 
   inline int get_unary(bool stop,
@@ -123,14 +162,32 @@ public:
   }
 
   inline uint64_t get_unsigned_golomb() {
+    if (m_cache_bits < 32)
+      refill();
+
+    // Fast path: the whole code word is in the cache.
+    if (m_cache) {
+      auto code_length = 2 * count_leading_zeros(m_cache) + 1;
+
+      if (code_length <= m_cache_bits) {
+        auto r = (m_cache >> (64 - code_length)) - 1;
+        consume(code_length);
+
+        return r;
+      }
+    }
+
     int n = 0;
 
+    // Values with 64 or more leading zero bits don't fit into 64 bits
+    // and only occur in damaged streams.
     while (get_bit() == 0)
-      ++n;
+      if (++n >= 64)
+        throw mtx::mm_io::end_of_file_x();
 
     auto bits = get_bits(n);
 
-    return (1u << n) - 1 + bits;
+    return (1ull << n) - 1 + bits;
   }
 
   inline int64_t get_signed_golomb() {
@@ -139,39 +196,12 @@ public:
   }
 
   uint64_t peek_bits(std::size_t n) {
-    uint64_t r                             = 0;
-    const unsigned char *tmp_byte_position = m_byte_position;
-    std::size_t tmp_bits_valid             = m_bits_valid;
-
-    while (0 < n) {
-      if (tmp_byte_position >= m_end_of_data)
-        throw mtx::mm_io::end_of_file_x();
-
-      std::size_t b = 8; // number of bits to extract from the current byte
-      if (b > n)
-        b = n;
-      if (b > tmp_bits_valid)
-        b = tmp_bits_valid;
-
-      std::size_t rshift = tmp_bits_valid - b;
-
-      r <<= b;
-      r  |= ((*tmp_byte_position) >> rshift) & (0xff >> (8 - b));
-
-      tmp_bits_valid -= b;
-      if (0 == tmp_bits_valid) {
-        tmp_bits_valid     = 8;
-        tmp_byte_position += 1;
-      }
-
-      n -= b;
-    }
-
-    return r;
+    auto copy = *this;
+    return copy.get_bits(n);
   }
 
   void get_bytes(unsigned char *buf, std::size_t n) {
-    if (8 == m_bits_valid) {
+    if (!m_rbsp_mode && !(m_cache_bits % 8)) {
       get_bytes_byte_aligned(buf, n);
       return;
     }
@@ -189,42 +219,49 @@ public:
   }
 
   void byte_align() {
-    if (8 != m_bits_valid)
-      skip_bits(m_bits_valid);
+    skip_bits(m_cache_bits % 8);
   }
 
   void set_bit_position(std::size_t pos) {
+    auto current_pos = static_cast<std::size_t>(get_bit_position());
+    if ((pos >= current_pos) && ((pos - current_pos) <= m_cache_bits)) {
+      consume(pos - current_pos);
+      return;
+    }
+
     if (pos > (static_cast<std::size_t>(m_end_of_data - m_start_of_data) * 8)) {
-      m_byte_position = m_end_of_data;
-      m_out_of_data   = true;
+      m_next_byte   = m_end_of_data;
+      m_cache       = 0;
+      m_cache_bits  = 0;
+      m_out_of_data = true;
 
       throw mtx::mm_io::end_of_file_x();
     }
 
-    m_byte_position = m_start_of_data + (pos / 8);
-    m_bits_valid    = 8 - (pos % 8);
+    reload(pos);
   }
 
   int get_bit_position() const {
-    return (m_byte_position - m_start_of_data) * 8 + (m_bits_valid ? 8 - m_bits_valid : 0);
+    return (m_next_byte - m_start_of_data) * 8 - m_cache_bits + (pending_emulation_prevention_byte() ? 8 : 0);
   }
 
   int get_remaining_bits() const {
-    return (m_end_of_data - m_byte_position) * 8 - (m_bits_valid ? 8 - m_bits_valid : 0);
+    return (m_end_of_data - m_start_of_data) * 8 - get_bit_position();
   }
 
   void skip_bits(std::size_t num) {
-    if (!m_rbsp_mode)
+    if (num <= m_cache_bits)
+      consume(num);
+
+    else if (!m_rbsp_mode)
       set_bit_position(get_bit_position() + num);
+
     else
-      get_bits(num);
+      get_bits_slow(num);
   }
 
   void skip_bit() {
-    if (!m_rbsp_mode)
-      set_bit_position(get_bit_position() + 1);
-    else
-      get_bits(1);
+    skip_bits(1);
   }
 
   uint64_t skip_get_bits(std::size_t to_skip,
@@ -234,16 +271,135 @@ public:
   }
 
 protected:
-  void get_bytes_byte_aligned(unsigned char *buf, std::size_t n) {
-    auto bytes_to_copy = std::min<std::size_t>(n, m_end_of_data - m_byte_position);
-    std::memcpy(buf, m_byte_position, bytes_to_copy);
+  static unsigned int count_leading_zeros(uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_clzll(value);
+#else
+    auto n = 0u;
+    for (auto mask = 1ull << 63; !(value & mask); mask >>= 1)
+      ++n;
+    return n;
+#endif
+  }
 
-    m_byte_position += bytes_to_copy;
+  void reload(std::size_t pos) {
+    m_next_byte      = m_start_of_data + (pos / 8);
+    m_cache          = 0;
+    m_cache_bits     = 0;
+    m_num_zero_bytes = 0;
 
-    if (bytes_to_copy < n) {
-      m_out_of_data = true;
-      throw mtx::mm_io::end_of_file_x();
+    if (pos % 8) {
+      refill();
+      consume(pos % 8);
+    }
+  }
+
+  void consume(std::size_t n) {
+    m_cache       = n < 64 ? m_cache << n : 0;
+    m_cache_bits -= n;
+  }
+
+  [[noreturn]] void throw_out_of_data() {
+    m_out_of_data = true;
+    throw mtx::mm_io::end_of_file_x();
+  }
+
+  // Fills the cache with as many whole bytes as fit. Never throws; the
+  // cache simply stays short at the end of the data.
+  void refill() {
+    if (m_cache_bits > 56)
+      return;
+
+    if (m_rbsp_mode) {
+      refill_rbsp();
+      return;
     }
+
+    if ((m_end_of_data - m_next_byte) >= 8) {
+      uint64_t word = 0;
+      for (auto idx = 0; idx < 8; ++idx)
+        word = (word << 8) | m_next_byte[idx];
+
+      auto num_bytes = (64 - m_cache_bits) / 8;
+      auto shift     = 64 - num_bytes * 8;
+
+      m_cache       |= (word >> shift) << (shift - m_cache_bits);
+      m_cache_bits  += num_bytes * 8;
+      m_next_byte   += num_bytes;
+
+      return;
+    }
+
+    while ((m_cache_bits <= 56) && (m_next_byte < m_end_of_data)) {
+      m_cache      |= static_cast<uint64_t>(*m_next_byte++) << (56 - m_cache_bits);
+      m_cache_bits += 8;
+    }
+  }
+
+  // An emulation prevention byte is only skipped once the cache has run
+  // empty. That way the byte is always either fully behind or fully
+  // ahead of the current position.
+  void refill_rbsp() {
+    while ((m_cache_bits <= 56) && (m_next_byte < m_end_of_data)) {
+      auto byte = *m_next_byte;
+
+      if ((m_num_zero_bytes >= 2) && (byte == 0x03)) {
+        if (m_cache_bits)
+          return;
+
+        ++m_next_byte;
+        m_num_zero_bytes = 0;
+        continue;
+      }
+
+      m_num_zero_bytes = byte ? 0 : m_num_zero_bytes + 1;
+      m_cache         |= static_cast<uint64_t>(byte) << (56 - m_cache_bits);
+      m_cache_bits    += 8;
+      ++m_next_byte;
+    }
+  }
+
+  bool pending_emulation_prevention_byte() const {
+    return m_rbsp_mode
+        && !m_cache_bits
+        && (m_num_zero_bytes >= 2)
+        && (m_next_byte < m_end_of_data)
+        && (*m_next_byte == 0x03);
+  }
+
+  uint64_t get_bits_slow(std::size_t n) {
+    uint64_t r = 0;
+
+    while (n > 0) {
+      if (!m_cache_bits) {
+        refill();
+        if (!m_cache_bits)
+          throw_out_of_data();
+      }
+
+      auto b    = std::min(n, m_cache_bits);
+      auto part = m_cache >> (64 - b);
+
+      r  = b < 64 ? (r << b) | part : part;
+      n -= b;
+      consume(b);
+    }
+
+    return r;
+  }
+
+  // The bytes still held in the cache haven't been consumed yet. Drop
+  // them and copy everything from the current byte on.
+  void get_bytes_byte_aligned(unsigned char *buf, std::size_t n) {
+    reload(get_bit_position());
+
+    auto bytes_to_copy = std::min<std::size_t>(n, m_end_of_data - m_next_byte);
+    std::memcpy(buf, m_next_byte, bytes_to_copy);
+
+    m_next_byte += bytes_to_copy;
+
+    if (bytes_to_copy < n)
+      throw_out_of_data();
   }
 };
 using reader_cptr = std::shared_ptr<reader_c>;
@@ -16,6 +16,7 @@
 #include "common/bit_reader.h"
 #include "common/bluray/clpi.h"
 #include "common/mm_file_io.h"
+#include "common/strings/formatting.h"
 
 namespace mtx { namespace bluray { namespace clpi {
 
@@ -72,6 +73,31 @@ program_stream_t::dump() {
                      language));
 }
 
+boost::optional<ep_map_entry_t>
+ep_map_t::find_entry_at_or_before(timestamp_c const &pts)
+  const {
+  auto itr = std::upper_bound(entries.begin(), entries.end(), pts, [](timestamp_c const &wanted, ep_map_entry_t const &entry) { return wanted < entry.pts; });
+  if (itr == entries.begin())
+    return boost::none;
+
+  return *(itr - 1);
+}
+
+void
+ep_map_t::dump()
+  const {
+  mxinfo(fmt::format("EP map dump:\n"
+                     "  pid:         {0}\n"
+                     "  stream_type: {1}\n"
+                     "  num_entries: {2}\n",
+                     pid, static_cast<unsigned int>(stream_type), entries.size()));
+
+  if (!entries.empty())
+    mxinfo(fmt::format("  first entry: PTS {0} SPN {1}\n"
+                       "  last entry:  PTS {2} SPN {3}\n",
+                       entries.front().pts, entries.front().spn, entries.back().pts, entries.back().spn));
+}
+
 parser_c::parser_c(std::string file_name)
   : m_file_name{std::move(file_name)}
   , m_ok{}
@@ -83,11 +109,25 @@ void
 parser_c::dump() {
   mxinfo(fmt::format("Parser dump:\n"
                      "  sequence_info_start: {0}\n"
-                     "  program_info_start:  {1}\n",
-                     m_sequence_info_start, m_program_info_start));
+                     "  program_info_start:  {1}\n"
+                     "  cpi_start:           {2}\n",
+                     m_sequence_info_start, m_program_info_start, m_cpi_start));
 
   for (auto &program : m_programs)
     program->dump();
+
+  for (auto const &ep_map : m_ep_maps)
+    ep_map.dump();
+}
+
+ep_map_t const *
+parser_c::find_ep_map(uint16_t pid)
+  const {
+  for (auto const &ep_map : m_ep_maps)
+    if ((ep_map.pid == pid) && !ep_map.entries.empty())
+      return &ep_map;
+
+  return nullptr;
 }
 
 bool
@@ -106,6 +146,7 @@ parser_c::parse() {
 
     parse_header(*bc);
     parse_program_info(*bc);
+    parse_cpi(*bc);
 
     if (m_debug)
       dump();
@@ -135,6 +176,7 @@ parser_c::parse_header(mtx::bits::reader_c &bc) {
 
   m_sequence_info_start = bc.get_bits(32);
   m_program_info_start  = bc.get_bits(32);
+  m_cpi_start           = bc.get_bits(32);
 }
 
 void
@@ -231,4 +273,120 @@ parser_c::parse_program_stream(mtx::bits::reader_c &bc,
   bc.set_bit_position(position_in_bits + length_in_bytes * 8);
 }
 
+/* The CPI (characteristic point information) contains the EP map:
+   for each video stream a list of entry points consisting of a PTS and
+   the source packet number where decoding can start. It is only used
+   for seeking; therefore errors in it don't invalidate the rest of the
+   clip info. */
+void
+parser_c::parse_cpi(mtx::bits::reader_c &bc) {
+  if (!m_cpi_start)
+    return;
+
+  try {
+    bc.set_bit_position(m_cpi_start * 8);
+
+    auto length = bc.get_bits(32);
+    if (!length)
+      return;
+
+    bc.skip_bits(12);           // reserved
+    auto cpi_type = bc.get_bits(4);
+
+    mxdebug_if(m_debug, fmt::format("CPI length {0} type {1}\n", length, cpi_type));
+
+    if (1 == cpi_type)
+      parse_ep_map(bc);
+
+  } catch (...) {
+    mxdebug_if(m_debug, "Parsing the EP map NOT OK\n");
+    m_ep_maps.clear();
+  }
+}
+
+/* The entry points of each stream are stored in two tables. The coarse
+   table contains the upper bits of the PTS & the SPN; the fine table
+   contains the lower bits. Each coarse entry references the first fine
+   entry it applies to. */
+void
+parser_c::parse_ep_map(mtx::bits::reader_c &bc) {
+  struct coarse_entry_t {
+    uint32_t ref_fine_id, pts, spn;
+  };
+
+  struct stream_info_t {
+    uint32_t num_coarse_entries, num_fine_entries, start_address;
+  };
+
+  auto ep_map_start = bc.get_bit_position() / 8;
+
+  bc.skip_bits(8);              // reserved
+  auto num_streams = bc.get_bits(8);
+
+  std::vector<stream_info_t> stream_infos;
+
+  for (auto stream_idx = 0u; stream_idx < num_streams; ++stream_idx) {
+    m_ep_maps.emplace_back();
+    auto &ep_map = m_ep_maps.back();
+
+    ep_map.pid         = bc.get_bits(16);
+    bc.skip_bits(10);           // reserved
+    ep_map.stream_type = bc.get_bits(4);
+
+    stream_info_t info;
+    info.num_coarse_entries = bc.get_bits(16);
+    info.num_fine_entries   = bc.get_bits(18);
+    info.start_address      = bc.get_bits(32);
+
+    stream_infos.push_back(info);
+  }
+
+  for (auto stream_idx = 0u; stream_idx < num_streams; ++stream_idx) {
+    auto &ep_map      = m_ep_maps[stream_idx];
+    auto const &info  = stream_infos[stream_idx];
+    auto stream_start = ep_map_start + info.start_address;
+
+    bc.set_bit_position(stream_start * 8);
+    auto fine_table_start = stream_start + bc.get_bits(32);
+
+    std::vector<coarse_entry_t> coarse_entries;
+    coarse_entries.reserve(info.num_coarse_entries);
+
+    for (auto idx = 0u; idx < info.num_coarse_entries; ++idx) {
+      coarse_entry_t entry;
+      entry.ref_fine_id = bc.get_bits(18);
+      entry.pts         = bc.get_bits(14);
+      entry.spn         = bc.get_bits(32);
+
+      coarse_entries.push_back(entry);
+    }
+
+    bc.set_bit_position(fine_table_start * 8);
+
+    ep_map.entries.reserve(info.num_fine_entries);
+
+    auto coarse_idx = 0u;
+
+    for (auto fine_idx = 0u; fine_idx < info.num_fine_entries; ++fine_idx) {
+      bc.skip_bits(4);          // is_angle_change_point, I_end_position_offset
+      auto fine_pts = bc.get_bits(11);
+      auto fine_spn = bc.get_bits(17);
+
+      while (((coarse_idx + 1) < coarse_entries.size()) && (coarse_entries[coarse_idx + 1].ref_fine_id <= fine_idx))
+        ++coarse_idx;
+
+      if (coarse_entries.empty())
+        break;
+
+      auto const &coarse = coarse_entries[coarse_idx];
+      auto pts           = (static_cast<uint64_t>(coarse.pts & ~0x01u) << 19) | (static_cast<uint64_t>(fine_pts) << 9);
+      auto spn           = static_cast<uint32_t>((coarse.spn & ~0x1ffffu) | fine_spn);
+
+      ep_map.entries.push_back({ timestamp_c::mpeg(pts), spn });
+    }
+
+    mxdebug_if(m_debug, fmt::format("EP map for PID {0}: {1} coarse & {2} fine entries\n", ep_map.pid, info.num_coarse_entries, info.num_fine_entries));
+  }
+}
+
 }}}
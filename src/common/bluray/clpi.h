@@ -15,6 +15,8 @@
 
 #include "common/common_pch.h"
 
+#include "common/timestamp.h"
+
 namespace mtx { namespace bits {
 class reader_c;
 }}
@@ -54,16 +56,36 @@ namespace mtx { namespace bluray { namespace clpi {
   };
   using program_cptr = std::shared_ptr<program_t>;
 
+  // One entry point from the EP map: the PTS of an access point at
+  // which decoding can start and the number of the source packet it
+  // starts in. Source packets are 192 bytes long and counted from the
+  // start of the clip's M2TS file.
+  struct ep_map_entry_t {
+    timestamp_c pts;
+    uint32_t spn{};
+  };
+
+  struct ep_map_t {
+    uint16_t pid{};
+    unsigned char stream_type{};
+    std::vector<ep_map_entry_t> entries;
+
+    boost::optional<ep_map_entry_t> find_entry_at_or_before(timestamp_c const &pts) const;
+
+    void dump() const;
+  };
+
   class parser_c {
   protected:
     std::string m_file_name;
     bool m_ok;
     debugging_option_c m_debug;
 
-    size_t m_sequence_info_start, m_program_info_start;
+    size_t m_sequence_info_start, m_program_info_start, m_cpi_start{};
 
   public:
     std::vector<program_cptr> m_programs;
+    std::vector<ep_map_t> m_ep_maps;
 
   public:
     parser_c(std::string file_name);
@@ -76,10 +98,14 @@ namespace mtx { namespace bluray { namespace clpi {
 
     virtual void dump();
 
+    ep_map_t const *find_ep_map(uint16_t pid) const;
+
   protected:
     virtual void parse_header(mtx::bits::reader_c &bc);
     virtual void parse_program_info(mtx::bits::reader_c &bc);
     virtual void parse_program_stream(mtx::bits::reader_c &bc, program_cptr &program);
+    virtual void parse_cpi(mtx::bits::reader_c &bc);
+    virtual void parse_ep_map(mtx::bits::reader_c &bc);
   };
   using parser_cptr = std::shared_ptr<parser_c>;
 
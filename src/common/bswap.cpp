@@ -16,8 +16,134 @@
 #include "common/bswap.h"
 #include "common/endian.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_BSWAP_HAVE_SSSE3
+# include <cpuid.h>
+# include <immintrin.h>
+#endif
+
 namespace mtx { namespace bytes {
 
+namespace {
+
+template<typename T>
+void
+swap_words(unsigned char const *src,
+           unsigned char *dst,
+           std::size_t num_bytes,
+           T (*swap)(T)) {
+  for (std::size_t idx = 0; idx < num_bytes; idx += sizeof(T)) {
+    T value;
+    std::memcpy(&value, &src[idx], sizeof(T));
+    value = swap(value);
+    std::memcpy(&dst[idx], &value, sizeof(T));
+  }
+}
+
+void
+swap_buffer_scalar(unsigned char const *src,
+                   unsigned char *dst,
+                   std::size_t num_bytes,
+                   std::size_t word_length) {
+  if (2 == word_length)
+    swap_words<uint16_t>(src, dst, num_bytes, swap_16);
+
+  else if (4 == word_length)
+    swap_words<uint32_t>(src, dst, num_bytes, swap_32);
+
+  else if (8 == word_length)
+    swap_words<uint64_t>(src, dst, num_bytes, swap_64);
+
+  else
+    for (std::size_t idx = 0; idx < num_bytes; idx += word_length)
+      put_uint_le(&dst[idx], get_uint_be(&src[idx], word_length), word_length);
+}
+
+#if defined(MTX_BSWAP_HAVE_SSSE3)
+
+bool
+cpu_supports_ssse3() {
+  unsigned int eax{}, ebx{}, ecx{}, edx{};
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+
+  return ecx & bit_SSSE3;
+}
+
+bool const s_ssse3_supported = cpu_supports_ssse3();
+
+/* Reverses the bytes of each word in blocks of 16 bytes with a single
+   shuffle per block. For 24-bit words five of them are handled per
+   block; the block's last byte is copied unchanged and overwritten by
+   the next block. Returns the number of bytes processed; the caller
+   handles the rest. 'src' and 'dst' must either be identical or not
+   overlap. */
+__attribute__((target("ssse3")))
+std::size_t
+swap_buffer_ssse3(unsigned char const *src,
+                  unsigned char *dst,
+                  std::size_t num_bytes,
+                  std::size_t word_length) {
+  __m128i mask;
+  std::size_t step = 16;
+
+  if (2 == word_length)
+    mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+  else if (3 == word_length) {
+    mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    step = 15;
+
+  } else if (4 == word_length)
+    mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+  else if (8 == word_length)
+    mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+  else
+    return 0;
+
+  std::size_t pos = 0;
+
+  for (; (pos + 16) <= num_bytes; pos += step) {
+    auto block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&src[pos]));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[pos]), _mm_shuffle_epi8(block, mask));
+  }
+
+  return pos;
+}
+
+#endif  // MTX_BSWAP_HAVE_SSSE3
+
+template<std::size_t BytesPerSample>
+void
+remap_frames(unsigned char const *src,
+             unsigned char *dst,
+             std::size_t num_frames,
+             std::size_t bytes_per_sample,
+             std::size_t num_input_channels,
+             std::vector<std::size_t> const &channel_map) {
+  auto sample_size      = BytesPerSample ? BytesPerSample : bytes_per_sample;
+  auto input_frame_size = sample_size * num_input_channels;
+  std::vector<unsigned char> frame(input_frame_size);
+
+  for (std::size_t frame_idx = 0; frame_idx < num_frames; ++frame_idx) {
+    // The frame is copied first so that the input may be overwritten
+    // while remapping in place.
+    std::memcpy(frame.data(), src, input_frame_size);
+
+    for (auto input_channel : channel_map) {
+      std::memcpy(dst, &frame[input_channel * sample_size], sample_size);
+      dst += sample_size;
+    }
+
+    src += input_frame_size;
+  }
+}
+
+}
+
 void
 swap_buffer(unsigned char const *src,
             unsigned char *dst,
@@ -26,8 +152,72 @@ swap_buffer(unsigned char const *src,
   if ((num_bytes % word_length) != 0)
     throw std::invalid_argument(fmt::format(Y("The number of bytes to swap isn't divisible by {0}."), word_length));
 
-  for (int idx = 0; idx < static_cast<int>(num_bytes); idx += word_length)
-    put_uint_le(&dst[idx], get_uint_be(&src[idx], word_length), word_length);
+  std::size_t num_done = 0;
+
+#if defined(MTX_BSWAP_HAVE_SSSE3)
+  if (s_ssse3_supported)
+    num_done = swap_buffer_ssse3(src, dst, num_bytes, word_length);
+#endif
+
+  swap_buffer_scalar(src + num_done, dst + num_done, num_bytes - num_done, word_length);
+}
+
+/** \brief Drops and/or reorders the channels of interleaved PCM samples
+
+   Each output frame consists of the samples of the input channels
+   listed in \c channel_map in that order, e.g. <tt>{ 0, 1, 2, 3, 4 }</tt>
+   drops the last channel of six-channel audio and <tt>{ 1, 0 }</tt>
+   swaps the two channels of stereo audio. A trailing partial input
+   frame is ignored.
+
+   \c src and \c dst may be identical as long as the output frames
+   aren't larger than the input frames.
+
+   \return The number of bytes written to \c dst.
+ */
+std::size_t
+remap_channels(unsigned char const *src,
+               unsigned char *dst,
+               std::size_t num_bytes,
+               std::size_t bytes_per_sample,
+               std::size_t num_input_channels,
+               std::vector<std::size_t> const &channel_map) {
+  auto input_frame_size  = bytes_per_sample * num_input_channels;
+  auto output_frame_size = bytes_per_sample * channel_map.size();
+
+  if (!input_frame_size)
+    throw std::invalid_argument{"Invalid number of channels or sample size"};
+
+  if ((src == dst) && (output_frame_size > input_frame_size))
+    throw std::invalid_argument{"Cannot remap channels in place if the output frames are larger than the input frames"};
+
+  for (auto input_channel : channel_map)
+    if (input_channel >= num_input_channels)
+      throw std::invalid_argument{fmt::format("Invalid input channel {0} for {1} channels", input_channel, num_input_channels)};
+
+  auto num_frames   = num_bytes / input_frame_size;
+  auto keeps_prefix = true;
+
+  for (std::size_t idx = 0; keeps_prefix && (idx < channel_map.size()); ++idx)
+    keeps_prefix = channel_map[idx] == idx;
+
+  if (keeps_prefix)
+    for (std::size_t frame = 0; frame < num_frames; ++frame)
+      std::memmove(&dst[frame * output_frame_size], &src[frame * input_frame_size], output_frame_size);
+
+  else if (2 == bytes_per_sample)
+    remap_frames<2>(src, dst, num_frames, bytes_per_sample, num_input_channels, channel_map);
+
+  else if (3 == bytes_per_sample)
+    remap_frames<3>(src, dst, num_frames, bytes_per_sample, num_input_channels, channel_map);
+
+  else if (4 == bytes_per_sample)
+    remap_frames<4>(src, dst, num_frames, bytes_per_sample, num_input_channels, channel_map);
+
+  else
+    remap_frames<0>(src, dst, num_frames, bytes_per_sample, num_input_channels, channel_map);
+
+  return num_frames * output_frame_size;
 }
 
 }}
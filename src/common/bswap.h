@@ -46,5 +46,6 @@ swap_64(uint64_t x) {
 }
 
 void swap_buffer(unsigned char const *src, unsigned char *dst, std::size_t num_bytes, std::size_t word_length);
+std::size_t remap_channels(unsigned char const *src, unsigned char *dst, std::size_t num_bytes, std::size_t bytes_per_sample, std::size_t num_input_channels, std::vector<std::size_t> const &channel_map);
 
 }}
@@ -20,8 +20,125 @@
 #include "common/checksums/crc.h"
 #include "common/endian.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_CRC_HAVE_CLMUL
+# include <cpuid.h>
+# include <immintrin.h>
+#endif
+
 namespace mtx { namespace checksum {
 
+namespace {
+
+inline uint32_t
+load_uint32_le(unsigned char const *buffer) {
+  uint32_t value;
+  std::memcpy(&value, buffer, 4);
+
+#if defined(ARCH_BIGENDIAN)
+  value = mtx::bytes::swap_32(value);
+#endif
+
+  return value;
+}
+
+#if defined(MTX_CRC_HAVE_CLMUL)
+
+bool
+cpu_supports_clmul() {
+  unsigned int eax{}, ebx{}, ecx{}, edx{};
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+
+  return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+}
+
+bool const s_clmul_supported = cpu_supports_clmul();
+
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i
+load_m128(unsigned char const *buffer) {
+  return _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer));
+}
+
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i
+fold_m128(__m128i value,
+          __m128i next,
+          __m128i constants) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x11), next), _mm_clmulepi64_si128(value, constants, 0x00));
+}
+
+/* Folding of 16-byte blocks by carry-less multiplication followed by
+   a Barrett reduction as described in Intel's white paper "Fast CRC
+   Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+   The constants are the ones for the bit-reflected polynomial
+   0xEDB88320. 'size' must be a multiple of 16 and at least 64. */
+__attribute__((target("pclmul,sse4.1")))
+uint32_t
+crc32_reflected_clmul(unsigned char const *buffer,
+                      size_t size,
+                      uint32_t crc) {
+  alignas(16) static uint64_t const k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+  alignas(16) static uint64_t const k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+  alignas(16) static uint64_t const k5k0[] = { 0x0163cd6124, 0x0000000000 };
+  alignas(16) static uint64_t const poly[] = { 0x01db710641, 0x01f7011641 };
+
+  auto x1   = _mm_xor_si128(load_m128(buffer), _mm_cvtsi32_si128(static_cast<int>(crc)));
+  auto x2   = load_m128(buffer + 0x10);
+  auto x3   = load_m128(buffer + 0x20);
+  auto x4   = load_m128(buffer + 0x30);
+  auto x0   = _mm_load_si128(reinterpret_cast<__m128i const *>(k1k2));
+
+  buffer   += 64;
+  size     -= 64;
+
+  // Fold four blocks in parallel.
+  while (size >= 64) {
+    x1      = fold_m128(x1, load_m128(buffer),        x0);
+    x2      = fold_m128(x2, load_m128(buffer + 0x10), x0);
+    x3      = fold_m128(x3, load_m128(buffer + 0x20), x0);
+    x4      = fold_m128(x4, load_m128(buffer + 0x30), x0);
+
+    buffer += 64;
+    size   -= 64;
+  }
+
+  // Fold the four blocks into one, then fold the remaining single blocks.
+  x0 = _mm_load_si128(reinterpret_cast<__m128i const *>(k3k4));
+  x1 = fold_m128(x1, x2, x0);
+  x1 = fold_m128(x1, x3, x0);
+  x1 = fold_m128(x1, x4, x0);
+
+  while (size >= 16) {
+    x1      = fold_m128(x1, load_m128(buffer), x0);
+    buffer += 16;
+    size   -= 16;
+  }
+
+  // Fold 128 bits to 64 bits.
+  auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+  x2        = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x1        = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+  x0        = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(k5k0));
+  x2        = _mm_srli_si128(x1, 4);
+  x1        = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00), x2);
+
+  // Barrett reduction to 32 bits.
+  x0        = _mm_load_si128(reinterpret_cast<__m128i const *>(poly));
+  x2        = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+  x2        = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), x0, 0x00);
+  x1        = _mm_xor_si128(x1, x2);
+
+  return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif  // MTX_CRC_HAVE_CLMUL
+
+}
+
 crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[6] = {
   { 0,  8,       0x07 },
   { 0, 16,     0x8005 },
@@ -31,6 +148,8 @@ crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[6] = {
   { 0, 16,     0x002d },
 };
 
+unsigned int const crc_base_c::ms_num_slices;
+
 crc_base_c::crc_base_c(type_e type,
                        table_t &table,
                        uint32_t crc)
@@ -55,7 +174,7 @@ crc_base_c::init_table() {
   if ((parameters.bits < 8) || (parameters.bits > 32) || (parameters.poly >= (1LL<<parameters.bits)))
     throw std::domain_error{"Invalid CRC parameters"};
 
-  m_table.resize(256);
+  m_table.resize(ms_num_slices * 256);
 
   for (auto i = 0u; i < 256u; i++) {
     if (parameters.le) {
@@ -72,6 +191,15 @@ crc_base_c::init_table() {
     }
   }
 
+  // Entry i of sub-table n is the CRC of byte i followed by n zero
+  // bytes. As the CRCs that aren't bit-reflected are stored
+  // byte-swapped, the same relation holds for all of them.
+  for (auto slice = 1u; slice < ms_num_slices; ++slice)
+    for (auto i = 0u; i < 256u; ++i) {
+      auto previous            = m_table[(slice - 1) * 256 + i];
+      m_table[slice * 256 + i] = m_table[previous & 0xff] ^ (previous >> 8);
+    }
+
   // for (auto row = 0u; row < (256u / 4); ++row)
   //   mxinfo(fmt::format("0x{0:08x} 0x{1:08x} 0x{2:08x} 0x{3:08x}\n", m_table[row * 4 + 0], m_table[row * 4 + 1], m_table[row * 4 + 2], m_table[row * 4 + 3]));
 }
@@ -121,15 +249,76 @@ crc_base_c::set_result_in_le(bool result_in_le) {
   m_result_in_le = result_in_le;
 }
 
+bool
+crc_base_c::use_clmul()
+  const {
+#if defined(MTX_CRC_HAVE_CLMUL)
+  return (m_type == crc_32_ieee_le) && s_clmul_supported;
+#else
+  return false;
+#endif
+}
+
+std::string
+crc_base_c::get_implementation_name()
+  const {
+  return use_clmul() ? "carry-less multiplication" : fmt::format("slicing-by-{0}", ms_num_slices);
+}
+
+void
+crc_base_c::add_with_tables(unsigned char const *buffer,
+                            size_t size) {
+  auto table = m_table.data();
+
+  while (size >= 16) {
+    auto one   = load_uint32_le(buffer) ^ m_crc;
+    auto two   = load_uint32_le(buffer +  4);
+    auto three = load_uint32_le(buffer +  8);
+    auto four  = load_uint32_le(buffer + 12);
+
+    m_crc      = table[15 * 256 + ( one          & 0xff)] ^ table[14 * 256 + ((one   >>  8) & 0xff)]
+               ^ table[13 * 256 + ((one   >> 16) & 0xff)] ^ table[12 * 256 + ( one   >> 24        )]
+               ^ table[11 * 256 + ( two          & 0xff)] ^ table[10 * 256 + ((two   >>  8) & 0xff)]
+               ^ table[ 9 * 256 + ((two   >> 16) & 0xff)] ^ table[ 8 * 256 + ( two   >> 24        )]
+               ^ table[ 7 * 256 + ( three        & 0xff)] ^ table[ 6 * 256 + ((three >>  8) & 0xff)]
+               ^ table[ 5 * 256 + ((three >> 16) & 0xff)] ^ table[ 4 * 256 + ( three >> 24        )]
+               ^ table[ 3 * 256 + ( four         & 0xff)] ^ table[ 2 * 256 + ((four  >>  8) & 0xff)]
+               ^ table[ 1 * 256 + ((four  >> 16) & 0xff)] ^ table[ 0 * 256 + ( four  >> 24        )];
+
+    buffer    += 16;
+    size      -= 16;
+  }
+
+  if (size >= 8) {
+    auto one   = load_uint32_le(buffer) ^ m_crc;
+    auto two   = load_uint32_le(buffer + 4);
+
+    m_crc      = table[7 * 256 + ( one        & 0xff)] ^ table[6 * 256 + ((one >>  8) & 0xff)]
+               ^ table[5 * 256 + ((one >> 16) & 0xff)] ^ table[4 * 256 + ( one >> 24        )]
+               ^ table[3 * 256 + ( two        & 0xff)] ^ table[2 * 256 + ((two >>  8) & 0xff)]
+               ^ table[1 * 256 + ((two >> 16) & 0xff)] ^ table[0 * 256 + ( two >> 24        )];
+
+    buffer    += 8;
+    size      -= 8;
+  }
+
+  for (auto end = buffer + size; buffer < end; ++buffer)
+    m_crc = table[(m_crc & 0xff) ^ *buffer] ^ (m_crc >> 8);
+}
+
 void
 crc_base_c::add_impl(unsigned char const *buffer,
                      size_t size) {
-  auto end = buffer + size;
-
-  while (buffer < end) {
-    m_crc = m_table[(m_crc & 0xff) ^ *buffer] ^ (m_crc >> 8);
-    ++buffer;
+#if defined(MTX_CRC_HAVE_CLMUL)
+  if ((size >= 64) && use_clmul()) {
+    auto to_fold  = size & ~static_cast<size_t>(15);
+    m_crc         = crc32_reflected_clmul(buffer, to_fold, m_crc);
+    buffer       += to_fold;
+    size         -= to_fold;
   }
+#endif
+
+  add_with_tables(buffer, size);
 }
 
 // ----------------------------------------------------------------------
@@ -40,6 +40,11 @@ protected:
 
   static table_parameters_t const ms_table_parameters[6];
 
+  // Number of bytes processed per step by the table-driven
+  // implementation ("slicing-by-16"); the table consists of that many
+  // sub-tables of 256 entries each.
+  static unsigned int const ms_num_slices = 16;
+
 protected:
   type_e m_type;
   table_t &m_table;
@@ -61,9 +66,14 @@ public:
   virtual void set_xor_result(uint64_t xor_result);
   virtual void set_result_in_le(bool result_in_le);
 
+  std::string get_implementation_name() const;
+
 protected:
   virtual void add_impl(unsigned char const *buffer, size_t size);
 
+  bool use_clmul() const;
+  void add_with_tables(unsigned char const *buffer, size_t size);
+
   virtual void set_initial_value_impl(uint64_t initial_value) ;
   virtual void set_initial_value_impl(unsigned char const *buffer, size_t size);
 };
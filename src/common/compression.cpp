@@ -50,6 +50,21 @@ compressor_c::~compressor_c() {
                      raw_size, compressed_size, items, compressed_size * 100.0 / raw_size, compressed_size / items));
 }
 
+/* The slice variants replace a frame consisting of several slices with
+   its (de-)compressed content. Compressors that cannot handle slices
+   directly join them first. */
+void
+compressor_c::compress(memory_slices_c &slices) {
+  auto compressed = compress(join_memory_slices(slices));
+  slices          = { { compressed, 0, compressed->get_size() } };
+}
+
+void
+compressor_c::decompress(memory_slices_c &slices) {
+  auto decompressed = decompress(join_memory_slices(slices));
+  slices            = { { decompressed, 0, decompressed->get_size() } };
+}
+
 void
 compressor_c::set_track_headers(KaxContentEncoding &c_encoding) {
   // Set compression method.
@@ -85,6 +85,9 @@ public:
     return do_decompress(buffer, size);
   }
 
+  virtual void compress(memory_slices_c &slices);
+  virtual void decompress(memory_slices_c &slices);
+
   virtual void set_track_headers(libmatroska::KaxContentEncoding &c_encoding);
 
   static compressor_ptr create(compression_method_e method);
@@ -38,12 +38,16 @@ header_removal_compressor_c::do_decompress(unsigned char const *buffer,
   return new_buffer;
 }
 
-memory_cptr
-header_removal_compressor_c::do_compress(unsigned char const *buffer,
-                                         std::size_t size) {
-  if (!m_bytes || (0 == m_bytes->get_size()))
-    return memory_c::clone(buffer, size);
+void
+header_removal_compressor_c::decompress(memory_slices_c &slices) {
+  if (m_bytes && (0 != m_bytes->get_size()))
+    slices.insert(slices.begin(), { m_bytes, 0, m_bytes->get_size() });
+}
 
+void
+header_removal_compressor_c::verify_removed_bytes(unsigned char const *buffer,
+                                                  std::size_t size)
+  const {
   size_t to_remove_size = m_bytes->get_size();
   if (size < to_remove_size)
     throw mtx::compression_x(fmt::format(Y("Header removal compression not possible because the buffer contained {0} bytes "
@@ -62,8 +66,57 @@ header_removal_compressor_c::do_compress(unsigned char const *buffer,
     throw mtx::compression_x(fmt::format(Y("Header removal compression not possible because the buffer did not start with the bytes that should be removed. "
                                            "Wanted bytes:{0}; found:{1}."), b_bytes, b_buffer));
   }
+}
+
+memory_cptr
+header_removal_compressor_c::do_compress(unsigned char const *buffer,
+                                         std::size_t size) {
+  if (!m_bytes || (0 == m_bytes->get_size()))
+    return memory_c::clone(buffer, size);
+
+  verify_removed_bytes(buffer, size);
+
+  return memory_c::clone(buffer + m_bytes->get_size(), size - m_bytes->get_size());
+}
+
+/* Only the first slices are shortened; the frame's content isn't
+   copied. */
+void
+header_removal_compressor_c::compress(memory_slices_c &slices) {
+  if (!m_bytes || (0 == m_bytes->get_size()))
+    return;
+
+  auto to_remove_size = m_bytes->get_size();
+  std::vector<unsigned char> start;
+
+  start.reserve(to_remove_size);
+
+  for (auto const &slice : slices) {
+    auto num_bytes = std::min(slice.m_size, to_remove_size - start.size());
+    start.insert(start.end(), slice.get_buffer(), slice.get_buffer() + num_bytes);
+
+    if (start.size() == to_remove_size)
+      break;
+  }
+
+  verify_removed_bytes(start.data(), get_memory_slices_size(slices));
+
+  auto num_emptied = 0u;
+
+  for (auto &slice : slices) {
+    auto num_bytes  = std::min(slice.m_size, to_remove_size);
+    slice.m_offset += num_bytes;
+    slice.m_size   -= num_bytes;
+    to_remove_size -= num_bytes;
+
+    if (!slice.m_size)
+      ++num_emptied;
+
+    if (!to_remove_size)
+      break;
+  }
 
-  return memory_c::clone(buffer + size, size - to_remove_size);
+  slices.erase(slices.begin(), slices.begin() + num_emptied);
 }
 
 void
@@ -29,10 +29,19 @@ public:
     m_bytes->take_ownership();
   }
 
+  using compressor_c::compress;
+  using compressor_c::decompress;
+
+  virtual void compress(memory_slices_c &slices) override;
+  virtual void decompress(memory_slices_c &slices) override;
+
   virtual memory_cptr do_compress(unsigned char const *buffer, std::size_t size) override;
   virtual memory_cptr do_decompress(unsigned char const *buffer, std::size_t size) override;
 
   virtual void set_track_headers(libmatroska::KaxContentEncoding &c_encoding);
+
+protected:
+  void verify_removed_bytes(unsigned char const *buffer, std::size_t size) const;
 };
 
 class analyze_header_removal_compressor_c: public compressor_c {
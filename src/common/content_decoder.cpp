@@ -129,6 +129,17 @@ content_decoder_c::reverse(memory_cptr &memory,
       memory = ce.compressor->decompress(memory);
 }
 
+void
+content_decoder_c::reverse(memory_slices_c &slices,
+                           content_encoding_scope_e scope) {
+  if (!is_ok() || encodings.empty())
+    return;
+
+  for (auto &ce : encodings)
+    if (0 != (ce.scope & scope))
+      ce.compressor->decompress(slices);
+}
+
 std::string
 content_decoder_c::descriptive_algorithm_list() {
   std::string list;
@@ -48,6 +48,7 @@ public:
 
   bool initialize(libmatroska::KaxTrackEntry &ktentry);
   void reverse(memory_cptr &data, content_encoding_scope_e scope);
+  void reverse(memory_slices_c &data, content_encoding_scope_e scope);
   bool is_ok() {
     return ok;
   }
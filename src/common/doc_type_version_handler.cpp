@@ -94,12 +94,32 @@ doc_type_version_handler_c::update_ebml_head(mm_io_c &file) {
 }
 
 doc_type_version_handler_c::update_result_e
-doc_type_version_handler_c::do_update_ebml_head(mm_io_c &file) {
+doc_type_version_handler_c::update_ebml_head(EbmlHead &head,
+                                             mm_io_c &file) {
   auto p = p_func();
 
   auto previous_pos = file.getFilePointer();
   at_scope_exit_c restore_pos([previous_pos, &file]() { file.setFilePointer(previous_pos); });
 
+  update_result_e result;
+
+  try {
+    result = update_head_element(head, head.ElementSize(true), file);
+
+  } catch (mtx::mm_io::exception &) {
+    result = update_result_e::err_read_or_write_failure;
+  }
+
+  mxdebug_if(p->debug, fmt::format("update_ebml_head (in memory): result {0}\n", static_cast<unsigned int>(result)));
+
+  return result;
+}
+
+doc_type_version_handler_c::update_result_e
+doc_type_version_handler_c::do_update_ebml_head(mm_io_c &file) {
+  auto previous_pos = file.getFilePointer();
+  at_scope_exit_c restore_pos([previous_pos, &file]() { file.setFilePointer(previous_pos); });
+
   try {
     file.setFilePointer(0);
     auto stream = std::make_shared<EbmlStream>(file);
@@ -115,51 +135,58 @@ doc_type_version_handler_c::do_update_ebml_head(mm_io_c &file) {
     head->Read(*stream, context, upper_lvl_el, l0, true, SCOPE_ALL_DATA);
     head->SkipData(*stream, context);
 
-    auto old_size          = file.getFilePointer() - head->GetElementPosition();
-    auto &dt_version       = GetChild<EDocTypeVersion>(*head);
-    auto file_version      = dt_version.GetValue();
-    auto &dt_read_version  = GetChild<EDocTypeReadVersion>(*head);
-    auto file_read_version = dt_read_version.GetValue();
-    auto changed           = false;
+    return update_head_element(*head, file.getFilePointer() - head->GetElementPosition(), file);
 
-    if (file_version < p->version) {
-      dt_version.SetValue(p->version);
-      changed = true;
-    }
+  } catch (mtx::mm_io::exception &) {
+    return update_result_e::err_read_or_write_failure;
+  }
+}
 
-    if (file_read_version < p->read_version) {
-      dt_read_version.SetValue(p->read_version);
-      changed = true;
-    }
+doc_type_version_handler_c::update_result_e
+doc_type_version_handler_c::update_head_element(EbmlHead &head,
+                                                uint64_t old_size,
+                                                mm_io_c &file) {
+  auto p                 = p_func();
+  auto &dt_version       = GetChild<EDocTypeVersion>(head);
+  auto file_version      = dt_version.GetValue();
+  auto &dt_read_version  = GetChild<EDocTypeReadVersion>(head);
+  auto file_read_version = dt_read_version.GetValue();
+  auto changed           = false;
+
+  if (file_version < p->version) {
+    dt_version.SetValue(p->version);
+    changed = true;
+  }
 
-    mxdebug_if(p->debug,
-               fmt::format("do_update_ebml_head: account version {0} read_version {1}, file version {2} read_version {3}, changed {4}\n",
-                           p->version, p->read_version, file_version, file_read_version, changed));
+  if (file_read_version < p->read_version) {
+    dt_read_version.SetValue(p->read_version);
+    changed = true;
+  }
 
-    if (!changed)
-      return update_result_e::ok_no_update_needed;
+  mxdebug_if(p->debug,
+             fmt::format("update_head_element: account version {0} read_version {1}, file version {2} read_version {3}, changed {4}\n",
+                         p->version, p->read_version, file_version, file_read_version, changed));
 
-    head->UpdateSize(true);
-    auto new_size = head->ElementSize(true);
+  if (!changed)
+    return update_result_e::ok_no_update_needed;
 
-    if (new_size > old_size)
-      return update_result_e::err_not_enough_space;
+  head.UpdateSize(true);
+  auto new_size = head.ElementSize(true);
 
-    auto diff = old_size - new_size;
-    if (diff == 1)
-      head->SetSizeLength(head->GetSizeLength() + 1);
+  if (new_size > old_size)
+    return update_result_e::err_not_enough_space;
 
-    file.setFilePointer(head->GetElementPosition());
-    head->Render(*stream, true);
+  auto diff = old_size - new_size;
+  if (diff == 1)
+    head.SetSizeLength(head.GetSizeLength() + 1);
 
-    if (diff > 1) {
-      EbmlVoid v;
-      v.SetSize(diff - 2);
-      v.Render(*stream);
-    }
+  file.setFilePointer(head.GetElementPosition());
+  head.Render(file, true);
 
-  } catch (mtx::mm_io::exception &) {
-    return update_result_e::err_read_or_write_failure;
+  if (diff > 1) {
+    EbmlVoid v;
+    v.SetSize(diff - 2);
+    v.Render(file);
   }
 
   return update_result_e::ok_updated;
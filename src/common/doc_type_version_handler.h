@@ -15,6 +15,7 @@
 
 namespace libebml {
 class EbmlElement;
+class EbmlHead;
 }
 
 class mm_io_c;
@@ -48,9 +49,11 @@ public:
   libebml::EbmlElement &render(libebml::EbmlElement &element, mm_io_c &file, bool with_default = false);
 
   update_result_e update_ebml_head(mm_io_c &file);
+  update_result_e update_ebml_head(libebml::EbmlHead &head, mm_io_c &file);
 
 private:
   update_result_e do_update_ebml_head(mm_io_c &file);
+  update_result_e update_head_element(libebml::EbmlHead &head, uint64_t old_size, mm_io_c &file);
 };
 
 } // namespace mtx
@@ -13,7 +13,6 @@
 
 #include "common/common_pch.h"
 
-#include <boost/version.hpp>
 #include <unordered_map>
 
 #include "common/iso639.h"
@@ -522,9 +521,55 @@ static std::unordered_map<std::string, std::string> s_deprecated_1_and_2_codes{
 
 std::vector<std::string> const g_popular_language_codes{ "chi", "dut", "eng", "fin", "fre", "ger", "ita", "jpn", "mul", "nor", "por", "rus", "spa", "swe", "und", "zxx" };
 
+namespace {
+
+// Indexes into g_iso639_languages, built on first use instead of
+// searching the table linearly for each look-up. Whenever several
+// entries match the same key, the first one is used, just like the
+// linear search did.
+struct iso639_index_t {
+  std::unordered_map<std::string, int> iso639_2_codes, codes, english_names;
+  std::vector<std::pair<std::string, int>> english_names_in_order;
+};
+
+iso639_index_t const &
+iso639_index() {
+  static iso639_index_t const s_index = []() {
+    iso639_index_t index;
+    auto idx = 0;
+
+    for (auto const &lang : g_iso639_languages) {
+      index.iso639_2_codes.emplace(lang.iso639_2_code, idx);
+
+      for (auto const &code : { lang.iso639_2_code, lang.terminology_abbrev, lang.iso639_1_code })
+        if (!code.empty())
+          index.codes.emplace(code, idx);
+
+      auto names = split(lang.english_name, ";");
+      strip(names);
+
+      for (auto const &name : names) {
+        auto name_lower = balg::to_lower_copy(name);
+
+        index.english_names.emplace(name_lower, idx);
+        index.english_names_in_order.emplace_back(name_lower, idx);
+      }
+
+      ++idx;
+    }
+
+    return index;
+  }();
+
+  return s_index;
+}
+
+}
+
 bool
 is_valid_iso639_2_code(std::string const &iso639_2_code) {
-  return brng::find_if(g_iso639_languages, [&iso639_2_code](auto const &lang) { return lang.iso639_2_code == iso639_2_code; }) != g_iso639_languages.end();
+  auto const &codes = iso639_index().iso639_2_codes;
+  return codes.find(iso639_2_code) != codes.end();
 }
 
 #define FILL(s, idx) s + std::wstring(longest[idx] - get_width_in_em(s), L' ')
@@ -556,8 +601,9 @@ list_iso639_languages() {
 
 std::string const &
 map_iso639_2_to_iso639_1(std::string const &iso639_2_code) {
-  auto lang = brng::find_if(g_iso639_languages, [&iso639_2_code](auto const &lang) { return lang.iso639_2_code == iso639_2_code; });
-  return (lang != g_iso639_languages.end()) ? lang->iso639_1_code : empty_string;
+  auto const &codes = iso639_index().iso639_2_codes;
+  auto lang         = codes.find(iso639_2_code);
+  return (lang != codes.end()) ? g_iso639_languages[lang->second].iso639_1_code : empty_string;
 }
 
 bool
@@ -573,7 +619,7 @@ is_popular_language_code(std::string const &code) {
 
 /** \brief Map a string to a ISO 639-2 language code
 
-   Searches the array of ISO 639 codes. If \c s is a valid ISO 639-2
+   Looks up the ISO 639 codes. If \c s is a valid ISO 639-2
    code, a valid ISO 639-1 code, a valid terminology abbreviation
    for an ISO 639-2 code or the English name for an ISO 639-2 code
    then it returns the index of that entry in the \c g_iso639_languages array.
@@ -588,52 +634,28 @@ map_to_iso639_2_code(std::string const &s,
   if (s.empty())
     return -1;
 
+  auto const &index    = iso639_index();
   auto source          = s;
   auto deprecated_code = s_deprecated_1_and_2_codes.find(source);
   if (deprecated_code != s_deprecated_1_and_2_codes.end())
     source = deprecated_code->second;
 
-  auto lang_code = brng::find_if(g_iso639_languages, [&source](auto const &lang) { return (lang.iso639_2_code == source) || (lang.terminology_abbrev == source) || (lang.iso639_1_code == source); });
-  if (lang_code != g_iso639_languages.end())
-    return std::distance(g_iso639_languages.begin(), lang_code);
-
-  auto range = g_iso639_languages | badap::indexed(0);
-  auto end   = boost::end(range);
-  for (auto lang = boost::begin(range); lang != end; lang++) {
-#if BOOST_VERSION < 105600
-    auto const &english_name = lang->english_name;
-    auto index               = lang.index();
-#else
-    auto const &english_name = lang->value().english_name;
-    auto index               = lang->index();
-#endif
-
-    auto s_lower = balg::to_lower_copy(s);
-    auto names   = split(english_name, ";");
-    strip(names);
-
-    for (auto const &name : names)
-      if (balg::to_lower_copy(name) == s_lower)
-        return index;
-  }
+  auto lang_code = index.codes.find(source);
+  if (lang_code != index.codes.end())
+    return lang_code->second;
+
+  auto english_name = index.english_names.find(balg::to_lower_copy(s));
+  if (english_name != index.english_names.end())
+    return english_name->second;
 
   if (!allow_short_english_name)
     return -1;
 
-  for (auto lang = boost::begin(range); lang != end; lang++) {
-#if BOOST_VERSION < 105600
-    auto const &english_name = lang->english_name;
-    auto index               = lang.index();
-#else
-    auto const &english_name = lang->value().english_name;
-    auto index               = lang->index();
-#endif
-
-    auto names = split(english_name, ";");
-    strip(names);
-    if (names.end() != brng::find_if(names, [&source](auto const &name) { return balg::istarts_with(name, source); }))
-      return index;
-  }
+  auto source_lower = balg::to_lower_copy(source);
+
+  for (auto const &name : index.english_names_in_order)
+    if (balg::starts_with(name.first, source_lower))
+      return name.second;
 
   return -1;
 }
@@ -0,0 +1,244 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   streaming JSON writer
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/json_writer.h"
+#include "common/strings/utf8.h"
+
+namespace mtx { namespace json {
+
+writer_c::writer_c(sink_t const &sink,
+                   int indentation,
+                   std::size_t flush_threshold)
+  : m_sink{sink}
+  , m_indentation{indentation}
+  , m_flush_threshold{flush_threshold}
+{
+  m_buffer.reserve(flush_threshold + 1024);
+}
+
+writer_c::~writer_c() {
+  flush();
+}
+
+void
+writer_c::flush() {
+  if (m_buffer.empty())
+    return;
+
+  m_sink(m_buffer);
+  m_buffer.clear();
+}
+
+void
+writer_c::new_line_and_indent(std::size_t depth) {
+  if (0 > m_indentation)
+    return;
+
+  m_buffer += '\n';
+  m_buffer.append(depth * m_indentation, ' ');
+}
+
+void
+writer_c::start_value() {
+  if (m_key_written) {
+    m_key_written = false;
+    return;
+  }
+
+  if (m_levels.empty())
+    return;
+
+  auto &level = m_levels.back();
+
+  if (level.num_elements)
+    m_buffer += ',';
+  ++level.num_elements;
+
+  new_line_and_indent(m_levels.size());
+}
+
+writer_c &
+writer_c::end_value() {
+  if (m_buffer.size() >= m_flush_threshold)
+    flush();
+
+  return *this;
+}
+
+void
+writer_c::start_container(bool is_object,
+                          char opening) {
+  start_value();
+  m_buffer += opening;
+  m_levels.push_back({ is_object, 0 });
+}
+
+writer_c &
+writer_c::end_container(char closing) {
+  assert(!m_levels.empty());
+
+  auto num_elements = m_levels.back().num_elements;
+  m_levels.pop_back();
+
+  if (num_elements)
+    new_line_and_indent(m_levels.size());
+  m_buffer += closing;
+
+  return end_value();
+}
+
+writer_c &
+writer_c::start_object() {
+  start_container(true, '{');
+  return *this;
+}
+
+writer_c &
+writer_c::end_object() {
+  return end_container('}');
+}
+
+writer_c &
+writer_c::start_array() {
+  start_container(false, '[');
+  return *this;
+}
+
+writer_c &
+writer_c::end_array() {
+  return end_container(']');
+}
+
+writer_c &
+writer_c::key(std::string const &name) {
+  assert(!m_levels.empty() && m_levels.back().is_object && !m_key_written);
+
+  start_value();
+  append_string(name);
+  m_buffer     += 0 > m_indentation ? ":" : ": ";
+  m_key_written = true;
+
+  return *this;
+}
+
+writer_c &
+writer_c::value(std::string const &string) {
+  start_value();
+  append_string(string);
+  return end_value();
+}
+
+writer_c &
+writer_c::value(char const *string) {
+  return value(std::string{string});
+}
+
+writer_c &
+writer_c::value(bool boolean) {
+  start_value();
+  m_buffer += boolean ? "true" : "false";
+  return end_value();
+}
+
+writer_c &
+writer_c::value(nlohmann::json const &json) {
+  switch (json.type()) {
+    case nlohmann::json::value_t::object:
+      start_object();
+      for (auto it = json.begin(), end = json.end(); it != end; ++it)
+        key(it.key()).value(it.value());
+      return end_object();
+
+    case nlohmann::json::value_t::array:
+      start_array();
+      for (auto const &element : json)
+        value(element);
+      return end_array();
+
+    case nlohmann::json::value_t::string:
+      return value(json.get_ref<std::string const &>());
+
+    case nlohmann::json::value_t::boolean:
+      return value(json.get<bool>());
+
+    case nlohmann::json::value_t::number_integer:
+      return value(json.get<int64_t>());
+
+    case nlohmann::json::value_t::number_unsigned:
+      return value(json.get<uint64_t>());
+
+    default:
+      // null, floating point numbers & binary values
+      start_value();
+      m_buffer += mtx::json::dump(json, m_indentation);
+      return end_value();
+  }
+}
+
+void
+writer_c::append_string(std::string const &string) {
+  m_buffer += '"';
+
+  if (mtx::utf8::is_valid(string))
+    escape(m_buffer, string);
+  else
+    escape(m_buffer, mtx::utf8::fix_invalid(string));
+
+  m_buffer += '"';
+}
+
+/** \brief Appends the string escaped the same way nlohmann::json does
+
+   Characters outside the ASCII range are copied as they are.
+ */
+void
+writer_c::escape(std::string &destination,
+                 std::string const &string) {
+  static char const s_hex_digits[] = "0123456789abcdef";
+
+  auto start = string.c_str();
+  auto end   = start + string.size();
+  auto run   = start;
+
+  for (auto ptr = start; ptr < end; ++ptr) {
+    auto c = static_cast<unsigned char>(*ptr);
+
+    if ((c >= 0x20) && (c != '"') && (c != '\\'))
+      continue;
+
+    destination.append(run, ptr - run);
+    run = ptr + 1;
+
+    destination += '\\';
+
+    switch (c) {
+      case '"':  destination += '"';  break;
+      case '\\': destination += '\\'; break;
+      case '\b': destination += 'b';  break;
+      case '\f': destination += 'f';  break;
+      case '\n': destination += 'n';  break;
+      case '\r': destination += 'r';  break;
+      case '\t': destination += 't';  break;
+      default:
+        destination += "u00";
+        destination += s_hex_digits[c >> 4];
+        destination += s_hex_digits[c & 0x0f];
+    }
+  }
+
+  destination.append(run, end - run);
+}
+
+}}
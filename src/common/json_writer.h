@@ -0,0 +1,92 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   streaming JSON writer
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/json.h"
+
+namespace mtx { namespace json {
+
+/* Writes JSON incrementally without building a document in memory
+   first. The output is identical to what mtx::json::dump() produces
+   for the equivalent document as long as the caller adds the members
+   of each object sorted by their keys.
+
+   Output is collected in a buffer that is passed to the sink whenever
+   it exceeds a threshold, on flush() and on destruction. The sink is
+   only ever called with complete values; strings are never split. */
+class writer_c {
+public:
+  using sink_t = std::function<void(std::string const &)>;
+
+private:
+  struct level_t {
+    bool is_object;
+    std::size_t num_elements;
+  };
+
+  sink_t m_sink;
+  int m_indentation;
+  std::size_t m_flush_threshold;
+  std::string m_buffer;
+  std::vector<level_t> m_levels;
+  bool m_key_written{};
+
+public:
+  writer_c(sink_t const &sink, int indentation = 2, std::size_t flush_threshold = 64 * 1024);
+  ~writer_c();
+
+  writer_c &start_object();
+  writer_c &end_object();
+  writer_c &start_array();
+  writer_c &end_array();
+
+  writer_c &key(std::string const &name);
+
+  writer_c &value(std::string const &string);
+  writer_c &value(char const *string);
+  writer_c &value(bool boolean);
+  writer_c &value(nlohmann::json const &json);
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, writer_c &>::type
+  value(T number) {
+    start_value();
+    m_buffer += ::fmt::format("{0}", number);
+    return end_value();
+  }
+
+  template<typename T>
+  writer_c &
+  member(std::string const &name,
+         T const &member_value) {
+    return key(name).value(member_value);
+  }
+
+  void flush();
+
+protected:
+  void start_value();
+  writer_c &end_value();
+  void start_container(bool is_object, char opening);
+  writer_c &end_container(char closing);
+  void new_line_and_indent(std::size_t depth);
+  void append_string(std::string const &string);
+
+public:
+  static void escape(std::string &destination, std::string const &string);
+};
+
+}}
@@ -0,0 +1,256 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   verification of EBML CRC-32 elements
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <unordered_set>
+
+#include <ebml/EbmlCrc32.h>
+#include <matroska/KaxAttachments.h>
+#include <matroska/KaxChapters.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxCues.h>
+#include <matroska/KaxInfo.h>
+#include <matroska/KaxSeekHead.h>
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTags.h>
+#include <matroska/KaxTracks.h>
+
+#include "common/checksums/base.h"
+#include "common/kax_crc32_verifier.h"
+#include "common/vint.h"
+
+using namespace libebml;
+using namespace libmatroska;
+
+namespace mtx {
+
+kax_crc32_verifier_c::kax_crc32_verifier_c(mm_io_c &in,
+                                           unsigned int num_threads)
+  : m_in(in)
+  , m_num_threads{std::max(num_threads ? num_threads : std::thread::hardware_concurrency(), 1u)}
+  , m_max_jobs_in_flight{m_num_threads * 2}
+  , m_max_bytes_in_flight{m_max_jobs_in_flight * 32ull * 1024 * 1024}
+{
+}
+
+kax_crc32_verifier_c::~kax_crc32_verifier_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_shutting_down = true;
+  }
+
+  m_task_available.notify_all();
+
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+bool
+kax_crc32_verifier_c::is_level1_master(uint32_t id) {
+  static std::unordered_set<uint32_t> const s_ids{
+    EBML_ID_VALUE(EBML_ID(KaxAttachments)),
+    EBML_ID_VALUE(EBML_ID(KaxChapters)),
+    EBML_ID_VALUE(EBML_ID(KaxCluster)),
+    EBML_ID_VALUE(EBML_ID(KaxCues)),
+    EBML_ID_VALUE(EBML_ID(KaxInfo)),
+    EBML_ID_VALUE(EBML_ID(KaxSeekHead)),
+    EBML_ID_VALUE(EBML_ID(KaxTags)),
+    EBML_ID_VALUE(EBML_ID(KaxTracks)),
+  };
+
+  return s_ids.count(id) != 0;
+}
+
+std::vector<kax_crc32_verifier_c::problem_t> const &
+kax_crc32_verifier_c::verify() {
+  m_file_size = m_in.get_size();
+  m_in.setFilePointer(0);
+
+  walk(m_file_size, false);
+
+  while (!m_jobs.empty())
+    finish_oldest_job();
+
+  std::stable_sort(m_problems.begin(), m_problems.end(), [](problem_t const &a, problem_t const &b) { return a.m_element_position < b.m_element_position; });
+
+  return m_problems;
+}
+
+/* Iterates over the elements up to 'end'. Segments found on the top
+   level are descended into; their children are checked. Returns
+   'false' if the file cannot be parsed any further. */
+bool
+kax_crc32_verifier_c::walk(uint64_t end,
+                           bool is_segment_level) {
+  static auto const s_segment_id = EBML_ID_VALUE(EBML_ID(KaxSegment));
+
+  while (m_in.getFilePointer() < end) {
+    auto element_position = m_in.getFilePointer();
+    auto id               = vint_c::read_ebml_id(m_in);
+    auto size             = vint_c::read(m_in);
+
+    if (!id.is_valid() || !size.is_valid()) {
+      mxdebug_if(m_debug, fmt::format("invalid element header at {0}; stopping\n", element_position));
+      return false;
+    }
+
+    auto data_start = m_in.getFilePointer();
+
+    if (!is_segment_level && (id.m_value == s_segment_id)) {
+      auto segment_end = size.is_unknown() ? m_file_size : std::min<uint64_t>(m_file_size, data_start + size.m_value);
+      if (!walk(segment_end, true))
+        return false;
+      continue;
+    }
+
+    // Elements of unknown size (e.g. clusters written by live
+    // encoders) cannot carry a CRC-32. Their children are read as if
+    // they were siblings, which skips them one by one.
+    if (size.is_unknown())
+      continue;
+
+    auto data_end = data_start + size.m_value;
+
+    if (data_end > m_file_size) {
+      mxdebug_if(m_debug, fmt::format("element 0x{0:x} at {1} extends beyond the end of the file\n", id.m_value, element_position));
+      m_problems.push_back({ problem_e::truncated, static_cast<uint32_t>(id.m_value), element_position, data_start, data_end, 0, 0 });
+      return false;
+    }
+
+    if (is_segment_level && is_level1_master(id.m_value))
+      check_element(id.m_value, element_position, data_start, data_end);
+
+    m_in.setFilePointer(data_end);
+  }
+
+  return true;
+}
+
+void
+kax_crc32_verifier_c::check_element(uint32_t id,
+                                    uint64_t element_position,
+                                    uint64_t data_start,
+                                    uint64_t data_end) {
+  static auto const s_crc32_id = EBML_ID_VALUE(EBML_ID(EbmlCrc32));
+
+  if ((data_end - data_start) < 6)
+    return;
+
+  auto crc32_id   = vint_c::read_ebml_id(m_in);
+  auto crc32_size = vint_c::read(m_in);
+
+  if (   !crc32_id.is_valid()
+      || !crc32_size.is_valid()
+      || (crc32_id.m_value   != s_crc32_id)
+      || (crc32_size.m_value != 4)
+      || ((m_in.getFilePointer() + 4) > data_end))
+    return;
+
+  auto stored_crc    = m_in.read_uint32_le();
+  auto covered_start = m_in.getFilePointer();
+
+  add_job({ id, element_position, covered_start, data_end, stored_crc, {} }, m_in.read(data_end - covered_start));
+}
+
+void
+kax_crc32_verifier_c::add_job(job_t job,
+                              memory_cptr const &data) {
+  while (   !m_jobs.empty()
+         && (   (m_jobs.size() >= m_max_jobs_in_flight)
+             || ((m_bytes_in_flight + data->get_size()) > m_max_bytes_in_flight)))
+    finish_oldest_job();
+
+  // The workers are started with the first job.
+  while (m_workers.size() < m_num_threads)
+    m_workers.emplace_back([this]() { run_worker(); });
+
+  std::packaged_task<uint32_t()> task{[data]() {
+    return static_cast<uint32_t>(mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc32_ieee_le, *data, 0xffffffffu) ^ 0xffffffffu);
+  }};
+
+  m_bytes_in_flight    += data->get_size();
+  job.m_calculated_crc  = task.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tasks.push_back(std::move(task));
+  }
+
+  m_task_available.notify_one();
+
+  m_jobs.push_back(std::move(job));
+}
+
+/* Runs the queued checksum calculations until the verifier is
+   destroyed. Tasks still queued at that point are run first so that no
+   future is left without a result. */
+void
+kax_crc32_verifier_c::run_worker() {
+  while (true) {
+    std::packaged_task<uint32_t()> task;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_task_available.wait(lock, [this]() { return m_shutting_down || !m_tasks.empty(); });
+
+      if (m_tasks.empty())
+        return;
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+void
+kax_crc32_verifier_c::finish_oldest_job() {
+  auto &job           = m_jobs.front();
+  auto calculated_crc = job.m_calculated_crc.get();
+  auto num_bytes      = job.m_covered_end - job.m_covered_start;
+
+  m_bytes_in_flight   -= num_bytes;
+  m_num_bytes_covered += num_bytes;
+  ++m_num_checked;
+
+  mxdebug_if(m_debug,
+             fmt::format("element 0x{0:x} at {1}: bytes {2}-{3}: stored 0x{4:08x} calculated 0x{5:08x}\n",
+                         job.m_id, job.m_element_position, job.m_covered_start, job.m_covered_end, job.m_stored_crc, calculated_crc));
+
+  if (calculated_crc != job.m_stored_crc)
+    m_problems.push_back({ problem_e::crc_mismatch, job.m_id, job.m_element_position, job.m_covered_start, job.m_covered_end, job.m_stored_crc, calculated_crc });
+
+  m_jobs.pop_front();
+}
+
+uint64_t
+kax_crc32_verifier_c::get_num_checked()
+  const {
+  return m_num_checked;
+}
+
+uint64_t
+kax_crc32_verifier_c::get_num_bytes_covered()
+  const {
+  return m_num_bytes_covered;
+}
+
+std::vector<kax_crc32_verifier_c::problem_t> const &
+kax_crc32_verifier_c::get_problems()
+  const {
+  return m_problems;
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   verification of EBML CRC-32 elements
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace mtx {
+
+/* Checks the EbmlCrc32 elements that are the first children of level 1
+   elements (clusters, tracks, cues etc.).
+
+   The file is streamed through once without building libebml element
+   trees. The checksums themselves are calculated by a fixed number of
+   worker threads so that several clusters are verified at the same time
+   while the next ones are read. */
+
+class kax_crc32_verifier_c {
+public:
+  enum class problem_e {
+    crc_mismatch,
+    truncated,
+  };
+
+  struct problem_t {
+    problem_e m_type;
+    uint32_t m_id;
+    uint64_t m_element_position, m_covered_start, m_covered_end;
+    uint32_t m_stored_crc, m_calculated_crc;
+  };
+
+protected:
+  struct job_t {
+    uint32_t m_id;
+    uint64_t m_element_position, m_covered_start, m_covered_end;
+    uint32_t m_stored_crc;
+    std::future<uint32_t> m_calculated_crc;
+  };
+
+  mm_io_c &m_in;
+  uint64_t m_file_size{};
+  unsigned int m_num_threads, m_max_jobs_in_flight;
+  uint64_t m_max_bytes_in_flight{}, m_bytes_in_flight{};
+  std::deque<job_t> m_jobs;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_task_available;
+  std::deque<std::packaged_task<uint32_t()>> m_tasks;
+  bool m_shutting_down{};
+
+  uint64_t m_num_checked{}, m_num_bytes_covered{};
+  std::vector<problem_t> m_problems;
+
+  debugging_option_c m_debug{"kax_crc32_verifier"};
+
+public:
+  kax_crc32_verifier_c(mm_io_c &in, unsigned int num_threads = 0);
+  ~kax_crc32_verifier_c();
+
+  std::vector<problem_t> const &verify();
+
+  uint64_t get_num_checked() const;
+  uint64_t get_num_bytes_covered() const;
+  std::vector<problem_t> const &get_problems() const;
+
+protected:
+  bool walk(uint64_t end, bool is_segment_level);
+  void check_element(uint32_t id, uint64_t element_position, uint64_t data_start, uint64_t data_end);
+  void add_job(job_t job, memory_cptr const &data);
+  void finish_oldest_job();
+  void run_worker();
+
+  static bool is_level1_master(uint32_t id);
+};
+
+}
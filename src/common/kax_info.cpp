@@ -14,8 +14,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <typeinfo>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -71,11 +74,13 @@
 #include "common/math.h"
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
+#include "common/mm_mem_io.h"
 #include "common/stereo_mode.h"
 #include "common/strings/editing.h"
 #include "common/strings/formatting.h"
 #include "common/translation.h"
 #include "common/version.h"
+#include "common/vint.h"
 #include "common/xml/ebml_chapters_converter.h"
 #include "common/xml/ebml_tags_converter.h"
 
@@ -158,6 +163,11 @@ kax_info_c::set_verbosity(int verbosity) {
   p_func()->m_verbose = verbosity;
 }
 
+void
+kax_info_c::set_num_threads(unsigned int num_threads) {
+  p_func()->m_num_threads = num_threads;
+}
+
 void
 kax_info_c::set_destination_file_name(std::string const &file_name) {
   p_func()->m_destination_file_name = file_name;
@@ -922,24 +932,16 @@ kax_info_c::post_block_group(EbmlElement &e) {
                              p->m_lf_tnum,
                              format_timestamp(p->m_lf_timestamp)));
 
-  auto &tinfo = p->m_track_info[p->m_lf_tnum];
+  kax_info::block_statistics_t stats;
 
-  tinfo.m_blocks                                                       += p->m_frame_sizes.size();
-  tinfo.m_blocks_by_ref_num[std::min<int64_t>(p->m_num_references, 2)] += p->m_frame_sizes.size();
-  tinfo.m_min_timestamp                                                 = std::min(tinfo.m_min_timestamp ? *tinfo.m_min_timestamp : p->m_lf_timestamp, p->m_lf_timestamp);
-  tinfo.m_size                                                         += boost::accumulate(p->m_frame_sizes, 0);
+  stats.m_track_number    = p->m_lf_tnum;
+  stats.m_timestamp       = p->m_lf_timestamp;
+  stats.m_num_frames      = p->m_frame_sizes.size();
+  stats.m_size            = boost::accumulate(p->m_frame_sizes, 0);
+  stats.m_reference_class = std::min<int64_t>(p->m_num_references, 2);
+  stats.m_duration        = p->m_block_duration;
 
-  if (tinfo.m_max_timestamp && (*tinfo.m_max_timestamp >= p->m_lf_timestamp))
-    return;
-
-  tinfo.m_max_timestamp = p->m_lf_timestamp;
-
-  if (!p->m_block_duration)
-    tinfo.m_add_duration_for_n_packets  = p->m_frame_sizes.size();
-  else {
-    *tinfo.m_max_timestamp             += *p->m_block_duration;
-    tinfo.m_add_duration_for_n_packets  = 0;
-  }
+  add_block_statistics(stats);
 }
 
 bool
@@ -978,7 +980,6 @@ kax_info_c::post_simple_block(EbmlElement &e) {
   auto p            = p_func();
 
   auto &block       = static_cast<KaxSimpleBlock &>(e);
-  auto &tinfo       = p->m_track_info[block.TrackNum()];
   auto timestamp_ns = mtx::math::to_signed(block.GlobalTimecode());
   int num_frames    = block.NumberFrames();
   auto frames_start = block.GetElementPosition() + block.ElementSize();
@@ -1036,22 +1037,62 @@ kax_info_c::post_simple_block(EbmlElement &e) {
                              block.TrackNum(),
                              timestamp_ns));
 
-  tinfo.m_blocks                                                                    += block.NumberFrames();
-  tinfo.m_blocks_by_ref_num[block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1] += block.NumberFrames();
-  tinfo.m_min_timestamp                                                              = std::min(tinfo.m_min_timestamp ? *tinfo.m_min_timestamp : static_cast<int64_t>(timestamp_ns), static_cast<int64_t>(timestamp_ns));
-  tinfo.m_max_timestamp                                                              = std::max(tinfo.m_max_timestamp ? *tinfo.m_max_timestamp : static_cast<int64_t>(timestamp_ns), static_cast<int64_t>(timestamp_ns));
-  tinfo.m_add_duration_for_n_packets                                                 = block.NumberFrames();
-  tinfo.m_size                                                                      += boost::accumulate(p->m_frame_sizes, 0);
+  kax_info::block_statistics_t stats;
+
+  stats.m_track_number    = block.TrackNum();
+  stats.m_timestamp       = timestamp_ns;
+  stats.m_num_frames      = block.NumberFrames();
+  stats.m_size            = boost::accumulate(p->m_frame_sizes, 0);
+  stats.m_reference_class = block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1;
+  stats.m_simple_block    = true;
+
+  add_block_statistics(stats);
+}
+
+void
+kax_info_c::add_block_statistics(kax_info::block_statistics_t const &stats) {
+  auto p = p_func();
+
+  if (p->m_collect_block_statistics) {
+    p->m_block_statistics.push_back(stats);
+    return;
+  }
+
+  auto &tinfo = p->m_track_info[stats.m_track_number];
+
+  tinfo.m_blocks                                     += stats.m_num_frames;
+  tinfo.m_blocks_by_ref_num[stats.m_reference_class] += stats.m_num_frames;
+  tinfo.m_min_timestamp                               = std::min(tinfo.m_min_timestamp ? *tinfo.m_min_timestamp : stats.m_timestamp, stats.m_timestamp);
+  tinfo.m_size                                       += stats.m_size;
+
+  if (stats.m_simple_block) {
+    tinfo.m_max_timestamp              = std::max(tinfo.m_max_timestamp ? *tinfo.m_max_timestamp : stats.m_timestamp, stats.m_timestamp);
+    tinfo.m_add_duration_for_n_packets = stats.m_num_frames;
+    return;
+  }
+
+  if (tinfo.m_max_timestamp && (*tinfo.m_max_timestamp >= stats.m_timestamp))
+    return;
+
+  tinfo.m_max_timestamp = stats.m_timestamp;
+
+  if (!stats.m_duration)
+    tinfo.m_add_duration_for_n_packets  = stats.m_num_frames;
+  else {
+    *tinfo.m_max_timestamp             += *stats.m_duration;
+    tinfo.m_add_duration_for_n_packets  = 0;
+  }
 }
 
 kax_info_c::result_e
 kax_info_c::handle_segment(EbmlElement *l0) {
   ui_show_element(*l0);
 
-  auto p        = p_func();
-  auto l1       = std::shared_ptr<EbmlElement>{};
-  auto kax_file = std::make_shared<kax_file_c>(*p->m_in);
-  p->m_level    = 1;
+  auto p           = p_func();
+  auto l1          = std::shared_ptr<EbmlElement>{};
+  auto kax_file    = std::make_shared<kax_file_c>(*p->m_in);
+  auto segment_end = l0->IsFiniteSize() ? std::min<uint64_t>(l0->GetElementPosition() + l0->HeadSize() + l0->GetSize(), p->m_file_size) : p->m_file_size;
+  p->m_level       = 1;
 
   kax_file->set_segment_end(*l0);
 
@@ -1065,6 +1106,11 @@ kax_info_c::handle_segment(EbmlElement *l0) {
       ui_show_element(*l1);
       return result_e::succeeded;
 
+    } else if (Is<KaxCluster>(*l1) && handle_clusters_in_parallel(l1->GetElementPosition(), segment_end)) {
+      if (p->m_abort)
+        return result_e::aborted;
+      continue;
+
     } else
       handle_elements_generic(*l1);
 
@@ -1080,6 +1126,252 @@ kax_info_c::handle_segment(EbmlElement *l0) {
   return result_e::succeeded;
 }
 
+/* Decodes runs of clusters on several worker threads. The level 1
+   elements' headers are read in order to find the clusters; ranges of
+   them are then handed to workers that each decode them with their own
+   instance. Their output and statistics are merged in file order so that
+   the result is identical to processing them sequentially.
+
+   Only clusters of known size are handled this way. If a worker cannot
+   decode all of its clusters, e.g. due to damaged data, everything from
+   that point on is left to the sequential code, which resyncs & reports
+   errors in file order. Returns 'false' if not even the first cluster
+   could be handled; otherwise the file pointer is positioned after the
+   last cluster handled. */
+bool
+kax_info_c::handle_clusters_in_parallel(uint64_t start,
+                                        uint64_t segment_end) {
+  static debugging_option_c s_debug{"kax_info_parallel"};
+  static auto const s_cluster_id           = EBML_ID_VALUE(EBML_ID(KaxCluster));
+  static auto const s_max_clusters_per_job = 64u;
+  static auto const s_max_bytes_per_job    = 16ull * 1024 * 1024;
+
+  auto p           = p_func();
+  auto num_threads = p->m_num_threads ? p->m_num_threads : std::thread::hardware_concurrency();
+
+  if (p->m_use_gui || (num_threads < 2))
+    return false;
+
+  // Initialize the names before they're looked up from several threads.
+  kax_element_names_c::init();
+
+  std::deque<std::pair<std::future<kax_info::cluster_range_result_t>, uint64_t>> jobs;
+  auto max_jobs_in_flight    = num_threads;
+  auto position              = start;
+  auto batch_start           = start;
+  auto num_clusters_in_batch = 0u;
+  auto num_clusters          = uint64_t{};
+  auto stopped_at            = boost::optional<uint64_t>{};
+
+  // The results of jobs following one that stopped early are discarded.
+  auto finish_oldest_job = [this, p, &jobs, &stopped_at]() {
+    auto result = jobs.front().first.get();
+    auto end    = jobs.front().second;
+    jobs.pop_front();
+
+    if (stopped_at)
+      return;
+
+    p->m_out->puts(result.m_output);
+
+    for (auto const &stats : result.m_block_statistics)
+      add_block_statistics(stats);
+
+    if (result.m_end_position < end)
+      stopped_at = result.m_end_position;
+  };
+
+  auto start_job = [this, p, &jobs, &position, &batch_start, &num_clusters_in_batch, &finish_oldest_job, &stopped_at, max_jobs_in_flight]() {
+    if (position == batch_start)
+      return;
+
+    while (!stopped_at && (jobs.size() >= max_jobs_in_flight))
+      finish_oldest_job();
+
+    if (stopped_at)
+      return;
+
+    p->m_in->setFilePointer(batch_start);
+
+    auto data   = p->m_in->read(position - batch_start);
+    auto worker = create_cluster_worker();
+    auto offset = batch_start;
+
+    jobs.emplace_back(std::async(std::launch::async, [worker, data, offset]() { return worker->handle_cluster_range(data, offset); }), position);
+
+    batch_start           = position;
+    num_clusters_in_batch = 0;
+  };
+
+  try {
+    while ((position < segment_end) && !p->m_abort && !stopped_at) {
+      p->m_in->setFilePointer(position);
+
+      auto id   = vint_c::read_ebml_id(*p->m_in);
+      auto size = vint_c::read(*p->m_in);
+
+      // Anything else, including damaged data, is left to the
+      // sequential code.
+      if (!id.is_valid() || !size.is_valid() || size.is_unknown() || (id.m_value != s_cluster_id))
+        break;
+
+      auto end = p->m_in->getFilePointer() + size.m_value;
+      if (end > segment_end)
+        break;
+
+      position = end;
+      ++num_clusters_in_batch;
+      ++num_clusters;
+
+      if ((num_clusters_in_batch >= s_max_clusters_per_job) || ((position - batch_start) >= s_max_bytes_per_job))
+        start_job();
+    }
+
+  } catch (mtx::mm_io::exception &) {
+  }
+
+  start_job();
+
+  while (!jobs.empty())
+    finish_oldest_job();
+
+  if (stopped_at)
+    position = *stopped_at;
+
+  mxdebug_if(s_debug,
+             fmt::format("handle_clusters_in_parallel: {0} clusters from {1} to {2} with {3} threads; stopped early? {4}\n",
+                         num_clusters, start, position, num_threads, !!stopped_at));
+
+  p->m_in->setFilePointer(position);
+
+  return position != start;
+}
+
+std::shared_ptr<kax_info_c>
+kax_info_c::create_cluster_worker() {
+  auto p                         = p_func();
+  auto worker                    = std::make_shared<kax_info_c>();
+  auto wp                        = worker->p_func();
+
+  wp->m_ts_scale                 = p->m_ts_scale;
+  wp->m_file_size                = p->m_file_size;
+  wp->m_tracks                   = p->m_tracks;
+  wp->m_tracks_by_number         = p->m_tracks_by_number;
+  wp->m_calc_checksums           = p->m_calc_checksums;
+  wp->m_show_summary             = p->m_show_summary;
+  wp->m_show_hexdump             = p->m_show_hexdump;
+  wp->m_show_size                = p->m_show_size;
+  wp->m_show_track_info          = p->m_show_track_info;
+  wp->m_hex_positions            = p->m_hex_positions;
+  wp->m_hexdump_max_size         = p->m_hexdump_max_size;
+  wp->m_verbose                  = p->m_verbose;
+  wp->m_level                    = p->m_level;
+  wp->m_collect_block_statistics = true;
+
+  return worker;
+}
+
+namespace {
+
+// Presents a copy of a part of a file as if it were the whole file so
+// that the elements read from it report their original positions.
+class file_window_io_c: public mm_mem_io_c {
+protected:
+  memory_cptr m_data;
+  uint64_t m_offset;
+
+public:
+  file_window_io_c(memory_cptr const &data, uint64_t offset)
+    : mm_mem_io_c{*data}
+    , m_data{data}
+    , m_offset{offset}
+  {
+  }
+
+  virtual uint64 getFilePointer() override {
+    return mm_mem_io_c::getFilePointer() + m_offset;
+  }
+
+  virtual void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning) override {
+    mm_mem_io_c::setFilePointer(libebml::seek_beginning == mode ? offset - static_cast<int64>(m_offset) : offset, mode);
+  }
+
+  // The end of the window, not its size, so that the range checks
+  // based on file positions work.
+  virtual int64_t get_size() override {
+    return m_offset + m_data->get_size();
+  }
+};
+
+// Reads the level 1 elements for a worker. Instead of resyncing &
+// reporting errors from the worker thread it stops at the first
+// problem.
+class cluster_range_kax_file_c: public kax_file_c {
+public:
+  cluster_range_kax_file_c(mm_io_c &in)
+    : kax_file_c{in}
+  {
+  }
+
+  virtual std::shared_ptr<libebml::EbmlElement> read_next_level1_element(uint32_t wanted_id = 0, bool /* report_cluster_timestamp */ = false) override {
+    return read_next_level1_element_internal(wanted_id);
+  }
+
+protected:
+  virtual std::shared_ptr<libebml::EbmlElement> resync_to_level1_element_internal(uint32_t /* wanted_id */ = 0) override {
+    return {};
+  }
+
+  virtual void report(std::string const &/* message */) override {
+  }
+};
+
+}
+
+kax_info::cluster_range_result_t
+kax_info_c::handle_cluster_range(memory_cptr const &data,
+                                 uint64_t start) {
+  auto p   = p_func();
+  auto out = std::make_shared<mm_mem_io_c>(nullptr, 0, 64 * 1024);
+  auto end = start + data->get_size();
+
+  p->m_in  = std::make_shared<file_window_io_c>(data, start);
+  p->m_out = out;
+  p->m_es  = std::make_shared<EbmlStream>(*p->m_in);
+
+  cluster_range_kax_file_c kax_file{*p->m_in};
+  kax_file.set_timestamp_scale(-1);
+
+  // Only the output & statistics of completely decoded elements are
+  // returned.
+  auto position             = start;
+  auto output_size          = std::size_t{};
+  auto num_block_statistics = std::size_t{};
+
+  try {
+    while (position < end) {
+      auto l1 = kax_file.read_next_level1_element();
+      if (!l1 || (l1->GetElementPosition() != position))
+        break;
+
+      handle_elements_generic(*l1);
+
+      position             = l1->GetElementPosition() + kax_file.get_element_size(*l1);
+      output_size          = out->getFilePointer();
+      num_block_statistics = p->m_block_statistics.size();
+
+      if (!p->m_in->setFilePointer2(position))
+        break;
+    }
+
+  } catch (...) {
+  }
+
+  p->m_block_statistics.erase(p->m_block_statistics.begin() + num_block_statistics, p->m_block_statistics.end());
+
+  return { out->get_content().substr(0, output_size), std::move(p->m_block_statistics), position };
+}
+
 bool
 kax_info_c::run_generic_pre_processors(EbmlElement &e) {
   auto p = p_func();
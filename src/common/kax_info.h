@@ -29,6 +29,8 @@ public:
   }
 };
 
+struct block_statistics_t;
+struct cluster_range_result_t;
 struct track_t;
 class private_c;
 
@@ -62,6 +64,7 @@ public:
   void set_hex_positions(bool enable);
   void set_hexdump_max_size(int max_size);
   void set_verbosity(int verbosity);
+  void set_num_threads(unsigned int num_threads);
   void set_destination_file_name(std::string const &file_name);
   void set_source_file(mm_io_cptr const &file);
   void set_source_file_name(std::string const &file_name);
@@ -123,6 +126,11 @@ protected:
   void handle_block_group(libebml::EbmlElement *&l2, libmatroska::KaxCluster *&cluster);
   void handle_elements_generic(libebml::EbmlElement &e);
   result_e handle_segment(libebml::EbmlElement *l0);
+  bool handle_clusters_in_parallel(uint64_t start, uint64_t segment_end);
+  kax_info::cluster_range_result_t handle_cluster_range(memory_cptr const &data, uint64_t start);
+  std::shared_ptr<kax_info_c> create_cluster_worker();
+
+  void add_block_statistics(kax_info::block_statistics_t const &stats);
 
   void display_track_info();
 
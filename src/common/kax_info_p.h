@@ -30,6 +30,24 @@ struct track_info_t {
   boost::optional<int64_t> m_min_timestamp, m_max_timestamp;
 };
 
+// The statistics a single block or simple block contributes to its
+// track's summary.
+struct block_statistics_t {
+  unsigned int m_track_number{};
+  int64_t m_timestamp{}, m_num_frames{}, m_size{}, m_reference_class{};
+  boost::optional<int64_t> m_duration;
+  bool m_simple_block{};
+};
+
+// The output created & the statistics collected while processing a
+// range of clusters on a worker thread and the position up to which
+// the clusters were processed.
+struct cluster_range_result_t {
+  std::string m_output;
+  std::vector<block_statistics_t> m_block_statistics;
+  uint64_t m_end_position{};
+};
+
 class private_c {
 public:
   std::vector<std::shared_ptr<track_t>> m_tracks;
@@ -54,6 +72,12 @@ public:
 
   bool m_use_gui{}, m_calc_checksums{}, m_show_summary{}, m_show_hexdump{}, m_show_size{}, m_show_track_info{}, m_hex_positions{}, m_retain_elements{};
   int m_hexdump_max_size{}, m_verbose{};
+  unsigned int m_num_threads{};
+
+  // Set for workers processing clusters in parallel: the statistics are
+  // merged into the main instance's m_track_info in file order.
+  bool m_collect_block_statistics{};
+  std::vector<block_statistics_t> m_block_statistics;
 
   bool m_abort{};
 
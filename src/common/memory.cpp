@@ -62,6 +62,24 @@ memory_c::prepend(unsigned char const *new_buffer,
   std::memcpy( &buffer[0],        &new_buffer[0], new_size);
 }
 
+std::size_t
+get_memory_slices_size(memory_slices_c const &slices) {
+  return boost::accumulate(slices, std::size_t{}, [](std::size_t sum, memory_slice_t const &slice) { return sum + slice.m_size; });
+}
+
+memory_cptr
+join_memory_slices(memory_slices_c const &slices) {
+  auto joined = memory_c::alloc(get_memory_slices_size(slices));
+  auto dst    = joined->get_buffer();
+
+  for (auto const &slice : slices) {
+    std::memcpy(dst, slice.get_buffer(), slice.m_size);
+    dst += slice.m_size;
+  }
+
+  return joined;
+}
+
 memory_cptr
 lace_memory_xiph(const std::vector<memory_cptr> &blocks) {
   size_t i, size = 1;
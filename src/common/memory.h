@@ -240,5 +240,19 @@ operator !=(memory_c const &a,
   return !(a == b);
 }
 
+// A part of a buffer. The slice keeps the buffer alive.
+struct memory_slice_t {
+  memory_cptr m_memory;
+  std::size_t m_offset{}, m_size{};
+
+  unsigned char *get_buffer() const {
+    return m_memory->get_buffer() + m_offset;
+  }
+};
+using memory_slices_c = std::vector<memory_slice_t>;
+
+std::size_t get_memory_slices_size(memory_slices_c const &slices);
+memory_cptr join_memory_slices(memory_slices_c const &slices);
+
 memory_cptr lace_memory_xiph(const std::vector<memory_cptr> &blocks);
 std::vector<memory_cptr> unlace_memory_xiph(memory_cptr &buffer);
@@ -74,35 +74,64 @@ guess_type_by_content(magic_t &m,
   return "";
 }
 
-std::string
-guess_type_internal(std::string ext,
-                    bool is_file) {
-  std::string ret;
-  magic_t m;
-
-  if (!is_file)
-    return guess_type_by_ext(ext);
+// Loading the magic database takes a while. Therefore it is only
+// loaded once the first file's content has to be examined, and the
+// handle is kept for all further files.
+struct magic_handle_t {
+  magic_t m_magic;
+
+  ~magic_handle_t() {
+    if (m_magic)
+      magic_close(m_magic);
+  }
+};
 
+magic_t
+open_magic() {
   // In newer versions of libmagic MAGIC_MIME is declared as MAGIC_MIME_TYPE | MAGIC_MIME_ENCODING.
   // Older versions don't know MAGIC_MIME_TYPE, though -- the old MAGIC_MIME is the new MAGIC_MIME_TYPE,
   // and the new MAGIC_MIME has been redefined.
 # ifdef MAGIC_MIME_TYPE
-  m = magic_open(MAGIC_MIME_TYPE | MAGIC_SYMLINK);
+  auto m = magic_open(MAGIC_MIME_TYPE | MAGIC_SYMLINK);
 # else  // MAGIC_MIME_TYPE
-  m = magic_open(MAGIC_MIME      | MAGIC_SYMLINK);
+  auto m = magic_open(MAGIC_MIME      | MAGIC_SYMLINK);
 # endif  // MAGIC_MIME_TYPE
 
+  if (!m)
+    return nullptr;
+
 # ifdef MTX_APPIMAGE
   auto magic_filename = (mtx::sys::get_installation_path() / ".." / "share" / "file" / "magic.mgc").string();
-  if (!m || (-1 == magic_load(m, magic_filename.c_str())) || (-1 == magic_load(m, nullptr)))
-    return guess_type_by_ext(ext);
+  if ((-1 == magic_load(m, magic_filename.c_str())) || (-1 == magic_load(m, nullptr))) {
 # else
-  if (!m || (-1 == magic_load(m, nullptr)))
-    return guess_type_by_ext(ext);
+  if (-1 == magic_load(m, nullptr)) {
 # endif  // defined(MTX_APPIMAGE)
+    magic_close(m);
+    return nullptr;
+  }
+
+  return m;
+}
+
+std::string
+guess_type_internal(std::string ext,
+                    bool is_file) {
+  if (!is_file)
+    return guess_type_by_ext(ext);
 
-  ret = guess_type_by_content(m, ext);
-  magic_close(m);
+  static magic_handle_t s_magic{open_magic()};
+  static std::mutex s_magic_mutex;
+
+  if (!s_magic.m_magic)
+    return guess_type_by_ext(ext);
+
+  std::string ret;
+
+  {
+    // A handle must not be used by several threads at the same time.
+    std::lock_guard<std::mutex> lock{s_magic_mutex};
+    ret = guess_type_by_content(s_magic.m_magic, ext);
+  }
 
   if (ret == "")
     return guess_type_by_ext(ext);
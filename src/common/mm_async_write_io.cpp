@@ -0,0 +1,353 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "common/locale.h"
+#include "common/mm_async_write_io.h"
+#include "common/mm_async_write_io_p.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+
+namespace {
+
+debugging_option_c s_debug{"async_write_io"};
+
+class background_writer_c {
+private:
+  struct job_t {
+    std::function<void()> function;
+    std::size_t num_bytes;
+  };
+
+  std::mutex m_mutex;
+  std::condition_variable m_job_available, m_progress;
+  std::deque<job_t> m_jobs;
+  std::size_t m_pending_bytes{}, m_max_pending_bytes{64 * 1024 * 1024};
+  bool m_busy{}, m_shutting_down{};
+  std::exception_ptr m_error;
+  std::thread m_thread;
+
+public:
+  ~background_writer_c() {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_shutting_down = true;
+      m_jobs.clear();
+    }
+
+    m_job_available.notify_all();
+
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+
+  void
+  set_max_pending_bytes(std::size_t max_pending_bytes) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_max_pending_bytes = max_pending_bytes;
+  }
+
+  void
+  enqueue(std::function<void()> const &function,
+          std::size_t num_bytes,
+          bool may_throw) {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    if (!m_thread.joinable())
+      m_thread = std::thread{[this]() { run(); }};
+
+    m_progress.wait(lock, [this, num_bytes]() {
+      return m_error || !m_pending_bytes || ((m_pending_bytes + num_bytes) <= m_max_pending_bytes);
+    });
+
+    if (m_error) {
+      if (may_throw)
+        std::rethrow_exception(m_error);
+      return;
+    }
+
+    m_jobs.push_back({ function, num_bytes });
+    m_pending_bytes += num_bytes;
+
+    lock.unlock();
+    m_job_available.notify_one();
+  }
+
+  void
+  wait_until_idle() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    m_progress.wait(lock, [this]() { return m_error || (m_jobs.empty() && !m_busy); });
+
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+
+private:
+  void
+  run() {
+    while (true) {
+      job_t job;
+
+      {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_job_available.wait(lock, [this]() { return m_shutting_down || !m_jobs.empty(); });
+
+        if (m_jobs.empty())
+          return;
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_busy = true;
+      }
+
+      std::exception_ptr error;
+
+      try {
+        job.function();
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        m_busy           = false;
+        m_pending_bytes -= job.num_bytes;
+
+        if (error && !m_error) {
+          // All further operations would fail, too, and the files
+          // they belong to are unusable anyway.
+          m_error         = error;
+          m_pending_bytes = 0;
+          m_jobs.clear();
+        }
+      }
+
+      m_progress.notify_all();
+    }
+  }
+};
+
+background_writer_c &
+background_writer() {
+  static background_writer_c s_writer;
+  return s_writer;
+}
+
+}
+
+mm_async_write_io_c::mm_async_write_io_c(std::string const &file_name,
+                                         std::string const &temporary_file_name)
+  : mm_io_c{*new mm_async_write_io_private_c{file_name, temporary_file_name}}
+{
+  auto target      = p_func()->target;
+  auto create_name = temporary_file_name.empty() ? file_name : temporary_file_name;
+
+  mxdebug_if(s_debug, fmt::format("async_write_io: queueing open of {0}\n", create_name));
+
+  background_writer().enqueue([target, create_name]() {
+    *target = std::make_shared<mm_file_io_c>(create_name, MODE_CREATE);
+  }, 0, true);
+}
+
+mm_async_write_io_c::mm_async_write_io_c(mm_async_write_io_private_c &p)
+  : mm_io_c{p}
+{
+}
+
+mm_async_write_io_c::~mm_async_write_io_c() {
+  close_async_write_io(false);
+}
+
+uint64
+mm_async_write_io_c::getFilePointer() {
+  return p_func()->pos;
+}
+
+void
+mm_async_write_io_c::setFilePointer(int64 offset,
+                                    libebml::seek_mode mode) {
+  auto p  = p_func();
+  auto new_pos
+    = libebml::seek_beginning == mode ? offset
+    : libebml::seek_end       == mode ? p->size + offset // offsets from the end are negative already
+    :                                   p->pos  + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{};
+
+  p->pos = new_pos;
+}
+
+int64_t
+mm_async_write_io_c::get_size() {
+  return p_func()->size;
+}
+
+uint32
+mm_async_write_io_c::_read(void *buffer,
+                           size_t size) {
+  auto p = p_func();
+
+  wait_for_pending_operations();
+
+  if (!*p->target)
+    throw mtx::mm_io::read_write_x{};
+
+  auto &target = **p->target;
+  target.setFilePointer(p->pos);
+  auto num_read = target.read(buffer, size);
+  p->pos       += num_read;
+
+  return num_read;
+}
+
+size_t
+mm_async_write_io_c::_write(const void *buffer,
+                            size_t size) {
+  auto p = p_func();
+
+  if (p->closed)
+    throw mtx::mm_io::read_write_x{};
+
+  auto target = p->target;
+  auto pos    = p->pos;
+  auto data   = memory_c::clone(buffer, size);
+
+  background_writer().enqueue([target, pos, data]() {
+    auto &out = **target;
+
+    if (static_cast<int64_t>(out.getFilePointer()) != pos)
+      out.setFilePointer(pos);
+
+    if (out.write(data->get_buffer(), data->get_size()) != data->get_size())
+      throw mtx::mm_io::insufficient_space_x{};
+  }, size, true);
+
+  p->pos         += size;
+  p->size         = std::max(p->size, p->pos);
+  p->cached_size  = -1;
+
+  return size;
+}
+
+void
+mm_async_write_io_c::flush() {
+  auto p = p_func();
+
+  if (p->closed)
+    return;
+
+  auto target = p->target;
+  background_writer().enqueue([target]() { (*target)->flush(); }, 0, true);
+}
+
+bool
+mm_async_write_io_c::eof() {
+  return false;
+}
+
+std::string
+mm_async_write_io_c::get_file_name()
+  const {
+  return p_func()->file_name;
+}
+
+void
+mm_async_write_io_c::close() {
+  close_async_write_io(false);
+}
+
+/** \brief Closes the file and removes it afterwards
+
+   Used for files that have been opened in advance but that turn out
+   not to be needed.
+ */
+void
+mm_async_write_io_c::discard() {
+  close_async_write_io(true);
+}
+
+/** \brief Marks a file created under a temporary name as needed
+
+   It will be renamed to its actual name when it's closed instead of
+   being removed.
+ */
+void
+mm_async_write_io_c::keep() {
+  p_func()->keep_temporary_file = true;
+}
+
+void
+mm_async_write_io_c::close_async_write_io(bool remove_file) {
+  auto p = p_func();
+
+  if (p->closed)
+    return;
+
+  p->closed          = true;
+  auto target        = p->target;
+  auto is_temporary  = !p->temporary_file_name.empty();
+  auto rename_file   = is_temporary && !remove_file && p->keep_temporary_file;
+  remove_file        = remove_file  || (is_temporary && !rename_file);
+  auto created_name  = g_cc_local_utf8->native(is_temporary ? p->temporary_file_name : p->file_name);
+  auto final_name    = rename_file ? g_cc_local_utf8->native(p->file_name) : std::string{};
+  auto removed_name  = remove_file ? created_name                          : std::string{};
+
+  mxdebug_if(s_debug,
+             fmt::format("async_write_io: queueing close{0} of {1}\n",
+                         remove_file ? " & removal" : rename_file ? fmt::format(" & rename to {0}", p->file_name) : std::string{}, created_name));
+
+  // Closing is usually done from destructors, therefore errors must
+  // not be thrown here. They'll be reported by the next operation
+  // that waits for the writer.
+  background_writer().enqueue([target, created_name, final_name, removed_name]() {
+    if (*target) {
+      (*target)->close();
+      target->reset();
+    }
+
+    if (!removed_name.empty()) {
+      boost::system::error_code ec;
+      bfs::remove(removed_name, ec);
+    }
+
+    if (!final_name.empty()) {
+      boost::system::error_code ec;
+      bfs::rename(created_name, final_name, ec);
+      if (ec)
+        throw mtx::mm_io::open_x{std::error_code{ec.value(), std::system_category()}};
+    }
+  }, 0, false);
+}
+
+/** \brief Blocks until all queued operations of all files have been carried out
+
+   Re-throws the first error that occurred in the background.
+ */
+void
+mm_async_write_io_c::wait_for_pending_operations() {
+  background_writer().wait_until_idle();
+}
+
+void
+mm_async_write_io_c::set_max_pending_bytes(std::size_t max_pending_bytes) {
+  background_writer().set_max_pending_bytes(max_pending_bytes);
+}
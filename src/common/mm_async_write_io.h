@@ -0,0 +1,62 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+/* Output file whose actual I/O (opening, writing, seeking, closing)
+   is performed by a single background thread shared by all instances.
+   Position and size are tracked locally so that writes and seeks never
+   block unless the amount of queued data exceeds a limit. Reads wait
+   until all queued operations have been carried out.
+
+   Errors that occur in the background are re-thrown on the next
+   write, read or call to wait_for_pending_operations(). close() never
+   throws.
+
+   If a temporary file name is given, the file is created under that
+   name. It is renamed to its actual name when it's closed after keep()
+   has been called, and removed otherwise.
+*/
+
+class mm_async_write_io_private_c;
+class mm_async_write_io_c: public mm_io_c {
+protected:
+  MTX_DECLARE_PRIVATE(mm_async_write_io_private_c)
+
+  explicit mm_async_write_io_c(mm_async_write_io_private_c &p);
+
+public:
+  mm_async_write_io_c(std::string const &file_name, std::string const &temporary_file_name = std::string{});
+  virtual ~mm_async_write_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, libebml::seek_mode mode = libebml::seek_beginning);
+  virtual int64_t get_size();
+  virtual void flush();
+  virtual void close();
+  virtual void discard();
+  void keep();
+  virtual bool eof();
+  virtual std::string get_file_name() const;
+
+  static void wait_for_pending_operations();
+  static void set_max_pending_bytes(std::size_t max_pending_bytes);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void close_async_write_io(bool remove_file);
+};
@@ -0,0 +1,39 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/mm_io_p.h"
+
+class mm_async_write_io_c;
+
+class mm_async_write_io_private_c : public mm_io_private_c {
+public:
+  // The target file is only ever accessed from the background thread
+  // or after all pending operations have been carried out.
+  std::shared_ptr<mm_io_cptr> target;
+
+  // Only ever accessed from the thread using the object. Jobs for the
+  // background thread receive copies of the values they need.
+  std::string file_name, temporary_file_name;
+  int64_t pos{}, size{};
+  bool closed{}, keep_temporary_file{};
+
+  explicit mm_async_write_io_private_c(std::string const &p_file_name,
+                                       std::string const &p_temporary_file_name)
+    : target{std::make_shared<mm_io_cptr>()}
+    , file_name{p_file_name}
+    , temporary_file_name{p_temporary_file_name}
+  {
+  }
+};
@@ -45,26 +45,53 @@ mm_io_c::mm_io_c(mm_io_private_c &p)
 mm_io_c::~mm_io_c() {           // NOLINT(modernize-use-equals-default) due to pimpl idiom requiring explicit dtor declaration somewhere
 }
 
+/** \brief Reads a line, dropping all carriage returns
+
+   Reads in small blocks instead of byte by byte. Whatever has been
+   read beyond the end of the line is given back by seeking backwards.
+   I/O that cannot seek is read byte by byte instead.
+ */
 std::string
 mm_io_c::getline(boost::optional<std::size_t> max_chars) {
-  char c;
+  char buffer[256];
   std::string s;
 
   if (eof())
     throw mtx::mm_io::end_of_file_x{mtx::mm_io::make_error_code()};
 
-  while (read(&c, 1) == 1) {
-    if (c == '\r')
-      continue;
-    if (c == '\n')
+  auto block_size = is_seekable() ? sizeof(buffer) : 1;
+
+  while (true) {
+    auto num_read = read(buffer, block_size);
+    if (!num_read)
       return s;
-    s += c;
 
-    if (max_chars && (s.length() >= *max_chars))
-      break;
-  }
+    auto end  = buffer + num_read;
+    auto ptr  = buffer;
+    auto done = false;
+
+    while (!done && (ptr < end)) {
+      auto c = *ptr++;
 
-  return s;
+      if (c == '\r')
+        continue;
+
+      if (c == '\n')
+        done = true;
+
+      else {
+        s    += c;
+        done  = max_chars && (s.length() >= *max_chars);
+      }
+    }
+
+    if (done) {
+      // Always seek, even by 0 bytes: this resets an end-of-file
+      // condition triggered by reading ahead.
+      setFilePointer(-static_cast<int64_t>(end - ptr), libebml::seek_current);
+      return s;
+    }
+  }
 }
 
 bool
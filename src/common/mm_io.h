@@ -67,6 +67,9 @@ public:
   virtual size_t write(const memory_cptr &buffer, size_t size = UINT_MAX, size_t offset = 0);
   virtual bool eof() = 0;
   virtual void clear_eof() { }
+  virtual bool is_seekable() {
+    return true;
+  }
   virtual void flush() {
   }
   virtual int truncate(int64_t) {
@@ -57,6 +57,11 @@ mm_proxy_io_c::eof() {
   return p_func()->proxy_io->eof();
 }
 
+bool
+mm_proxy_io_c::is_seekable() {
+  return p_func()->proxy_io->is_seekable();
+}
+
 std::string
 mm_proxy_io_c::get_file_name()
   const {
@@ -30,6 +30,7 @@ public:
   virtual uint64 getFilePointer();
   virtual void clear_eof();
   virtual bool eof();
+  virtual bool is_seekable();
   virtual void close();
   virtual std::string get_file_name() const;
   virtual mm_io_c *get_proxied() const;
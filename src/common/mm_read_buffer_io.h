@@ -16,7 +16,7 @@
 
 #include "common/common_pch.h"
 
-#include "common/mm_io.h"
+#include "common/mm_proxy_io.h"
 
 class mm_read_buffer_io_private_c;
 class mm_read_buffer_io_c: public mm_proxy_io_c {
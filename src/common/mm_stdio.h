@@ -25,6 +25,9 @@ public:
   virtual bool eof() {
     return false;
   }
+  virtual bool is_seekable() {
+    return false;
+  }
   virtual std::string get_file_name() const {
     return "";
   }
@@ -14,6 +14,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/endian.h"
 #include "common/mm_io_x.h"
 #include "common/mm_proxy_io.h"
 #include "common/mm_text_io.h"
@@ -23,6 +24,122 @@
    Class for handling UTF-8/UTF-16/UTF-32 text files.
 */
 
+namespace {
+
+std::size_t const s_read_ahead_size = 64 * 1024;
+
+/* Determines the number of bytes at the start of [start, end) that
+   make up regular characters, meaning everything up to the first
+   carriage return or newline. Stops earlier if max_chars characters
+   have been read in total or if a UTF-8 sequence is cut off by the end
+   of the range; in the latter case min_bytes_needed is set to the
+   sequence's length.
+
+   Pure ASCII runs are checked eight bytes at a time. */
+std::size_t
+scan_regular_characters(unsigned char const *start,
+                        unsigned char const *end,
+                        bool is_utf8,
+                        boost::optional<std::size_t> const &max_chars,
+                        std::size_t &num_chars_read,
+                        std::size_t &min_bytes_needed) {
+  static uint64_t const s_ones       = 0x0101010101010101ull;
+  static uint64_t const s_high_bits  = 0x8080808080808080ull;
+  static uint64_t const s_all_cr     = s_ones * '\r';
+  static uint64_t const s_all_nl     = s_ones * '\n';
+  auto const non_ascii_mask          = is_utf8 ? s_high_bits : 0ull;
+
+  auto has_zero_byte = [](uint64_t word) {
+    return ((word - s_ones) & ~word & s_high_bits) != 0;
+  };
+
+  auto ptr = start;
+
+  while (ptr < end) {
+    while (   ((end - ptr) >= 8)
+           && (!max_chars || ((*max_chars - num_chars_read) >= 8))) {
+      uint64_t word;
+      std::memcpy(&word, ptr, 8);
+
+      if ((word & non_ascii_mask) || has_zero_byte(word ^ s_all_cr) || has_zero_byte(word ^ s_all_nl))
+        break;
+
+      ptr            += 8;
+      num_chars_read += 8;
+    }
+
+    if (ptr >= end)
+      break;
+
+    auto c = *ptr;
+
+    if (('\r' == c) || ('\n' == c))
+      break;
+
+    std::size_t size = 1;
+
+    if (is_utf8 && (c & 0x80)) {
+      size = ((c & 0xe0) == 0xc0) ?  2
+           : ((c & 0xf0) == 0xe0) ?  3
+           : ((c & 0xf8) == 0xf0) ?  4
+           : ((c & 0xfc) == 0xf8) ?  5
+           : ((c & 0xfe) == 0xfc) ?  6
+           :                        99;
+
+      if (99 == size)
+        throw mtx::mm_io::text::invalid_utf8_char_x(c);
+
+      if (static_cast<std::size_t>(end - ptr) < size) {
+        min_bytes_needed = size;
+        break;
+      }
+    }
+
+    ptr += size;
+    ++num_chars_read;
+
+    if (max_chars && (num_chars_read >= *max_chars))
+      break;
+  }
+
+  return ptr - start;
+}
+
+unsigned long
+decode_code_unit(unsigned char const *buffer,
+                 byte_order_e byte_order) {
+  return BO_UTF16_LE == byte_order ? get_uint16_le(buffer)
+       : BO_UTF16_BE == byte_order ? get_uint16_be(buffer)
+       : BO_UTF32_LE == byte_order ? get_uint32_le(buffer)
+       :                             get_uint32_be(buffer);
+}
+
+void
+append_as_utf8(std::string &destination,
+               unsigned long data) {
+  if (data < 0x80) {
+    destination += static_cast<char>(data);
+    return;
+  }
+
+  if (data < 0x800) {
+    destination += static_cast<char>(0xc0 | (data >> 6));
+    destination += static_cast<char>(0x80 | (data & 0x3f));
+    return;
+  }
+
+  if (data < 0x10000) {
+    destination += static_cast<char>(0xe0 |  (data >> 12));
+    destination += static_cast<char>(0x80 | ((data >> 6) & 0x3f));
+    destination += static_cast<char>(0x80 |  (data       & 0x3f));
+    return;
+  }
+
+  mxerror(Y("mm_text_io_c: UTF32_* is not supported at the moment.\n"));
+}
+
+}
+
 mm_text_io_private_c::mm_text_io_private_c(mm_io_cptr const &in)
   : mm_proxy_io_private_c{in}
 {
@@ -178,40 +295,15 @@ mm_text_io_c::read_next_codepoint() {
     return std::string{reinterpret_cast<char *>(buffer), size};
   }
 
-  size = ((BO_UTF16_LE == p->byte_order) || (BO_UTF16_BE == p->byte_order)) ? 2 : 4;
+  size = get_code_unit_size();
 
   if (read(buffer, size) != size)
     return {};
 
-  unsigned long data = 0;
-  auto little_endian = ((BO_UTF16_LE == p->byte_order) || (BO_UTF32_LE == p->byte_order));
-  auto shift         = little_endian ? 0 : 8 * (size - 1);
-  for (auto i = 0u; i < size; i++) {
-    data  |= static_cast<unsigned long>(buffer[i]) << shift;
-    shift += little_endian ? 8 : -8;
-  }
-
-  if (data < 0x80) {
-    buffer[0] = data;
-    return std::string{reinterpret_cast<char *>(buffer), 1};
-  }
-
-  if (data < 0x800) {
-    buffer[0] = 0xc0 | (data >> 6);
-    buffer[1] = 0x80 | (data & 0x3f);
-    return std::string{reinterpret_cast<char *>(buffer), 2};
-  }
-
-  if (data < 0x10000) {
-    buffer[0] = 0xe0 |  (data >> 12);
-    buffer[1] = 0x80 | ((data >> 6) & 0x3f);
-    buffer[2] = 0x80 |  (data       & 0x3f);
-    return std::string{reinterpret_cast<char *>(buffer), 3};
-  }
-
-  mxerror(Y("mm_text_io_c: UTF32_* is not supported at the moment.\n"));
+  std::string utf8char;
+  append_as_utf8(utf8char, decode_code_unit(buffer, p->byte_order));
 
-  return {};
+  return utf8char;
 }
 
 std::string
@@ -226,36 +318,65 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
 
   std::string s;
   bool previous_was_carriage_return = false;
-  std::size_t num_chars_read{};
+  std::size_t num_chars_read{}, min_bytes_needed{};
+  auto unit_size = get_code_unit_size();
+  auto is_utf8   = BO_UTF8 == p->byte_order;
 
   while (true) {
-    auto previous_pos = getFilePointer();
-    auto utf8char     = read_next_codepoint();
-    auto len          = utf8char.length();
+    auto bytes_needed = std::max(min_bytes_needed, unit_size);
+    auto available    = fill_buffer(bytes_needed);
 
-    if (0 == len)
+    if (available < bytes_needed) {
+      // Incomplete character at the end of the file.
+      p->buffer_offset += available;
       return s;
+    }
 
-    if ((1 == len) && (utf8char[0] == '\r')) {
-      if (previous_was_carriage_return && !p->uses_newlines) {
-        setFilePointer(previous_pos);
-        return s;
+    auto start       = &p->buffer[p->buffer_offset];
+    min_bytes_needed = 0;
+
+    unsigned long codepoint;
+
+    if (1 == unit_size) {
+      if (!previous_was_carriage_return) {
+        auto num_bytes = scan_regular_characters(start, start + available, is_utf8, max_chars, num_chars_read, min_bytes_needed);
+
+        s.append(reinterpret_cast<char const *>(start), num_bytes);
+        p->buffer_offset += num_bytes;
+
+        if (max_chars && (num_chars_read >= *max_chars))
+          return s;
+
+        if ((num_bytes == available) || min_bytes_needed)
+          continue;
+
+        start += num_bytes;
       }
 
-      previous_was_carriage_return = true;
+      codepoint = *start;
+
+    } else
+      codepoint = decode_code_unit(start, p->byte_order);
+
+    if ('\r' == codepoint) {
+      if (previous_was_carriage_return && !p->uses_newlines)
+        return s;
+
+      previous_was_carriage_return  = true;
+      p->buffer_offset             += unit_size;
       continue;
     }
 
-    if ((1 == len) && (utf8char[0] == '\n') && (!p->uses_carriage_returns || previous_was_carriage_return))
+    if (('\n' == codepoint) && (!p->uses_carriage_returns || previous_was_carriage_return)) {
+      p->buffer_offset += unit_size;
       return s;
+    }
 
-    if (previous_was_carriage_return) {
-      setFilePointer(previous_pos);
+    if (previous_was_carriage_return)
       return s;
-    }
 
-    previous_was_carriage_return  = false;
-    s                            += utf8char;
+    p->buffer_offset += unit_size;
+    append_as_utf8(s, codepoint);
     ++num_chars_read;
 
     if (max_chars && (num_chars_read >= *max_chars))
@@ -266,7 +387,147 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
 void
 mm_text_io_c::setFilePointer(int64 offset,
                              libebml::seek_mode mode) {
-  mm_proxy_io_c::setFilePointer(((0 == offset) && (libebml::seek_beginning == mode)) ? p_func()->bom_len : offset, mode);
+  auto p = p_func();
+
+  if ((0 == offset) && (libebml::seek_beginning == mode))
+    offset = p->bom_len;
+
+  if (!p->buffer.empty() && (libebml::seek_end != mode)) {
+    auto buffer_start = static_cast<int64_t>(p->buffer_start_pos);
+    auto new_pos      = libebml::seek_beginning == mode ? offset : buffer_start + static_cast<int64_t>(p->buffer_offset) + offset;
+
+    if ((new_pos >= buffer_start) && (new_pos <= (buffer_start + static_cast<int64_t>(p->buffer.size())))) {
+      p->buffer_offset = new_pos - buffer_start;
+      return;
+    }
+  }
+
+  discard_buffer();
+  mm_proxy_io_c::setFilePointer(offset, mode);
+}
+
+uint64
+mm_text_io_c::getFilePointer() {
+  auto p = p_func();
+
+  return p->buffer.empty() ? mm_proxy_io_c::getFilePointer() : p->buffer_start_pos + p->buffer_offset;
+}
+
+bool
+mm_text_io_c::eof() {
+  auto p = p_func();
+
+  return (p->buffer_offset >= p->buffer.size()) && mm_proxy_io_c::eof();
+}
+
+uint32
+mm_text_io_c::_read(void *buffer,
+                    size_t size) {
+  auto p           = p_func();
+  auto destination = static_cast<unsigned char *>(buffer);
+  auto num_copied  = std::size_t{};
+
+  while (num_copied < size) {
+    auto available = p->buffer.size() - p->buffer_offset;
+
+    if (!available) {
+      // Large reads bypass the buffer.
+      if ((size - num_copied) >= s_read_ahead_size) {
+        discard_buffer();
+        return num_copied + mm_proxy_io_c::_read(destination + num_copied, size - num_copied);
+      }
+
+      available = fill_buffer(1);
+      if (!available)
+        break;
+    }
+
+    auto to_copy = std::min(available, size - num_copied);
+    std::memcpy(destination + num_copied, &p->buffer[p->buffer_offset], to_copy);
+
+    p->buffer_offset += to_copy;
+    num_copied       += to_copy;
+  }
+
+  return num_copied;
+}
+
+size_t
+mm_text_io_c::_write(const void *buffer,
+                     size_t size) {
+  discard_buffer();
+  return mm_proxy_io_c::_write(buffer, size);
+}
+
+/** \brief Makes sure that at least \c min_available unread bytes are buffered
+
+   Reads from the proxied I/O in blocks. Returns the number of unread
+   bytes available, which is less than \c min_available only at the
+   end of the file.
+ */
+std::size_t
+mm_text_io_c::fill_buffer(std::size_t min_available) {
+  auto p         = p_func();
+  auto available = p->buffer.size() - p->buffer_offset;
+
+  if (available >= min_available)
+    return available;
+
+  if (p->buffer.empty())
+    p->buffer_start_pos = mm_proxy_io_c::getFilePointer();
+
+  else if (p->buffer_offset) {
+    p->buffer.erase(p->buffer.begin(), p->buffer.begin() + p->buffer_offset);
+    p->buffer_start_pos += p->buffer_offset;
+    p->buffer_offset     = 0;
+  }
+
+  while (available < min_available) {
+    auto old_size = p->buffer.size();
+
+    p->buffer.resize(old_size + s_read_ahead_size);
+    auto num_read = mm_proxy_io_c::_read(&p->buffer[old_size], s_read_ahead_size);
+    p->buffer.resize(old_size + num_read);
+
+    if (!num_read)
+      break;
+
+    available += num_read;
+  }
+
+  return available;
+}
+
+/** \brief Drops all buffered data
+
+   Positions the proxied I/O at the current logical position
+   afterwards.
+ */
+void
+mm_text_io_c::discard_buffer() {
+  auto p = p_func();
+
+  if (p->buffer.empty())
+    return;
+
+  auto pos    = p->buffer_start_pos + p->buffer_offset;
+  auto at_end = p->buffer_offset == p->buffer.size();
+
+  p->buffer.clear();
+  p->buffer_offset = 0;
+
+  if (!at_end)
+    mm_proxy_io_c::setFilePointer(pos);
+}
+
+std::size_t
+mm_text_io_c::get_code_unit_size()
+  const {
+  auto byte_order = p_func()->byte_order;
+
+  return (BO_UTF16_LE == byte_order) || (BO_UTF16_BE == byte_order) ? 2
+       : (BO_UTF32_LE == byte_order) || (BO_UTF32_BE == byte_order) ? 4
+       :                                                              1;
 }
 
 byte_order_e
@@ -15,6 +15,8 @@
 
 #include "common/common_pch.h"
 
+#include "common/mm_proxy_io.h"
+
 class mm_text_io_private_c;
 class mm_text_io_c: public mm_proxy_io_c {
 protected:
@@ -26,6 +28,8 @@ public:
   mm_text_io_c(mm_io_cptr const &in);
 
   virtual void setFilePointer(int64 offset, libebml::seek_mode mode=libebml::seek_beginning);
+  virtual uint64 getFilePointer();
+  virtual bool eof();
   virtual std::string getline(boost::optional<std::size_t> max_chars = boost::none);
   virtual std::string read_next_codepoint();
   virtual byte_order_e get_byte_order() const;
@@ -35,6 +39,12 @@ public:
 
 protected:
   virtual void detect_eol_style();
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  std::size_t fill_buffer(std::size_t min_available);
+  void discard_buffer();
+  std::size_t get_code_unit_size() const;
 
 public:
   static bool has_byte_order_marker(const std::string &string);
@@ -23,5 +23,12 @@ public:
   unsigned int bom_len{};
   bool uses_carriage_returns{}, uses_newlines{}, eol_style_detected{};
 
+  // Raw bytes read ahead from the proxied I/O. As long as the buffer
+  // isn't empty the proxied I/O is positioned right after its last
+  // byte, and the logical position is buffer_start_pos + buffer_offset.
+  std::vector<unsigned char> buffer;
+  std::size_t buffer_offset{};
+  uint64_t buffer_start_pos{};
+
   explicit mm_text_io_private_c(mm_io_cptr const &in);
 };
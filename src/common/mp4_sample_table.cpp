@@ -0,0 +1,120 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   MP4 sample tables & iterating over the samples described by them
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mp4_sample_table.h"
+
+namespace mtx { namespace mp4 {
+
+sample_cursor_c::sample_cursor_c(std::vector<qt_chunk_t> const &chunks,
+                                 std::vector<uint32_t> const &sample_sizes,
+                                 uint32_t uniform_sample_size,
+                                 std::vector<qt_durmap_t> const &durations,
+                                 std::vector<qt_frame_offset_t> const &frame_offsets)
+  : m_chunks(chunks)
+  , m_sample_sizes(sample_sizes)
+  , m_durations(durations)
+  , m_frame_offsets(frame_offsets)
+  , m_uniform_sample_size{uniform_sample_size}
+{
+  if (!m_sample_sizes.empty())
+    m_num_samples_in_size_table = m_sample_sizes.size();
+
+  else
+    for (auto const &chunk : m_chunks)
+      m_num_samples_in_size_table += chunk.size;
+
+  for (auto const &duration : m_durations)
+    m_num_samples_in_duration_table += duration.number;
+
+  m_num_samples = std::min(m_num_samples_in_size_table, m_num_samples_in_duration_table);
+
+  if (!m_chunks.empty())
+    m_position = m_chunks[0].pos;
+}
+
+uint64_t
+sample_cursor_c::get_num_samples()
+  const {
+  return m_num_samples;
+}
+
+uint64_t
+sample_cursor_c::get_num_samples_in_size_table()
+  const {
+  return m_num_samples_in_size_table;
+}
+
+uint64_t
+sample_cursor_c::get_num_samples_in_duration_table()
+  const {
+  return m_num_samples_in_duration_table;
+}
+
+bool
+sample_cursor_c::get_next(sample_t &sample) {
+  if (m_sample >= m_num_samples)
+    return false;
+
+  // Position: continues within the current chunk, starts at the next
+  // non-empty chunk's offset otherwise.
+  while ((m_chunk_idx < m_chunks.size()) && (m_sample_in_chunk >= m_chunks[m_chunk_idx].size)) {
+    ++m_chunk_idx;
+    m_sample_in_chunk = 0;
+
+    if (m_chunk_idx < m_chunks.size())
+      m_position = m_chunks[m_chunk_idx].pos;
+  }
+
+  sample.size = m_sample_sizes.empty() ? m_uniform_sample_size : m_sample_sizes[m_sample];
+
+  if (m_chunk_idx < m_chunks.size()) {
+    sample.position    = m_position;
+    m_position        += sample.size;
+    ++m_sample_in_chunk;
+
+  } else
+    sample.position = 0;
+
+  // Duration: the number of samples is limited by the duration table;
+  // therefore the current run always exists.
+  while (m_sample_in_duration >= m_durations[m_duration_idx].number) {
+    ++m_duration_idx;
+    m_sample_in_duration = 0;
+  }
+
+  sample.duration      = m_durations[m_duration_idx].duration;
+  sample.decoding_time = m_decoding_time;
+  m_decoding_time     += sample.duration;
+  ++m_sample_in_duration;
+
+  // Composition time offset
+  while ((m_frame_offset_idx < m_frame_offsets.size()) && (m_sample_in_frame_offset >= m_frame_offsets[m_frame_offset_idx].count)) {
+    ++m_frame_offset_idx;
+    m_sample_in_frame_offset = 0;
+  }
+
+  if (m_frame_offset_idx < m_frame_offsets.size()) {
+    sample.composition_offset = m_frame_offsets[m_frame_offset_idx].offset;
+    ++m_sample_in_frame_offset;
+
+  } else
+    sample.composition_offset = 0;
+
+  ++m_sample;
+
+  return true;
+}
+
+}}
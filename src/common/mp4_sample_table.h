@@ -0,0 +1,133 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   MP4 sample tables & iterating over the samples described by them
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+// One run of the 'stts' atom: 'number' samples with the same duration.
+struct qt_durmap_t {
+  uint32_t number;
+  uint32_t duration;
+
+  qt_durmap_t()
+    : number{}
+    , duration{}
+  {
+  }
+
+  qt_durmap_t(uint32_t p_number, uint32_t p_duration)
+    : number{p_number}
+    , duration{p_duration}
+  {
+  }
+};
+
+// One chunk from the 'stco'/'co64' atoms. 'size' is the number of
+// samples in the chunk and 'samples' the number of the chunk's first
+// sample.
+struct qt_chunk_t {
+  uint32_t samples;
+  uint32_t size;
+  uint32_t desc;
+  uint64_t pos;
+
+  qt_chunk_t()
+    : samples{}
+    , size{}
+    , desc{}
+    , pos{}
+  {
+  }
+
+  qt_chunk_t(uint32_t p_size, uint64_t p_pos)
+    : samples{}
+    , size{p_size}
+    , desc{}
+    , pos{p_pos}
+  {
+  }
+};
+
+// One run of the 'ctts' atom: 'count' samples with the same
+// composition time offset.
+struct qt_frame_offset_t {
+  unsigned int count;
+  int64_t offset;
+
+  qt_frame_offset_t()
+    : count{}
+    , offset{}
+  {
+  }
+
+  qt_frame_offset_t(unsigned int p_count, int64_t p_offset)
+    : count{p_count}
+    , offset{p_offset}
+  {
+  }
+};
+
+namespace mtx { namespace mp4 {
+
+struct sample_t {
+  uint64_t position{};
+  uint32_t size{}, duration{};
+  int64_t decoding_time{}, composition_offset{};
+};
+
+/* Iterates over the samples of a track in decoding order. The
+   position, size and timing of each sample are calculated on the fly
+   from the run-length encoded tables the way they're stored in the
+   file instead of expanding them into one entry per sample first:
+
+   - 'chunks': the chunk offsets with the number of samples per chunk
+     already set from the 'stsc' atom,
+   - 'sample_sizes': the 'stsz' entries; if it is empty, each sample is
+     'uniform_sample_size' bytes big,
+   - 'durations': the 'stts' runs and
+   - 'frame_offsets': the 'ctts' runs.
+
+   The number of samples is limited by the sample size and the
+   duration tables. Samples not covered by the chunk table are
+   reported at position 0; samples not covered by the composition time
+   offset table have an offset of 0.
+
+   The cursor only references the tables; they must outlive it and must
+   not be modified while it is used. */
+class sample_cursor_c {
+protected:
+  std::vector<qt_chunk_t> const &m_chunks;
+  std::vector<uint32_t> const &m_sample_sizes;
+  std::vector<qt_durmap_t> const &m_durations;
+  std::vector<qt_frame_offset_t> const &m_frame_offsets;
+  uint32_t m_uniform_sample_size;
+  uint64_t m_num_samples{}, m_num_samples_in_size_table{}, m_num_samples_in_duration_table{};
+
+  uint64_t m_sample{}, m_position{};
+  int64_t m_decoding_time{};
+  std::size_t m_chunk_idx{}, m_duration_idx{}, m_frame_offset_idx{};
+  uint32_t m_sample_in_chunk{}, m_sample_in_duration{}, m_sample_in_frame_offset{};
+
+public:
+  sample_cursor_c(std::vector<qt_chunk_t> const &chunks, std::vector<uint32_t> const &sample_sizes, uint32_t uniform_sample_size, std::vector<qt_durmap_t> const &durations,
+                  std::vector<qt_frame_offset_t> const &frame_offsets);
+
+  uint64_t get_num_samples() const;
+  uint64_t get_num_samples_in_size_table() const;
+  uint64_t get_num_samples_in_duration_table() const;
+
+  bool get_next(sample_t &sample);
+};
+
+}}
@@ -14,63 +14,118 @@
 
 #include "common/debugging.h"
 #include "common/endian.h"
-#include "common/mm_mem_io.h"
 #include "common/mpeg.h"
 
 namespace mtx { namespace mpeg {
 
-memory_cptr
-nalu_to_rbsp(memory_cptr const &buffer) {
-  mm_mem_io_cptr d;
-  auto b = buffer->get_buffer();
-
-  for (int pos = 0, size = buffer->get_size(); pos < size; ++pos) {
-    if (   ((pos + 2) < size)
-        && (0 == b[pos])
-        && (0 == b[pos + 1])
-        && (3 == b[pos + 2])) {
-
-      if (!d) {
-        d = std::make_shared<mm_mem_io_c>(nullptr, size, 100);
-        if (pos > 0)
-          d->write(b, pos);
-      }
-
-      d->write_uint8(0);
-      d->write_uint8(0);
+namespace {
+
+/* Finds the next position at or after 'pos' at which two zero bytes
+   are followed by a byte in the range [min_third, max_third]. Returns
+   'size' if there is no such position.
+
+   Eight bytes are examined at a time; only words containing a zero
+   byte are looked at in detail. */
+std::size_t
+find_zero_zero_x(unsigned char const *buffer,
+                 std::size_t pos,
+                 std::size_t size,
+                 unsigned char min_third,
+                 unsigned char max_third) {
+  static uint64_t const s_ones      = 0x0101010101010101ull;
+  static uint64_t const s_high_bits = 0x8080808080808080ull;
+
+  while ((pos + 2) < size) {
+    while ((pos + 8) <= size) {
+      uint64_t word;
+      std::memcpy(&word, &buffer[pos], 8);
+
+      if ((word - s_ones) & ~word & s_high_bits)
+        break;
+
+      pos += 8;
+    }
+
+    if ((pos + 2) >= size)
+      break;
+
+    if (buffer[pos + 1])
       pos += 2;
 
-    } else if (d)
-      d->write_uint8(b[pos]);
+    else if (buffer[pos])
+      pos += 1;
+
+    else if ((buffer[pos + 2] >= min_third) && (buffer[pos + 2] <= max_third))
+      return pos;
+
+    else
+      pos += 1;
   }
 
-  if (!d)
+  return size;
+}
+
+}
+
+/** \brief Removes the emulation prevention bytes from a NALU
+
+   Returns the source buffer itself if it doesn't contain any.
+ */
+memory_cptr
+nalu_to_rbsp(memory_cptr const &buffer) {
+  auto src  = buffer->get_buffer();
+  auto size = buffer->get_size();
+  auto pos  = find_zero_zero_x(src, 0, size, 3, 3);
+
+  if (pos == size)
     return buffer;
 
-  return d->get_and_lock_buffer();
+  auto rbsp      = memory_c::alloc(size);
+  auto dst       = rbsp->get_buffer();
+  auto dst_size  = std::size_t{};
+  auto run_start = std::size_t{};
+
+  while (pos < size) {
+    // Copy everything up to and including the two zero bytes, skip the 0x03.
+    std::memcpy(&dst[dst_size], &src[run_start], pos + 2 - run_start);
+    dst_size  += pos + 2 - run_start;
+    run_start  = pos + 3;
+    pos        = find_zero_zero_x(src, run_start, size, 3, 3);
+  }
+
+  std::memcpy(&dst[dst_size], &src[run_start], size - run_start);
+  rbsp->set_size(dst_size + size - run_start);
+
+  return rbsp;
 }
 
+/** \brief Inserts emulation prevention bytes into an RBSP
+
+   Always returns a new buffer.
+ */
 memory_cptr
 rbsp_to_nalu(memory_cptr const &buffer) {
-  int pos, size = buffer->get_size();
-  mm_mem_io_c d(nullptr, size, 100);
-  unsigned char *b = buffer->get_buffer();
-
-  for (pos = 0; pos < size; ++pos) {
-    if (   ((pos + 2) < size)
-        && (0 == b[pos])
-        && (0 == b[pos + 1])
-        && (3 >= b[pos + 2])) {
-      d.write_uint8(0);
-      d.write_uint8(0);
-      d.write_uint8(3);
-      ++pos;
-
-    } else
-      d.write_uint8(b[pos]);
+  auto src       = buffer->get_buffer();
+  auto size      = buffer->get_size();
+  // At most one byte is inserted for every two source bytes.
+  auto nalu      = memory_c::alloc(size + size / 2 + 1);
+  auto dst       = nalu->get_buffer();
+  auto dst_size  = std::size_t{};
+  auto run_start = std::size_t{};
+  auto pos       = find_zero_zero_x(src, 0, size, 0, 3);
+
+  while (pos < size) {
+    std::memcpy(&dst[dst_size], &src[run_start], pos + 2 - run_start);
+    dst_size        += pos + 2 - run_start;
+    dst[dst_size++]  = 0x03;
+    run_start        = pos + 2;
+    pos              = find_zero_zero_x(src, run_start, size, 0, 3);
   }
 
-  return d.get_and_lock_buffer();
+  std::memcpy(&dst[dst_size], &src[run_start], size - run_start);
+  nalu->set_size(dst_size + size - run_start);
+
+  return nalu;
 }
 
 void
@@ -89,6 +144,78 @@ write_nalu_size(unsigned char *buffer,
   put_uint_be(buffer, size, nalu_size_length);
 }
 
+/** \brief Shortens the NALU size fields of a frame
+
+   The NALUs are moved towards the start of the buffer as required.
+   Any trailing bytes too short for a size field are dropped. Throws
+   nalu_size_length_x if a NALU is too big for the new field length.
+ */
+void
+change_nalu_size_length_in_place(memory_c &buffer,
+                                 std::size_t src_length,
+                                 std::size_t dst_length) {
+  assert(dst_length <= src_length);
+
+  auto ptr     = buffer.get_buffer();
+  auto size    = buffer.get_size();
+  auto src_pos = std::size_t{};
+  auto dst_pos = std::size_t{};
+
+  while ((src_pos + src_length) <= size) {
+    auto nalu_size = std::min<std::size_t>(get_uint_be(&ptr[src_pos], src_length), size - src_pos - src_length);
+
+    // The new size field ends before the NALU's content starts.
+    write_nalu_size(&ptr[dst_pos], nalu_size, dst_length);
+
+    std::memmove(&ptr[dst_pos + dst_length], &ptr[src_pos + src_length], nalu_size);
+
+    src_pos += src_length + nalu_size;
+    dst_pos += dst_length + nalu_size;
+  }
+
+  buffer.set_size(dst_pos);
+}
+
+/** \brief Lengthens the NALU size fields of a frame
+
+   Copies the NALUs into a newly allocated buffer with the longer size
+   fields. Only the size fields are read for determining the new
+   buffer's size; the NALUs' content is copied exactly once. Any
+   trailing bytes too short for a size field are dropped.
+ */
+memory_cptr
+change_nalu_size_length_copy(memory_c const &buffer,
+                             std::size_t src_length,
+                             std::size_t dst_length) {
+  assert(dst_length >= src_length);
+
+  auto src       = buffer.get_buffer();
+  auto size      = buffer.get_size();
+  auto num_nalus = std::size_t{};
+
+  for (auto pos = std::size_t{}; (pos + src_length) <= size; ++num_nalus)
+    pos += src_length + get_uint_be(&src[pos], src_length);
+
+  auto dst_buffer = memory_c::alloc(size + num_nalus * (dst_length - src_length));
+  auto dst        = dst_buffer->get_buffer();
+  auto src_pos    = std::size_t{};
+  auto dst_pos    = std::size_t{};
+
+  for (auto idx = std::size_t{}; idx < num_nalus; ++idx) {
+    auto nalu_size = std::min<std::size_t>(get_uint_be(&src[src_pos], src_length), size - src_pos - src_length);
+
+    write_nalu_size(&dst[dst_pos], nalu_size, dst_length);
+    std::memcpy(&dst[dst_pos + dst_length], &src[src_pos + src_length], nalu_size);
+
+    src_pos += src_length + nalu_size;
+    dst_pos += dst_length + nalu_size;
+  }
+
+  dst_buffer->set_size(dst_pos);
+
+  return dst_buffer;
+}
+
 memory_cptr
 create_nalu_with_size(memory_cptr const &src,
                       std::size_t nalu_size_length,
@@ -44,6 +44,8 @@ memory_cptr nalu_to_rbsp(memory_cptr const &buffer);
 memory_cptr rbsp_to_nalu(memory_cptr const &buffer);
 
 void write_nalu_size(unsigned char *buffer, std::size_t size, std::size_t nalu_size_length, bool ignore_nalu_size_length_errors = false);
+void change_nalu_size_length_in_place(memory_c &buffer, std::size_t src_length, std::size_t dst_length);
+memory_cptr change_nalu_size_length_copy(memory_c const &buffer, std::size_t src_length, std::size_t dst_length);
 memory_cptr create_nalu_with_size(memory_cptr const &src, std::size_t nalu_size_length, std::vector<memory_cptr> extra_data);
 
 void remove_trailing_zero_bytes(memory_c &buffer);
@@ -23,6 +23,7 @@
 #include "common/endian.h"
 #include "common/fs_sys_helpers.h"
 #include "common/json.h"
+#include "common/json_writer.h"
 #include "common/locale.h"
 #include "common/logger.h"
 #include "common/mm_io.h"
@@ -59,6 +60,31 @@ display_json_output(nlohmann::json json) {
   mxinfo(fmt::format("{0}\n", mtx::json::dump(json, 2)));
 }
 
+/** \brief Outputs a JSON object without building it in memory first
+
+   Each member's value is written by its function directly to the
+   output. The warnings and errors emitted so far are added.
+ */
+void
+display_json_output(json_member_writers_t members) {
+  members["warnings"] = [](mtx::json::writer_c &writer) { writer.value(to_json_array(s_warnings_emitted)); };
+  members["errors"]   = [](mtx::json::writer_c &writer) { writer.value(to_json_array(s_errors_emitted)); };
+
+  mtx::json::writer_c writer{[](std::string const &chunk) { mxinfo(chunk); }};
+
+  writer.start_object();
+
+  for (auto const &member : members) {
+    writer.key(member.first);
+    member.second(writer);
+  }
+
+  writer.end_object();
+  writer.flush();
+
+  mxinfo("\n");
+}
+
 static void
 json_warning_error_handler(unsigned int level,
                            std::string const &message) {
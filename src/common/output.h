@@ -34,8 +34,16 @@ extern std::shared_ptr<mm_io_c> g_mm_stdio;
 void redirect_stdio(const mm_io_cptr &new_stdio);
 bool stdio_redirected();
 
+namespace mtx { namespace json {
+class writer_c;
+}}
+
+// Members of the top-level object; they're written sorted by their keys.
+using json_member_writers_t = std::map<std::string, std::function<void(mtx::json::writer_c &)>>;
+
 void redirect_warnings_and_errors_to_json();
 void display_json_output(nlohmann::json json);
+void display_json_output(json_member_writers_t members);
 
 void init_common_output(bool no_charset_detection);
 void set_cc_stdio(const std::string &charset);
@@ -0,0 +1,221 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   hot path instrumentation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/json_writer.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "common/tracing.h"
+
+namespace mtx { namespace tracing {
+
+namespace {
+
+struct event_t {
+  stage_c *stage;
+  int64_t start_ns, duration_ns;
+};
+
+// Roughly 100 MB of events; anything beyond that is only counted.
+std::size_t const s_max_num_events = 4 * 1024 * 1024;
+
+debugging_option_c s_debug{"tracing"};
+std::map<std::string, std::unique_ptr<stage_c>> s_stages;
+scope_c *s_current_scope{};
+boost::optional<std::string> s_trace_file_name;
+std::vector<event_t> s_events;
+int64_t s_num_dropped_events{};
+
+int64_t
+now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t const s_start_ns = now_ns();
+
+std::string const &
+trace_file_name() {
+  if (!s_trace_file_name) {
+    std::string file_name;
+    debugging_c::requested("tracing", &file_name);
+    s_trace_file_name = file_name;
+  }
+
+  return *s_trace_file_name;
+}
+
+void
+record_event(stage_c &stage,
+             int64_t start_ns,
+             int64_t duration_ns) {
+  if (trace_file_name().empty())
+    return;
+
+  if (s_events.size() < s_max_num_events)
+    s_events.push_back({ &stage, start_ns, duration_ns });
+  else
+    ++s_num_dropped_events;
+}
+
+double
+to_ms(int64_t ns) {
+  return static_cast<double>(ns) / 1000000.0;
+}
+
+void
+write_summary() {
+  std::vector<stage_c *> stages;
+  std::size_t name_width = 5;
+
+  for (auto const &pair : s_stages) {
+    stages.push_back(pair.second.get());
+    name_width = std::max(name_width, pair.first.size());
+  }
+
+  std::sort(stages.begin(), stages.end(), [](stage_c *a, stage_c *b) { return a->m_self_ns > b->m_self_ns; });
+
+  auto summary = fmt::format("tracing: summary after {0:.1f} ms\n", to_ms(now_ns() - s_start_ns));
+  summary     += fmt::format("  {0:<{1}} {2:>10} {3:>12} {4:>12} {5:>10} {6:>14} {7:>10}\n", "stage", name_width, "calls", "total ms", "self ms", "packets", "bytes", "MiB/s");
+
+  for (auto const &stage : stages) {
+    auto mib_per_second = stage->m_total_ns ? (static_cast<double>(stage->m_num_bytes) / 1024.0 / 1024.0) / (static_cast<double>(stage->m_total_ns) / 1000000000.0) : 0.0;
+
+    summary += fmt::format("  {0:<{1}} {2:>10} {3:>12.3f} {4:>12.3f} {5:>10} {6:>14} {7:>10.1f}\n",
+                           stage->m_name, name_width, stage->m_num_calls, to_ms(stage->m_total_ns), to_ms(stage->m_self_ns), stage->m_num_packets, stage->m_num_bytes, mib_per_second);
+  }
+
+  debugging_c::output(summary);
+}
+
+void
+write_trace_events() {
+  auto const &file_name = trace_file_name();
+
+  if (file_name.empty())
+    return;
+
+  try {
+    mm_file_io_c out{file_name, MODE_CREATE};
+    mtx::json::writer_c writer{[&out](std::string const &chunk) { out.write(chunk); }, -1};
+
+    writer.start_object()
+      .member("displayTimeUnit", "ms")
+      .member("otherData", nlohmann::json{ { "dropped_events", s_num_dropped_events } })
+      .key("traceEvents")
+      .start_array();
+
+    for (auto const &event : s_events)
+      writer.start_object()
+        .member("cat",  "mkvmerge")
+        .member("dur",  nlohmann::json(static_cast<double>(event.duration_ns) / 1000.0))
+        .member("name", event.stage->m_name)
+        .member("ph",   "X")
+        .member("pid",  1)
+        .member("tid",  1)
+        .member("ts",   nlohmann::json(static_cast<double>(event.start_ns - s_start_ns) / 1000.0))
+        .end_object();
+
+    writer.end_array().end_object().flush();
+
+    debugging_c::output(fmt::format("tracing: wrote {0} events ({1} dropped) to {2}\n", s_events.size(), s_num_dropped_events, file_name));
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxwarn(fmt::format(Y("The file '{0}' could not be opened for writing: {1}.\n"), file_name, ex.what()));
+  }
+}
+
+}
+
+stage_c::stage_c(std::string const &name)
+  : m_name{name}
+{
+}
+
+bool
+is_enabled() {
+  return s_debug;
+}
+
+stage_c &
+get_stage(std::string const &name) {
+  auto &stage = s_stages[name];
+  if (!stage)
+    stage.reset(new stage_c{name});
+
+  return *stage;
+}
+
+scope_c::scope_c(stage_c &stage)
+  : scope_c{&stage}
+{
+}
+
+scope_c::scope_c(stage_c *stage)
+{
+  if (!stage || !is_enabled())
+    return;
+
+  m_stage         = stage;
+  m_parent        = s_current_scope;
+  s_current_scope = this;
+  m_start_ns      = now_ns();
+}
+
+scope_c::~scope_c() {
+  if (!m_stage)
+    return;
+
+  auto duration_ns = now_ns() - m_start_ns;
+
+  m_stage->m_num_calls++;
+  m_stage->m_total_ns += duration_ns;
+  m_stage->m_self_ns  += duration_ns - m_children_ns;
+
+  if (m_parent)
+    m_parent->m_children_ns += duration_ns;
+
+  s_current_scope = m_parent;
+
+  record_event(*m_stage, m_start_ns, duration_ns);
+}
+
+void
+scope_c::add_bytes(int64_t num_bytes) {
+  if (m_stage)
+    m_stage->m_num_bytes += num_bytes;
+}
+
+void
+scope_c::add_packets(int64_t num_packets) {
+  if (m_stage)
+    m_stage->m_num_packets += num_packets;
+}
+
+/** \brief Outputs the per-stage summary and writes the trace file
+
+   Does nothing unless tracing has been enabled. Can be called more
+   than once; each call reports the totals accumulated so far.
+ */
+void
+report() {
+  if (!is_enabled() || s_stages.empty())
+    return;
+
+  write_summary();
+  write_trace_events();
+}
+
+}}
@@ -0,0 +1,63 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   hot path instrumentation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+namespace mtx { namespace tracing {
+
+/* Scoped timers & counters for the hot paths of the muxing loop.
+
+   Everything is disabled unless the debugging option "tracing" is
+   given (e.g. "--debug tracing"). In that case the time spent in each
+   stage as well as the number of bytes and packets passing through it
+   are accumulated and reported by report(). Scopes may be nested; the
+   time spent in nested scopes is subtracted from the parent's "self"
+   time.
+
+   With "--debug tracing=file.json" each scope is additionally recorded
+   as an event and written to that file in Chrome's trace event format
+   (viewable with chrome://tracing or Perfetto).
+
+   Stages must only be used from the muxing thread. */
+
+class stage_c {
+public:
+  std::string const m_name;
+  int64_t m_num_calls{}, m_total_ns{}, m_self_ns{}, m_num_bytes{}, m_num_packets{};
+
+  explicit stage_c(std::string const &name);
+};
+
+bool is_enabled();
+stage_c &get_stage(std::string const &name);
+
+class scope_c {
+private:
+  stage_c *m_stage{};
+  scope_c *m_parent{};
+  int64_t m_start_ns{}, m_children_ns{};
+
+public:
+  explicit scope_c(stage_c &stage);
+  explicit scope_c(stage_c *stage);
+  ~scope_c();
+
+  void add_bytes(int64_t num_bytes);
+  void add_packets(int64_t num_packets = 1);
+};
+
+void report();
+
+}}
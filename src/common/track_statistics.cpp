@@ -12,6 +12,7 @@
 #include "common/common_pch.h"
 
 #include "common/date_time.h"
+#include "common/math.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
 #include "common/track_statistics.h"
@@ -49,3 +50,146 @@ track_statistics_c::create_tags(KaxTags &tags,
 
   mtx::tags::set_simple(*tag, "_STATISTICS_TAGS", "BPS DURATION NUMBER_OF_FRAMES NUMBER_OF_BYTES");
 }
+
+detailed_track_statistics_c::detailed_track_statistics_c(std::vector<int64_t> const &window_lengths)
+  : m_block_size_buckets(ms_num_block_size_buckets, 0)
+{
+  for (auto length : window_lengths) {
+    m_windows.emplace_back();
+    m_windows.back().length = length;
+  }
+}
+
+unsigned int
+detailed_track_statistics_c::block_size_bucket(uint64_t num_bytes) {
+  return mtx::math::int_log2(num_bytes) + 1;
+}
+
+void
+detailed_track_statistics_c::account(int64_t timestamp,
+                                     int64_t duration,
+                                     uint64_t num_bytes,
+                                     bool key_frame) {
+  ++m_num_frames;
+  m_num_bytes += num_bytes;
+
+  if (!m_min_timestamp)
+    m_min_timestamp = timestamp;
+
+  m_max_timestamp              = std::max(timestamp,            m_max_timestamp              ? *m_max_timestamp              : std::numeric_limits<int64_t>::min());
+  m_max_timestamp_and_duration = std::max(timestamp + duration, m_max_timestamp_and_duration ? *m_max_timestamp_and_duration : std::numeric_limits<int64_t>::min());
+
+  // Frames are accounted in storage order. B frames may therefore
+  // have timestamps before the first frame's one; they're counted in
+  // the first second. Only seconds containing frames are stored so that
+  // large gaps between timestamps don't cost any memory.
+  auto second = static_cast<uint64_t>(std::max<int64_t>(timestamp - *m_min_timestamp, 0) / 1000000000ll);
+  m_bytes_per_second[second] += num_bytes;
+
+  ++m_block_size_buckets[block_size_bucket(num_bytes)];
+
+  account_sliding_windows(timestamp, num_bytes);
+
+  if (key_frame)
+    account_key_frame(timestamp);
+
+  ++m_num_frames_since_key_frame;
+}
+
+void
+detailed_track_statistics_c::account_sliding_windows(int64_t timestamp,
+                                                     uint64_t num_bytes) {
+  for (auto &window : m_windows) {
+    window.frames.emplace_back(timestamp, num_bytes);
+    window.num_bytes += num_bytes;
+
+    auto window_start = *m_max_timestamp - window.length;
+
+    while (!window.frames.empty() && (window.frames.front().first <= window_start)) {
+      window.num_bytes -= window.frames.front().second;
+      window.frames.pop_front();
+    }
+
+    if (window.num_bytes <= window.peak_num_bytes)
+      continue;
+
+    window.peak_num_bytes = window.num_bytes;
+    window.peak_start     = std::max(window_start, *m_min_timestamp);
+  }
+}
+
+void
+detailed_track_statistics_c::account_key_frame(int64_t timestamp) {
+  ++m_num_key_frames;
+
+  if (m_previous_key_frame_timestamp) {
+    auto interval = timestamp - *m_previous_key_frame_timestamp;
+
+    m_min_key_frame_interval  = m_num_key_frame_intervals ? std::min(m_min_key_frame_interval, interval) : interval;
+    m_max_key_frame_interval  = m_num_key_frame_intervals ? std::max(m_max_key_frame_interval, interval) : interval;
+    m_key_frame_interval_sum += interval;
+    ++m_num_key_frame_intervals;
+
+    ++m_key_frame_distances[m_num_frames_since_key_frame];
+  }
+
+  m_previous_key_frame_timestamp = timestamp;
+  m_num_frames_since_key_frame   = 0;
+}
+
+nlohmann::json
+detailed_track_statistics_c::to_json()
+  const {
+  auto duration = m_min_timestamp ? *m_max_timestamp_and_duration - *m_min_timestamp : 0;
+
+  auto bits_per_second = nlohmann::json::array();
+  for (auto const &second : m_bytes_per_second)
+    bits_per_second.push_back(nlohmann::json{
+      { "second", second.first       },
+      { "bits",   second.second * 8 },
+    });
+
+  auto peak_bits_per_second = nlohmann::json::array();
+  for (auto const &window : m_windows)
+    peak_bits_per_second.push_back(nlohmann::json{
+      { "window_length",   window.length                                                                },
+      { "bits_per_second", static_cast<uint64_t>(window.peak_num_bytes * 8 * 1000000000.0 / window.length) },
+      { "start_timestamp", window.peak_start                                                            },
+    });
+
+  auto key_frame_distances = nlohmann::json::array();
+  for (auto const &distance : m_key_frame_distances)
+    key_frame_distances.push_back(nlohmann::json{
+      { "frames", distance.first  },
+      { "count",  distance.second },
+    });
+
+  auto block_sizes = nlohmann::json::array();
+  for (auto bucket = 0u; bucket < ms_num_block_size_buckets; ++bucket) {
+    if (!m_block_size_buckets[bucket])
+      continue;
+
+    block_sizes.push_back(nlohmann::json{
+      { "min_size", !bucket ? 0 : 1ull << (bucket - 1)                                     },
+      { "max_size", !bucket ? 0 : bucket == 64 ? std::numeric_limits<uint64_t>::max() : (1ull << bucket) - 1 },
+      { "count",    m_block_size_buckets[bucket]                                          },
+    });
+  }
+
+  return nlohmann::json{
+    { "num_frames",              m_num_frames                                                                      },
+    { "num_bytes",               m_num_bytes                                                                       },
+    { "duration",                duration                                                                          },
+    { "average_bits_per_second", duration > 0 ? static_cast<uint64_t>(m_num_bytes * 8 * 1000000000.0 / duration) : 0 },
+    { "bits_per_second",         bits_per_second                                                                   },
+    { "peak_bits_per_second",    peak_bits_per_second                                                              },
+    { "block_sizes",             block_sizes                                                                       },
+    { "key_frames", {
+        { "count",            m_num_key_frames                                                                     },
+        { "min_interval",     m_min_key_frame_interval                                                             },
+        { "max_interval",     m_max_key_frame_interval                                                             },
+        { "average_interval", m_num_key_frame_intervals ? m_key_frame_interval_sum / m_num_key_frame_intervals : 0 },
+        { "distances",        key_frame_distances                                                                  },
+      } },
+  };
+}
@@ -18,6 +18,8 @@
 
 #include <boost/date_time/posix_time/ptime.hpp>
 
+#include "common/json.h"
+
 namespace libmatroska {
 class KaxTags;
 }
@@ -88,3 +90,46 @@ public:
 
   void create_tags(libmatroska::KaxTags &tags, std::string const &writing_app, boost::optional<boost::posix_time::ptime> writing_date) const;
 };
+
+/* Detailed statistics collected over the whole multiplexing run:
+   bytes per second of play time, peak bitrates over sliding windows,
+   the distribution of key frame intervals and a histogram of block
+   sizes. All of them are updated incrementally for each block
+   rendered so that no second pass over the data is needed. */
+class detailed_track_statistics_c {
+public:
+  // Block sizes are put into buckets by powers of two: bucket 0
+  // counts empty blocks, bucket n blocks of 2^(n-1) to 2^n - 1
+  // bytes.
+  static unsigned int const ms_num_block_size_buckets = 65;
+
+private:
+  struct sliding_window_t {
+    int64_t length{};
+    std::deque<std::pair<int64_t, uint64_t>> frames;
+    uint64_t num_bytes{}, peak_num_bytes{};
+    int64_t peak_start{};
+  };
+
+  boost::optional<int64_t> m_min_timestamp, m_max_timestamp, m_max_timestamp_and_duration, m_previous_key_frame_timestamp;
+  uint64_t m_num_bytes{}, m_num_frames{}, m_num_key_frames{}, m_num_frames_since_key_frame{};
+  int64_t m_min_key_frame_interval{}, m_max_key_frame_interval{}, m_key_frame_interval_sum{}, m_num_key_frame_intervals{};
+
+  std::map<uint64_t, uint64_t> m_bytes_per_second;
+  std::vector<sliding_window_t> m_windows;
+  std::map<uint64_t, uint64_t> m_key_frame_distances;
+  std::vector<uint64_t> m_block_size_buckets;
+
+public:
+  detailed_track_statistics_c(std::vector<int64_t> const &window_lengths = { 1000000000ll, 10000000000ll });
+
+  void account(int64_t timestamp, int64_t duration, uint64_t num_bytes, bool key_frame);
+
+  nlohmann::json to_json() const;
+
+protected:
+  void account_sliding_windows(int64_t timestamp, uint64_t num_bytes);
+  void account_key_frame(int64_t timestamp);
+
+  static unsigned int block_size_bucket(uint64_t num_bytes);
+};
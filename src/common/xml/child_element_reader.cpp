@@ -0,0 +1,359 @@
+/*
+  mkvmerge -- utility for splicing together matroska files
+  from component media subtypes
+
+  Distributed under the GPL v2
+  see the file COPYING for details
+  or visit http://www.gnu.org/copyleft/gpl.html
+
+  splitting XML documents into the root element's children
+
+  Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/xml/child_element_reader.h"
+
+namespace mtx { namespace xml {
+
+namespace {
+
+bool
+is_space(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+bool
+is_name_start(char c) {
+  return std::isalpha(static_cast<unsigned char>(c)) || (c == '_') || (c == ':') || (static_cast<unsigned char>(c) >= 0x80);
+}
+
+// Documents declaring another encoding are recoded by load_file()
+// before being parsed. Those aren't split.
+bool
+is_utf8_or_not_a_declaration(std::string const &instruction) {
+  static boost::regex s_declaration_re{"^<\\?xml\\s",                             boost::regex::perl};
+  static boost::regex s_encoding_re{"\\sencoding\\s*=\\s*[\"']([^\"']*)[\"']", boost::regex::perl};
+
+  boost::smatch matches;
+
+  if (   !boost::regex_search(instruction, s_declaration_re)
+      || !boost::regex_search(instruction, matches, s_encoding_re))
+    return true;
+
+  auto encoding = balg::to_lower_copy(matches[1].str());
+
+  return (encoding == "utf-8") || (encoding == "utf8");
+}
+
+}
+
+child_element_reader_c::child_element_reader_c(mm_io_c &in,
+                                               std::size_t block_size)
+  : m_in(in)
+  , m_block_size{block_size}
+{
+}
+
+std::string const &
+child_element_reader_c::get_root_name()
+  const {
+  return m_root_name;
+}
+
+// Appends the next block to the buffer. Everything in front of the
+// current element (or in front of the current position if no element
+// is being read) has been handled already and is removed beforehand.
+bool
+child_element_reader_c::read_block() {
+  if (m_eof)
+    return false;
+
+  auto keep_from = std::min(m_position, m_element_start);
+  if (keep_from) {
+    m_buffer.erase(0, keep_from);
+    m_position -= keep_from;
+
+    if (m_element_start != std::string::npos)
+      m_element_start -= keep_from;
+  }
+
+  auto num_read = m_in.read(m_buffer, m_block_size, m_buffer.size());
+  if (num_read < m_block_size)
+    m_eof = true;
+
+  return num_read > 0;
+}
+
+bool
+child_element_reader_c::ensure_available(std::size_t num_bytes) {
+  while ((m_buffer.size() - m_position) < num_bytes)
+    if (!read_block())
+      return false;
+
+  return true;
+}
+
+bool
+child_element_reader_c::next_is(char const *text) {
+  auto length = std::strlen(text);
+
+  return ensure_available(length) && !m_buffer.compare(m_position, length, text);
+}
+
+bool
+child_element_reader_c::seek_to(char const *text) {
+  auto length = std::strlen(text);
+  auto offset = std::size_t{};
+
+  while (true) {
+    auto idx = m_buffer.find(text, m_position + offset, length);
+    if (idx != std::string::npos) {
+      m_position = idx;
+      return true;
+    }
+
+    // The text may start at the end of the current buffer.
+    auto available = m_buffer.size() - m_position;
+    if (available >= length)
+      offset = std::max(offset, available - length + 1);
+
+    if (!read_block())
+      return false;
+  }
+}
+
+bool
+child_element_reader_c::skip_past(char const *text) {
+  if (!seek_to(text))
+    return false;
+
+  m_position += std::strlen(text);
+
+  return true;
+}
+
+void
+child_element_reader_c::skip_whitespace() {
+  while (ensure_available(1) && is_space(m_buffer[m_position]))
+    ++m_position;
+}
+
+// Skips from the '<' to the '>' ending a tag (or a document type
+// declaration) while ignoring quoted attribute values.
+bool
+child_element_reader_c::skip_tag(bool &is_empty_element,
+                                 bool &has_subset) {
+  auto quote       = '\0';
+  auto previous    = '\0';
+  is_empty_element = false;
+  has_subset       = false;
+
+  ++m_position;
+
+  while (true) {
+    auto data = m_buffer.data();
+    auto size = m_buffer.size();
+
+    for (; m_position < size; ++m_position) {
+      auto c = data[m_position];
+
+      if (quote) {
+        if (c == quote)
+          quote = '\0';
+
+      } else if ((c == '"') || (c == '\''))
+        quote = c;
+
+      else if (c == '[')
+        has_subset = true;
+
+      else if (c == '>') {
+        ++m_position;
+        is_empty_element = previous == '/';
+        return true;
+      }
+
+      previous = c;
+    }
+
+    if (!read_block())
+      return false;
+  }
+}
+
+std::string
+child_element_reader_c::read_name(std::size_t offset) {
+  auto length = std::size_t{};
+
+  while (ensure_available(offset + length + 1)) {
+    auto c = m_buffer[m_position + offset + length];
+    if (is_space(c) || (c == '/') || (c == '>'))
+      break;
+
+    ++length;
+  }
+
+  return m_buffer.substr(m_position + offset, length);
+}
+
+child_element_reader_c::result_e
+child_element_reader_c::read_root(std::string &start_tag) {
+  if (m_root_read)
+    return result_e::unsupported;
+
+  m_root_read  = true;
+  auto has_bom = next_is("\xef\xbb\xbf");
+
+  if (has_bom)
+    m_position += 3;
+
+  while (true) {
+    auto is_empty = false, has_subset = false;
+
+    skip_whitespace();
+
+    if (!ensure_available(2) || (m_buffer[m_position] != '<'))
+      return result_e::unsupported;
+
+    if (next_is("<?")) {
+      m_element_start = m_position;
+      if (!skip_past("?>"))
+        return result_e::unsupported;
+
+      auto instruction = m_buffer.substr(m_element_start, m_position - m_element_start);
+      m_element_start  = std::string::npos;
+
+      // A byte order mark takes precedence over the declaration.
+      if (!has_bom && !is_utf8_or_not_a_declaration(instruction))
+        return result_e::unsupported;
+
+    } else if (next_is("<!--")) {
+      if (!skip_past("-->"))
+        return result_e::unsupported;
+
+    } else if (next_is("<!DOCTYPE")) {
+      if (!skip_tag(is_empty, has_subset) || has_subset)
+        return result_e::unsupported;
+
+    } else if (is_name_start(m_buffer[m_position + 1])) {
+      m_element_start = m_position;
+      m_root_name     = read_name(1);
+
+      if (!skip_tag(is_empty, has_subset))
+        return result_e::unsupported;
+
+      start_tag       = m_buffer.substr(m_element_start, m_position - m_element_start);
+      m_element_start = std::string::npos;
+      m_root_is_empty = is_empty;
+
+      if (!is_empty)
+        start_tag.insert(start_tag.size() - 1, "/");
+
+      return result_e::element;
+
+    } else
+      return result_e::unsupported;
+  }
+}
+
+child_element_reader_c::result_e
+child_element_reader_c::read_next(std::string &element) {
+  if (!m_root_read)
+    return result_e::unsupported;
+
+  if (m_root_ended)
+    return result_e::end_of_root;
+
+  if (m_root_is_empty) {
+    m_root_ended = true;
+    return skip_trailing_misc();
+  }
+
+  auto depth = 0u;
+
+  while (seek_to("<")) {
+    auto is_empty = false, has_subset = false, is_complete = false;
+
+    if (!ensure_available(2))
+      return result_e::unsupported;
+
+    auto next = m_buffer[m_position + 1];
+
+    if ((next == '!') && next_is("<!--")) {
+      if (!skip_past("-->"))
+        return result_e::unsupported;
+
+    } else if ((next == '!') && next_is("<![CDATA[")) {
+      if (!skip_past("]]>"))
+        return result_e::unsupported;
+
+    } else if (next == '?') {
+      if (!skip_past("?>"))
+        return result_e::unsupported;
+
+    } else if (next == '/') {
+      if (!depth) {
+        if ((read_name(2) != m_root_name) || !skip_tag(is_empty, has_subset))
+          return result_e::unsupported;
+
+        m_root_ended = true;
+
+        return skip_trailing_misc();
+      }
+
+      if (!skip_tag(is_empty, has_subset))
+        return result_e::unsupported;
+
+      is_complete = !--depth;
+
+    } else if (is_name_start(next)) {
+      if (!depth)
+        m_element_start = m_position;
+
+      if (!skip_tag(is_empty, has_subset))
+        return result_e::unsupported;
+
+      if (!is_empty)
+        ++depth;
+      else
+        is_complete = !depth;
+
+    } else
+      return result_e::unsupported;
+
+    if (is_complete) {
+      element.assign(m_buffer, m_element_start, m_position - m_element_start);
+      m_element_start = std::string::npos;
+
+      return result_e::element;
+    }
+  }
+
+  return result_e::unsupported;
+}
+
+// Only comments & processing instructions may follow the root element.
+child_element_reader_c::result_e
+child_element_reader_c::skip_trailing_misc() {
+  while (true) {
+    skip_whitespace();
+
+    if (!ensure_available(1))
+      return result_e::end_of_root;
+
+    if (next_is("<!--")) {
+      if (!skip_past("-->"))
+        return result_e::unsupported;
+
+    } else if (next_is("<?")) {
+      if (!skip_past("?>"))
+        return result_e::unsupported;
+
+    } else
+      return result_e::unsupported;
+  }
+}
+
+}}
@@ -0,0 +1,69 @@
+/*
+  mkvmerge -- utility for splicing together matroska files
+  from component media subtypes
+
+  Distributed under the GPL v2
+  see the file COPYING for details
+  or visit http://www.gnu.org/copyleft/gpl.html
+
+  splitting XML documents into the root element's children
+
+  Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+namespace mtx { namespace xml {
+
+// Reads an XML document block by block and returns the root element's
+// start tag followed by the complete text of each of the root element's
+// children. This way huge documents can be converted one top level
+// element at a time instead of having to load all of them into a DOM.
+//
+// Only the tags, comments, processing instructions & CDATA sections
+// are looked at, not their content. Therefore only documents encoded
+// in UTF-8 without internal DTD subsets are supported. For all others
+// as well as for documents that are obviously not well-formed
+// 'unsupported' is returned, and the caller has to fall back to
+// loading the whole document.
+class child_element_reader_c {
+public:
+  enum class result_e {
+    element,
+    end_of_root,
+    unsupported,
+  };
+
+protected:
+  mm_io_c &m_in;
+  std::string m_buffer, m_root_name;
+  std::size_t m_position{}, m_element_start{std::string::npos}, m_block_size;
+  bool m_eof{}, m_root_is_empty{}, m_root_read{}, m_root_ended{};
+
+public:
+  child_element_reader_c(mm_io_c &in, std::size_t block_size = 1024 * 1024);
+
+  // Returns the root element's start tag including its attributes as
+  // an empty element, e.g. "<Tags/>".
+  result_e read_root(std::string &start_tag);
+  result_e read_next(std::string &element);
+
+  std::string const &get_root_name() const;
+
+protected:
+  bool read_block();
+  bool ensure_available(std::size_t num_bytes);
+  bool next_is(char const *text);
+  bool seek_to(char const *text);
+  bool skip_past(char const *text);
+  void skip_whitespace();
+  bool skip_tag(bool &is_empty_element, bool &has_subset);
+  std::string read_name(std::size_t offset);
+  result_e skip_trailing_misc();
+};
+
+}}
@@ -13,8 +13,6 @@
 
 #include "common/common_pch.h"
 
-#include <sstream>
-
 #include "common/extern_data.h"
 #include "common/iso639.h"
 #include "common/mm_io_x.h"
@@ -168,18 +166,9 @@ ebml_chapters_converter_c::fix_display(KaxChapterDisplay &display)
 void
 ebml_chapters_converter_c::write_xml(KaxChapters &chapters,
                                      mm_io_c &out) {
-  document_cptr doc(new pugi::xml_document);
-
-  doc->append_child(pugi::node_comment).set_value(" <!DOCTYPE Chapters SYSTEM \"matroskachapters.dtd\"> ");
-
-  ebml_chapters_converter_c converter;
-  converter.to_xml(chapters, doc);
-
   out.write_bom("UTF-8");
 
-  std::stringstream out_stream;
-  doc->save(out_stream, "  ");
-  out.puts(out_stream.str());
+  ebml_chapters_converter_c{}.to_xml(chapters, out, " <!DOCTYPE Chapters SYSTEM \"matroskachapters.dtd\"> ");
 }
 
 bool
@@ -24,12 +24,39 @@
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "common/strings/utf8.h"
+#include "common/xml/child_element_reader.h"
 #include "common/xml/ebml_converter.h"
 
 using namespace libmatroska;
 
 namespace mtx { namespace xml {
 
+namespace {
+
+debugging_option_c s_debug{"ebml_converter"};
+
+// Uses puts() in order to convert line endings the same way as for
+// the saved document as a whole.
+class mm_io_xml_writer_c: public pugi::xml_writer {
+protected:
+  mm_io_c &m_out;
+
+public:
+  mm_io_xml_writer_c(mm_io_c &out)
+    : m_out(out)
+  {
+  }
+
+  virtual void
+  write(void const *data,
+        size_t size)
+    override {
+    m_out.puts(std::string{static_cast<char const *>(data), size});
+  }
+};
+
+}
+
 ebml_converter_c::limits_t::limits_t()
   : has_min{false}
   , has_max{false}
@@ -66,6 +93,45 @@ ebml_converter_c::to_xml(EbmlElement &e,
   return doc;
 }
 
+// Writes the same as saving the document created by the other to_xml()
+// with an indentation of two spaces. However, only the part of the
+// document for a single child of the root element exists at a time.
+void
+ebml_converter_c::to_xml(EbmlMaster &root,
+                         mm_io_c &out,
+                         std::string const &comment)
+  const {
+  mm_io_xml_writer_c writer{out};
+  pugi::xml_document frame;
+
+  frame.append_child(pugi::node_comment).set_value(comment.c_str());
+  auto root_node = frame.append_child(get_tag_name(root).c_str());
+
+  out.puts("<?xml version=\"1.0\"?>\n");
+  frame.first_child().print(writer, "  ", pugi::format_default, pugi::encoding_auto, 0);
+
+  auto has_children = std::any_of(root.begin(), root.end(), [](EbmlElement *child) { return !dynamic_cast<EbmlVoid *>(child); });
+  if (!has_children) {
+    root_node.print(writer, "  ", pugi::format_default, pugi::encoding_auto, 0);
+    return;
+  }
+
+  out.puts(fmt::format("<{0}>\n", root_node.name()));
+
+  document_cptr doc{new pugi::xml_document};
+
+  for (auto child : root) {
+    doc->reset();
+    to_xml_recursively(*doc, *child);
+    fix_xml(doc);
+
+    for (auto node : doc->children())
+      node.print(writer, "  ", pugi::format_default, pugi::encoding_auto, 1);
+  }
+
+  out.puts(fmt::format("</{0}>\n", root_node.name()));
+}
+
 std::string
 ebml_converter_c::get_tag_name(EbmlElement &e)
   const {
@@ -113,6 +179,11 @@ ebml_converter_c::reverse_debug_to_tag_name_map() {
     m_tag_to_debug_name_map[pair.second] = pair.first;
 }
 
+void
+ebml_converter_c::enable_streaming(bool enable) {
+  m_streaming_enabled = enable;
+}
+
 void
 ebml_converter_c::fix_xml(document_cptr &)
   const {
@@ -332,17 +403,21 @@ ebml_converter_c::to_xml_recursively(pugi::xml_node &parent,
 ebml_master_cptr
 ebml_converter_c::to_ebml(std::string const &file_name,
                           std::string const &root_name) {
-  auto doc       = load_file(file_name);
-  auto root_node = doc->document_element();
-  if (!root_node)
-    return ebml_master_cptr();
+  auto ebml_root = m_streaming_enabled ? to_ebml_streamed(file_name, root_name) : ebml_master_cptr{};
 
-  if (root_name != root_node.name())
-    throw conversion_x{fmt::format(Y("The root element must be <{0}>."), root_name)};
+  if (!ebml_root) {
+    auto doc       = load_file(file_name);
+    auto root_node = doc->document_element();
+    if (!root_node)
+      return ebml_master_cptr();
 
-  ebml_master_cptr ebml_root{new KaxSegment};
+    if (root_name != root_node.name())
+      throw conversion_x{fmt::format(Y("The root element must be <{0}>."), root_name)};
+
+    ebml_root.reset(new KaxSegment);
 
-  to_ebml_recursively(*ebml_root, root_node);
+    to_ebml_recursively(*ebml_root, root_node);
+  }
 
   auto master = dynamic_cast<EbmlMaster *>((*ebml_root)[0]);
   if (!master)
@@ -352,12 +427,72 @@ ebml_converter_c::to_ebml(std::string const &file_name,
 
   ebml_root->Remove(0);
 
-  if (debugging_c::requested("ebml_converter"))
+  if (s_debug)
     dump_ebml_elements(master, true);
 
   return ebml_master_cptr{master};
 }
 
+// Converts one child of the root element at a time so that neither the
+// whole file nor its DOM has to be kept in memory. Returns an empty
+// pointer if the file cannot be split (see child_element_reader_c) or
+// if it contains errors. The caller converts it via a DOM of the whole
+// file in that case so that the error messages report the positions
+// within the file.
+ebml_master_cptr
+ebml_converter_c::to_ebml_streamed(std::string const &file_name,
+                                   std::string const &root_name)
+  const {
+  auto in = mm_file_io_c::open(file_name, MODE_READ);
+  child_element_reader_c reader{*in};
+  std::string text;
+
+  if (   (reader.read_root(text) != child_element_reader_c::result_e::element)
+      || (reader.get_root_name() != root_name)) {
+    mxdebug_if(s_debug, fmt::format("to_ebml_streamed: cannot split {0}\n", file_name));
+    return {};
+  }
+
+  ebml_master_cptr ebml_root{new KaxSegment};
+  pugi::xml_document doc;
+  auto num_children = 0u;
+
+  try {
+    if (!doc.load_buffer_inplace(&text[0], text.size(), pugi::parse_default, pugi::encoding_utf8))
+      return {};
+
+    auto root_node = doc.document_element();
+    to_ebml_recursively(*ebml_root, root_node);
+
+    auto master = dynamic_cast<EbmlMaster *>((*ebml_root)[0]);
+    if (!master)
+      return {};
+
+    while (true) {
+      auto result = reader.read_next(text);
+
+      if (result == child_element_reader_c::result_e::end_of_root)
+        break;
+
+      if (   (result != child_element_reader_c::result_e::element)
+          || !doc.load_buffer_inplace(&text[0], text.size(), pugi::parse_default, pugi::encoding_utf8)) {
+        mxdebug_if(s_debug, fmt::format("to_ebml_streamed: cannot split or parse {0} after {1} children\n", file_name, num_children));
+        return {};
+      }
+
+      auto node = doc.document_element();
+      to_ebml_recursively(*master, node);
+      ++num_children;
+    }
+
+  } catch (mtx::xml::exception &ex) {
+    mxdebug_if(s_debug, fmt::format("to_ebml_streamed: conversion of {0} failed after {1} children: {2}\n", file_name, num_children, ex.what()));
+    return {};
+  }
+
+  return ebml_root;
+}
+
 void
 ebml_converter_c::to_ebml_recursively(EbmlMaster &parent,
                                       pugi::xml_node &node)
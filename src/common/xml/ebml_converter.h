@@ -16,6 +16,7 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/mm_io.h"
 #include "common/xml/xml.h"
 
 namespace mtx { namespace xml {
@@ -47,14 +48,18 @@ protected:
   std::map<std::string, value_parser_t> m_parser_map;
   std::map<std::string, limits_t> m_limits;
   std::map<std::string, bool> m_invalid_elements_map;
+  bool m_streaming_enabled{true};
 
 public:
   ebml_converter_c();
   virtual ~ebml_converter_c();
 
   document_cptr to_xml(EbmlElement &e, document_cptr const &destination = document_cptr{}) const;
+  void to_xml(EbmlMaster &root, mm_io_c &out, std::string const &comment) const;
   ebml_master_cptr to_ebml(std::string const &file_name, std::string const &required_root_name);
 
+  void enable_streaming(bool enable);
+
   std::string get_tag_name(EbmlElement &e) const;
   std::string get_debug_name(std::string const &tag_name) const;
 
@@ -79,6 +84,7 @@ protected:
 
   void to_xml_recursively(pugi::xml_node &parent, EbmlElement &e) const;
 
+  ebml_master_cptr to_ebml_streamed(std::string const &file_name, std::string const &required_root_name) const;
   void to_ebml_recursively(EbmlMaster &parent, pugi::xml_node &node) const;
   EbmlElement *convert_node_or_attribute_to_ebml(EbmlMaster &parent, pugi::xml_node const &node, pugi::xml_attribute const &attribute, std::map<std::string, bool> &handled_attributes) const;
   EbmlElement *verify_and_create_element(EbmlMaster &parent, std::string const &name, pugi::xml_node const &node) const;
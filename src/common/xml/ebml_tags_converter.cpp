@@ -13,8 +13,6 @@
 
 #include "common/common_pch.h"
 
-#include <sstream>
-
 #include "common/mm_io_x.h"
 #include "common/strings/formatting.h"
 #include "common/xml/ebml_tags_converter.h"
@@ -58,18 +56,9 @@ ebml_tags_converter_c::setup_maps() {
 void
 ebml_tags_converter_c::write_xml(KaxTags &tags,
                                  mm_io_c &out) {
-  document_cptr doc(new pugi::xml_document);
-
-  doc->append_child(pugi::node_comment).set_value(" <!DOCTYPE Tags SYSTEM \"matroskatags.dtd\"> ");
-
-  ebml_tags_converter_c converter;
-  converter.to_xml(tags, doc);
-
   out.write_bom("UTF-8");
 
-  std::stringstream out_stream;
-  doc->save(out_stream, "  ");
-  out.puts(out_stream.str());
+  ebml_tags_converter_c{}.to_xml(tags, out, " <!DOCTYPE Tags SYSTEM \"matroskatags.dtd\"> ");
 }
 
 void
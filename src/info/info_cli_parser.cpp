@@ -42,6 +42,8 @@ info_cli_parser_c::init_parser() {
   OPT("X|full-hexdump",  set_full_hexdump,  YT("Show all bytes of each frame as a hex dump."));
   OPT("p|hex-positions", set_hex_positions, YT("Show positions in hexadecimal."));
   OPT("z|size",          set_size,          YT("Show the size of each element including its header."));
+  OPT("verify-crc32",    set_verify_crc32,  YT("Verify the CRC-32 elements of all clusters and other level 1 elements and report corrupted byte ranges instead of showing the file's content."));
+  OPT("threads=<n>",     set_num_threads,   YT("Decode clusters on up to n threads at the same time (default: the number of hardware threads; 1 disables it)."));
 
   add_common_options();
 
@@ -104,6 +106,17 @@ info_cli_parser_c::set_hex_positions() {
   m_options.m_hex_positions = true;
 }
 
+void
+info_cli_parser_c::set_verify_crc32() {
+  m_options.m_verify_crc32 = true;
+}
+
+void
+info_cli_parser_c::set_num_threads() {
+  if (!parse_number(m_next_arg, m_options.m_num_threads) || !m_options.m_num_threads)
+    mxerror(fmt::format(Y("Invalid number of threads in '{0} {1}'.\n"), m_current_arg, m_next_arg));
+}
+
 options_c
 info_cli_parser_c::run() {
   init_parser();
@@ -36,4 +36,6 @@ protected:
   void set_file_name();
   void set_track_info();
   void set_hex_positions();
+  void set_verify_crc32();
+  void set_num_threads();
 };
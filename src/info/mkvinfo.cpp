@@ -13,7 +13,12 @@
 #include "common/common_pch.h"
 
 #include "common/command_line.h"
+#include "common/kax_crc32_verifier.h"
+#include "common/kax_element_names.h"
 #include "common/kax_info.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/version.h"
 #include "info/info_cli_parser.h"
 
@@ -23,6 +28,35 @@ setup(char const *argv0) {
   mtx::cli::g_version_info = get_version_info("mkvinfo", vif_full);
 }
 
+void
+verify_crc32(std::string const &file_name) {
+  mm_io_cptr in;
+
+  try {
+    in = std::make_shared<mm_read_buffer_io_c>(mm_file_io_c::open(file_name), 1024 * 1024);
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(fmt::format(Y("Error: Couldn't open source file {0} ({1}).\n"), file_name, ex));
+  }
+
+  mtx::kax_crc32_verifier_c verifier{*in};
+  auto const &problems = verifier.verify();
+
+  for (auto const &problem : problems) {
+    auto name = mtx::kax_element_names_c::get(problem.m_id);
+
+    if (problem.m_type == mtx::kax_crc32_verifier_c::problem_e::truncated)
+      mxinfo(fmt::format(Y("The element '{0}' at position {1} is truncated: its data should end at byte {2}, but the file ends earlier.\n"), name, problem.m_element_position, problem.m_covered_end));
+
+    else
+      mxinfo(fmt::format(Y("CRC-32 mismatch in the element '{0}' at position {1}: bytes {2} to {3} are corrupted (stored: 0x{4:08x}, calculated: 0x{5:08x}).\n"),
+                         name, problem.m_element_position, problem.m_covered_start, problem.m_covered_end - 1, problem.m_stored_crc, problem.m_calculated_crc));
+  }
+
+  mxinfo(fmt::format(Y("{0} CRC-32 element(s) covering {1} bytes checked, {2} problem(s) found.\n"), verifier.get_num_checked(), verifier.get_num_bytes_covered(), problems.size()));
+
+  mxexit(problems.empty() ? 0 : 2);
+}
+
 int
 main(int argc,
      char **argv) {
@@ -35,6 +69,9 @@ main(int argc,
   if (options.m_file_name.empty())
     mxerror(Y("No file name given.\n"));
 
+  if (options.m_verify_crc32)
+    verify_crc32(options.m_file_name);
+
   mtx::kax_info_c info;
 
   info.set_calc_checksums(options.m_calc_checksums);
@@ -45,6 +82,7 @@ main(int argc,
   info.set_hex_positions(options.m_hex_positions);
   info.set_hexdump_max_size(options.m_hexdump_max_size);
   info.set_verbosity(options.m_verbose);
+  info.set_num_threads(options.m_num_threads);
 
   try {
     info.open_and_process_file(options.m_file_name);
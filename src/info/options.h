@@ -15,6 +15,7 @@
 class options_c {
 public:
   std::string m_file_name;
-  bool m_calc_checksums{}, m_show_summary{}, m_show_hexdump{}, m_show_size{}, m_show_track_info{}, m_hex_positions{};
+  bool m_calc_checksums{}, m_show_summary{}, m_show_hexdump{}, m_show_size{}, m_show_track_info{}, m_hex_positions{}, m_verify_crc32{};
   int m_hexdump_max_size{16}, m_verbose{};
+  unsigned int m_num_threads{};
 };
@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/bswap.h"
 #include "input/bluray_pcm_channel_removal_packet_converter.h"
 #include "merge/generic_packetizer.h"
 
@@ -24,26 +25,15 @@ bluray_pcm_channel_removal_packet_converter_c::bluray_pcm_channel_removal_packet
   , m_num_input_channels{num_input_channels}
   , m_num_output_channels{num_output_channels}
 {
+  for (auto channel = 0u; channel < m_num_output_channels; ++channel)
+    m_channel_map.push_back(channel);
 }
 
 bool
 bluray_pcm_channel_removal_packet_converter_c::convert(packet_cptr const &packet) {
-  auto start_ptr                  = packet->data->get_buffer();
-  auto end_ptr                    = start_ptr + packet->data->get_size();
-  auto input_ptr                  = start_ptr;
-  auto output_ptr                 = start_ptr;
-  auto input_bytes_per_iteration  = m_bytes_per_channel * m_num_input_channels;
-  auto output_bytes_per_iteration = m_bytes_per_channel * m_num_output_channels;
-
-  while ((input_ptr + input_bytes_per_iteration) <= end_ptr) {
-    if (input_ptr != output_ptr)
-      std::memmove(output_ptr, input_ptr, output_bytes_per_iteration);
-
-    input_ptr  += input_bytes_per_iteration;
-    output_ptr += output_bytes_per_iteration;
-  }
-
-  packet->data->set_size(output_ptr - start_ptr);
+  auto buffer = packet->data->get_buffer();
+
+  packet->data->set_size(mtx::bytes::remap_channels(buffer, buffer, packet->data->get_size(), m_bytes_per_channel, m_num_input_channels, m_channel_map));
 
   m_ptzr->process(packet);
 
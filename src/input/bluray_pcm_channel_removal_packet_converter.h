@@ -21,6 +21,7 @@
 class bluray_pcm_channel_removal_packet_converter_c: public packet_converter_c {
 protected:
   std::size_t m_bytes_per_channel, m_num_input_channels, m_num_output_channels;
+  std::vector<std::size_t> m_channel_map;
 
 public:
   bluray_pcm_channel_removal_packet_converter_c(std::size_t bytes_per_channel, std::size_t num_input_channels, std::size_t num_output_channels);
@@ -0,0 +1,66 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   a cache of large blocks read from a file
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "input/chunk_cache.h"
+
+chunk_cache_c::chunk_cache_c(uint64_t max_cached_bytes)
+  : m_max_cached_bytes{max_cached_bytes}
+{
+}
+
+bool
+chunk_cache_c::get(uint64_t position,
+                   unsigned char *buffer,
+                   std::size_t size) {
+  for (auto &block : m_blocks) {
+    if ((position < block.m_position) || ((position + size) > (block.m_position + block.m_data->get_size())))
+      continue;
+
+    std::memcpy(buffer, block.m_data->get_buffer() + (position - block.m_position), size);
+    block.m_last_use = ++m_use_counter;
+    ++m_num_hits;
+
+    return true;
+  }
+
+  ++m_num_misses;
+
+  return false;
+}
+
+void
+chunk_cache_c::add(uint64_t position,
+                   memory_cptr const &data) {
+  while (!m_blocks.empty() && ((m_cached_bytes + data->get_size()) > m_max_cached_bytes)) {
+    auto least_recently_used = boost::min_element(m_blocks, [](block_t const &a, block_t const &b) { return a.m_last_use < b.m_last_use; });
+    m_cached_bytes          -= least_recently_used->m_data->get_size();
+    m_blocks.erase(least_recently_used);
+  }
+
+  m_cached_bytes += data->get_size();
+  m_blocks.push_back({ position, data, ++m_use_counter });
+}
+
+uint64_t
+chunk_cache_c::get_num_hits()
+  const {
+  return m_num_hits;
+}
+
+uint64_t
+chunk_cache_c::get_num_misses()
+  const {
+  return m_num_misses;
+}
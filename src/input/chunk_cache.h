@@ -0,0 +1,43 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definitions for a cache of large blocks read from a file
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+/* Holds a limited number of large blocks read from the file. Readers
+   read samples located close to each other together, and the samples
+   are then copied out of the blocks. For badly interleaved files this
+   turns a seek per sample into a few large sequential reads. Used by
+   the MP4 & AVI readers. */
+class chunk_cache_c {
+protected:
+  struct block_t {
+    uint64_t m_position;
+    memory_cptr m_data;
+    uint64_t m_last_use;
+  };
+
+  std::vector<block_t> m_blocks;
+  uint64_t m_max_cached_bytes, m_cached_bytes{}, m_use_counter{};
+  uint64_t m_num_hits{}, m_num_misses{};
+
+public:
+  chunk_cache_c(uint64_t max_cached_bytes);
+
+  bool get(uint64_t position, unsigned char *buffer, std::size_t size);
+  void add(uint64_t position, memory_cptr const &data);
+
+  uint64_t get_num_hits() const;
+  uint64_t get_num_misses() const;
+};
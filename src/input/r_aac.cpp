@@ -78,6 +78,7 @@ aac_reader_c::read_headers() {
       mxerror(fmt::format(Y("The AAC file '{0}' contains invalid header data: the sampling frequency or the number of channels is 0.\n"), m_ti.m_fname));
 
     m_parser             = mtx::aac::parser_c{};
+    m_parser.slice_data(true);
 
     m_ti.m_id            = 0;       // ID for this track.
     int detected_profile = m_aacheader.config.profile;
@@ -117,16 +118,19 @@ aac_reader_c::create_packetizer(int64_t) {
 file_status_e
 aac_reader_c::read(generic_packetizer_c *,
                    bool) {
+  // A new chunk is used for each read as the frames refer to it.
   int remaining_bytes = m_size - m_in->getFilePointer();
   int read_len        = std::min(INITCHUNKSIZE, remaining_bytes);
-  int num_read        = m_in->read(m_chunk, read_len);
+  auto chunk          = memory_c::alloc(std::max(read_len, 0));
+  int num_read        = m_in->read(chunk, read_len);
 
   if (0 < num_read) {
-    m_parser.add_bytes(m_chunk->get_buffer(), num_read);
+    m_parser.add_bytes(chunk);
 
     while (m_parser.frames_available()) {
-      auto frame = m_parser.get_frame();
-      PTZR0->process(std::make_shared<packet_t>(frame.m_data));
+      auto packet = std::make_shared<packet_t>();
+      packet->set_data_slices({ m_parser.get_frame().get_data_slice() });
+      PTZR0->process(packet);
     }
   }
 
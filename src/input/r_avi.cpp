@@ -22,6 +22,7 @@
 #include "common/codec.h"
 #include "common/endian.h"
 #include "common/error.h"
+#include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/ivf.h"
 #include "common/mm_io_x.h"
@@ -53,7 +54,12 @@ extern "C" {
 extern long AVI_errno;
 }
 
-#define AVI_MAX_AUDIO_CHUNK_SIZE (10 * 1024 * 1024)
+#define AVI_MAX_AUDIO_CHUNK_SIZE  (10 * 1024 * 1024)
+
+#define CHUNK_CACHE_SIZE          (32 * 1024 * 1024)
+#define CHUNK_CACHE_MAX_READ_SIZE ( 4 * 1024 * 1024)
+#define CHUNK_CACHE_MAX_GAP       (64 * 1024)
+#define CHUNK_CACHE_MAX_LOOKAHEAD 1024
 
 #define GAB2_TAG                 FOURCC('G', 'A', 'B', '2')
 #define GAB2_ID_LANGUAGE         0x0000
@@ -80,7 +86,8 @@ avi_reader_c::probe_file(mm_io_c &in,
   if ((data.substr(0, 4) != "riff") || (data.substr(8, 4) != "avi "))
     return false;
 
-  auto avi       = AVI_open_input_file(&in, 1);
+  // The index isn't needed for probing.
+  auto avi       = AVI_open_input_file(&in, 0);
   auto const err = AVI_errno;
 
   if (avi)
@@ -97,6 +104,9 @@ avi_reader_c::probe_file(mm_io_c &in,
 avi_reader_c::avi_reader_c(const track_info_c &ti,
                            const mm_io_cptr &in)
   : generic_reader_c(ti, in)
+  , m_chunk_cache{CHUNK_CACHE_SIZE}
+  , m_debug_index{      "avi|avi_index"}
+  , m_debug_chunk_cache{"avi|avi_chunk_cache"}
 {
 }
 
@@ -112,11 +122,13 @@ avi_reader_c::read_headers() {
 
   show_demuxer_info();
 
-  if (!(m_avi = AVI_open_input_file(m_in.get(), 1)))
+  if (!(m_avi = AVI_open_input_file(m_in.get(), 0)))
     throw mtx::input::invalid_format_x();
 
+  load_index();
+
   m_fps              = AVI_frame_rate(m_avi);
-  m_max_video_frames = AVI_video_frames(m_avi);
+  m_max_video_frames = m_index.get_video().size();
   m_video_width      = std::abs(AVI_video_width(m_avi));
   m_video_height     = std::abs(AVI_video_height(m_avi));
 
@@ -132,6 +144,42 @@ avi_reader_c::~avi_reader_c() {
     AVI_close(m_avi);
 
   mxverb(2, fmt::format("avi_reader_c: Dropped video frames: {0}\n", m_dropped_video_frames));
+
+  mxdebug_if(m_debug_chunk_cache,
+             fmt::format("Chunk cache: {0} chunks served from the cache, {1} not cached; {2} coalesced reads of {3} bytes in total; {4} chunks read directly; {5} reads required seeking\n",
+                         m_chunk_cache.get_num_hits(), m_chunk_cache.get_num_misses(), m_num_chunk_reads, m_num_chunk_bytes_read, m_num_direct_reads, m_num_seeks));
+}
+
+/* The index is loaded from the 'idx1' entries avilib has read along
+   with the headers or from the OpenDML 'ix##' chunks. Only if there's
+   no usable index the file is opened again with avilib's index, and
+   avilib reconstructs the index by scanning the whole file. */
+void
+avi_reader_c::load_index() {
+  auto start = mtx::sys::get_current_time_millis();
+
+  if (m_index.load(*m_in, *m_avi)) {
+    // The raw 'idx1' entries aren't needed anymore.
+    if (m_avi->idx) {
+      free(m_avi->idx);
+      m_avi->idx     = nullptr;
+      m_avi->n_idx   = 0;
+      m_avi->max_idx = 0;
+    }
+
+  } else {
+    mxdebug_if(m_debug_index, "Index: no usable index found; letting avilib reconstruct it\n");
+
+    AVI_close(m_avi);
+    m_in->setFilePointer(0);
+
+    if (!(m_avi = AVI_open_input_file(m_in.get(), 1)))
+      throw mtx::input::invalid_format_x();
+
+    m_index.import(*m_avi);
+  }
+
+  mxdebug_if(m_debug_index, fmt::format("Index: {0} video chunks, {1} audio tracks; loaded in {2} ms\n", m_index.get_video().size(), AVI_audio_tracks(m_avi), mtx::sys::get_current_time_millis() - start));
 }
 
 void
@@ -144,20 +192,16 @@ void
 avi_reader_c::parse_subtitle_chunks() {
   int i;
   for (i = 0; AVI_text_tracks(m_avi) > i; ++i) {
-    AVI_set_text_track(m_avi, i);
+    auto const &index = m_index.get_text(i);
 
-    if (AVI_text_chunks(m_avi) == 0)
+    if (index.empty())
       continue;
 
-    int chunk_size = AVI_read_text_chunk(m_avi, nullptr);
-    if (0 >= chunk_size)
+    auto chunk = read_indexed_chunk(index, 0);
+    if (!chunk || !chunk->get_size())
       continue;
 
-    memory_cptr chunk(memory_c::alloc(chunk_size));
-    chunk_size = AVI_read_text_chunk(m_avi, reinterpret_cast<char *>(chunk->get_buffer()));
-
-    if (0 >= chunk_size)
-      continue;
+    auto chunk_size = chunk->get_size();
 
     avi_subs_demuxer_t demuxer;
 
@@ -170,7 +214,7 @@ avi_reader_c::parse_subtitle_chunks() {
 
       io.skip(1);
 
-      while (!io.eof() && (io.getFilePointer() < static_cast<size_t>(chunk_size))) {
+      while (!io.eof() && (io.getFilePointer() < chunk_size)) {
         uint16_t id = io.read_uint16_le();
         int len     = io.read_uint32_le();
 
@@ -213,14 +257,14 @@ avi_reader_c::create_packetizer(int64_t tid) {
 
 void
 avi_reader_c::create_video_packetizer() {
-  size_t i;
+  auto const &index = m_index.get_video();
 
   mxverb_tid(4, m_ti.m_fname, 0, "frame sizes:\n");
 
-  for (i = 0; i < m_max_video_frames; i++) {
-    m_bytes_to_process += AVI_frame_size(m_avi, i);
-    mxverb(4, fmt::format("  {0}: {1}\n", i, AVI_frame_size(m_avi, i)));
-  }
+  for (auto i = 0u; i < m_max_video_frames; i++)
+    mxverb(4, fmt::format("  {0}: {1}\n", i, index.get_size(i)));
+
+  m_bytes_to_process += index.get_total_size();
 
   if (m_avi->bitmap_info_header) {
     m_ti.m_private_data = memory_c::clone(m_avi->bitmap_info_header, sizeof(alBITMAPINFOHEADER) + m_avi->extradata_size);
@@ -273,26 +317,18 @@ avi_reader_c::create_mpeg1_2_packetizer() {
   while ((frame_number < std::min(m_max_video_frames, 100u)) && (MPV_PARSER_STATE_FRAME != state)) {
     ++frame_number;
 
-    int size = AVI_frame_size(m_avi, frame_number - 1);
-    if (0 == size)
+    if (0 == m_index.get_video().get_size(frame_number - 1))
       continue;
 
-    AVI_set_video_position(m_avi, frame_number - 1);
-
-    memory_cptr buffer = memory_c::alloc(size);
-    int key      = 0;
-    int num_read = AVI_read_frame(m_avi, reinterpret_cast<char *>(buffer->get_buffer()), &key);
-
-    if (0 >= num_read)
+    auto buffer = read_indexed_chunk(m_index.get_video(), frame_number - 1);
+    if (!buffer)
       continue;
 
-    m2v_parser->WriteData(buffer->get_buffer(), num_read);
+    m2v_parser->WriteData(buffer->get_buffer(), buffer->get_size());
 
     state = m2v_parser->GetState();
   }
 
-  AVI_set_video_position(m_avi, 0);
-
   if (MPV_PARSER_STATE_FRAME != state)
     mxerror_tid(m_ti.m_fname, 0, Y("Could not extract the sequence header from this MPEG-1/2 track.\n"));
 
@@ -444,8 +480,8 @@ avi_reader_c::add_audio_demuxer(int aid) {
       return;
 
   AVI_set_audio_track(m_avi, aid);
-  if (AVI_read_audio_chunk(m_avi, nullptr) < 0) {
-    mxwarn(fmt::format(Y("Could not find an index for audio track {0} (avilib error message: {1}). Skipping track.\n"), aid + 1, AVI_strerror()));
+  if (m_index.get_audio(aid).empty()) {
+    mxwarn(fmt::format(Y("Could not find an index for audio track {0}. Skipping track.\n"), aid + 1));
     return;
   }
 
@@ -509,9 +545,9 @@ avi_reader_c::add_audio_demuxer(int aid) {
 
   m_audio_demuxers.push_back(demuxer);
 
-  int i, maxchunks = AVI_audio_chunks(m_avi);
-  for (i = 0; i < maxchunks; i++) {
-    auto size = AVI_audio_size(m_avi, i);
+  auto const &index = m_index.get_audio(aid);
+  for (auto i = 0u; i < index.size(); i++) {
+    auto size = index.get_size(i);
     if (size < AVI_MAX_AUDIO_CHUNK_SIZE)
       m_bytes_to_process += size;
   }
@@ -566,21 +602,16 @@ avi_reader_c::create_aac_packetizer(int aid,
 generic_packetizer_c *
 avi_reader_c::create_dts_packetizer(int aid) {
   try {
-    AVI_set_audio_track(m_avi, aid);
-
-    long audio_position   = AVI_get_audio_position_index(m_avi);
-    unsigned int num_read = 0;
-    int dts_position      = -1;
+    auto const &index = m_index.get_audio(aid);
+    auto chunk_idx    = 0u;
+    int dts_position  = -1;
     mtx::bytes::buffer_c buffer;
     mtx::dts::header_t dtsheader;
 
-    while ((-1 == dts_position) && (10 > num_read)) {
-      int chunk_size = AVI_read_audio_chunk(m_avi, nullptr);
-
-      if (0 < chunk_size) {
-        memory_cptr chunk = memory_c::alloc(chunk_size);
-        AVI_read_audio_chunk(m_avi, reinterpret_cast<char *>(chunk->get_buffer()));
+    while (-1 == dts_position) {
+      auto chunk = chunk_idx < index.size() ? read_indexed_chunk(index, chunk_idx++) : memory_cptr{};
 
+      if (chunk && chunk->get_size()) {
         buffer.add(*chunk);
         dts_position = mtx::dts::find_header(buffer.get_buffer(), buffer.get_size(), dtsheader);
 
@@ -593,8 +624,6 @@ avi_reader_c::create_dts_packetizer(int aid) {
     if (-1 == dts_position)
       throw false;
 
-    AVI_set_audio_position_index(m_avi, audio_position);
-
     return new dts_packetizer_c(this, m_ti, dtsheader);
 
   } catch (...) {
@@ -657,26 +686,20 @@ void
 avi_reader_c::set_avc_nal_size_size(avc_es_video_packetizer_c *ptzr) {
   m_avc_nal_size_size = ptzr->get_nalu_size_length();
 
-  for (int i = 0; i < static_cast<int>(m_max_video_frames); ++i) {
-    int size = AVI_frame_size(m_avi, i);
-    if (0 == size)
+  for (auto i = 0u; i < m_max_video_frames; ++i) {
+    if (0 == m_index.get_video().get_size(i))
       continue;
 
-    memory_cptr buffer = memory_c::alloc(size);
+    auto buffer = read_indexed_chunk(m_index.get_video(), i);
 
-    AVI_set_video_position(m_avi, i);
-    int key = 0;
-    size    = AVI_read_frame(m_avi, reinterpret_cast<char *>(buffer->get_buffer()), &key);
-
-    if (   (4 <= size)
+    if (   buffer
+        && (4 <= buffer->get_size())
         && (   (get_uint32_be(buffer->get_buffer()) == NALU_START_CODE)
             || (get_uint24_be(buffer->get_buffer()) == NALU_START_CODE)))
       m_avc_nal_size_size = -1;
 
     break;
   }
-
-  AVI_set_video_position(m_avi, 0);
 }
 
 file_status_e
@@ -684,27 +707,29 @@ avi_reader_c::read_video() {
   if (m_video_frames_read >= m_max_video_frames)
     return flush_packetizer(m_vptzr);
 
+  auto const &index         = m_index.get_video();
   memory_cptr chunk;
-  int key                   = 0;
+  bool key                  = false;
   int old_video_frames_read = m_video_frames_read;
 
-  int size, num_read;
+  int num_read;
 
   int dropped_frames_here   = 0;
 
   do {
-    size  = AVI_frame_size(m_avi, m_video_frames_read);
-    chunk = memory_c::alloc(size);
-    num_read = AVI_read_frame(m_avi, reinterpret_cast<char *>(chunk->get_buffer()), &key);
+    key   = index.is_key(m_video_frames_read);
+    chunk = read_indexed_chunk(index, m_video_frames_read);
 
     ++m_video_frames_read;
 
-    if (0 > num_read) {
+    if (!chunk) {
       // Error reading the frame: abort
       m_video_frames_read = m_max_video_frames;
       return flush_packetizer(m_vptzr);
+    }
 
-    } else if (0 == num_read)
+    num_read = chunk->get_size();
+    if (0 == num_read)
       ++dropped_frames_here;
 
   } while ((0 == num_read) && (m_video_frames_read < m_max_video_frames));
@@ -713,13 +738,7 @@ avi_reader_c::read_video() {
     // This is only the case if the AVI contains dropped frames only.
     return flush_packetizer(m_vptzr);
 
-  size_t i;
-  for (i = m_video_frames_read; i < m_max_video_frames; ++i) {
-    if (0 != AVI_frame_size(m_avi, i))
-      break;
-
-    int dummy_key;
-    AVI_read_frame(m_avi, nullptr, &dummy_key);
+  while ((m_video_frames_read < m_max_video_frames) && (0 == index.get_size(m_video_frames_read))) {
     ++dropped_frames_here;
     ++m_video_frames_read;
   }
@@ -761,38 +780,32 @@ avi_reader_c::read_video() {
 
 file_status_e
 avi_reader_c::read_audio(avi_demuxer_t &demuxer) {
-  AVI_set_audio_track(m_avi, demuxer.m_aid);
-
-  while (true) {
-    int size = AVI_audio_size(m_avi, AVI_get_audio_position_index(m_avi));
+  auto const &index = m_index.get_audio(demuxer.m_aid);
 
-    // -1 indicates the last chunk.
-    if (-1 == size)
-      return flush_packetizer(demuxer.m_ptzr);
+  while (demuxer.m_chunk < index.size()) {
+    auto size = index.get_size(demuxer.m_chunk);
 
     // Sanity check. Ignore chunks with obvious wrong size information
     // (> 10 MB). Also skip 0-sized blocks. Those are officially
     // skipped.
     if (!size || (size > AVI_MAX_AUDIO_CHUNK_SIZE)) {
-      AVI_set_audio_position_index(m_avi, AVI_get_audio_position_index(m_avi) + 1);
+      ++demuxer.m_chunk;
       continue;
     }
 
-    auto chunk = memory_c::alloc(size);
-    size       = AVI_read_audio_chunk(m_avi, reinterpret_cast<char *>(chunk->get_buffer()));
+    auto chunk = read_indexed_chunk(index, demuxer.m_chunk++);
 
-    if (0 > size)
+    if (!chunk)
       return flush_packetizer(demuxer.m_ptzr);
 
-    if (!size)
-      continue;
-
     PTZR(demuxer.m_ptzr)->process(new packet_t(chunk));
 
     m_bytes_processed += size;
 
-    return AVI_get_audio_position_index(m_avi) < AVI_max_audio_chunk(m_avi) ? FILE_STATUS_MOREDATA : flush_packetizer(demuxer.m_ptzr);
+    return demuxer.m_chunk < index.size() ? FILE_STATUS_MOREDATA : flush_packetizer(demuxer.m_ptzr);
   }
+
+  return flush_packetizer(demuxer.m_ptzr);
 }
 
 file_status_e
@@ -803,6 +816,106 @@ avi_reader_c::read_subtitles(avi_subs_demuxer_t &demuxer) {
   return demuxer.m_subs->empty() ? flush_packetizer(demuxer.m_ptzr) : FILE_STATUS_MOREDATA;
 }
 
+memory_cptr
+avi_reader_c::read_indexed_chunk(mtx::avi::chunk_index_c const &index,
+                                 std::size_t idx) {
+  auto size  = index.get_size(idx);
+  auto chunk = memory_c::alloc(size);
+
+  if (size && !read_chunk(index.get_position(idx), chunk->get_buffer(), size))
+    return {};
+
+  return chunk;
+}
+
+/* Chunks not found in the chunk cache are read together with the
+   upcoming chunks of all streams located near them. */
+bool
+avi_reader_c::read_chunk(uint64_t position,
+                         unsigned char *buffer,
+                         std::size_t size) {
+  if (m_chunk_cache.get(position, buffer, size))
+    return true;
+
+  auto end = determine_coalesced_read_end(position, position + size);
+
+  try {
+    if (m_in->getFilePointer() != position)
+      ++m_num_seeks;
+
+    m_in->setFilePointer(position);
+
+    if (end == (position + size)) {
+      ++m_num_direct_reads;
+      return m_in->read(buffer, size) == size;
+    }
+
+    auto block    = memory_c::alloc(end - position);
+    auto num_read = m_in->read(block->get_buffer(), end - position);
+
+    block->set_size(num_read);
+
+    ++m_num_chunk_reads;
+    m_num_chunk_bytes_read += num_read;
+
+    if (num_read < size)
+      return false;
+
+    std::memcpy(buffer, block->get_buffer(), size);
+    m_chunk_cache.add(position, block);
+
+    return true;
+
+  } catch (mtx::mm_io::exception &) {
+  }
+
+  return false;
+}
+
+uint64_t
+avi_reader_c::determine_coalesced_read_end(uint64_t position,
+                                           uint64_t end)
+  const {
+  if ((end - position) > (CHUNK_CACHE_MAX_READ_SIZE / 2))
+    return end;
+
+  auto const max_end = position + CHUNK_CACHE_MAX_READ_SIZE;
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+
+  auto add_upcoming_chunks = [&ranges, position, max_end](mtx::avi::chunk_index_c const &index, std::size_t first) {
+    auto const last = std::min<std::size_t>(index.size(), first + CHUNK_CACHE_MAX_LOOKAHEAD);
+
+    for (auto idx = first; idx < last; ++idx) {
+      auto const start     = index.get_position(idx);
+      auto const chunk_end = start + index.get_size(idx);
+
+      if (chunk_end > max_end)
+        break;
+
+      if (start >= position)
+        ranges.emplace_back(start, chunk_end);
+    }
+  };
+
+  if (-1 != m_vptzr)
+    add_upcoming_chunks(m_index.get_video(), m_video_frames_read);
+
+  for (auto const &demuxer : m_audio_demuxers)
+    if (-1 != demuxer.m_ptzr)
+      add_upcoming_chunks(m_index.get_audio(demuxer.m_aid), demuxer.m_chunk);
+
+  brng::sort(ranges);
+
+  for (auto const &range : ranges) {
+    if (range.first > (end + CHUNK_CACHE_MAX_GAP))
+      break;
+
+    end = std::max(end, range.second);
+  }
+
+  return end;
+}
+
 file_status_e
 avi_reader_c::read(generic_packetizer_c *ptzr,
                    bool) {
@@ -832,15 +945,15 @@ avi_reader_c::get_maximum_progress() {
 
 void
 avi_reader_c::extended_identify_mpeg4_l2(mtx::id::info_c &info) {
-  int size = AVI_frame_size(m_avi, 0);
-  if (0 >= size)
+  if (m_index.get_video().empty() || !m_index.get_video().get_size(0))
     return;
 
-  memory_cptr af_buffer = memory_c::alloc(size);
-  unsigned char *buffer = af_buffer->get_buffer();
-  int dummy_key;
+  auto af_buffer = read_indexed_chunk(m_index.get_video(), 0);
+  if (!af_buffer)
+    return;
 
-  AVI_read_frame(m_avi, reinterpret_cast<char *>(buffer), &dummy_key);
+  unsigned char *buffer = af_buffer->get_buffer();
+  auto size             = af_buffer->get_size();
 
   uint32_t par_num, par_den;
   if (mpeg4::p2::extract_par(buffer, size, par_num, par_den)) {
@@ -962,14 +1075,9 @@ avi_reader_c::add_available_track_ids() {
 
 void
 avi_reader_c::debug_dump_video_index() {
-  int num_video_frames = AVI_video_frames(m_avi), i;
-
-  mxinfo(fmt::format("AVI video index dump: {0} entries; frame rate: {1}\n", num_video_frames, m_fps));
-  for (i = 0; num_video_frames > i; ++i) {
-    int key = 0;
-    AVI_read_frame(m_avi, nullptr, &key);
-    mxinfo(fmt::format("  {0}: {1} bytes; key: {2}\n", i, AVI_frame_size(m_avi, i), key));
-  }
+  auto const &index = m_index.get_video();
 
-  AVI_set_video_position(m_avi, 0);
+  mxinfo(fmt::format("AVI video index dump: {0} entries; frame rate: {1}\n", index.size(), m_fps));
+  for (auto i = 0u; index.size() > i; ++i)
+    mxinfo(fmt::format("  {0}: {1} bytes at {2}; key: {3}\n", i, index.get_size(i), index.get_position(i), index.is_key(i) ? 1 : 0));
 }
@@ -16,9 +16,11 @@
 #include "common/common_pch.h"
 
 #include "avilib.h"
+#include "common/avi_index.h"
 #include "common/codec.h"
 #include "merge/generic_reader.h"
 #include "common/error.h"
+#include "input/chunk_cache.h"
 #include "input/subtitles.h"
 
 namespace mtx { namespace id {
@@ -31,6 +33,7 @@ struct avi_demuxer_t {
   int m_ptzr{-1};
   int m_channels{}, m_bits_per_sample{}, m_samples_per_second{}, m_aid{};
   int64_t m_bytes_processed{};
+  std::size_t m_chunk{};
   codec_c m_codec;
 };
 
@@ -61,6 +64,7 @@ private:
 
   divx_type_e m_divx_type{DIVX_TYPE_NONE};
   avi_t *m_avi{};
+  mtx::avi::index_c m_index;
   int m_vptzr{-1};
   std::vector<avi_demuxer_t> m_audio_demuxers;
   std::vector<avi_subs_demuxer_t> m_subtitle_demuxers;
@@ -72,6 +76,11 @@ private:
   uint64_t m_bytes_to_process{}, m_bytes_processed{};
   bool m_video_track_ok{};
 
+  chunk_cache_c m_chunk_cache;
+  uint64_t m_num_chunk_reads{}, m_num_chunk_bytes_read{}, m_num_direct_reads{}, m_num_seeks{};
+
+  debugging_option_c m_debug_index, m_debug_chunk_cache;
+
 public:
   avi_reader_c(const track_info_c &ti, const mm_io_cptr &in);
   virtual ~avi_reader_c();
@@ -97,6 +106,11 @@ protected:
   virtual file_status_e read_audio(avi_demuxer_t &demuxer);
   virtual file_status_e read_subtitles(avi_subs_demuxer_t &demuxer);
 
+  virtual void load_index();
+  virtual memory_cptr read_indexed_chunk(mtx::avi::chunk_index_c const &index, std::size_t idx);
+  virtual bool read_chunk(uint64_t position, unsigned char *buffer, std::size_t size);
+  virtual uint64_t determine_coalesced_read_end(uint64_t position, uint64_t end) const;
+
   virtual generic_packetizer_c *create_aac_packetizer(int aid, avi_demuxer_t &demuxer);
   virtual generic_packetizer_c *create_dts_packetizer(int aid);
   virtual generic_packetizer_c *create_vorbis_packetizer(int aid);
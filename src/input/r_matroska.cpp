@@ -2315,6 +2315,18 @@ kax_reader_c::finish_file() {
   return FILE_STATUS_DONE;
 }
 
+/* Used for passthrough tracks whose frames aren't parsed. Bytes removed
+   by header removal compression are put in front of the frame as a
+   separate slice instead of copying the frame. */
+memory_slices_c
+kax_reader_c::reverse_content_encodings(kax_track_t &track,
+                                        DataBuffer &data_buffer) {
+  memory_slices_c slices{ { memory_c::borrow(data_buffer.Buffer(), data_buffer.Size()), 0, data_buffer.Size() } };
+  track.content_decoder.reverse(slices, CONTENT_ENCODING_SCOPE_BLOCK);
+
+  return slices;
+}
+
 void
 kax_reader_c::process_simple_block(KaxCluster *cluster,
                                    KaxSimpleBlock *block_simple) {
@@ -2363,11 +2375,8 @@ kax_reader_c::process_simple_block(KaxCluster *cluster,
     // and stuff. Just pass everything through as it is.
     size_t i;
     for (i = 0; block_simple->NumberFrames() > i; ++i) {
-      DataBuffer &data_buffer = block_simple->GetBuffer(i);
-      auto data = memory_c::borrow(data_buffer.Buffer(), data_buffer.Size());
-      block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
-
-      packet_cptr packet(new packet_t(data, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref));
+      packet_cptr packet(new packet_t(memory_cptr{}, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref));
+      packet->set_data_slices(reverse_content_encodings(*block_track, block_simple->GetBuffer(i)));
       packet->key_flag         = key_flag;
       packet->discardable_flag = discardable_flag;
 
@@ -2489,12 +2498,9 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
 
     size_t i;
     for (i = 0; i < block->NumberFrames(); i++) {
-      auto &data_buffer = block->GetBuffer(i);
-      auto data         = memory_c::borrow(data_buffer.Buffer(), data_buffer.Size());
-      block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
-
-      auto packet                = std::make_shared<packet_t>(data, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref);
+      auto packet                = std::make_shared<packet_t>(memory_cptr{}, m_last_timestamp + i * frame_duration, block_duration, block_bref, block_fref);
       packet->duration_mandatory = duration;
+      packet->set_data_slices(reverse_content_encodings(*block_track, block->GetBuffer(i)));
 
       process_block_group_common(block_group, packet.get(), *block_track);
 
@@ -18,7 +18,9 @@
 #include "common/debugging.h"
 #include "common/endian.h"
 #include "common/error.h"
+#include "common/fs_sys_helpers.h"
 #include "common/id_info.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/mp3.h"
 #include "common/mpeg1_2.h"
 #include "common/mpeg4_p2.h"
@@ -87,10 +89,15 @@ mpeg_ps_reader_c::mpeg_ps_reader_c(const track_info_c &ti,
   : generic_reader_c(ti, in)
   , file_done(false)
   , m_probe_range{}
+  , m_use_probe_packet_positions{}
+  , m_num_packets_read{}
+  , m_num_bytes_read{}
+  , m_reading_start_time{-1}
   , m_debug_timestamps{"mpeg_ps|mpeg_ps_timestamps"}
   , m_debug_headers{   "mpeg_ps|mpeg_ps_headers"}
   , m_debug_packets{   "mpeg_ps|mpeg_ps_packets"}
   , m_debug_resync{    "mpeg_ps|mpeg_ps_resync"}
+  , m_debug_statistics{"mpeg_ps|mpeg_ps_statistics"}
 {
 }
 
@@ -101,14 +108,23 @@ mpeg_ps_reader_c::read_headers() {
 
     if (!m_ti.m_disable_multi_file && boost::regex_search(bfs::path{m_ti.m_fname}.filename().string(), boost::regex{"^vts_\\d+_\\d+", boost::regex::icase | boost::regex::perl})) {
       m_in.reset();               // Close the source file first before opening it a second time.
-      m_in = mm_multi_file_io_c::open_multi(m_ti.m_fname, false);
+      m_in = std::make_shared<mm_read_buffer_io_c>(mm_multi_file_io_c::open_multi(m_ti.m_fname, false));
     }
 
+    // Pack & PES headers are small. Parse them from a large window
+    // instead of reading each one from the file.
+    auto buffered_in = dynamic_cast<mm_read_buffer_io_c *>(m_in.get());
+    if (buffered_in)
+      buffered_in->set_buffer_size(1024 * 1024);
+
     m_size          = m_in->get_size();
     m_probe_range   = calculate_probe_range(m_size, 10 * 1024 * 1024);
+    version         = -1;
+
+    index_packets_for_probing();
+
     uint32_t header = m_in->read_uint32_be();
     bool done       = m_in->eof();
-    version         = -1;
 
     while (!done) {
       uint8_t stream_id;
@@ -186,6 +202,9 @@ mpeg_ps_reader_c::read_headers() {
   } catch (...) {
   }
 
+  m_use_probe_packet_positions = false;
+  m_probe_packet_positions.clear();
+
   sort_tracks();
   calculate_global_timestamp_offset();
 
@@ -202,6 +221,41 @@ mpeg_ps_reader_c::read_headers() {
 mpeg_ps_reader_c::~mpeg_ps_reader_c() {
 }
 
+// Determining a new stream's parameters may require the data of
+// several of its packets. Recording where all packets within the probe
+// range are located once avoids scanning the file again for each new
+// stream.
+void
+mpeg_ps_reader_c::index_packets_for_probing() {
+  m_probe_packet_positions.clear();
+
+  try {
+    mpeg_ps_id_t id;
+    while (find_next_packet(id, m_probe_range)) {
+      m_probe_packet_positions[id.id].push_back(m_in->getFilePointer() - 4);
+      m_in->skip(m_in->read_uint16_be());
+    }
+
+  } catch (...) {
+  }
+
+  // The program stream maps are parsed again in the order they occur
+  // in while reading the headers.
+  es_map.clear();
+
+  m_use_probe_packet_positions = true;
+
+  if (m_debug_headers) {
+    auto num_packets = 0u;
+    for (auto const &positions : m_probe_packet_positions)
+      num_packets += positions.second.size();
+
+    mxdebug(fmt::format("mpeg_ps: indexed {0} packets of {1} stream IDs up to position {2}\n", num_packets, m_probe_packet_positions.size(), m_in->getFilePointer()));
+  }
+
+  m_in->setFilePointer(0);
+}
+
 void
 mpeg_ps_reader_c::sort_tracks() {
   size_t i;
@@ -1187,6 +1241,17 @@ mpeg_ps_reader_c::find_next_packet(mpeg_ps_id_t &id,
 bool
 mpeg_ps_reader_c::find_next_packet_for_id(mpeg_ps_id_t id,
                                           int64_t max_file_pos) {
+  if (m_use_probe_packet_positions && (static_cast<int64_t>(m_probe_range) == max_file_pos)) {
+    auto &positions = m_probe_packet_positions[id.id];
+    auto itr        = std::lower_bound(positions.begin(), positions.end(), static_cast<int64_t>(m_in->getFilePointer()));
+
+    if (itr == positions.end())
+      return false;
+
+    m_in->setFilePointer(*itr + 4);
+    return true;
+  }
+
   try {
     mpeg_ps_id_t new_id;
     while (find_next_packet(new_id, max_file_pos)) {
@@ -1204,16 +1269,29 @@ mpeg_ps_reader_c::resync_stream(uint32_t &header) {
   mxdebug_if(m_debug_resync, fmt::format("MPEG PS: synchronisation lost at {0}; looking for start code\n", m_in->getFilePointer()));
 
   try {
+    unsigned char buffer[4096];
+
     while (1) {
-      header <<= 8;
-      header  |= m_in->read_uint8();
-      if (mpeg_is_start_code(header))
-        break;
-    }
+      auto block_start = m_in->getFilePointer();
+      auto num_read    = m_in->read(buffer, sizeof(buffer));
 
-    mxdebug_if(m_debug_resync, fmt::format("resync succeeded at {0}, header 0x{1:08x}\n", m_in->getFilePointer() - 4, header));
+      if (!num_read) {
+        mxdebug_if(m_debug_resync, "resync failed: end of file reached\n");
+        return false;
+      }
 
-    return true;
+      for (auto idx = 0u; idx < num_read; ++idx) {
+        header = (header << 8) | buffer[idx];
+        if (!mpeg_is_start_code(header))
+          continue;
+
+        m_in->setFilePointer(block_start + idx + 1);
+
+        mxdebug_if(m_debug_resync, fmt::format("resync succeeded at {0}, header 0x{1:08x}\n", m_in->getFilePointer() - 4, header));
+
+        return true;
+      }
+    }
 
   } catch (...) {
     mxdebug_if(m_debug_resync, "resync failed: exception caught\n");
@@ -1308,6 +1386,9 @@ mpeg_ps_reader_c::read(generic_packetizer_c *requested_ptzr,
   if (file_done)
     return flush_packetizers();
 
+  if (-1 == m_reading_start_time)
+    m_reading_start_time = mtx::sys::get_current_time_millis();
+
   auto num_queued_bytes = get_queued_bytes();
   if (!force && (20 * 1024 * 1024 < num_queued_bytes)) {
     mpeg_ps_track_ptr requested_ptzr_track = m_ptzr_to_track_map[requested_ptzr];
@@ -1339,6 +1420,9 @@ mpeg_ps_reader_c::read(generic_packetizer_c *requested_ptzr,
 
       auto track = tracks[id2idx[new_id.idx()]];
 
+      ++m_num_packets_read;
+      m_num_bytes_read += packet.m_length;
+
       int64_t timestamp = packet.has_pts() ? packet.pts() : -1;
       if ((-1 != timestamp) && track->provide_timestamps)
         timestamp = std::max<int64_t>(timestamp - global_timestamp_offset, -1);
@@ -1410,6 +1494,12 @@ mpeg_ps_reader_c::finish() {
 
   file_done = true;
 
+  if (m_debug_statistics && (-1 != m_reading_start_time)) {
+    auto duration = std::max<int64_t>(mtx::sys::get_current_time_millis() - m_reading_start_time, 1);
+    mxdebug(fmt::format("mpeg_ps: statistics: {0} packets with {1} bytes of payload read from {2} bytes in {3} ms ({4:.1f} MB/s)\n",
+                        m_num_packets_read, m_num_bytes_read, m_size, duration, m_size * 1000.0 / duration / 1024 / 1024));
+  }
+
   return flush_packetizers();
 }
 
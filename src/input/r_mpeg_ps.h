@@ -205,7 +205,15 @@ private:
 
   uint64_t m_probe_range;
 
-  debugging_option_c m_debug_timestamps, m_debug_headers, m_debug_packets, m_debug_resync;
+  // Positions of the PES packets within the probe range by stream ID;
+  // only used while reading the headers.
+  std::unordered_map<int, std::vector<int64_t>> m_probe_packet_positions;
+  bool m_use_probe_packet_positions;
+
+  uint64_t m_num_packets_read, m_num_bytes_read;
+  int64_t m_reading_start_time;
+
+  debugging_option_c m_debug_timestamps, m_debug_headers, m_debug_packets, m_debug_resync, m_debug_statistics;
 
 public:
   mpeg_ps_reader_c(const track_info_c &ti, const mm_io_cptr &in);
@@ -247,6 +255,7 @@ private:
   virtual void new_stream_a_truehd(mpeg_ps_id_t id, unsigned char *buf, unsigned int length, mpeg_ps_track_ptr &track);
   virtual bool resync_stream(uint32_t &header);
   virtual file_status_e finish();
+  void index_packets_for_probing();
   void sort_tracks();
   void calculate_global_timestamp_offset();
 };
@@ -2376,6 +2376,51 @@ reader_c::create_packetizers() {
   mxdebug_if(m_debug_headers, fmt::format("create_packetizers: create packetizers...\n"));
   for (int i = 0, end = m_tracks.size(); i < end; ++i)
     create_packetizer(i);
+
+  seek_to_start_of_first_kept_part();
+}
+
+/* When splitting in 'parts:' mode everything before the start of the
+   first part is discarded anyway. If the clip info's EP map is
+   available for the video track, reading can start at the last entry
+   point a bit before that part instead of at the start of the file. */
+void
+reader_c::seek_to_start_of_first_kept_part() {
+  if (!g_cluster_helper || m_appending || (m_files.size() != 1) || !m_ti.m_timestamp_syncs.empty() || !m_ti.m_reset_timestamps_specs.empty())
+    return;
+
+  auto start = g_cluster_helper->get_start_of_first_kept_part();
+  auto &f    = *m_files[0];
+
+  if (!start.valid() || !f.m_clpi_parser || !f.m_global_timestamp_offset.valid() || (f.m_detected_packet_size != 192))
+    return;
+
+  mtx::bluray::clpi::ep_map_t const *ep_map{};
+  for (auto const &track : m_tracks)
+    if ((pid_type_e::video == track->type) && (-1 != track->ptzr) && (ep_map = f.m_clpi_parser->find_ep_map(track->pid)))
+      break;
+
+  if (!ep_map)
+    return;
+
+  // Entry points are only sorted if the timestamps don't wrap within
+  // the clip.
+  auto is_sorted = std::is_sorted(ep_map->entries.begin(), ep_map->entries.end(), [](auto const &a, auto const &b) { return a.pts < b.pts; });
+  auto target    = f.m_global_timestamp_offset + start - timestamp_c::s(1);
+  auto entry     = is_sorted ? ep_map->find_entry_at_or_before(target) : boost::none;
+
+  mxdebug_if(m_debug_clpi, fmt::format("seek_to_start_of_first_kept_part: start {0} target PTS {1} EP map PID {2} sorted {3} entry found {4} PTS {5} SPN {6}\n",
+                                       start, target, ep_map->pid, is_sorted, !!entry, entry ? entry->pts : timestamp_c{}, entry ? entry->spn : 0));
+
+  if (!entry || !entry->spn)
+    return;
+
+  auto position = static_cast<uint64_t>(entry->spn) * f.m_detected_packet_size;
+  if (position >= static_cast<uint64_t>(f.m_in->get_size()))
+    return;
+
+  f.m_in->setFilePointer(position);
+  m_bytes_processed += position;
 }
 
 void
@@ -2485,17 +2530,19 @@ reader_c::parse_clip_info_file(std::size_t file_idx) {
   if (clpi_file.empty())
     return;
 
-  mtx::bluray::clpi::parser_c parser(clpi_file.string());
-  if (!parser.parse())
+  auto parser = std::make_shared<mtx::bluray::clpi::parser_c>(clpi_file.string());
+  if (!parser->parse())
     return;
 
+  file.m_clpi_parser = parser;
+
   for (auto &track : m_tracks) {
     if (track->m_file_num != file_idx)
       continue;
 
     bool found = false;
 
-    for (auto &program : parser.m_programs) {
+    for (auto &program : parser->m_programs) {
       for (auto &stream : program->program_streams) {
         if ((stream->pid != track->pid) || stream->language.empty())
           continue;
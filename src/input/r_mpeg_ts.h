@@ -18,6 +18,7 @@
 
 #include "common/aac.h"
 #include "common/avc_es_parser.h"
+#include "common/bluray/clpi.h"
 #include "common/byte_buffer.h"
 #include "common/codec.h"
 #include "common/endian.h"
@@ -408,6 +409,8 @@ struct file_t {
 
   bool m_file_done, m_packet_sent_to_packetizer;
 
+  mtx::bluray::clpi::parser_cptr m_clpi_parser;
+
   unsigned int m_detected_packet_size, m_num_pat_crc_errors, m_num_pmt_crc_errors;
   bool m_validate_pat_crc, m_validate_pmt_crc, m_has_audio_or_video_track;
 
@@ -505,6 +508,7 @@ private:
   void determine_global_timestamp_offset();
 
   void parse_clip_info_file(std::size_t file_idx);
+  void seek_to_start_of_first_kept_part();
 
   void add_external_files_from_mpls(mm_mpls_multi_file_io_c &mpls_in);
   void add_programs_to_identification_info(mtx::id::info_c &info);
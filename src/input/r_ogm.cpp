@@ -52,7 +52,8 @@
 #include "output/p_vorbis.h"
 #include "output/p_vpx.h"
 
-#define BUFFER_SIZE 4096
+// Pages are read in large chunks directly into libogg's sync buffer.
+#define BUFFER_SIZE (256 * 1024)
 
 struct ogm_frame_t {
   memory_cptr mem;
@@ -338,6 +339,11 @@ ogm_reader_c::read_headers() {
 
   ogg_sync_init(&oy);
 
+  // libogg's sync buffer is large enough; reading through another
+  // buffer would only copy all of the data once more.
+  m_in->enable_buffering(false);
+  m_in->setFilePointer(0);
+
   show_demuxer_info();
 
   if (read_headers_internal() <= 0)
@@ -365,10 +371,13 @@ ogm_reader_c::find_demuxer(int serialno) {
 
 /*
    Reads an OGG page from the stream. Returns 0 if there are no more pages
-   left, EMOREDATA otherwise.
+   left, EMOREDATA otherwise. If 'buffered_only' is set then only pages
+   already in the sync buffer are returned, and 0 means that more data
+   would have to be read.
 */
 int
-ogm_reader_c::read_page(ogg_page *og) {
+ogm_reader_c::read_page(ogg_page *og,
+                        bool buffered_only) {
   int np, done, nread;
   unsigned char *buf;
 
@@ -382,6 +391,12 @@ ogm_reader_c::read_page(ogg_page *og) {
       if (0 > np)
         mxwarn_fn(m_ti.m_fname, Y("Could not find the next Ogg page. This indicates a damaged Ogg/Ogm file. Will try to continue.\n"));
 
+      if (buffered_only) {
+        if (0 > np)
+          continue;
+        return 0;
+      }
+
       buf = (unsigned char *)ogg_sync_buffer(&oy, BUFFER_SIZE);
       if (!buf)
         mxerror_fn(m_ti.m_fname, Y("ogg_sync_buffer failed\n"));
@@ -686,23 +701,30 @@ ogm_reader_c::read(generic_packetizer_c *,
   if (get_queued_bytes() > 20 * 1024 * 1024)
     return FILE_STATUS_HOLDING;
 
+  // Are there streams that have not finished yet?
+  auto streams_left = [this]() {
+    return std::any_of(sdemuxers.begin(), sdemuxers.end(), [](ogm_demuxer_cptr const &dmx) { return !dmx->eos && dmx->in_use; });
+  };
+
   ogg_page og;
+  auto num_pages = 0u;
 
-  do {
-    // Make sure we have a page that we can work with.
-    if (read_page(&og) == FILE_STATUS_DONE)
-      return flush_packetizers();
+  // Process all pages from the chunk read last before reading the next
+  // one.
+  while (read_page(&og, 0 < num_pages) != FILE_STATUS_DONE) {
+    ++num_pages;
 
     // Is this the first page of a new stream? No, so process it normally.
-    if (!ogg_page_bos(&og))
+    if (!ogg_page_bos(&og)) {
       process_page(&og);
-  } while (ogg_page_bos(&og));
 
-  size_t i;
-  // Are there streams that have not finished yet?
-  for (i = 0; i < sdemuxers.size(); i++)
-    if (!sdemuxers[i]->eos && sdemuxers[i]->in_use)
-      return FILE_STATUS_MOREDATA;
+      if (!streams_left())
+        break;
+    }
+  }
+
+  if (num_pages && streams_left())
+    return FILE_STATUS_MOREDATA;
 
   // No, we're done with this file.
   return flush_packetizers();
@@ -1225,7 +1247,7 @@ ogm_a_opus_demuxer_c::process_page(int64_t granulepos) {
       continue;
 
     try {
-      auto packet    = std::make_shared<packet_t>(memory_c::clone(op.packet, op.bytes));
+      auto packet    = std::make_shared<packet_t>(memory_c::borrow(op.packet, op.bytes));
       auto toc       = mtx::opus::toc_t::decode(packet->data);
       page_duration += toc.packet_duration;
 
@@ -1480,7 +1502,7 @@ ogm_v_mscomp_demuxer_c::process_page(int64_t granulepos) {
       duration = 1;
 
     ogm_frame_t frame = {
-      memory_c::clone(&op.packet[duration_len + 1], op.bytes - 1 - duration_len),
+      memory_c::borrow(&op.packet[duration_len + 1], op.bytes - 1 - duration_len),
       duration * default_duration,
       op.packet[0],
     };
@@ -1649,7 +1671,7 @@ ogm_v_vp8_demuxer_c::process_page(int64_t granulepos) {
     eos |= op.e_o_s;
 
     if ((units_processed > 0) || !is_header_packet(op))
-      packets.push_back(memory_c::clone(op.packet, op.bytes));
+      packets.push_back(memory_c::borrow(op.packet, op.bytes));
   }
 
   if (packets.empty())
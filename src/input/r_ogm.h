@@ -101,7 +101,7 @@ public:
 private:
   virtual ogm_demuxer_cptr find_demuxer(int serialno);
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false) override;
-  virtual int read_page(ogg_page *);
+  virtual int read_page(ogg_page *og, bool buffered_only = false);
   virtual void handle_new_stream(ogg_page *);
   virtual void handle_new_stream_and_packets(ogg_page *);
   virtual void process_page(ogg_page *);
@@ -67,6 +67,12 @@ using namespace libmatroska;
 
 #define MAX_INTERLEAVING_BADNESS 0.4
 
+// Limits for reading samples located near each other at once
+#define CHUNK_CACHE_SIZE          (32 * 1024 * 1024)
+#define CHUNK_CACHE_MAX_READ_SIZE ( 4 * 1024 * 1024)
+#define CHUNK_CACHE_MAX_GAP       (64 * 1024)
+#define CHUNK_CACHE_MAX_LOOKAHEAD 1024
+
 namespace mtx {
 
 class atom_chunk_size_x: public exception {
@@ -194,12 +200,15 @@ qtmp4_reader_c::qtmp4_reader_c(const track_info_c &ti,
   , m_fragment{}
   , m_track_for_fragment{}
   , m_timestamps_calculated{}
+  , m_chunk_cache{CHUNK_CACHE_SIZE}
   , m_debug_chapters{    "qtmp4|qtmp4_full|qtmp4_chapters"}
   , m_debug_headers{     "qtmp4|qtmp4_full|qtmp4_headers"}
   , m_debug_tables{            "qtmp4_full|qtmp4_tables|qtmp4_tables_full"}
   , m_debug_tables_full{                               "qtmp4_tables_full"}
   , m_debug_interleaving{"qtmp4|qtmp4_full|qtmp4_interleaving"}
   , m_debug_resync{      "qtmp4|qtmp4_full|qtmp4_resync"}
+  , m_debug_chunk_cache{ "qtmp4|qtmp4_full|qtmp4_chunk_cache"}
+  , m_debug_fragments{   "qtmp4|qtmp4_full|qtmp4_fragments"}
 {
 }
 
@@ -219,10 +228,19 @@ qtmp4_reader_c::read_headers() {
 }
 
 qtmp4_reader_c::~qtmp4_reader_c() {
+  mxdebug_if(m_debug_chunk_cache,
+             fmt::format("Chunk cache: {0} samples served from the cache, {1} not cached; {2} coalesced reads of {3} bytes in total; {4} samples read directly; {5} reads required seeking\n",
+                         m_chunk_cache.get_num_hits(), m_chunk_cache.get_num_misses(), m_num_chunk_reads, m_num_chunk_bytes_read, m_num_direct_reads, m_num_seeks));
 }
 
 void
 qtmp4_reader_c::calculate_num_bytes_to_process() {
+  // The index of all samples isn't known when streaming fragments.
+  if (m_next_fragment_position) {
+    m_bytes_to_process = m_size;
+    return;
+  }
+
   for (auto const &dmx : m_demuxers)
     if (demuxing_requested(dmx->type, dmx->id, dmx->language))
       m_bytes_to_process += boost::accumulate(dmx->m_index, 0ull, [](int64_t num, auto const &entry) { return num + entry.size; });
@@ -283,6 +301,82 @@ qtmp4_reader_c::resync_to_top_level_atom(uint64_t start_pos) {
   return false;
 }
 
+/* Fragments don't have to be parsed before muxing starts if each track
+   has received samples from the ones parsed so far and the edit lists
+   only shift the timestamps by a constant amount. The remaining
+   fragments are parsed while reading. */
+bool
+qtmp4_reader_c::can_stream_fragments()
+  const {
+  for (auto const &dmx : m_demuxers) {
+    if (dmx->editlist_table.size() > 1)
+      return false;
+
+    if (mtx::includes(m_track_defaults, dmx->container_id) && dmx->chunk_table.empty())
+      return false;
+  }
+
+  return true;
+}
+
+void
+qtmp4_reader_c::read_next_fragments(qtmp4_demuxer_c &dmx) {
+  // Entries already read aren't needed anymore; neither are the
+  // entries of tracks that aren't muxed.
+  for (auto const &demuxer : m_demuxers) {
+    auto num_done = -1 == demuxer->ptzr ? demuxer->m_index.size() : demuxer->pos;
+
+    demuxer->m_index.erase(demuxer->m_index.begin(), demuxer->m_index.begin() + num_done);
+    demuxer->m_num_dropped_index_entries += num_done;
+    demuxer->pos                          = 0;
+  }
+
+  while (m_next_fragment_position && dmx.m_index.empty())
+    parse_next_fragment_atom();
+}
+
+void
+qtmp4_reader_c::parse_next_fragment_atom() {
+  try {
+    if (*m_next_fragment_position >= m_size) {
+      m_next_fragment_position.reset();
+      return;
+    }
+
+    m_in->setFilePointer(*m_next_fragment_position);
+
+    auto atom = read_atom(nullptr, false);
+    mxdebug_if(m_debug_fragments, fmt::format("'{0}' atom, size {1}, at {2}–{3}\n", atom.fourcc, atom.size, atom.pos, atom.pos + atom.size));
+
+    m_next_fragment_position = atom.pos + atom.size;
+
+    if (atom.fourcc == "moof") {
+      handle_moof_atom(atom.to_parent(), 0, atom);
+
+      for (auto const &demuxer : m_demuxers)
+        if (-1 != demuxer->ptzr)
+          demuxer->index_fragment_samples();
+        else
+          demuxer->drop_indexed_tables();
+
+    } else if (!atom.fourcc.human_readable()) {
+      if (resync_to_top_level_atom(atom.pos))
+        m_next_fragment_position = m_in->getFilePointer();
+      else
+        m_next_fragment_position.reset();
+    }
+
+    return;
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(m_debug_fragments, fmt::format("I/O exception while parsing the next fragment: {0}\n", ex.what()));
+  } catch (mtx::atom_chunk_size_x &ex) {
+    mxdebug_if(m_debug_fragments, fmt::format("Atom exception while parsing the next fragment: {0}\n", ex.error()));
+  }
+
+  m_next_fragment_position.reset();
+}
+
 void
 qtmp4_reader_c::parse_headers() {
   unsigned int idx;
@@ -291,6 +385,7 @@ qtmp4_reader_c::parse_headers() {
 
   bool headers_parsed = false;
   bool mdat_found     = false;
+  auto num_moof_atoms = 0u;
 
   try {
     while (!m_in->eof()) {
@@ -319,8 +414,15 @@ qtmp4_reader_c::parse_headers() {
         skip_atom();
         mdat_found = true;
 
+        if (headers_parsed && num_moof_atoms && can_stream_fragments()) {
+          m_next_fragment_position = m_in->getFilePointer();
+          mxdebug_if(m_debug_fragments, fmt::format("Streaming fragments: {0} 'moof' atoms parsed up front; continuing at {1} while reading\n", num_moof_atoms, *m_next_fragment_position));
+          break;
+        }
+
       } else if (atom.fourcc == "moof") {
         handle_moof_atom(atom.to_parent(), 0, atom);
+        ++num_moof_atoms;
 
       } else if (atom.fourcc.human_readable())
         skip_atom();
@@ -419,6 +521,10 @@ qtmp4_reader_c::calculate_timestamps() {
     }
   }
 
+  if (m_next_fragment_position)
+    for (auto &dmx : m_demuxers)
+      dmx->drop_indexed_tables();
+
   m_timestamps_calculated = true;
 }
 
@@ -882,8 +988,8 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
   auto entries = m_in->read_uint32_be();
   auto &track  = *m_track_for_fragment;
 
-  if (track.raw_frame_offset_table.empty() && !track.sample_table.empty())
-    track.raw_frame_offset_table.emplace_back(track.sample_table.size(), 0);
+  if (track.raw_frame_offset_table.empty() && !track.sample_size_table.empty())
+    track.raw_frame_offset_table.emplace_back(track.sample_size_table.size(), 0);
 
   auto data_offset        = flags & QTMP4_TRUN_DATA_OFFSET ? m_in->read_uint32_be() : 0;
   auto first_sample_flags = flags & QTMP4_TRUN_FIRST_SAMPLE_FLAGS ? m_in->read_uint32_be() : m_fragment->sample_flags;
@@ -893,7 +999,7 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
   std::vector<bool> all_keyframe_flags;
 
   track.durmap_table.reserve(track.durmap_table.size() + entries);
-  track.sample_table.reserve(track.sample_table.size() + entries);
+  track.sample_size_table.reserve(track.sample_size_table.size() + entries);
   track.chunk_table.reserve(track.chunk_table.size() + entries);
   track.raw_frame_offset_table.reserve(track.raw_frame_offset_table.size() + entries);
   track.keyframe_table.reserve(track.keyframe_table.size() + entries);
@@ -908,7 +1014,7 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
     auto keyframe        = !track.is_video()                    ? true                   : !(sample_flags & (QTMP4_FRAG_SAMPLE_FLAG_IS_NON_SYNC | QTMP4_FRAG_SAMPLE_FLAG_DEPENDS_YES));
 
     track.durmap_table.emplace_back(1, sample_duration);
-    track.sample_table.emplace_back(sample_size);
+    track.sample_size_table.push_back(sample_size);
     track.chunk_table.emplace_back(1, offset);
     track.raw_frame_offset_table.emplace_back(1, mtx::math::to_signed(ctts_duration));
 
@@ -933,7 +1039,7 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
 
   auto spc                = space((level + 2) * 2 + 1);
   auto durmap_start       = track.durmap_table.size()           - entries;
-  auto sample_start       = track.sample_table.size()           - entries;
+  auto sample_start       = track.sample_size_table.size()      - entries;
   auto chunk_start        = track.chunk_table.size()            - entries;
   auto frame_offset_start = track.raw_frame_offset_table.size() - entries;
   auto end                = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), entries);
@@ -942,9 +1048,9 @@ qtmp4_reader_c::handle_trun_atom(qt_atom_t,
     mxdebug(fmt::format("{0}{1}: duration {2} size {3} data start {4} end {5} pts offset {6} key? {7} raw flags 0x{8:08x}\n",
                         spc, idx,
                         track.durmap_table[durmap_start + idx].duration,
-                        track.sample_table[sample_start + idx].size,
+                        track.sample_size_table[sample_start + idx],
                         track.chunk_table[chunk_start + idx].pos,
-                        (track.sample_table[sample_start + idx].size + track.chunk_table[chunk_start + idx].pos),
+                        (track.sample_size_table[sample_start + idx] + track.chunk_table[chunk_start + idx].pos),
                         track.raw_frame_offset_table[frame_offset_start + idx].offset,
                         static_cast<unsigned int>(all_keyframe_flags[idx]),
                         all_sample_flags[idx]));
@@ -1094,7 +1200,7 @@ qtmp4_reader_c::read_chapter_track() {
   if (m_demuxers.end() == chapter_dmx_itr)
     return;
 
-  if ((*chapter_dmx_itr)->sample_table.empty())
+  if (!(*chapter_dmx_itr)->num_samples)
     return;
 
   std::vector<qtmp4_chapter_entry_t> entries;
@@ -1102,13 +1208,16 @@ qtmp4_reader_c::read_chapter_track() {
   uint64_t pts_scale_num = 1000000000ull                                         / pts_scale_gcd;
   uint64_t pts_scale_den = static_cast<uint64_t>((*chapter_dmx_itr)->time_scale) / pts_scale_gcd;
 
-  entries.reserve((*chapter_dmx_itr)->sample_table.size());
+  entries.reserve((*chapter_dmx_itr)->num_samples);
+
+  auto cursor = (*chapter_dmx_itr)->create_sample_cursor();
+  mtx::mp4::sample_t sample;
 
-  for (auto &sample : (*chapter_dmx_itr)->sample_table) {
+  while (cursor.get_next(sample)) {
     if (2 >= sample.size)
       continue;
 
-    m_in->setFilePointer(sample.pos);
+    m_in->setFilePointer(sample.position);
     memory_cptr chunk(memory_c::alloc(sample.size));
     if (m_in->read(chunk->get_buffer(), sample.size) != sample.size)
       continue;
@@ -1118,7 +1227,7 @@ qtmp4_reader_c::read_chapter_track() {
       continue;
 
     entries.push_back(qtmp4_chapter_entry_t(std::string(reinterpret_cast<char *>(chunk->get_buffer()) + 2, name_len),
-                                            sample.pts * pts_scale_num / pts_scale_den));
+                                            sample.decoding_time * pts_scale_num / pts_scale_den));
   }
 
   recode_chapter_entries(entries);
@@ -1346,28 +1455,26 @@ qtmp4_reader_c::handle_stsz_atom(qtmp4_demuxer_c &dmx,
   uint32_t count       = m_in->read_uint32_be();
 
   if (0 == sample_size) {
-    dmx.sample_table.reserve(dmx.sample_table.size() + count);
+    dmx.sample_size_table.reserve(dmx.sample_size_table.size() + count);
 
     size_t i;
     for (i = 0; i < count; ++i) {
-      qt_sample_t sample;
-
-      sample.size = m_in->read_uint32_be();
+      auto size = m_in->read_uint32_be();
 
       // This is a sanity check against damaged samples. I have one of
       // those in which one sample was suppposed to be > 2GB big.
-      if (sample.size >= 100 * 1024 * 1024)
-        sample.size = 0;
+      if (size >= 100 * 1024 * 1024)
+        size = 0;
 
-      dmx.sample_table.push_back(sample);
+      dmx.sample_size_table.push_back(size);
     }
 
     mxdebug_if(m_debug_headers, fmt::format("{0}Sample size table: {1} entries\n", space(level * 2 + 1), count));
     if (m_debug_tables) {
-      auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), dmx.sample_table.size());
+      auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), dmx.sample_size_table.size());
 
       for (auto idx = 0u; idx < end; ++idx)
-        mxdebug(fmt::format("{0}{1}: size {2}\n", space((level + 1) * 2 + 1), idx, dmx.sample_table[idx].size));
+        mxdebug(fmt::format("{0}{1}: size {2}\n", space((level + 1) * 2 + 1), idx, dmx.sample_size_table[idx]));
     }
 
   } else {
@@ -1559,6 +1666,9 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
     if ((-1 == dmx.ptzr) || (PTZR(dmx.ptzr) != ptzr))
       continue;
 
+    if ((dmx.pos >= dmx.m_index.size()) && m_next_fragment_position)
+      read_next_fragments(dmx);
+
     if (dmx.pos < dmx.m_index.size())
       break;
   }
@@ -1566,16 +1676,16 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   if (m_demuxers.size() == dmx_idx)
     return flush_packetizers();
 
- auto &dmx   = *m_demuxers[dmx_idx];
- auto &index = dmx.m_index[dmx.pos];
-
-  m_in->setFilePointer(index.file_pos);
+ auto &dmx     = *m_demuxers[dmx_idx];
+ auto &index   = dmx.m_index[dmx.pos];
+ auto position = static_cast<uint64_t>(index.file_pos);
 
   int buffer_offset = 0;
   memory_cptr buffer;
 
   if (   dmx.is_video()
       && !dmx.pos
+      && !dmx.m_num_dropped_index_entries
       && dmx.codec.is(codec_c::type_e::V_MPEG4_P2)
       && dmx.esds_parsed
       && (dmx.esds.decoder_config)) {
@@ -1587,7 +1697,7 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   } else if (   dmx.is_video()
              && dmx.codec.is(codec_c::type_e::V_PRORES)
              && (index.size >= 8)) {
-    m_in->skip(8);
+    position   += 8;
     index.size -= 8;
     buffer = memory_c::alloc(index.size);
 
@@ -1595,9 +1705,9 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
     buffer = memory_c::alloc(index.size);
   }
 
-  if (m_in->read(buffer->get_buffer() + buffer_offset, index.size) != index.size) {
+  if (!read_sample(position, buffer->get_buffer() + buffer_offset, index.size)) {
     mxwarn(fmt::format(Y("Quicktime/MP4 reader: Could not read chunk number {0}/{1} with size {2} from position {3}. Aborting.\n"),
-                       dmx.pos, dmx.m_index.size(), index.size, index.file_pos));
+                       dmx.m_num_dropped_index_entries + dmx.pos, dmx.m_num_dropped_index_entries + dmx.m_index.size(), index.size, index.file_pos));
     return flush_packetizers();
   }
 
@@ -1605,14 +1715,102 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   PTZR(dmx.ptzr)->process(new packet_t(buffer, index.timestamp, duration, index.is_keyframe ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
   ++dmx.pos;
 
-  m_bytes_processed += index.size;
+  if (m_next_fragment_position)
+    m_bytes_processed = std::max<int64_t>(m_bytes_processed, index.file_pos + index.size);
+  else
+    m_bytes_processed += index.size;
 
-  if (dmx.pos < dmx.m_index.size())
+  if ((dmx.pos < dmx.m_index.size()) || m_next_fragment_position)
     return FILE_STATUS_MOREDATA;
 
   return flush_packetizers();
 }
 
+/* Samples not found in the chunk cache are read together with the
+   upcoming samples of all tracks located near them. */
+bool
+qtmp4_reader_c::read_sample(uint64_t position,
+                            unsigned char *buffer,
+                            std::size_t size) {
+  if (m_chunk_cache.get(position, buffer, size))
+    return true;
+
+  auto end = determine_coalesced_read_end(position, position + size);
+
+  try {
+    if (m_in->getFilePointer() != position)
+      ++m_num_seeks;
+
+    m_in->setFilePointer(position);
+
+    if (end == (position + size)) {
+      ++m_num_direct_reads;
+      return m_in->read(buffer, size) == size;
+    }
+
+    auto block    = memory_c::alloc(end - position);
+    auto num_read = m_in->read(block->get_buffer(), end - position);
+
+    block->set_size(num_read);
+
+    ++m_num_chunk_reads;
+    m_num_chunk_bytes_read += num_read;
+
+    if (num_read < size)
+      return false;
+
+    std::memcpy(buffer, block->get_buffer(), size);
+    m_chunk_cache.add(position, block);
+
+    return true;
+
+  } catch (mtx::mm_io::exception &) {
+  }
+
+  return false;
+}
+
+uint64_t
+qtmp4_reader_c::determine_coalesced_read_end(uint64_t position,
+                                             uint64_t end)
+  const {
+  if ((end - position) > (CHUNK_CACHE_MAX_READ_SIZE / 2))
+    return end;
+
+  auto const max_end = position + CHUNK_CACHE_MAX_READ_SIZE;
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+
+  for (auto const &dmx : m_demuxers) {
+    if (-1 == dmx->ptzr)
+      continue;
+
+    auto const &index = dmx->m_index;
+    auto const last   = std::min<std::size_t>(index.size(), dmx->pos + CHUNK_CACHE_MAX_LOOKAHEAD);
+
+    for (auto idx = static_cast<std::size_t>(dmx->pos); idx < last; ++idx) {
+      auto const start     = static_cast<uint64_t>(index[idx].file_pos);
+      auto const entry_end = start + index[idx].size;
+
+      if (entry_end > max_end)
+        break;
+
+      if (start >= position)
+        ranges.emplace_back(start, entry_end);
+    }
+  }
+
+  brng::sort(ranges);
+
+  for (auto const &range : ranges) {
+    if (range.first > (end + CHUNK_CACHE_MAX_GAP))
+      break;
+
+    end = std::max(end, range.second);
+  }
+
+  return end;
+}
+
 memory_cptr
 qtmp4_reader_c::create_bitmap_info_header(qtmp4_demuxer_c &dmx,
                                           const char *fourcc,
@@ -2032,7 +2230,7 @@ void
 qtmp4_reader_c::detect_interleaving() {
   std::list<qtmp4_demuxer_cptr> demuxers_to_read;
   boost::remove_copy_if(m_demuxers, std::back_inserter(demuxers_to_read), [this](auto const &dmx) {
-    return !(dmx->ok && (dmx->is_audio() || dmx->is_video()) && this->demuxing_requested(dmx->type, dmx->id, dmx->language) && (dmx->sample_table.size() > 1));
+    return !(dmx->ok && (dmx->is_audio() || dmx->is_video()) && this->demuxing_requested(dmx->type, dmx->id, dmx->language) && (dmx->num_samples > 1));
   });
 
   if (demuxers_to_read.size() < 2) {
@@ -2040,12 +2238,17 @@ qtmp4_reader_c::detect_interleaving() {
     return;
   }
 
-  auto cmp = [](const qt_sample_t &s1, const qt_sample_t &s2) -> uint64_t { return s1.pos < s2.pos; };
-
   std::list<double> gradients;
   for (auto &dmx : demuxers_to_read) {
-    uint64_t min = boost::min_element(dmx->sample_table, cmp)->pos;
-    uint64_t max = boost::max_element(dmx->sample_table, cmp)->pos;
+    auto cursor = dmx->create_sample_cursor();
+    auto min    = std::numeric_limits<uint64_t>::max();
+    auto max    = uint64_t{};
+    mtx::mp4::sample_t sample;
+
+    while (cursor.get_next(sample)) {
+      min = std::min(min, sample.position);
+      max = std::max(max, sample.position);
+    }
     gradients.push_back(static_cast<double>(max - min) / m_in->get_size());
 
     mxdebug_if(m_debug_interleaving, fmt::format("Interleaving: Track id {0} min {1} max {2} gradient {3}\n", dmx->id, min, max, gradients.back()));
@@ -2062,7 +2265,9 @@ qtmp4_reader_c::detect_interleaving() {
 
 void
 qtmp4_demuxer_c::calculate_frame_rate() {
-  if ((1 == durmap_table.size()) && (0 != durmap_table[0].duration) && ((0 != sample_size) || (0 == frame_offset_table.size()))) {
+  auto has_frame_offsets = brng::find_if(raw_frame_offset_table, [](auto const &frame_offset) { return frame_offset.count != 0; }) != raw_frame_offset_table.end();
+
+  if ((1 == durmap_table.size()) && (0 != durmap_table[0].duration) && ((0 != sample_size) || !has_frame_offsets)) {
     // Constant frame_rate. Let's set the default duration.
     frame_rate.assign(time_scale, static_cast<int64_t>(durmap_table[0].duration));
     mxdebug_if(m_debug_frame_rate, fmt::format("calculate_frame_rate: case 1: {0}/{1}\n", frame_rate.numerator(), frame_rate.denominator()));
@@ -2070,21 +2275,33 @@ qtmp4_demuxer_c::calculate_frame_rate() {
     return;
   }
 
-  if (sample_table.size() < 2) {
+  if (num_samples < 2) {
     mxdebug_if(m_debug_frame_rate, fmt::format("calculate_frame_rate: case 2: sample table too small\n"));
     return;
   }
 
-  auto max_pts = sample_table[0].pts;
-  auto min_pts = max_pts;
+  // The samples' timestamps start at 0 and never decrease. The
+  // differences between consecutive ones are the durations from the
+  // 'stts' runs covering all but the last sample.
+  std::map<int64_t, int> duration_map;
+  auto remaining = num_samples - 1;
+  auto max_pts   = int64_t{};
+
+  for (auto const &durmap : durmap_table) {
+    auto num_covered = std::min<uint64_t>(durmap.number, remaining);
+    if (!num_covered)
+      continue;
+
+    max_pts                        += num_covered * durmap.duration;
+    duration_map[durmap.duration]  += num_covered;
+    remaining                      -= num_covered;
 
-  for (auto const &sample : sample_table) {
-    max_pts = std::max(max_pts, sample.pts);
-    min_pts = std::min(min_pts, sample.pts);
+    if (!remaining)
+      break;
   }
 
-  auto duration   = to_nsecs(max_pts - min_pts);
-  auto num_frames = sample_table.size() - 1;
+  auto duration   = to_nsecs(max_pts);
+  auto num_frames = num_samples - 1;
   frame_rate      = mtx::frame_timing::determine_frame_rate(duration / num_frames);
 
   if (frame_rate) {
@@ -2098,13 +2315,6 @@ qtmp4_demuxer_c::calculate_frame_rate() {
     return;
   }
 
-  std::map<int64_t, int> duration_map;
-
-  std::accumulate(sample_table.begin() + 1, sample_table.end(), sample_table[0], [&duration_map](auto const &previous_sample, auto const &current_sample) -> auto {
-    duration_map[current_sample.pts - previous_sample.pts]++;
-    return current_sample;
-  });
-
   auto most_common = std::accumulate(duration_map.begin(), duration_map.end(), std::pair<int64_t, int>(*duration_map.begin()),
                                      [](auto const &winner, std::pair<int64_t, int> const &current) { return current.second > winner.second ? current : winner; });
 
@@ -2123,71 +2333,12 @@ qtmp4_demuxer_c::to_nsecs(int64_t value,
   if (!actual_time_scale)
     return 0;
 
-  return boost::rational_cast<int64_t>(int64_rational_c{value, actual_time_scale} * int64_rational_c{1'000'000'000ll, 1});
-}
-
-void
-qtmp4_demuxer_c::calculate_timestamps_constant_sample_size() {
-  int const num_frame_offsets = frame_offset_table.size();
-  auto chunk_index            = 0;
-
-  timestamps.reserve(timestamps.size() + chunk_table.size());
-  durations.reserve(durations.size() + chunk_table.size());
-  frame_indices.reserve(frame_indices.size() + chunk_table.size());
-
-  for (auto const &chunk : chunk_table) {
-    auto frame_offset = chunk_index < num_frame_offsets ? frame_offset_table[chunk_index] : 0;
-
-    timestamps.push_back(to_nsecs(static_cast<uint64_t>(chunk.samples) * track_duration + frame_offset));
-    durations.push_back(to_nsecs(static_cast<uint64_t>(chunk.size)     * track_duration));
-    frame_indices.push_back(chunk_index);
-
-    ++chunk_index;
-  }
-}
-
-void
-qtmp4_demuxer_c::calculate_timestamps_variable_sample_size() {
-  auto const num_frame_offsets = frame_offset_table.size();
-  auto const num_samples       = sample_table.size();
-
-  std::vector<int64_t> timestamps_before_offsets;
+  // This is called for each sample while building the index. Avoid
+  // the rational arithmetic as long as the product cannot overflow.
+  if ((value > -(1ll << 33)) && (value < (1ll << 33)))
+    return value * 1'000'000'000ll / actual_time_scale;
 
-  timestamps.reserve(num_samples);
-  timestamps_before_offsets.reserve(num_samples);
-  durations.reserve(num_samples);
-  frame_indices.reserve(num_samples);
-
-  for (int frame = 0; static_cast<int>(num_samples) > frame; ++frame) {
-    auto timestamp = to_nsecs(sample_table[frame].pts);
-
-    frame_indices.push_back(frame);
-    timestamps_before_offsets.push_back(timestamp);
-    timestamps.push_back(timestamp + (static_cast<unsigned int>(frame) < num_frame_offsets ? to_nsecs(frame_offset_table[frame]) : 0));
-  }
-
-  int64_t avg_duration = 0, num_good_frames = 0;
-
-  for (int frame = 0; static_cast<int>(num_samples) > (frame + 1); ++frame) {
-    int64_t diff = timestamps_before_offsets[frame + 1] - timestamps_before_offsets[frame];
-
-    if (0 >= diff)
-      durations.push_back(0);
-    else {
-      ++num_good_frames;
-      avg_duration += diff;
-      durations.push_back(diff);
-    }
-  }
-
-  durations.push_back(0);
-
-  if (num_good_frames) {
-    avg_duration /= num_good_frames;
-    for (auto &duration : durations)
-      if (!duration)
-        duration = avg_duration;
-  }
+  return boost::rational_cast<int64_t>(int64_rational_c{value, actual_time_scale} * int64_rational_c{1'000'000'000ll, 1});
 }
 
 void
@@ -2195,20 +2346,16 @@ qtmp4_demuxer_c::calculate_timestamps() {
   if (m_timestamps_calculated)
     return;
 
-  if (0 != sample_size)
-    calculate_timestamps_constant_sample_size();
-  else
-    calculate_timestamps_variable_sample_size();
+  build_index();
 
   if (m_debug_tables) {
     mxdebug(fmt::format("Timestamps for track ID {0}:\n", id));
-    auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), timestamps.size());
+    auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), m_index.size());
 
     for (auto idx = 0u; idx < end; ++idx)
-      mxdebug(fmt::format("  {0}: pts {1}\n", idx, format_timestamp(timestamps[idx])));
+      mxdebug(fmt::format("  {0}: pts {1}\n", idx, format_timestamp(m_index[idx].timestamp)));
   }
 
-  build_index();
   apply_edit_list();
 
   m_timestamps_calculated = true;
@@ -2216,11 +2363,10 @@ qtmp4_demuxer_c::calculate_timestamps() {
 
 void
 qtmp4_demuxer_c::adjust_timestamps(int64_t delta) {
-  for (auto &timestamp : timestamps)
-    timestamp += delta;
-
   for (auto &index : m_index)
     index.timestamp += delta;
+
+  m_fragment_timestamp_shift += delta;
 }
 
 boost::optional<int64_t>
@@ -2274,18 +2420,12 @@ qtmp4_demuxer_c::update_tables() {
 
   // workaround for fixed-size video frames (dv and uncompressed), but
   // also for audio with constant sample size
-  if (sample_table.empty() && (sample_size > 1)) {
-    for (i = 0; i < s; ++i) {
-      qt_sample_t sample;
-
-      sample.size = sample_size;
-      sample_table.push_back(sample);
-    }
-
-    sample_size = 0;
+  if (sample_size_table.empty() && (sample_size > 1)) {
+    uniform_sample_size = sample_size;
+    sample_size         = 0;
   }
 
-  if (sample_table.empty()) {
+  if (sample_size_table.empty() && !uniform_sample_size) {
     // constant sample size
     if ((1 == durmap_table.size()) || ((2 == durmap_table.size()) && (1 == durmap_table[1].number)))
       track_duration = durmap_table[0].duration;
@@ -2297,61 +2437,39 @@ qtmp4_demuxer_c::update_tables() {
     return true;
   }
 
-  // calc pts:
-  auto num_samples = sample_table.size();
-  s                = 0;
-  uint64_t pts     = 0;
-
-  for (j = 0; (j < durmap_table.size()) && (s < num_samples); ++j) {
-    for (i = 0; (i < durmap_table[j].number) && (s < num_samples); ++i) {
-      sample_table[s].pts  = pts;
-      pts                 += durmap_table[j].duration;
-      ++s;
-    }
-  }
-
-  if (s < num_samples) {
-    mxdebug_if(m_debug_headers, fmt::format("Track {0}: fewer timestamps assigned than entries in the sample table: {1} < {2}; dropping the excessive items\n", id, s, num_samples));
-    sample_table.resize(s);
-    num_samples = s;
-  }
-
-  // calc sample offsets
-  s = 0;
-  for (j = 0; (j < chunk_table.size()) && (s < num_samples); ++j) {
-    uint64_t chunk_pos = chunk_table[j].pos;
-
-    for (i = 0; (i < chunk_table[j].size) && (s < num_samples); ++i) {
-      sample_table[s].pos  = chunk_pos;
-      chunk_pos           += sample_table[s].size;
-      ++s;
-    }
-  }
-
-  // calc pts/dts offsets
-  for (j = 0; j < raw_frame_offset_table.size(); ++j) {
-    size_t k;
+  // The samples' positions and timestamps aren't expanded into
+  // per-sample tables here; they're calculated from the run-length
+  // encoded tables while iterating over the samples.
+  auto cursor = create_sample_cursor();
+  num_samples = cursor.get_num_samples();
 
-    for (k = 0; k < raw_frame_offset_table[j].count; ++k)
-      frame_offset_table.push_back(raw_frame_offset_table[j].offset);
-  }
+  if (cursor.get_num_samples_in_duration_table() < cursor.get_num_samples_in_size_table())
+    mxdebug_if(m_debug_headers,
+               fmt::format("Track {0}: fewer timestamps assigned than entries in the sample table: {1} < {2}; dropping the excessive items\n",
+                           id, cursor.get_num_samples_in_duration_table(), cursor.get_num_samples_in_size_table()));
 
   m_tables_updated = true;
 
   if (!m_debug_tables)
     return true;
 
-  mxdebug(fmt::format(" Frame offset table for track ID {0}: {1} entries\n",    id, frame_offset_table.size()));
-  mxdebug(fmt::format(" Sample table contents for track ID {0}: {1} entries\n", id, sample_table.size()));
+  mxdebug(fmt::format(" Sample table contents for track ID {0}: {1} entries\n", id, num_samples));
 
-  auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), sample_table.size());
+  auto end = std::min<std::size_t>(!m_debug_tables_full ? 20 : std::numeric_limits<std::size_t>::max(), num_samples);
+  mtx::mp4::sample_t sample;
 
-  for (auto idx = 0u; idx < end; ++idx)
-    mxdebug(fmt::format("   {0}: pts {1} size {2} pos {3}\n", idx, sample_table[idx].pts, sample_table[idx].size, sample_table[idx].pos));
+  for (auto idx = 0u; (idx < end) && cursor.get_next(sample); ++idx)
+    mxdebug(fmt::format("   {0}: pts {1} size {2} pos {3} offset {4}\n", idx, sample.decoding_time, sample.size, sample.position, sample.composition_offset));
 
   return true;
 }
 
+mtx::mp4::sample_cursor_c
+qtmp4_demuxer_c::create_sample_cursor()
+  const {
+  return { chunk_table, sample_size_table, uniform_sample_size, durmap_table, raw_frame_offset_table };
+}
+
 void
 qtmp4_demuxer_c::apply_edit_list() {
   if (editlist_table.empty())
@@ -2402,9 +2520,10 @@ qtmp4_demuxer_c::apply_edit_list() {
     }
 
     if (num_edits == 1) {
-      timeline_cts          = to_nsecs(edit.media_time) * -1;
-      edit.media_time       = 0;
-      edit.segment_duration = 0;
+      timeline_cts               = to_nsecs(edit.media_time) * -1;
+      m_fragment_timestamp_shift = timeline_cts;
+      edit.media_time            = 0;
+      edit.segment_duration      = 0;
       mxdebug_if(m_debug_editlists, fmt::format("  {0}: single edit with positive media_time; track start offset {1}; change to non-edit to copy the rest\n", info, format_timestamp(timeline_cts)));
 
     } else if (   (num_edits   == 2)
@@ -2447,6 +2566,8 @@ qtmp4_demuxer_c::apply_edit_list() {
 
   if (!edited_index.empty())
     m_index = std::move(edited_index);
+  else
+    m_fragment_timestamp_shift = 0;
 
   if (m_debug_editlists)
     dump_index_entries("Index after edit list");
@@ -2520,20 +2641,107 @@ qtmp4_demuxer_c::build_index_constant_sample_size_mode() {
       }
     }
 
-    m_index.emplace_back(chunk_table[frame_idx].pos, frame_size, timestamps[frame_idx], durations[frame_idx], false);
+    auto const &chunk = chunk_table[frame_idx];
+
+    m_index.emplace_back(chunk.pos, frame_size, to_nsecs(static_cast<uint64_t>(chunk.samples) * track_duration), to_nsecs(static_cast<uint64_t>(chunk.size) * track_duration), false);
   }
 }
 
 void
 qtmp4_demuxer_c::build_index_chunk_mode() {
-  m_index.reserve(m_index.size() + frame_indices.size());
+  add_samples_to_index(0, 0, !!m_reader.m_next_fragment_position);
+}
+
+/* A sample's duration is the difference between its timestamp and the
+   next one's (both without the composition time offsets). Samples
+   without such a difference get the average duration. So does the last
+   one unless more fragments follow it; its duration from the tables is
+   used then so that the samples of all fragments are treated alike. */
+void
+qtmp4_demuxer_c::add_samples_to_index(uint64_t decoding_time_offset,
+                                      int64_t timestamp_shift,
+                                      bool more_samples_follow) {
+  auto cursor      = create_sample_cursor();
+  auto num_frames  = cursor.get_num_samples();
+  auto first_entry = m_index.size();
 
-  for (int frame_idx = 0, num_frames = frame_indices.size(); frame_idx < num_frames; ++frame_idx) {
-    auto act_frame_idx = frame_indices[frame_idx];
-    auto &sample       = sample_table[act_frame_idx];
+  m_index.reserve(first_entry + num_frames);
 
-    m_index.emplace_back(sample.pos, sample.size, timestamps[frame_idx], durations[frame_idx], false);
+  int64_t avg_duration = 0, num_good_frames = 0;
+  mtx::mp4::sample_t sample;
+
+  for (auto frame_idx = 0ull; cursor.get_next(sample); ++frame_idx) {
+    auto decoding_time = static_cast<int64_t>(decoding_time_offset) + sample.decoding_time;
+    auto timestamp     = to_nsecs(decoding_time);
+    auto duration      = more_samples_follow || ((frame_idx + 1) < num_frames) ? to_nsecs(decoding_time + sample.duration) - timestamp : 0;
+
+    if (0 >= duration)
+      duration = 0;
+
+    else {
+      ++num_good_frames;
+      avg_duration += duration;
+    }
+
+    m_index.emplace_back(sample.position, sample.size, timestamp + to_nsecs(sample.composition_offset) + timestamp_shift, duration, false);
   }
+
+  if (!num_good_frames)
+    return;
+
+  avg_duration /= num_good_frames;
+
+  for (auto idx = first_entry, end = m_index.size(); idx < end; ++idx)
+    if (!m_index[idx].duration)
+      m_index[idx].duration = avg_duration;
+}
+
+/* Adds the samples of the fragments parsed while streaming to the
+   index. The edit list & the global minimum timestamp have already been
+   determined from the first fragments; they're applied as a constant
+   shift. */
+void
+qtmp4_demuxer_c::index_fragment_samples() {
+  auto first_entry = m_index.size();
+
+  add_samples_to_index(m_fragment_decoding_time, m_fragment_timestamp_shift, true);
+
+  auto num_frames = m_index.size() - first_entry;
+
+  // The 'trun' atoms list the key frames explicitly; an empty table
+  // means there aren't any.
+  for (auto keyframe_number : keyframe_table) {
+    auto frame_idx = static_cast<uint64_t>(keyframe_number) - 1;
+
+    if ((frame_idx >= m_num_fragment_samples_indexed) && ((frame_idx - m_num_fragment_samples_indexed) < num_frames))
+      m_index[first_entry + frame_idx - m_num_fragment_samples_indexed].is_keyframe = true;
+  }
+
+  mxdebug_if(m_debug_indexes && num_frames, fmt::format("Track ID {0}: {1} samples from fragments added to the index\n", id, num_frames));
+
+  drop_indexed_tables();
+}
+
+/* When streaming fragments, the samples in the tables have been added
+   to the index. Only the state needed for the next fragment is kept. */
+void
+qtmp4_demuxer_c::drop_indexed_tables() {
+  auto remaining = create_sample_cursor().get_num_samples();
+
+  for (auto const &durmap : durmap_table) {
+    auto num_covered          = std::min<uint64_t>(durmap.number, remaining);
+    m_fragment_decoding_time += num_covered * durmap.duration;
+    remaining                -= num_covered;
+  }
+
+  m_num_fragment_samples_indexed = num_frames_from_trun;
+
+  chunk_table.clear();
+  sample_size_table.clear();
+  durmap_table.clear();
+  raw_frame_offset_table.clear();
+  keyframe_table.clear();
+  m_fragments.clear();
 }
 
 void
@@ -15,10 +15,13 @@
 
 #include "common/common_pch.h"
 
+#include "common/aac.h"
 #include "common/ac3.h"
 #include "common/codec.h"
 #include "common/dts.h"
 #include "common/fourcc.h"
+#include "common/mp4_sample_table.h"
+#include "input/chunk_cache.h"
 #include "input/qtmp4_atoms.h"
 #include "merge/generic_reader.h"
 #include "output/p_pcm.h"
@@ -42,46 +45,6 @@
 #define QTMP4_FRAG_SAMPLE_FLAG_IS_NON_SYNC 0x00010000
 #define QTMP4_FRAG_SAMPLE_FLAG_DEPENDS_YES 0x01000000
 
-struct qt_durmap_t {
-  uint32_t number;
-  uint32_t duration;
-
-  qt_durmap_t()
-    : number{}
-    , duration{}
-  {
-  }
-
-  qt_durmap_t(uint32_t p_number, uint32_t p_duration)
-    : number{p_number}
-    , duration{p_duration}
-  {
-  }
-};
-
-struct qt_chunk_t {
-  uint32_t samples;
-  uint32_t size;
-  uint32_t desc;
-  uint64_t pos;
-
-  qt_chunk_t()
-    : samples{}
-    , size{}
-    , desc{}
-    , pos{}
-  {
-  }
-
-  qt_chunk_t(uint32_t p_size, uint64_t p_pos)
-    : samples{}
-    , size{p_size}
-    , desc{}
-    , pos{p_pos}
-  {
-  }
-};
-
 struct qt_chunkmap_t {
   uint32_t first_chunk;
   uint32_t samples_per_chunk;
@@ -107,62 +70,25 @@ struct qt_editlist_t {
   };
 };
 
-struct qt_sample_t {
-  int64_t  pts;
-  uint32_t size;
-  int64_t  pos;
-
-  qt_sample_t()
-    : pts{}
-    , size{}
-    , pos{}
-  {
-  }
-
-  qt_sample_t(uint32_t p_size)
-    : pts{}
-    , size{p_size}
-    , pos{}
-  {
-  }
-};
-
-struct qt_frame_offset_t {
-  unsigned int count;
-  int64_t offset;
-
-  qt_frame_offset_t()
-    : count{}
-    , offset{}
-  {
-  }
-
-  qt_frame_offset_t(unsigned int p_count, int64_t p_offset)
-    : count{p_count}
-    , offset{p_offset}
-  {
-  }
-};
-
 struct qt_index_t {
-  int64_t file_pos, size;
-  int64_t timestamp, duration;
-  bool    is_keyframe;
+  int64_t  file_pos, timestamp, duration;
+  uint32_t size;
+  bool     is_keyframe;
 
   qt_index_t()
     : file_pos{}
-    , size{}
     , timestamp{}
     , duration{}
+    , size{}
     , is_keyframe{}
   {
   };
 
-  qt_index_t(int64_t p_file_pos, int64_t p_size, int64_t p_timestamp, int64_t p_duration, bool p_is_keyframe)
+  qt_index_t(int64_t p_file_pos, uint32_t p_size, int64_t p_timestamp, int64_t p_duration, bool p_is_keyframe)
     : file_pos{p_file_pos}
-    , size{p_size}
     , timestamp{p_timestamp}
     , duration{p_duration}
+    , size{p_size}
     , is_keyframe{p_is_keyframe}
   {
   }
@@ -233,24 +159,29 @@ struct qtmp4_demuxer_c {
   pcm_packetizer_c::pcm_format_e m_pcm_format;
 
   int64_t time_scale, track_duration, global_duration, num_frames_from_trun;
-  uint32_t sample_size;
+  uint32_t sample_size, uniform_sample_size{};
+  uint64_t num_samples{};
 
-  std::vector<qt_sample_t> sample_table;
+  std::vector<uint32_t> sample_size_table;
   std::vector<qt_chunk_t> chunk_table;
   std::vector<qt_chunkmap_t> chunkmap_table;
   std::vector<qt_durmap_t> durmap_table;
   std::vector<uint32_t> keyframe_table;
   std::vector<qt_editlist_t> editlist_table;
   std::vector<qt_frame_offset_t> raw_frame_offset_table;
-  std::vector<int32_t> frame_offset_table;
   std::vector<qt_random_access_point_t> random_access_point_table;
   std::unordered_map<uint32_t, std::vector<qt_sample_to_group_t> > sample_to_group_tables;
 
-  std::vector<int64_t> timestamps, durations, frame_indices;
-
   std::vector<qt_index_t> m_index;
   std::vector<qt_fragment_t> m_fragments;
 
+  // Streaming fragments: the number of index entries already read &
+  // dropped from the index, the decoding time & number of the next
+  // sample not indexed yet and the shift applied to all timestamps by
+  // the edit list & the global minimum timestamp.
+  uint64_t m_num_dropped_index_entries{}, m_fragment_decoding_time{}, m_num_fragment_samples_indexed{};
+  int64_t m_fragment_timestamp_shift{};
+
   int64_rational_c frame_rate;
   boost::optional<int64_t> m_use_frame_rate_for_duration;
 
@@ -323,9 +254,12 @@ struct qtmp4_demuxer_c {
   void adjust_timestamps(int64_t delta);
 
   bool update_tables();
+  mtx::mp4::sample_cursor_c create_sample_cursor() const;
   void apply_edit_list();
 
   void build_index();
+  void index_fragment_samples();
+  void drop_indexed_tables();
 
   memory_cptr read_first_bytes(int num_bytes);
 
@@ -378,14 +312,12 @@ struct qtmp4_demuxer_c {
 
 private:
   void build_index_chunk_mode();
+  void add_samples_to_index(uint64_t decoding_time_offset, int64_t timestamp_shift, bool more_samples_follow);
   void build_index_constant_sample_size_mode();
   void dump_index_entries(std::string const &message) const;
   void mark_key_frames_from_key_frame_table();
   void mark_open_gop_random_access_points_as_key_frames();
 
-  void calculate_timestamps_constant_sample_size();
-  void calculate_timestamps_variable_sample_size();
-
   bool parse_esds_atom(mm_io_c &io, int level);
 };
 using qtmp4_demuxer_cptr = std::shared_ptr<qtmp4_demuxer_c>;
@@ -443,7 +375,7 @@ struct qtmp4_chapter_entry_t {
 };
 
 class qtmp4_reader_c: public generic_reader_c {
-private:
+protected:
   std::vector<qtmp4_demuxer_cptr> m_demuxers;
   std::unordered_map<unsigned int, bool> m_chapter_track_ids;
   std::unordered_map<unsigned int, qt_track_defaults_t> m_track_defaults;
@@ -461,9 +393,14 @@ private:
   bool m_timestamps_calculated;
   boost::optional<uint64_t> m_duration;
 
+  boost::optional<uint64_t> m_next_fragment_position;
+
   int64_t m_bytes_to_process{}, m_bytes_processed{};
 
-  debugging_option_c m_debug_chapters, m_debug_headers, m_debug_tables, m_debug_tables_full, m_debug_interleaving, m_debug_resync;
+  chunk_cache_c m_chunk_cache;
+  uint64_t m_num_chunk_reads{}, m_num_chunk_bytes_read{}, m_num_direct_reads{}, m_num_seeks{};
+
+  debugging_option_c m_debug_chapters, m_debug_headers, m_debug_tables, m_debug_tables_full, m_debug_interleaving, m_debug_resync, m_debug_chunk_cache, m_debug_fragments;
 
   friend class qtmp4_demuxer_c;
 
@@ -496,6 +433,9 @@ protected:
 
   virtual qt_atom_t read_atom(mm_io_c *read_from = nullptr, bool exit_on_error = true);
   virtual bool resync_to_top_level_atom(uint64_t start_pos);
+  virtual bool can_stream_fragments() const;
+  virtual void read_next_fragments(qtmp4_demuxer_c &dmx);
+  virtual void parse_next_fragment_atom();
   virtual void parse_itunsmpb(std::string data);
 
   virtual void handle_cmov_atom(qt_atom_t parent, int level);
@@ -567,6 +507,8 @@ protected:
   virtual void process_chapter_entries(int level, std::vector<qtmp4_chapter_entry_t> &entries);
 
   virtual void detect_interleaving();
+  virtual bool read_sample(uint64_t position, unsigned char *buffer, std::size_t size);
+  virtual uint64_t determine_coalesced_read_end(uint64_t position, uint64_t end) const;
 
   virtual std::string read_string_atom(qt_atom_t atom, size_t num_skipped);
 
@@ -14,16 +14,26 @@
 
 #include "common/common_pch.h"
 
+#include <ebml/EbmlCrc32.h>
+
+#include "common/checksums/base.h"
 #include "common/doc_type_version_handler.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/hacks.h"
+#include "common/json.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "common/mm_mem_io.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
+#include "common/tracing.h"
 #include "common/translation.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
+#include "merge/id_result.h"
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 #include "merge/packet_extensions.h"
@@ -38,6 +48,43 @@ using namespace libmatroska;
 
 debugging_option_c render_groups_c::ms_gap_detection{"cluster_helper_gap_detection"};
 
+namespace {
+
+// A memory buffer reporting positions as if its content had been
+// written to another file starting at 'base'. Used for rendering a
+// cluster in memory while libebml & libmatroska record the element
+// positions in the actual destination file.
+class mm_positioned_mem_io_c: public mm_mem_io_c {
+protected:
+  uint64_t m_base;
+
+public:
+  mm_positioned_mem_io_c(uint64_t base,
+                         std::size_t initial_size)
+    : mm_mem_io_c{nullptr, initial_size, 1024 * 1024}
+    , m_base{base}
+  {
+  }
+
+  virtual uint64
+  getFilePointer() override {
+    return m_base + get_rendered_size();
+  }
+
+  virtual void
+  setFilePointer(int64 offset,
+                 libebml::seek_mode mode = libebml::seek_beginning) override {
+    mm_mem_io_c::setFilePointer(libebml::seek_beginning == mode ? offset - m_base : offset, mode);
+  }
+
+  uint64_t
+  get_rendered_size() {
+    return mm_mem_io_c::getFilePointer();
+  }
+};
+
+}
+
 cluster_helper_c::impl_t::~impl_t() {
 }
 
@@ -171,7 +218,7 @@ cluster_helper_c::split_if_necessary(packet_cptr &packet) {
 
     if (!m->packets.empty())
       // Cluster + Cluster timestamp: roughly 21 bytes. Add all frame sizes & their overheaders, too.
-      additional_size = 21 + boost::accumulate(m->packets, 0, [](size_t size, const packet_cptr &p) { return size + p->data->get_size() + (p->is_key_frame() ? 10 : p->is_p_frame() ? 13 : 16); });
+      additional_size = 21 + boost::accumulate(m->packets, 0, [](size_t size, const packet_cptr &p) { return size + p->get_data_size() + (p->is_key_frame() ? 10 : p->is_p_frame() ? 13 : 16); });
 
     additional_size += 18 * m->num_cue_elements;
 
@@ -250,6 +297,11 @@ cluster_helper_c::split(packet_cptr &packet) {
 
 void
 cluster_helper_c::add_packet(packet_cptr packet) {
+  static auto &s_tracing_stage = mtx::tracing::get_stage("cluster: adding packets");
+  mtx::tracing::scope_c tracing_scope{s_tracing_stage};
+  tracing_scope.add_packets();
+  tracing_scope.add_bytes(packet->get_data_size());
+
   if (!m->cluster)
     prepare_new_cluster();
 
@@ -258,7 +310,7 @@ cluster_helper_c::add_packet(packet_cptr packet) {
   split_if_necessary(packet);
 
   m->packets.push_back(packet);
-  m->cluster_content_size += packet->data->get_size();
+  m->cluster_content_size += packet->get_data_size();
 
   if (packet->assigned_timestamp > m->max_timestamp_in_cluster)
     m->max_timestamp_in_cluster = packet->assigned_timestamp;
@@ -378,6 +430,11 @@ cluster_helper_c::must_duration_be_set(render_groups_c *rg,
 
 int
 cluster_helper_c::render() {
+  static auto &s_tracing_stage = mtx::tracing::get_stage("cluster: rendering");
+  mtx::tracing::scope_c tracing_scope{s_tracing_stage};
+  tracing_scope.add_packets(m->packets.size());
+  tracing_scope.add_bytes(m->cluster_content_size);
+
   std::vector<render_groups_cptr> render_groups;
   kax_cues_with_cleanup_c cues;
   cues.SetGlobalTimecodeScale(g_timestamp_scale);
@@ -433,6 +490,9 @@ cluster_helper_c::render() {
     min_cl_timestamp                       = std::min(pack->assigned_timestamp, min_cl_timestamp);
     max_cl_timestamp                       = std::max(pack->assigned_timestamp, max_cl_timestamp);
 
+    // libmatroska requires each frame in a single buffer.
+    pack->join_data_slices();
+
     DataBuffer *data_buffer                = new DataBuffer((binary *)pack->data->get_buffer(), pack->data->get_size());
 
     KaxTrackEntry &track_entry             = static_cast<KaxTrackEntry &>(*source->get_track_entry());
@@ -544,6 +604,9 @@ cluster_helper_c::render() {
 
     pack->account(m->track_statistics[ source->get_uid() ], timestamp_offset);
 
+    if (!m->detailed_track_statistics_file_name.empty())
+      m->detailed_track_statistics[ source->get_uid() ].account(pack->assigned_timestamp, pack->get_duration(), pack->calculate_uncompressed_size(), pack->is_key_frame());
+
     source->after_packet_rendered(*pack);
   }
 
@@ -556,7 +619,17 @@ cluster_helper_c::render() {
       m->cluster->set_min_timestamp(min_cl_timestamp - timestamp_offset);
       m->cluster->set_max_timestamp(max_cl_timestamp - timestamp_offset);
 
-      m->cluster->Render(*m->out, cues);
+      {
+        static auto &s_tracing_write_stage = mtx::tracing::get_stage("cluster: writing");
+        mtx::tracing::scope_c tracing_write_scope{s_tracing_write_stage};
+
+        if (m->write_crc32_elements)
+          render_cluster_with_crc32(cues);
+        else
+          m->cluster->Render(*m->out, cues);
+        tracing_write_scope.add_bytes(m->cluster->ElementSize());
+      }
+
       g_doc_type_version_handler->account(*m->cluster);
       m->bytes_in_file += m->cluster->ElementSize();
 
@@ -687,6 +760,20 @@ cluster_helper_c::split_mode_produces_many_files()
   return false;
 }
 
+/* Returns the timestamp at which the first part to be kept starts in
+   'parts:' splitting mode if everything before it is discarded. Readers
+   may skip the data before that timestamp. */
+timestamp_c
+cluster_helper_c::get_start_of_first_kept_part()
+  const {
+  if (   (m->split_points.size() < 2)
+      || (split_point_c::parts != m->split_points.front().m_type)
+      || !m->split_points.front().m_discard)
+    return {};
+
+  return timestamp_c::ns(m->split_points[1].m_point);
+}
+
 void
 cluster_helper_c::discard_queued_packets() {
   m->packets.clear();
@@ -715,6 +802,77 @@ cluster_helper_c::create_tags_for_track_statistics(KaxTags &tags,
   m->track_statistics.clear();
 }
 
+void
+cluster_helper_c::enable_detailed_track_statistics(std::string const &file_name) {
+  m->detailed_track_statistics_file_name = file_name;
+}
+
+void
+cluster_helper_c::enable_crc32_elements() {
+  m->write_crc32_elements = true;
+}
+
+/* Renders the cluster with an EbmlCrc32 element as its first child.
+   The cluster is rendered into memory first as the checksum covers
+   all following children and must be written before them. Element
+   positions are still recorded relative to the destination file so
+   that cues & seek head entries remain valid. */
+void
+cluster_helper_c::render_cluster_with_crc32(KaxCues &cues) {
+  auto crc32 = new EbmlCrc32;
+  m->cluster->InsertElement(*crc32, 0);
+
+  mm_positioned_mem_io_c buffer{m->out->getFilePointer(), static_cast<std::size_t>(m->cluster_content_size) + 64 * 1024};
+  m->cluster->Render(buffer, cues);
+
+  auto data          = buffer.get_buffer();
+  auto size          = buffer.get_rendered_size();
+  auto crc32_offset  = crc32->GetElementPosition() - m->out->getFilePointer();
+  auto covered_start = crc32_offset + crc32->ElementSize();
+  auto value         = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc32_ieee_le, data + covered_start, size - covered_start, 0xffffffffu) ^ 0xffffffffu;
+
+  put_uint32_le(data + crc32_offset + crc32->HeadSize(), value);
+
+  m->out->write(data, size);
+}
+
+void
+cluster_helper_c::write_detailed_track_statistics() {
+  if (m->detailed_track_statistics_file_name.empty())
+    return;
+
+  auto tracks = nlohmann::json::array();
+
+  for (auto const &ptzr : g_packetizers) {
+    auto &source = *ptzr.packetizer;
+    auto track   = m->detailed_track_statistics[ source.get_uid() ].to_json();
+
+    track["number"]   = source.get_track_num();
+    track["uid"]      = source.get_uid();
+    track["type"]     = track_video     == source.get_track_type() ? ID_RESULT_TRACK_VIDEO
+                      : track_audio     == source.get_track_type() ? ID_RESULT_TRACK_AUDIO
+                      : track_subtitle  == source.get_track_type() ? ID_RESULT_TRACK_SUBTITLES
+                      : track_buttons   == source.get_track_type() ? ID_RESULT_TRACK_BUTTONS
+                      :                                              ID_RESULT_TRACK_UNKNOWN;
+    track["codec_id"] = source.get_codec_id();
+
+    tracks.push_back(track);
+  }
+
+  auto json = nlohmann::json{
+    { "file_name", g_outfile },
+    { "tracks",    tracks    },
+  };
+
+  try {
+    mm_file_io_c out{m->detailed_track_statistics_file_name, MODE_CREATE};
+    out.puts(mtx::json::dump(json, 2) + "\n");
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(fmt::format(Y("The file '{0}' could not be opened for writing: {1}.\n"), m->detailed_track_statistics_file_name, ex));
+  }
+}
+
 void
 cluster_helper_c::enable_chapter_generation(chapter_generation_mode_e mode,
                                             std::string const &language) {
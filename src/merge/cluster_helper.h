@@ -66,6 +66,7 @@ public:
   void dump_split_points() const;
   bool splitting() const;
   bool split_mode_produces_many_files() const;
+  timestamp_c get_start_of_first_kept_part() const;
 
   bool discarding() const;
 
@@ -75,6 +76,9 @@ public:
   bool is_splitting_and_processed_fully() const;
 
   void create_tags_for_track_statistics(libmatroska::KaxTags &tags, std::string const &writing_app, boost::posix_time::ptime const &writing_date);
+  void enable_detailed_track_statistics(std::string const &file_name);
+  void enable_crc32_elements();
+  void write_detailed_track_statistics();
 
   void register_new_packetizer(generic_packetizer_c &ptzr);
 
@@ -93,6 +97,7 @@ private:
   void generate_chapters_if_necessary(packet_cptr const &packet);
   void generate_one_chapter(timestamp_c const &timestamp);
   void split(packet_cptr &packet);
+  void render_cluster_with_crc32(libmatroska::KaxCues &cues);
 
   bool add_to_cues_maybe(packet_cptr &pack);
 };
@@ -1279,8 +1279,21 @@ generic_packetizer_c::compress_packet(packet_t &packet) {
     return;
   }
 
+  // Header removal only shortens the frame's first slice. Treating
+  // contiguous frames as a single slice avoids copying their content.
+  if (packet.data_slices.empty() && std::dynamic_pointer_cast<header_removal_compressor_c>(m_compressor)) {
+    packet.data_slices = { { packet.data, 0, packet.data->get_size() } };
+    packet.data.reset();
+  }
+
   try {
-    packet.data = m_compressor->compress(packet.data);
+    if (!packet.data_slices.empty()) {
+      m_compressor->compress(packet.data_slices);
+      packet.set_data_slices(std::move(packet.data_slices));
+
+    } else
+      packet.data = m_compressor->compress(packet.data);
+
     size_t i;
     for (i = 0; packet.data_adds.size() > i; ++i)
       packet.data_adds[i] = m_compressor->compress(packet.data_adds[i]);
@@ -1296,6 +1309,28 @@ generic_packetizer_c::account_enqueued_bytes(packet_t &packet,
   m_enqueued_bytes += packet.calculate_uncompressed_size() * factor;
 }
 
+mtx::tracing::stage_c *
+generic_packetizer_c::get_tracing_stage() {
+  if (mtx::tracing::is_enabled() && !m_tracing_stage)
+    m_tracing_stage = &mtx::tracing::get_stage(fmt::format("packetizer: {0} (track {1} of {2})", get_format_name(), m_ti.m_id, m_ti.m_fname));
+
+  return m_tracing_stage;
+}
+
+/** \brief Hands a packet from the reader over to the packetizer
+
+   The time spent in the packetizer is accounted for in the
+   packetizer's tracing stage instead of the reader's.
+ */
+int
+generic_packetizer_c::process(packet_cptr packet) {
+  mtx::tracing::scope_c tracing_scope{get_tracing_stage()};
+  tracing_scope.add_packets();
+  tracing_scope.add_bytes(packet->get_data_size());
+
+  return process_impl(packet);
+}
+
 void
 generic_packetizer_c::add_packet(packet_cptr pack) {
   if ((0 == m_num_packets) && m_ti.m_reset_timestamps)
@@ -1311,9 +1346,7 @@ generic_packetizer_c::add_packet(packet_cptr pack) {
       && (pack->data_adds.size()  > static_cast<size_t>(m_htrack_max_add_block_ids)))
     pack->data_adds.resize(m_htrack_max_add_block_ids);
 
-  pack->data->take_ownership();
-  for (auto &data_add : pack->data_adds)
-    data_add->take_ownership();
+  pack->take_ownership();
 
   pack->source = this;
 
@@ -1442,6 +1475,9 @@ generic_packetizer_c::apply_factory() {
   if (m_packet_queue.empty())
     return;
 
+  static auto &s_tracing_stage = mtx::tracing::get_stage("timestamp factory");
+  mtx::tracing::scope_c tracing_scope{s_tracing_stage};
+
   // Find the first packet to which the factory hasn't been applied yet.
   packet_cptr_di p_start = m_packet_queue.begin() + m_next_packet_wo_assigned_timestamp;
 
@@ -1607,6 +1643,8 @@ generic_packetizer_c::contains_gap() {
 
 void
 generic_packetizer_c::flush() {
+  mtx::tracing::scope_c tracing_scope{get_tracing_stage()};
+
   flush_impl();
 
   m_has_been_flushed = true;
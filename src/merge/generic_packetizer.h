@@ -19,6 +19,7 @@
 
 #include "common/option_with_source.h"
 #include "common/timestamp.h"
+#include "common/tracing.h"
 #include "common/translation.h"
 #include "merge/file_status.h"
 #include "merge/packet.h"
@@ -93,6 +94,8 @@ protected:
   bool m_prevent_lacing;
   generic_packetizer_c *m_connected_successor;
 
+  mtx::tracing::stage_c *m_tracing_stage{};
+
 protected:                      // static
   static int ms_track_number;
 
@@ -144,7 +147,7 @@ public:
   inline int process(packet_t *packet) {
     return process(packet_cptr(packet));
   }
-  virtual int process(packet_cptr packet) = 0;
+  int process(packet_cptr packet);
 
   virtual void set_cue_creation(cue_strategy_e create_cue_data) {
     m_ti.m_cues = create_cue_data;
@@ -190,6 +193,9 @@ public:
   virtual void set_language(const std::string &language);
 
   virtual void set_codec_id(const std::string &id);
+  virtual std::string const &get_codec_id() const {
+    return m_hcodec_id;
+  }
   virtual void set_codec_private(memory_cptr const &buffer);
 
   virtual void set_track_default_duration(int64_t default_duration, bool force = false);
@@ -290,6 +296,7 @@ public:
   virtual void after_file_created();
 
 protected:
+  virtual int process_impl(packet_cptr packet) = 0;
   virtual void flush_impl() {
   };
 
@@ -297,6 +304,8 @@ protected:
 
   virtual void compress_packet(packet_t &packet);
   virtual void account_enqueued_bytes(packet_t &packet, int64_t factor);
+
+  mtx::tracing::stage_c *get_tracing_stage();
 };
 
 extern std::vector<generic_packetizer_c *> ptzrs_in_header_order;
@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/json_writer.h"
 #include "common/list_utils.h"
 #include "common/mm_proxy_io.h"
 #include "common/strings/formatting.h"
@@ -104,11 +105,17 @@ generic_reader_c::read_all() {
 file_status_e
 generic_reader_c::read_next(generic_packetizer_c *ptzr,
                             bool force) {
+  if (mtx::tracing::is_enabled() && !m_tracing_stage)
+    m_tracing_stage = &mtx::tracing::get_stage(fmt::format("reader: {0} ({1})", get_format_name(), m_ti.m_fname));
+
+  mtx::tracing::scope_c tracing_scope{m_tracing_stage};
+
   auto prior_progrss = get_progress();
   auto result        = read(ptzr, force);
   auto new_progress  = get_progress();
 
   add_to_progress(new_progress - prior_progrss);
+  tracing_scope.add_bytes(new_progress - prior_progrss);
 
   return result;
 }
@@ -367,66 +374,98 @@ generic_reader_c::display_identification_results_as_text() {
 
 void
 generic_reader_c::display_identification_results_as_json() {
-  auto verbose_info_to_object = [](mtx::id::verbose_info_t const &verbose_info) -> nlohmann::json {
-    auto object = nlohmann::json{};
+  // The output is written directly without building a JSON document
+  // first as there may be thousands of tracks or chapters. Members
+  // must be written sorted by their keys in order to produce the same
+  // output as nlohmann::json.
+  auto write_verbose_info = [](mtx::json::writer_c &writer, mtx::id::verbose_info_t const &verbose_info) {
+    auto object = nlohmann::json::object();
     for (auto const &property : verbose_info)
       object[property.first] = property.second;
 
-    return object.is_null() ? nlohmann::json::object() : object;
+    writer.value(object);
   };
 
-  auto json = nlohmann::json{
-    { "identification_format_version", ID_JSON_FORMAT_VERSION  },
-    { "file_name",                     m_ti.m_fname            },
-    { "tracks",                        nlohmann::json::array() },
-    { "attachments",                   nlohmann::json::array() },
-    { "chapters",                      nlohmann::json::array() },
-    { "global_tags",                   nlohmann::json::array() },
-    { "track_tags",                    nlohmann::json::array() },
-    { "container", {
-        { "recognized", true                                                        },
-        { "supported",  true                                                        },
-        { "type",       m_id_results_container.info                                 },
-        { "properties", verbose_info_to_object(m_id_results_container.verbose_info) },
-      } },
+  auto write_array = [](mtx::json::writer_c &writer, std::vector<id_result_t> const &results, std::function<void(id_result_t const &)> const &write_result) {
+    writer.start_array();
+    for (auto const &result : results)
+      write_result(result);
+    writer.end_array();
   };
 
-  for (auto const &result : m_id_results_tracks)
-    json["tracks"] += nlohmann::json{
-      { "id",         result.id                                   },
-      { "type",       result.type                                 },
-      { "codec",      result.info                                 },
-      { "properties", verbose_info_to_object(result.verbose_info) },
-    };
-
-  for (auto const &result : m_id_results_attachments)
-    json["attachments"] += nlohmann::json{
-      { "id",           result.id                                   },
-      { "content_type", result.type                                 },
-      { "size",         result.size                                 },
-      { "description",  result.description                          },
-      { "file_name",    result.info                                 },
-      { "properties",   verbose_info_to_object(result.verbose_info) },
-    };
-
-  for (auto const &result : m_id_results_chapters)
-    json["chapters"] += nlohmann::json{
-      { "num_entries", result.size },
-    };
-
-  for (auto const &result : m_id_results_tags) {
-    if (ID_RESULT_GLOBAL_TAGS_ID == result.id)
-      json["global_tags"] += nlohmann::json{
-        { "num_entries", result.size },
-      };
-    else
-      json["track_tags"] += nlohmann::json{
-        { "track_id",    result.id   },
-        { "num_entries", result.size },
-      };
-  }
+  auto members = json_member_writers_t{};
+
+  members["identification_format_version"] = [](mtx::json::writer_c &writer) { writer.value(ID_JSON_FORMAT_VERSION); };
+  members["file_name"]                     = [this](mtx::json::writer_c &writer) { writer.value(m_ti.m_fname); };
+
+  members["container"] = [this, &write_verbose_info](mtx::json::writer_c &writer) {
+    writer.start_object();
+    writer.key("properties");
+    write_verbose_info(writer, m_id_results_container.verbose_info);
+    writer
+      .member("recognized", true)
+      .member("supported",  true)
+      .member("type",       m_id_results_container.info)
+      .end_object();
+  };
+
+  members["tracks"] = [this, &write_array, &write_verbose_info](mtx::json::writer_c &writer) {
+    write_array(writer, m_id_results_tracks, [&writer, &write_verbose_info](id_result_t const &result) {
+      writer
+        .start_object()
+        .member("codec", result.info)
+        .member("id",    result.id)
+        .key("properties");
+      write_verbose_info(writer, result.verbose_info);
+      writer
+        .member("type",  result.type)
+        .end_object();
+    });
+  };
+
+  members["attachments"] = [this, &write_array, &write_verbose_info](mtx::json::writer_c &writer) {
+    write_array(writer, m_id_results_attachments, [&writer, &write_verbose_info](id_result_t const &result) {
+      writer
+        .start_object()
+        .member("content_type", result.type)
+        .member("description",  result.description)
+        .member("file_name",    result.info)
+        .member("id",           result.id)
+        .key("properties");
+      write_verbose_info(writer, result.verbose_info);
+      writer
+        .member("size",         result.size)
+        .end_object();
+    });
+  };
+
+  members["chapters"] = [this, &write_array](mtx::json::writer_c &writer) {
+    write_array(writer, m_id_results_chapters, [&writer](id_result_t const &result) {
+      writer.start_object().member("num_entries", result.size).end_object();
+    });
+  };
+
+  members["global_tags"] = [this](mtx::json::writer_c &writer) {
+    writer.start_array();
+    for (auto const &result : m_id_results_tags)
+      if (ID_RESULT_GLOBAL_TAGS_ID == result.id)
+        writer.start_object().member("num_entries", result.size).end_object();
+    writer.end_array();
+  };
+
+  members["track_tags"] = [this](mtx::json::writer_c &writer) {
+    writer.start_array();
+    for (auto const &result : m_id_results_tags)
+      if (ID_RESULT_GLOBAL_TAGS_ID != result.id)
+        writer
+          .start_object()
+          .member("num_entries", result.size)
+          .member("track_id",    result.id)
+          .end_object();
+    writer.end_array();
+  };
 
-  display_json_output(json);
+  display_json_output(members);
 }
 
 void
@@ -18,6 +18,7 @@
 #include "common/file_types.h"
 #include "common/chapters/chapters.h"
 #include "common/math_fwd.h"
+#include "common/tracing.h"
 #include "common/translation.h"
 #include "merge/file_status.h"
 #include "merge/id_result.h"
@@ -64,6 +65,8 @@ protected:
 
   timestamp_c m_restricted_timestamps_min, m_restricted_timestamps_max;
 
+  mtx::tracing::stage_c *m_tracing_stage{};
+
 public:
   generic_reader_c(const track_info_c &ti, const mm_io_cptr &in);
   virtual ~generic_reader_c();
@@ -50,12 +50,14 @@
 #include "common/kax_analyzer.h"
 #include "common/list_utils.h"
 #include "common/mime.h"
+#include "common/mm_async_write_io.h"
 #include "common/mm_file_io.h"
 #include "common/mm_mpls_multi_file_io.h"
 #include "common/segmentinfo.h"
 #include "common/split_arg_parsing.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
+#include "common/tracing.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
 #include "common/webm.h"
@@ -132,9 +134,15 @@ set_usage() {
                   "                           information headers.\n");
   usage_text += Y("  --disable-lacing         Do not use lacing.\n");
   usage_text += Y("  --enable-durations       Enable block durations for all blocks.\n");
+  usage_text += Y("  --enable-cluster-crc32   Write a CRC-32 element at the start of each\n"
+                  "                           cluster.\n");
   usage_text += Y("  --timestamp-scale <n>    Force the timestamp scale factor to n.\n");
   usage_text += Y("  --disable-track-statistics-tags\n"
                   "                           Do not write tags with track statistics.\n");
+  usage_text += Y("  --track-statistics-json <file>\n"
+                  "                           Write detailed statistics for each track\n"
+                  "                           (bitrate histogram, peak bitrates, key frame\n"
+                  "                           intervals, block sizes) to a JSON file.\n");
   usage_text +=   "\n";
   usage_text += Y(" File splitting, linking, appending and concatenating (more global options):\n");
   usage_text += Y("  --split <d[K,M,G]|HH:MM:SS|s>\n"
@@ -157,6 +165,8 @@ set_usage() {
                   "                           Create a new file before each chapter (with 'all')\n"
                   "                           or before chapter numbers A, B etc.\n");
   usage_text += Y("  --split-max-files <n>    Create at most n files.\n");
+  usage_text += Y("  --split-pre-open-files   Open the file for the next part while the\n"
+                  "                           current part is still being written.\n");
   usage_text += Y("  --link                   Link splitted files.\n");
   usage_text += Y("  --link-to-previous <SID> Link the first file to the given SID.\n");
   usage_text += Y("  --link-to-next <SID>     Link the last file to the given SID.\n");
@@ -2371,6 +2381,9 @@ parse_args(std::vector<std::string> args) {
 
       sit++;
 
+    } else if (this_arg == "--split-pre-open-files") {
+      g_split_pre_open_files = true;
+
     } else if (this_arg == "--link") {
       g_no_linking = false;
 
@@ -2417,9 +2430,20 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--enable-durations")
       g_use_durations = true;
 
+    else if (this_arg == "--enable-cluster-crc32")
+      g_cluster_helper->enable_crc32_elements();
+
     else if (this_arg == "--disable-track-statistics-tags")
       g_no_track_statistics_tags = true;
 
+    else if (this_arg == "--track-statistics-json") {
+      if (no_next_arg || next_arg.empty())
+        mxerror(Y("'--track-statistics-json' lacks the file name.\n"));
+
+      g_cluster_helper->enable_detailed_track_statistics(next_arg);
+      sit++;
+    }
+
     else if (this_arg == "--attachment-description") {
       if (no_next_arg)
         mxerror(Y("'--attachment-description' lacks the description.\n"));
@@ -3153,6 +3177,9 @@ main(int argc,
     create_next_output_file();
     main_loop();
     finish_file(true);
+    mm_async_write_io_c::wait_for_pending_operations();
+    g_cluster_helper->write_detailed_track_statistics();
+    mtx::tracing::report();
   } catch (mtx::mm_io::exception &ex) {
     force_close_output_file();
     mxerror(fmt::format("{0} {1} {2} {3}; {4}\n",
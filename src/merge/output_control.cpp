@@ -57,12 +57,15 @@
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/list_utils.h"
+#include "common/locale.h"
+#include "common/mm_async_write_io.h"
 #include "common/mm_io_x.h"
 #include "common/mm_null_io.h"
 #include "common/mm_proxy_io.h"
 #include "common/mm_write_buffer_io.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
+#include "common/tracing.h"
 #include "common/translation.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
@@ -150,6 +153,7 @@ int64_t g_tags_size                         = 0;
 int g_file_num = 1;
 
 int g_split_max_num_files                   = 65535;
+bool g_split_pre_open_files                 = false;
 std::string g_splitting_by_chapters_arg;
 
 append_mode_e g_append_mode                 = APPEND_MODE_FILE_BASED;
@@ -179,6 +183,7 @@ static std::unique_ptr<EbmlVoid> s_void_after_track_headers;
 static std::vector<std::tuple<timestamp_c, std::string, std::string>> s_additional_chapter_atoms;
 
 static mm_io_cptr s_out;
+static std::shared_ptr<mm_async_write_io_c> s_pre_opened_out;
 
 static mtx::bits::value_c s_seguid_prev(128), s_seguid_current(128), s_seguid_next(128);
 
@@ -222,7 +227,7 @@ update_ebml_head() {
   if (g_cluster_helper->discarding())
     return;
 
-  auto result = g_doc_type_version_handler->update_ebml_head(*s_out);
+  auto result = g_doc_type_version_handler->update_ebml_head(*s_head, *s_out);
   if (mtx::included_in(result, mtx::doc_type_version_handler_c::update_result_e::ok_updated, mtx::doc_type_version_handler_c::update_result_e::ok_no_update_needed))
     return;
 
@@ -287,6 +292,7 @@ sighandler(int /* signum */) {
   // Manually close s_out because cleanup() will discard any remaining
   // write buffer content in s_out.
   s_out->close();
+  mm_async_write_io_c::wait_for_pending_operations();
 
   cleanup();
 
@@ -1266,6 +1272,77 @@ prepare_tags_for_rendering() {
   g_tags_size = s_kax_tags->ElementSize();
 }
 
+static void
+discard_pre_opened_output_file() {
+  if (!s_pre_opened_out)
+    return;
+
+  s_pre_opened_out->discard();
+  s_pre_opened_out.reset();
+}
+
+/** \brief Opens a destination file for writing
+
+   When splitting into several files all I/O for the destination files
+   is done by a background thread. That way finishing one file
+   (writing the cues, updating the headers etc.) doesn't stall
+   multiplexing the next part. The file may have been opened in advance
+   already if \c --split-pre-open-files is used.
+*/
+static mm_io_cptr
+open_output_file(std::string const &file_name) {
+  if (!g_cluster_helper->split_mode_produces_many_files())
+    return mm_write_buffer_io_c::open(file_name, 20 * 1024 * 1024);
+
+  mm_io_cptr out;
+
+  if (s_pre_opened_out && (s_pre_opened_out->get_file_name() == file_name)) {
+    out = s_pre_opened_out;
+    s_pre_opened_out->keep();
+    s_pre_opened_out.reset();
+
+  } else {
+    discard_pre_opened_output_file();
+    out = std::make_shared<mm_async_write_io_c>(file_name);
+  }
+
+  return std::make_shared<mm_write_buffer_io_c>(out, 20 * 1024 * 1024);
+}
+
+/** \brief Opens the next destination file in advance
+
+   The file may turn out not to be needed, e.g. if splitting stops
+   early. In that case it is removed again. Existing files must not be
+   touched before the part is actually written. Therefore the file is
+   created under a temporary name if one with the destination name
+   exists already. It will only be renamed if the part is written.
+*/
+static void
+pre_open_next_output_file() {
+  if (   !g_split_pre_open_files
+      || s_pre_opened_out
+      || !g_cluster_helper->split_mode_produces_many_files()
+      || (g_file_num > g_split_max_num_files))
+    return;
+
+  auto file_name = create_output_name();
+  auto exists    = [](std::string const &name) {
+    boost::system::error_code ec;
+    return bfs::exists(g_cc_local_utf8->native(name), ec);
+  };
+
+  if (!exists(file_name)) {
+    s_pre_opened_out = std::make_shared<mm_async_write_io_c>(file_name);
+    return;
+  }
+
+  auto temporary_file_name = std::string{};
+  for (auto idx = 0u; temporary_file_name.empty() || exists(temporary_file_name); ++idx)
+    temporary_file_name = fmt::format("{0}.mkvmerge-{1}.tmp", file_name, idx);
+
+  s_pre_opened_out = std::make_shared<mm_async_write_io_c>(file_name, temporary_file_name);
+}
+
 /** \brief Creates the next output file
 
    Creates a new file name depending on the split settings. Opens that
@@ -1284,7 +1361,7 @@ create_next_output_file() {
 
   // Open the output file.
   try {
-    s_out = !g_cluster_helper->discarding() ? mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
+    s_out = !g_cluster_helper->discarding() ? open_output_file(this_outfile) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
   } catch (mtx::mm_io::exception &ex) {
     mxerror(fmt::format(Y("The file '{0}' could not be opened for writing: {1}.\n"), this_outfile, ex));
   }
@@ -1308,6 +1385,8 @@ create_next_output_file() {
   run_after_file_created_packetizer_hooks();
 
   ++g_file_num;
+
+  pre_open_next_output_file();
 }
 
 static void
@@ -1581,8 +1660,13 @@ finish_file(bool last_file,
 
   update_ebml_head();
 
+  // With background writing active this only queues the remaining
+  // write operations.
   s_out.reset();
 
+  if (last_file)
+    discard_pre_opened_output_file();
+
   g_kax_segment.reset();
   s_kax_sh_void.reset();
   g_kax_sh_main.reset();
@@ -1983,6 +2067,8 @@ discard_queued_packets() {
 */
 void
 main_loop() {
+  mtx::tracing::scope_c tracing_scope{mtx::tracing::get_stage("main loop")};
+
   // Let's go!
   while (1) {
     // Step 1: Make sure a packet is available for each output
@@ -2056,6 +2142,8 @@ cleanup() {
     s_out.reset();
   }
 
+  discard_pre_opened_output_file();
+
   g_cluster_helper.reset();
 
   destroy_readers();
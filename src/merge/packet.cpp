@@ -33,6 +33,67 @@ packet_t::normalize_timestamps() {
     fref                        = ROUND_TIMESTAMP_SCALE(fref);
 }
 
+std::size_t
+packet_t::get_data_size()
+  const {
+  return !data_slices.empty() ? get_memory_slices_size(data_slices)
+       : data                 ? data->get_size()
+       :                        0;
+}
+
+/* A single slice covering a whole buffer is stored as 'data' so that
+   the frame can be rendered directly. */
+void
+packet_t::set_data_slices(memory_slices_c slices) {
+  data_slices.clear();
+
+  if (slices.empty())
+    data = memory_c::alloc(0);
+
+  else if (   (slices.size() == 1)
+           && !slices[0].m_offset
+           && (slices[0].m_size == slices[0].m_memory->get_size()))
+    data = slices[0].m_memory;
+
+  else {
+    data.reset();
+    data_slices = std::move(slices);
+  }
+}
+
+/* Appends a buffer without copying the frame's content. The packet
+   keeps a reference to 'more_data'. */
+void
+packet_t::append_data(memory_cptr const &more_data) {
+  if (data) {
+    data_slices = { { data, 0, data->get_size() } };
+    data.reset();
+  }
+
+  data_slices.push_back({ more_data, 0, more_data->get_size() });
+}
+
+void
+packet_t::join_data_slices() {
+  if (data_slices.empty())
+    return;
+
+  data = join_memory_slices(data_slices);
+  data_slices.clear();
+}
+
+void
+packet_t::take_ownership() {
+  if (data)
+    data->take_ownership();
+
+  for (auto &slice : data_slices)
+    slice.m_memory->take_ownership();
+
+  for (auto &data_add : data_adds)
+    data_add->take_ownership();
+}
+
 void
 packet_t::add_extensions(std::vector<packet_extension_cptr> const &new_extensions) {
   brng::copy(new_extensions, std::back_inserter(extensions));
@@ -47,7 +108,7 @@ packet_t::account(track_statistics_c &statistics,
 uint64_t
 packet_t::calculate_uncompressed_size() {
   if (!uncompressed_size) {
-    uncompressed_size = data->get_size() + boost::accumulate(data_adds, 0ull, [](auto const &sum, auto const &data_add) { return sum + data_add->get_size(); });
+    uncompressed_size = get_data_size() + boost::accumulate(data_adds, 0ull, [](auto const &sum, auto const &data_add) { return sum + data_add->get_size(); });
   }
 
   return *uncompressed_size;
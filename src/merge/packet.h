@@ -47,6 +47,12 @@ using packet_extension_cptr = std::shared_ptr<packet_extension_c>;
 
 struct packet_t {
   memory_cptr data;
+  // If not empty the frame consists of these slices instead of
+  // 'data'. This allows packetizers to replace small parts of a frame
+  // without copying all of it. The slices are joined into one buffer
+  // once, right before the frame is handed over to libmatroska for
+  // rendering; the memory they refer to is kept alive until then.
+  memory_slices_c data_slices;
   std::vector<memory_cptr> data_adds;
   memory_cptr codec_state;
 
@@ -217,6 +223,12 @@ struct packet_t {
     return nullptr;
   }
 
+  std::size_t get_data_size() const;
+  void set_data_slices(memory_slices_c slices);
+  void append_data(memory_cptr const &more_data);
+  void join_data_slices();
+  void take_ownership();
+
   void add_extensions(std::vector<packet_extension_cptr> const &new_extensions);
 
   void normalize_timestamps();
@@ -77,6 +77,11 @@ public:
 
   std::unordered_map<uint64_t, track_statistics_c> track_statistics;
 
+  std::string detailed_track_statistics_file_name;
+  std::unordered_map<uint64_t, detailed_track_statistics_c> detailed_track_statistics;
+
+  bool write_crc32_elements{};
+
   debugging_option_c debug_splitting{"cluster_helper|splitting"}, debug_packets{"cluster_helper|cluster_helper_packets"}, debug_duration{"cluster_helper|cluster_helper_duration"},
     debug_rendering{"cluster_helper|cluster_helper_rendering"}, debug_chapter_generation{"cluster_helper|cluster_helper_chapter_generation"};
 
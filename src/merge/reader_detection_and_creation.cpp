@@ -19,6 +19,7 @@
 #include "common/mm_read_buffer_io.h"
 #include "common/mm_text_io.h"
 #include "common/strings/formatting.h"
+#include "common/tracing.h"
 #include "common/xml/xml.h"
 #include "input/r_aac.h"
 #include "input/r_ac3.h"
@@ -340,6 +341,9 @@ get_file_type_internal(filelist_t &file) {
 
 void
 get_file_type(filelist_t &file) {
+  static auto &s_tracing_stage = mtx::tracing::get_stage("probing file types");
+  mtx::tracing::scope_c tracing_scope{s_tracing_stage};
+
   auto result = get_file_type_internal(file);
 
   g_file_sizes += result.second;
@@ -471,7 +475,14 @@ create_readers() {
       }
 
       file->reader->m_appending = file->appending;
-      file->reader->read_headers();
+
+      {
+        static auto &s_tracing_stage = mtx::tracing::get_stage("reading headers");
+        mtx::tracing::scope_c tracing_scope{s_tracing_stage};
+
+        file->reader->read_headers();
+      }
+
       file->reader->set_timestamp_restrictions(file->restricted_timestamp_min, file->restricted_timestamp_max);
 
       // Re-calculate file size because the reader might switch to a
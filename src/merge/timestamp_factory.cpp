@@ -65,7 +65,7 @@ timestamp_factory_c::create(std::string const &file_name,
   else
     mxerror(fmt::format(Y("The timestamp file '{0}' contains an unsupported/unrecognized format (version {1}).\n"), file_name, version));
 
-  factory->parse(*in);
+  factory->parse(in);
 
   return timestamp_factory_cptr(factory);
 }
@@ -77,15 +77,13 @@ timestamp_factory_c::create_fps_factory(int64_t default_duration,
 }
 
 void
-timestamp_factory_v1_c::parse(mm_io_c &in) {
+timestamp_factory_v1_c::parse(mm_io_cptr const &in) {
   std::string line;
   timestamp_range_c t;
-  std::vector<timestamp_range_c>::iterator iit;
-  std::vector<timestamp_range_c>::const_iterator pit;
 
   int line_no = 1;
   do {
-    if (!in.getline2(line))
+    if (!in->getline2(line))
       mxerror(fmt::format(Y("The timestamp file '{0}' does not contain a valid 'Assume' line with the default number of frames per second.\n"), m_file_name));
     line_no++;
     strip(line);
@@ -102,7 +100,7 @@ timestamp_factory_v1_c::parse(mm_io_c &in) {
   if (!parse_number(line.c_str(), m_default_fps))
     mxerror(fmt::format(Y("The timestamp file '{0}' does not contain a valid 'Assume' line with the default number of frames per second.\n"), m_file_name));
 
-  while (in.getline2(line)) {
+  while (in->getline2(line)) {
     line_no++;
     strip(line, true);
     if (line.empty() || ('#' == line[0]))
@@ -128,47 +126,53 @@ timestamp_factory_v1_c::parse(mm_io_c &in) {
 
   mxdebug_if(m_debug, fmt::format("ext_timestamps: Version 1, default fps {0}, {1} entries.\n", m_default_fps, m_ranges.size()));
 
-  if (m_ranges.size() == 0)
-    t.start_frame = 0;
-  else {
-    std::sort(m_ranges.begin(), m_ranges.end());
-    bool done;
-    do {
-      done = true;
-      iit  = m_ranges.begin();
-      size_t i;
-      for (i = 0; i < (m_ranges.size() - 1); i++) {
-        iit++;
-        if (m_ranges[i].end_frame < (m_ranges[i + 1].start_frame - 1)) {
-          t.start_frame = m_ranges[i].end_frame + 1;
-          t.end_frame = m_ranges[i + 1].start_frame - 1;
-          t.fps = m_default_fps;
-          m_ranges.insert(iit, t);
-          done = false;
-          break;
-        }
-      }
-    } while (!done);
-    if (m_ranges[0].start_frame != 0) {
-      t.start_frame = 0;
-      t.end_frame = m_ranges[0].start_frame - 1;
-      t.fps = m_default_fps;
-      m_ranges.insert(m_ranges.begin(), t);
-    }
-    t.start_frame = m_ranges[m_ranges.size() - 1].end_frame + 1;
+  fill_gaps_between_ranges();
+
+  m_ranges[0].base_timestamp = 0.0;
+  for (auto idx = 1u; idx < m_ranges.size(); ++idx) {
+    auto const &previous          = m_ranges[idx - 1];
+    m_ranges[idx].base_timestamp  = previous.base_timestamp + ((double)previous.end_frame - (double)previous.start_frame + 1) * 1000000000.0 / previous.fps;
   }
 
-  t.end_frame = 0xfffffffffffffffll;
-  t.fps       = m_default_fps;
-  m_ranges.push_back(t);
+  if (m_debug)
+    for (auto const &range : m_ranges)
+      mxdebug(fmt::format("ranges: entry {0} -> {1} at {2} with {3}\n", range.start_frame, range.end_frame, range.fps, range.base_timestamp));
+}
 
-  m_ranges[0].base_timestamp = 0.0;
-  pit = m_ranges.begin();
-  for (iit = m_ranges.begin() + 1; iit < m_ranges.end(); iit++, pit++)
-    iit->base_timestamp = pit->base_timestamp + ((double)pit->end_frame - (double)pit->start_frame + 1) * 1000000000.0 / pit->fps;
+/** \brief Covers all frames not mentioned in the file with ranges using the default FPS
+
+   Done in a single pass over the sorted ranges so that files with
+   millions of entries don't take quadratic time.
+ */
+void
+timestamp_factory_v1_c::fill_gaps_between_ranges() {
+  std::sort(m_ranges.begin(), m_ranges.end());
+
+  std::vector<timestamp_range_c> filled;
+  filled.reserve(m_ranges.size() * 2 + 2);
+
+  timestamp_range_c t;
+  t.fps            = m_default_fps;
+  t.base_timestamp = 0.0;
+
+  uint64_t next_frame = 0;
+
+  for (auto const &range : m_ranges) {
+    if (range.start_frame > next_frame) {
+      t.start_frame = next_frame;
+      t.end_frame   = range.start_frame - 1;
+      filled.push_back(t);
+    }
 
-  for (iit = m_ranges.begin(); iit < m_ranges.end(); iit++)
-    mxdebug_if(m_debug, fmt::format("ranges: entry {0} -> {1} at {2} with {3}\n", iit->start_frame, iit->end_frame, iit->fps, iit->base_timestamp));
+    filled.push_back(range);
+    next_frame = range.end_frame + 1;
+  }
+
+  t.start_frame = next_frame;
+  t.end_frame   = 0xfffffffffffffffll;
+  filled.push_back(t);
+
+  m_ranges = std::move(filled);
 }
 
 bool
@@ -179,32 +183,39 @@ timestamp_factory_v1_c::get_next(packet_cptr &packet) {
 
   m_frameno++;
   if ((m_frameno > m_ranges[m_current_range].end_frame) && (m_current_range < (m_ranges.size() - 1)))
-    m_current_range++;
+    m_current_range = find_range(m_frameno);
 
   mxdebug_if(m_debug, fmt::format("ext_timestamps v1: tc {0} dur {1} for {2}\n", packet->assigned_timestamp, packet->duration, m_frameno - 1));
 
   return false;
 }
 
+uint32_t
+timestamp_factory_v1_c::find_range(uint64_t frame)
+  const {
+  auto itr = std::upper_bound(m_ranges.begin(), m_ranges.end(), frame, [](uint64_t value, timestamp_range_c const &range) { return value < range.start_frame; });
+  return itr == m_ranges.begin() ? 0 : std::distance(m_ranges.begin(), itr) - 1;
+}
+
 int64_t
 timestamp_factory_v1_c::get_at(uint64_t frame) {
-  timestamp_range_c *t = &m_ranges[m_current_range];
-  if ((frame > t->end_frame) && (m_current_range < (m_ranges.size() - 1)))
-    t = &m_ranges[m_current_range + 1];
+  auto t = &m_ranges[m_current_range];
+
+  if ((frame < t->start_frame) || (frame > t->end_frame)) {
+    if ((m_current_range < (m_ranges.size() - 1)) && (frame == (t->end_frame + 1)))
+      t = &m_ranges[m_current_range + 1];
+    else
+      t = &m_ranges[find_range(frame)];
+  }
 
   return (int64_t)(t->base_timestamp + 1000000000.0 * (frame - t->start_frame) / t->fps);
 }
 
-void
-timestamp_factory_v2_c::parse(mm_io_c &in) {
+boost::optional<int64_t>
+timestamp_factory_v2_c::read_next_timestamp(int &line_no) {
   std::string line;
-  std::map<int64_t, int64_t> dur_map;
-
-  int64_t dur_sum          = 0;
-  int line_no              = 0;
-  double previous_timestamp = 0;
 
-  while (in.getline2(line)) {
+  while (m_in->getline2(line)) {
     line_no++;
     strip(line);
     if ((line.length() == 0) || (line[0] == '#'))
@@ -214,7 +225,29 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
     if (!parse_number(line.c_str(), timestamp))
       mxerror(fmt::format(Y("The line {0} of the timestamp file '{1}' does not contain a valid floating point number.\n"), line_no, m_file_name));
 
-    if ((2 == m_version) && (timestamp < previous_timestamp))
+    return static_cast<int64_t>(timestamp * 1000000);
+  }
+
+  return {};
+}
+
+void
+timestamp_factory_v2_c::parse(mm_io_cptr const &in) {
+  std::map<int64_t, int64_t> dur_map;
+
+  int64_t dur_sum           = 0;
+  int line_no               = 0;
+  int64_t previous_timestamp = 0;
+
+  m_in             = in;
+  m_data_start_pos = m_in->getFilePointer();
+
+  while (true) {
+    auto timestamp = read_next_timestamp(line_no);
+    if (!timestamp)
+      break;
+
+    if ((2 == m_version) && (*timestamp < previous_timestamp))
       mxerror(fmt::format(Y("The timestamp v2 file '{0}' contains timestamps that are not ordered. "
                             "Due to a bug in mkvmerge versions up to and including v1.5.0 this was necessary "
                             "if the track to which the timestamp file was applied contained B frames. "
@@ -223,24 +256,23 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
                             "the first timestamps being '0', '40', '80', '120' etc and. not '0', '120', '40', '80' etc.\n\n"
                             "If you really have to specify non-sorted timestamps then use the timestamp format v4. "
                             "It is identical to format v2 but allows non-sorted timestamps.\n"),
-                          in.get_file_name()));
-
-    previous_timestamp = timestamp;
-    m_timestamps.push_back((int64_t)(timestamp * 1000000));
-    if (m_timestamps.size() > 1) {
-      int64_t duration = m_timestamps[m_timestamps.size() - 1] - m_timestamps[m_timestamps.size() - 2];
-      if (dur_map.find(duration) == dur_map.end())
-        dur_map[duration] = 1;
-      else
-        dur_map[duration] = dur_map[duration] + 1;
+                          in->get_file_name()));
+
+    if (m_num_timestamps) {
+      int64_t duration = *timestamp - previous_timestamp;
+      dur_map[duration]++;
       dur_sum += duration;
-      m_durations.push_back(duration);
     }
+
+    previous_timestamp = *timestamp;
+    ++m_num_timestamps;
   }
 
-  if (m_timestamps.empty())
+  if (!m_num_timestamps)
     mxerror(fmt::format(Y("The timestamp file '{0}' does not contain any valid entry.\n"), m_file_name));
 
+  m_last_timestamp = previous_timestamp;
+
   if (m_debug) {
     mxdebug("Absolute probablities with maximum in separate line:\n");
     mxdebug("Duration  | Absolute probability\n");
@@ -260,42 +292,68 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
   if (0 < dur_sum)
     m_default_duration = dur_sum;
 
-  m_durations.push_back(dur_sum);
+  // The last frame lasts as long as the most common duration.
+  m_last_duration = dur_sum;
+
+  m_in->setFilePointer(m_data_start_pos);
+}
+
+void
+timestamp_factory_v2_c::fill_window() {
+  // At least two timestamps are needed for calculating the current
+  // frame's duration.
+  if (m_window.size() >= 2)
+    return;
+
+  int line_no = 0;
+
+  while (m_window.size() < ms_window_size) {
+    auto timestamp = read_next_timestamp(line_no);
+    if (!timestamp)
+      break;
+
+    m_window.push_back(*timestamp);
+  }
 }
 
 bool
 timestamp_factory_v2_c::get_next(packet_cptr &packet) {
-  if ((static_cast<size_t>(m_frameno) >= m_timestamps.size()) && !m_warning_printed) {
-    mxwarn_tid(m_source_name, m_tid,
-               fmt::format(Y("The number of external timestamps {0} is smaller than the number of frames in this track. "
-                             "The remaining frames of this track might not be timestamped the way you intended them to be. mkvmerge might even crash.\n"),
-                           m_timestamps.size()));
-    m_warning_printed = true;
-
-    if (m_timestamps.empty()) {
-      packet->assigned_timestamp = 0;
-      if (!m_preserve_duration || (0 >= packet->duration))
-        packet->duration = 0;
-
-    } else {
-      packet->assigned_timestamp = m_timestamps.back();
-      if (!m_preserve_duration || (0 >= packet->duration))
-        packet->duration = m_timestamps.back();
+  if (static_cast<uint64_t>(m_frameno) >= m_num_timestamps) {
+    if (!m_warning_printed) {
+      mxwarn_tid(m_source_name, m_tid,
+                 fmt::format(Y("The number of external timestamps {0} is smaller than the number of frames in this track. "
+                               "The remaining frames of this track might not be timestamped the way you intended them to be. mkvmerge might even crash.\n"),
+                             m_num_timestamps));
+      m_warning_printed = true;
     }
 
+    packet->assigned_timestamp = m_last_timestamp;
+    if (!m_preserve_duration || (0 >= packet->duration))
+      packet->duration = m_last_timestamp;
+
     return false;
   }
 
-  packet->assigned_timestamp = m_timestamps[m_frameno];
+  fill_window();
+
+  if (m_window.empty()) {
+    // The file has been truncated since it was parsed.
+    m_num_timestamps = m_frameno;
+    return get_next(packet);
+  }
+
+  packet->assigned_timestamp = m_window.front();
   if (!m_preserve_duration || (0 >= packet->duration))
-    packet->duration = m_durations[m_frameno];
+    packet->duration = m_window.size() >= 2 ? m_window[1] - m_window[0] : m_last_duration;
+
+  m_window.pop_front();
   m_frameno++;
 
   return false;
 }
 
 void
-timestamp_factory_v3_c::parse(mm_io_c &in) {
+timestamp_factory_v3_c::parse(mm_io_cptr const &in) {
   std::string line;
   timestamp_duration_c t;
   std::vector<timestamp_duration_c>::iterator iit;
@@ -304,7 +362,7 @@ timestamp_factory_v3_c::parse(mm_io_c &in) {
 
   int line_no = 1;
   do {
-    if (!in.getline2(line))
+    if (!in->getline2(line))
       mxerror(err_msg_assume);
     line_no++;
     strip(line);
@@ -320,7 +378,7 @@ timestamp_factory_v3_c::parse(mm_io_c &in) {
   if (!parse_number(line.c_str(), m_default_fps))
     mxerror(err_msg_assume);
 
-  while (in.getline2(line)) {
+  while (in->getline2(line)) {
     line_no++;
     strip(line, true);
     if ((line.length() == 0) || (line[0] == '#'))
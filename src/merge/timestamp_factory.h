@@ -69,7 +69,7 @@ public:
   virtual ~timestamp_factory_c() {
   }
 
-  virtual void parse(mm_io_c &) {
+  virtual void parse(mm_io_cptr const &) {
   }
   virtual bool get_next(packet_cptr &packet) {
     // No gap is following!
@@ -112,7 +112,7 @@ public:
   virtual ~timestamp_factory_v1_c() {
   }
 
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual double get_default_duration(double proposal) {
     return 0.0 != m_default_fps ? 1000000000.0 / m_default_fps : proposal;
@@ -120,15 +120,27 @@ public:
 
 protected:
   virtual int64_t get_at(uint64_t frame);
+  virtual uint32_t find_range(uint64_t frame) const;
+  virtual void fill_gaps_between_ranges();
 };
 
+// Timestamps from v2/v4 files aren't kept in memory. parse() only
+// validates the file and gathers the statistics needed for the
+// default duration. Afterwards the timestamps are read on demand into
+// a window of fixed size.
 class timestamp_factory_v2_c: public timestamp_factory_c {
 protected:
-  std::vector<int64_t> m_timestamps, m_durations;
+  mm_io_cptr m_in;
+  int64_t m_data_start_pos{};
+  std::deque<int64_t> m_window;
+  uint64_t m_num_timestamps{};
+  int64_t m_last_timestamp{}, m_last_duration{};
   int64_t m_frameno;
   double m_default_duration;
   bool m_warning_printed;
 
+  static std::size_t const ms_window_size = 1024;
+
 public:
   timestamp_factory_v2_c(const std::string &file_name,
                         const std::string &source_name,
@@ -142,11 +154,15 @@ public:
   virtual ~timestamp_factory_v2_c() {
   }
 
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual double get_default_duration(double proposal) {
     return m_default_duration != 0 ? m_default_duration : proposal;
   }
+
+protected:
+  virtual boost::optional<int64_t> read_next_timestamp(int &line_no);
+  virtual void fill_window();
 };
 
 class timestamp_factory_v3_c: public timestamp_factory_c {
@@ -168,7 +184,7 @@ public:
     , m_default_fps(0.0)
   {
   }
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual bool contains_gap() {
     return true;
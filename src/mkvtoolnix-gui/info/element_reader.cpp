@@ -16,10 +16,10 @@ using namespace libmatroska;
 namespace mtx { namespace gui { namespace Info {
 
 ElementReader::ElementReader(mm_io_c &in,
-                             EbmlElement &element,
+                             uint64_t position,
                              QModelIndex const &idx)
   : m_in{in}
-  , m_element{element}
+  , m_position{position}
   , m_idx{idx}
 {
 }
@@ -33,26 +33,36 @@ ElementReader::abort() {
 
 void
 ElementReader::run() {
-  try {
-    m_in.setFilePointer(m_element.GetElementPosition());
+  std::unique_ptr<EbmlElement> element;
 
-    auto callbacks = find_ebml_callbacks(EBML_INFO(KaxSegment), EbmlId(m_element));
-    if (!callbacks)
-      callbacks = &EBML_CLASS_CALLBACK(KaxSegment);
+  try {
+    m_in.setFilePointer(m_position);
 
     EbmlStream es(m_in);
     auto upper_lvl_el = static_cast<EbmlElement *>(nullptr);
     auto upper_lvl    = 0;
 
-    m_element.Read(es, EBML_INFO_CONTEXT(*callbacks), upper_lvl, upper_lvl_el, true);
+    element.reset(es.FindNextElement(EBML_CLASS_CONTEXT(KaxSegment), upper_lvl, 0xFFFFFFFFL, true));
+
+    if (element && (static_cast<uint64_t>(element->GetElementPosition()) == m_position)) {
+      auto callbacks = find_ebml_callbacks(EBML_INFO(KaxSegment), EbmlId(*element));
+      if (!callbacks)
+        callbacks = &EBML_CLASS_CALLBACK(KaxSegment);
+
+      upper_lvl = 0;
+      element->Read(es, EBML_INFO_CONTEXT(*callbacks), upper_lvl, upper_lvl_el, true);
+
+      if (upper_lvl)
+        delete upper_lvl_el;
 
-    if (upper_lvl)
-      delete upper_lvl_el;
+    } else
+      element.reset();
 
   } catch (mtx::mm_io::exception &) {
+    element.reset();
   }
 
-  emit elementRead(m_idx);
+  emit elementRead(m_idx, element.release());
 }
 
 }}}
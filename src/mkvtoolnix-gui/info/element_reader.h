@@ -15,18 +15,20 @@ class ElementReader : public QObject, public Util::Runnable {
 
 protected:
   mm_io_c &m_in;
-  EbmlElement &m_element;
+  uint64_t m_position;
   QModelIndex m_idx;
 
 public:
-  explicit ElementReader(mm_io_c &in, EbmlElement &m_element, QModelIndex const &idx);
+  explicit ElementReader(mm_io_c &in, uint64_t position, QModelIndex const &idx);
   virtual ~ElementReader();
 
   virtual void run() override;
   virtual void abort() override;
 
 signals:
-  void elementRead(const QModelIndex &idx);
+  // The receiver takes ownership of the element. It is null if the
+  // element couldn't be read.
+  void elementRead(const QModelIndex &idx, EbmlElement *element);
 };
 
 }}}
@@ -2,12 +2,14 @@
 
 #include <QDebug>
 #include <QLocale>
+#include <QPersistentModelIndex>
 
 #include <ebml/EbmlDummy.h>
 #include <matroska/KaxSegment.h>
 
 #include "common/checksums/base.h"
 #include "common/kax_element_names.h"
+#include "common/kax_file.h"
 #include "common/qt.h"
 #include "mkvtoolnix-gui/info/model.h"
 #include "mkvtoolnix-gui/util/kax_info.h"
@@ -17,10 +19,35 @@ using namespace libmatroska;
 
 namespace mtx { namespace gui { namespace Info {
 
+namespace {
+
+int const s_level1ItemsBatchSize = 1000;
+uint64_t const s_maxLoadedLevel1Size = 256 * 1024 * 1024;
+
+}
+
 class ModelPrivate {
 public:
+  struct LoadedLevel1Element {
+    QPersistentModelIndex m_idx;
+    std::shared_ptr<EbmlElement> m_element;
+    uint64_t m_size{};
+  };
+
   std::unique_ptr<Util::KaxInfo> m_info;
   QVector<QStandardItem *> m_treeInsertionPosition;
+
+  // The level 1 elements following the first cluster. Items are only
+  // created for them once the view needs them (see fetchMore()).
+  std::vector<Util::KaxInfo::Level1Element> m_level1Elements;
+  QStandardItem *m_level1Parent{};
+  int m_level1FirstRow{}, m_numLevel1ItemsCreated{};
+
+  // Level 1 elements that have been read fully on expansion, least
+  // recently read first. Old ones are dropped once their total size
+  // exceeds s_maxLoadedLevel1Size.
+  std::list<LoadedLevel1Element> m_loadedLevel1Elements;
+  uint64_t m_loadedLevel1Size{};
 };
 
 Model::Model(QObject *parent)
@@ -100,6 +127,13 @@ Model::retranslateUi() {
     if (element) {
       auto items = itemsForRow(idx);
       setItemsFromElement(items, *element);
+      return;
+    }
+
+    auto level1Element = level1ElementFor(*itemFromIndex(idx));
+    if (level1Element) {
+      auto items = itemsForRow(idx);
+      setItemsFromLevel1Element(items, *level1Element);
     }
   });
 }
@@ -124,6 +158,32 @@ Model::setItemsFromElement(QList<QStandardItem *> &items,
   items[0]->setData(static_cast<qint64>(EbmlId(element).GetValue()), Roles::EbmlId);
 }
 
+void
+Model::setItemsFromLevel1Element(QList<QStandardItem *> &items,
+                                 Util::KaxInfo::Level1Element const &element) {
+  auto nameAndStatus = elementName(element.m_id);
+  auto locale        = QLocale::system();
+
+  items[0]->setText(nameAndStatus.first);
+  items[1]->setText({});
+  items[2]->setText(locale.toString(static_cast<quint64>(element.m_position)));
+  items[3]->setText(element.m_finiteSize ? locale.toString(static_cast<quint64>(element.m_size)) : QY("unknown"));
+
+  items[2]->setTextAlignment(Qt::AlignRight);
+  items[3]->setTextAlignment(Qt::AlignRight);
+
+  items[0]->setData(QVariant{},                                Roles::Element);
+  items[0]->setData(static_cast<qint64>(element.m_id),       Roles::EbmlId);
+  items[0]->setData(static_cast<qint64>(element.m_position), Roles::Position);
+  items[0]->setData(static_cast<qint64>(element.m_size),     Roles::Size);
+  items[0]->setData(!element.m_finiteSize,                   Roles::UnknownSize);
+
+  if (element.m_master) {
+    items[0]->setData(true,  Roles::DeferredLoad);
+    items[0]->setData(false, Roles::Loaded);
+  }
+}
+
 void
 Model::reset() {
   auto p = p_func();
@@ -134,6 +194,14 @@ Model::reset() {
   p->m_treeInsertionPosition.clear();
   p->m_treeInsertionPosition << invisibleRootItem();
 
+  p->m_level1Elements.clear();
+  p->m_level1Parent          = nullptr;
+  p->m_level1FirstRow        = 0;
+  p->m_numLevel1ItemsCreated = 0;
+
+  p->m_loadedLevel1Elements.clear();
+  p->m_loadedLevel1Size      = 0;
+
   endResetModel();
 }
 
@@ -162,6 +230,79 @@ Model::addElement(int level,
   p->m_treeInsertionPosition << items[0];
 }
 
+void
+Model::addLevel1Elements(QVector<Util::KaxInfo::Level1Element> const &elements) {
+  auto p = p_func();
+
+  if (!p->m_level1Parent) {
+    while (p->m_treeInsertionPosition.size() > 2)
+      p->m_treeInsertionPosition.removeLast();
+
+    if (p->m_treeInsertionPosition.size() < 2) {
+      qDebug() << "addLevel1Elements: no segment to add" << elements.size() << "level 1 elements to";
+      return;
+    }
+
+    p->m_level1Parent   = p->m_treeInsertionPosition.last();
+    p->m_level1FirstRow = p->m_level1Parent->rowCount();
+  }
+
+  p->m_level1Elements.insert(p->m_level1Elements.end(), elements.begin(), elements.end());
+
+  // Make the first couple of elements visible right away. Items for the
+  // rest are created when the view scrolls towards them.
+  if (p->m_numLevel1ItemsCreated < s_level1ItemsBatchSize)
+    createLevel1ElementItems(s_level1ItemsBatchSize - p->m_numLevel1ItemsCreated);
+}
+
+boost::optional<Util::KaxInfo::Level1Element>
+Model::level1ElementFor(QStandardItem const &item)
+  const {
+  auto p = p_func();
+
+  if (!p->m_level1Parent || (item.parent() != p->m_level1Parent) || (item.column() != 0))
+    return {};
+
+  auto idx = item.row() - p->m_level1FirstRow;
+  if ((idx < 0) || (idx >= p->m_numLevel1ItemsCreated))
+    return {};
+
+  return p->m_level1Elements[idx];
+}
+
+void
+Model::createLevel1ElementItems(int numItems) {
+  auto p   = p_func();
+  auto end = std::min<int>(p->m_numLevel1ItemsCreated + numItems, p->m_level1Elements.size());
+
+  if (!p->m_level1Parent)
+    return;
+
+  for (; p->m_numLevel1ItemsCreated < end; ++p->m_numLevel1ItemsCreated) {
+    auto items = newItems();
+    setItemsFromLevel1Element(items, p->m_level1Elements[p->m_numLevel1ItemsCreated]);
+
+    p->m_level1Parent->appendRow(items);
+  }
+}
+
+bool
+Model::canFetchMore(QModelIndex const &parent)
+  const {
+  auto p = p_func();
+
+  if (!parent.isValid() || !p->m_level1Parent || (itemFromIndex(parent) != p->m_level1Parent))
+    return QStandardItemModel::canFetchMore(parent);
+
+  return p->m_numLevel1ItemsCreated < static_cast<int>(p->m_level1Elements.size());
+}
+
+void
+Model::fetchMore(QModelIndex const &parent) {
+  if (canFetchMore(parent))
+    createLevel1ElementItems(s_level1ItemsBatchSize);
+}
+
 void
 Model::addElementInfo(int level,
                       QString const &text,
@@ -277,6 +418,9 @@ Model::hasChildren(const QModelIndex &parent)
     return QStandardItemModel::hasChildren(parent);
 
   auto item = itemFromIndex(parent);
+  if (canFetchMore(parent))
+    return true;
+
   if (!item->data(Roles::DeferredLoad).toBool())
     return QStandardItemModel::hasChildren(parent);
 
@@ -292,45 +436,97 @@ Model::forgetLevel1ElementChildren(QModelIndex const &idx) {
   if (!idx.isValid())
     return;
 
+  auto p    = p_func();
   auto item = itemFromIndex(idx);
-  if (!item->data(Roles::DeferredLoad).toBool() || !item->data(Roles::DeferredLoad).toBool())
+  if (!item->data(Roles::DeferredLoad).toBool() || !item->data(Roles::Loaded).toBool())
     return;
 
   item->removeRows(0, item->rowCount());
-  item->setData(false, Roles::Loaded);
 
-  auto element = dynamic_cast<EbmlMaster *>(elementFromItem(*item));
-  if (!element)
+  auto level1Element = level1ElementFor(*item);
+  if (level1Element) {
+    auto items = itemsForRow(idx);
+    setItemsFromLevel1Element(items, *level1Element);
+
+  } else
+    item->setData(false, Roles::Loaded);
+
+  // Only now that no item refers to the element's children anymore may
+  // the element be freed.
+  auto itr = brng::find_if(p->m_loadedLevel1Elements, [&idx](auto const &loaded) { return loaded.m_idx == idx; });
+  if (itr == p->m_loadedLevel1Elements.end())
     return;
 
-  for (auto child : *element)
-    delete child;
-  element->RemoveAll();
+  p->m_loadedLevel1Size -= itr->m_size;
+  p->m_loadedLevel1Elements.erase(itr);
 }
 
 void
-Model::addChildrenOfLevel1Element(QModelIndex const &idx) {
+Model::evictLevel1Elements(QStandardItem const *keep) {
+  auto p = p_func();
+
+  while (   (p->m_loadedLevel1Size > s_maxLoadedLevel1Size)
+         && !p->m_loadedLevel1Elements.empty()
+         && (itemFromIndex(p->m_loadedLevel1Elements.front().m_idx) != keep)) {
+    auto loaded = std::move(p->m_loadedLevel1Elements.front());
+    auto idx    = QModelIndex{loaded.m_idx};
+
+    p->m_loadedLevel1Elements.pop_front();
+    p->m_loadedLevel1Size -= loaded.m_size;
+
+    if (!idx.isValid())
+      continue;
+
+    qDebug() << "evictLevel1Elements: dropping element at" << loaded.m_element->GetElementPosition() << "size" << loaded.m_size;
+
+    emit collapseRequested(idx);
+    forgetLevel1ElementChildren(idx);
+  }
+}
+
+void
+Model::addChildrenOfLevel1Element(QModelIndex const &idx,
+                                  EbmlElement *element) {
+  auto elementPtr = std::shared_ptr<EbmlElement>{element};
+
   if (!idx.isValid())
     return;
 
-  auto p       = p_func();
-  auto element = elementFromIndex(idx);
-  auto master  = dynamic_cast<EbmlMaster *>(element);
-  auto parent  = itemFromIndex(idx);
-  auto items   = itemsForRow(idx);
-
-  if (element)
-    setItemsFromElement(items, *element);
+  auto p             = p_func();
+  auto master        = dynamic_cast<EbmlMaster *>(element);
+  auto parent        = itemFromIndex(idx);
+  auto items         = itemsForRow(idx);
+  auto level1Element = level1ElementFor(*parent);
+
+  if (!element) {
+    if (level1Element)
+      setItemsFromLevel1Element(items, *level1Element);
+    return;
+  }
 
-  if (!master)
+  // The element may have been expanded, collapsed & expanded again
+  // before the first read finished.
+  if (parent->data(Roles::Loaded).toBool())
     return;
 
-  p->m_info->run_generic_pre_processors(*element);
+  setItemsFromElement(items, *element);
+  parent->setData(true, Roles::Loaded);
+
+  auto size = level1Element ? level1Element->m_size : static_cast<uint64_t>(kax_file_c::get_element_size(*element));
+
+  p->m_loadedLevel1Elements.push_back({ QPersistentModelIndex{idx}, elementPtr, size });
+  p->m_loadedLevel1Size += size;
 
-  for (auto child : *master)
-    addElementStructure(*parent, *child);
+  if (master) {
+    p->m_info->run_generic_pre_processors(*element);
+
+    for (auto child : *master)
+      addElementStructure(*parent, *child);
 
-  p->m_info->run_generic_post_processors(*element);
+    p->m_info->run_generic_post_processors(*element);
+  }
+
+  evictLevel1Elements(parent);
 }
 
 std::pair<QString, bool>
@@ -346,4 +542,14 @@ Model::elementName(EbmlElement &element) {
   return { Q(name), true };
 }
 
+std::pair<QString, bool>
+Model::elementName(uint32_t id) {
+  auto name = kax_element_names_c::get(id);
+
+  if (name.empty())
+    return { Q(fmt::format(Y("Unknown element (ID: 0x{0})"), kax_info_c::format_ebml_id_as_hex(id))), false };
+
+  return { Q(name), true };
+}
+
 }}}
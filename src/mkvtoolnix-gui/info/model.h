@@ -3,6 +3,7 @@
 #include "common/common_pch.h"
 
 #include "mkvtoolnix-gui/jobs/job.h"
+#include "mkvtoolnix-gui/util/kax_info.h"
 
 #include <QStandardItemModel>
 
@@ -14,10 +15,6 @@ class KaxSimpleBlock;
 
 namespace mtx { namespace gui {
 
-namespace Util {
-class KaxInfo;
-}
-
 namespace Info {
 
 namespace Roles {
@@ -28,6 +25,7 @@ int constexpr Loaded       = Qt::UserRole + 4;
 int constexpr Position     = Qt::UserRole + 5;
 int constexpr Size         = Qt::UserRole + 6;
 int constexpr PseudoType   = Qt::UserRole + 7;
+int constexpr UnknownSize  = Qt::UserRole + 8;
 }
 
 namespace PseudoTypes {
@@ -59,21 +57,34 @@ public:
   QList<QStandardItem *> itemsForRow(QModelIndex const &idx);
   QList<QStandardItem *> newItems() const;
   void setItemsFromElement(QList<QStandardItem *> &items, libebml::EbmlElement &element);
+  void setItemsFromLevel1Element(QList<QStandardItem *> &items, Util::KaxInfo::Level1Element const &element);
 
   void reset();
 
   bool hasChildren(const QModelIndex &parent) const override;
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
+
   std::pair<QString, bool> elementName(libebml::EbmlElement &element);
+  std::pair<QString, bool> elementName(uint32_t id);
+
+signals:
+  void collapseRequested(QModelIndex const &idx);
 
 public slots:
   void addElement(int level, libebml::EbmlElement *element, bool readFully);
   void addElementInfo(int level, QString const &text, boost::optional<int64_t> position, boost::optional<int64_t> size);
   void addElementStructure(QStandardItem &parent, libebml::EbmlElement &element);
 
-  void addChildrenOfLevel1Element(QModelIndex const &idx);
+  void addLevel1Elements(QVector<mtx::gui::Util::KaxInfo::Level1Element> const &elements);
+  void addChildrenOfLevel1Element(QModelIndex const &idx, libebml::EbmlElement *element);
   void forgetLevel1ElementChildren(QModelIndex const &idx);
 
 protected:
+  boost::optional<Util::KaxInfo::Level1Element> level1ElementFor(QStandardItem const &item) const;
+  void createLevel1ElementItems(int numItems);
+  void evictLevel1Elements(QStandardItem const *keep);
+
   template<typename T> void addFrameInfoFor(T &block);
   // void addFrameInfoFor(libmatroska::KaxSimpleBlock &block);
   void addFrameInfo(libmatroska::DataBuffer &buffer, int64_t position);
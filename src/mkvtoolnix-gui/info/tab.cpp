@@ -74,10 +74,11 @@ Tab::Tab(QWidget *parent)
 
   Util::HeaderViewManager::create(*p->m_ui->elements, "Info::Elements");
 
-  connect(p->m_ui->elements,      &QTreeView::customContextMenuRequested, this,       &Tab::showContextMenu);
-  connect(p->m_ui->elements,      &QTreeView::expanded,                   this,       &Tab::readLevel1Element);
-  connect(p->m_ui->elements,      &QTreeView::collapsed,                  p->m_model, &Model::forgetLevel1ElementChildren);
-  connect(p->m_showHexDumpAction, &QAction::triggered,                    this,       &Tab::showElementHexDumpInViewer);
+  connect(p->m_ui->elements,      &QTreeView::customContextMenuRequested, this,              &Tab::showContextMenu);
+  connect(p->m_ui->elements,      &QTreeView::expanded,                   this,              &Tab::readLevel1Element);
+  connect(p->m_ui->elements,      &QTreeView::collapsed,                  p->m_model,        &Model::forgetLevel1ElementChildren);
+  connect(p->m_model,             &Model::collapseRequested,              p->m_ui->elements, &QTreeView::collapse);
+  connect(p->m_showHexDumpAction, &QAction::triggered,                    this,              &Tab::showElementHexDumpInViewer);
 
   retranslateUi();
 
@@ -128,6 +129,7 @@ Tab::load(QString const &fileName) {
     connect(&info, &Util::KaxInfo::errorFound,                 this,              &Tab::showError);
     connect(&info, &Util::KaxInfo::elementFound,               p->m_model,        &Model::addElement);
     connect(&info, &Util::KaxInfo::elementInfoFound,           p->m_model,        &Model::addElementInfo);
+    connect(&info, &Util::KaxInfo::level1ElementsFound,        p->m_model,        &Model::addLevel1Elements);
 
     emit titleChanged();
 
@@ -234,16 +236,17 @@ Tab::readLevel1Element(QModelIndex const &idx) {
   if (!idx.isValid())
     return;
 
-  auto p       = p_func();
-  auto item    = p->m_model->itemFromIndex(idx);
-  auto element = p->m_model->elementFromIndex(idx);
+  auto p    = p_func();
+  auto item = p->m_model->itemFromIndex(idx);
 
-  if (!element || !item->data(Roles::DeferredLoad).toBool())
+  if (   !item->data(Roles::DeferredLoad).toBool()
+      ||  item->data(Roles::Loaded).toBool()
+      || !item->data(Roles::Position).isValid())
     return;
 
   item->setText(QY("Loading…"));
 
-  auto reader = new ElementReader(*p->m_file, *element, idx);
+  auto reader = new ElementReader(*p->m_file, item->data(Roles::Position).toULongLong(), idx);
   connect(reader, &ElementReader::elementRead, p->m_model, &Model::addChildrenOfLevel1Element);
 
   p->m_queue->add(reader);
@@ -259,7 +262,8 @@ Tab::showContextMenu(QPoint const &pos) {
   if (   !element
       && (   !items[0]->data(Roles::Position).isValid()
           || !items[0]->data(Roles::Size).isValid()
-          || !items[0]->data(Roles::PseudoType).isValid()))
+          || (   !items[0]->data(Roles::PseudoType).isValid()
+              && !items[0]->data(Roles::EbmlId).isValid())))
     return;
 
   QMenu menu{this};
@@ -278,11 +282,16 @@ Tab::showElementHexDumpInViewer() {
   auto storedPosition = items[0]->data(Roles::Position);
   auto storedSize     = items[0]->data(Roles::Size);
   auto pseudoType     = items[0]->data(Roles::PseudoType);
+  auto storedId       = items[0]->data(Roles::EbmlId);
+
+  // Level 1 elements that haven't been read yet only carry their ID,
+  // position & size.
+  auto isElement = element || !pseudoType.isValid();
 
   if (   !element
       && (   !storedPosition.isValid()
           || !storedSize.isValid()
-          || !pseudoType.isValid()))
+          || (!pseudoType.isValid() && !storedId.isValid())))
     return;
 
   memory_cptr mem;
@@ -302,7 +311,9 @@ Tab::showElementHexDumpInViewer() {
     } else {
       effectiveElementPosition = storedPosition.toLongLong();
       effectiveElementSize     = storedSize.toLongLong();
-      signaledElementSize      = effectiveElementSize;
+
+      if (!items[0]->data(Roles::UnknownSize).toBool())
+        signaledElementSize    = effectiveElementSize;
     }
 
     try {
@@ -318,8 +329,8 @@ Tab::showElementHexDumpInViewer() {
 
   auto dlg    = new ElementViewerDialog{this};
   auto result = dlg
-    ->setContent(mem, !!element)
-    .setId(element ? EbmlId(*element).GetValue() : pseudoType.toUInt())
+    ->setContent(mem, isElement)
+    .setId(element ? EbmlId(*element).GetValue() : isElement ? storedId.toUInt() : pseudoType.toUInt())
     .setPosition(effectiveElementPosition)
     .setSize(signaledElementSize, effectiveElementSize)
     .exec();
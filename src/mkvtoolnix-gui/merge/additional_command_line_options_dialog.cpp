@@ -43,7 +43,13 @@ AdditionalCommandLineOptionsDialog::AdditionalCommandLineOptionsDialog(QWidget *
                                                              QY("This field is normally set to the date the file is created.") });
   add(Q("--disable-lacing"),                false, global, { QY("Disables lacing for all tracks."), QY("This will increase the file's size, especially if there are many audio tracks."), QY("Use only for testing.") });
   add(Q("--enable-durations"),              false, global, { QY("Write durations for all blocks."), QY("This will increase file size and does not offer any additional value for players at the moment.") });
+  add(Q("--enable-cluster-crc32"),         false, global,
+      { QY("Writes a CRC-32 element at the start of each cluster."),
+        QY("It allows detecting corrupted data later on, e.g. with mkvinfo's option '--verify-crc32'.") });
   add(Q("--disable-track-statistics-tags"), false, global, { QY("Tells mkvmerge not to write tags with statistics for each track.") });
+  add(Q("--track-statistics-json"),         true,  global,
+      { QY("Writes detailed statistics for each track to the given file in JSON format."),
+        QY("They include a bitrate histogram, peak bitrates, key frame intervals and block sizes.") });
   add(Q("--timestamp-scale"),               true,  global,
       { QY("Forces the timestamp scale factor to the given value."),
         QY("You have to enter a value between 1000 and 10000000 or the magic value -1."),
@@ -58,6 +64,10 @@ AdditionalCommandLineOptionsDialog::AdditionalCommandLineOptionsDialog(QWidget *
         QY("The downside is that multiplexing will take longer as mkvmerge will wait until all data has been written to the storage before exiting."),
         QY("See issues #2469 and #2480 on the MKVToolNix bug tracker for in-depth discussions on the pros and cons.") });
 
+  add(Q("--split-pre-open-files"), false, global,
+      { QY("When splitting into several files the file for the next part is created as soon as the current part has been started instead of when the split point is reached."),
+        QY("This helps on storage where creating files is slow, e.g. network shares.") });
+
   add(Q("--abort-on-warnings"), false, global, { QY("Tells mkvmerge to abort after the first warning is emitted.") });
 
   auto hacks  = m_ui->gridDevelopmentHacks;
@@ -11,6 +11,7 @@
 #include "common/qt.h"
 #include "common/timestamp.h"
 #include "mkvtoolnix-gui/merge/file_identification_thread.h"
+#include "mkvtoolnix-gui/merge/playlist_scanner.h"
 #include "mkvtoolnix-gui/merge/source_file.h"
 #include "mkvtoolnix-gui/util/file_identifier.h"
 #include "mkvtoolnix-gui/util/settings.h"
@@ -213,28 +214,22 @@ FileIdentificationWorker::scanPlaylists(QFileInfoList const &files) {
 
   QList<SourceFilePtr> identifiedPlaylists;
   auto minimumPlaylistDuration = timestamp_c::s(Util::Settings::get().m_minimumPlaylistDuration);
+  auto scannedPlaylists        = PlaylistScanner::scan(files,
+                                                       [this](int numFilesScanned) { emit playlistScanProgressChanged(numFilesScanned); },
+                                                       [p]() -> bool { return p->m_abortPlaylistScan; });
 
-  for (auto idx = 0; idx < numFiles; ++idx) {
-    Util::FileIdentifier identifier{files[idx].filePath()};
-    if (identifier.identify()) {
-      auto file = identifier.file();
-      if (timestamp_c::ns(file->m_playlistDuration) >= minimumPlaylistDuration)
-        identifiedPlaylists << file;
+  if (p->m_abortPlaylistScan) {
+    qDebug() << "FileIdentificationWorker::scanPlaylists: scan aborted";
 
-    } else
-      qDebug() << "the error of my ways" << identifier.errorTitle() << identifier.errorText();
+    emit playlistScanFinished();
 
-    if (p->m_abortPlaylistScan) {
-      qDebug() << "FileIdentificationWorker::scanPlaylists: scan aborted";
-
-      emit playlistScanFinished();
-
-      return Result::Continue;
-    }
-
-    emit playlistScanProgressChanged(idx + 1);
+    return Result::Continue;
   }
 
+  for (auto const &file : scannedPlaylists)
+    if (timestamp_c::ns(file->m_playlistDuration) >= minimumPlaylistDuration)
+      identifiedPlaylists << file;
+
   emit playlistScanProgressChanged(numFiles);
   emit playlistScanFinished();
 
@@ -245,8 +240,7 @@ FileIdentificationWorker::scanPlaylists(QFileInfoList const &files) {
 
   if (identifiedPlaylists.count() == 1) {
     qDebug() << "FileIdentificationWorker::scanPlaylists: scan finished, exactly one file, adding directly";
-    addIdentifiedFile(identifiedPlaylists.first());
-    return Result::Continue;
+    return identifySelectedPlaylist(identifiedPlaylists.first());
   }
 
   qDebug() << "FileIdentificationWorker::scanPlaylists: scan finished, multiple files, requiring user selection";
@@ -256,6 +250,33 @@ FileIdentificationWorker::scanPlaylists(QFileInfoList const &files) {
   return Result::Wait;
 }
 
+// The playlist scanner only parses the playlists themselves. The
+// playlist that's actually added must be identified by mkvmerge in
+// order to know the track IDs & properties.
+FileIdentificationWorker::Result
+FileIdentificationWorker::identifySelectedPlaylist(SourceFilePtr const &playlist) {
+  qDebug() << "FileIdentificationWorker::identifySelectedPlaylist: identifying" << playlist->m_fileName;
+
+  Util::FileIdentifier identifier{playlist->m_fileName};
+  if (!identifier.identify()) {
+    qDebug() << "FileIdentificationWorker::identifySelectedPlaylist: failed";
+    emit identificationFailed(identifier.errorTitle(), identifier.errorText());
+    return Result::Wait;
+  }
+
+  addIdentifiedFile(identifier.file());
+
+  return Result::Continue;
+}
+
+void
+FileIdentificationWorker::continueWithSelectedPlaylist(SourceFilePtr const &playlist) {
+  auto result = playlist ? identifySelectedPlaylist(playlist) : Result::Continue;
+
+  if (result == Result::Continue)
+    identifyFiles();
+}
+
 FileIdentificationWorker::Result
 FileIdentificationWorker::identifyThisFile(QString const &fileName) {
   qDebug() << "FileIdentificationWorker::identifyThisFile: starting for" << fileName;
@@ -317,6 +338,11 @@ FileIdentificationThread::continueIdentification() {
   QTimer::singleShot(0, &worker(), SLOT(identifyFiles()));
 }
 
+void
+FileIdentificationThread::continueWithSelectedPlaylist(SourceFilePtr const &playlist) {
+  QMetaObject::invokeMethod(&worker(), "continueWithSelectedPlaylist", Q_ARG(std::shared_ptr<SourceFile>, playlist));
+}
+
 void
 FileIdentificationThread::continueByScanningPlaylists(QFileInfoList const &fileNames) {
   QMetaObject::invokeMethod(&worker(), "continueByScanningPlaylists", Q_ARG(QFileInfoList, fileNames));
@@ -40,6 +40,7 @@ public:
 
 public slots:
   void continueByScanningPlaylists(QFileInfoList const &files);
+  void continueWithSelectedPlaylist(std::shared_ptr<SourceFile> const &playlist);
 
 protected slots:
   void identifyFiles();
@@ -70,6 +71,7 @@ protected:
   Result identifyThisFile(QString const &fileName);
 
   Result scanPlaylists(QFileInfoList const &fileNames);
+  Result identifySelectedPlaylist(SourceFilePtr const &playlist);
 };
 
 class FileIdentificationThread : public QThread {
@@ -85,6 +87,7 @@ public:
   FileIdentificationWorker &worker();
 
   void continueByScanningPlaylists(QFileInfoList const &files);
+  void continueWithSelectedPlaylist(SourceFilePtr const &playlist);
   void continueIdentification();
 
 public slots:
@@ -1265,10 +1265,7 @@ void
 Tab::selectPlaylistToAdd(QList<SourceFilePtr> const &identifiedPlaylists) {
   auto playlist = SelectPlaylistDialog{this, identifiedPlaylists}.select();
 
-  if (playlist)
-    m_identifier->worker().addIdentifiedFile(playlist);
-
-  m_identifier->continueIdentification();
+  m_identifier->continueWithSelectedPlaylist(playlist);
 }
 
 void
@@ -0,0 +1,343 @@
+#include "common/common_pch.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVector>
+#include <QtConcurrent>
+
+#include "common/bluray/clpi.h"
+#include "common/bluray/mpls.h"
+#include "common/bluray/util.h"
+#include "common/codec.h"
+#include "common/iso639.h"
+#include "common/mm_file_io.h"
+#include "common/qt.h"
+#include "mkvtoolnix-gui/merge/playlist_scanner.h"
+#include "mkvtoolnix-gui/merge/track.h"
+#include "mkvtoolnix-gui/util/settings.h"
+
+namespace mtx { namespace gui { namespace Merge {
+
+namespace {
+
+struct ParsedPlaylist {
+  qint64 m_fileSize{}, m_modificationTime{};
+  bool m_keepLastChapter{};
+  std::shared_ptr<mtx::bluray::mpls::parser_c> m_parser;
+};
+using ParsedPlaylistPtr = std::shared_ptr<ParsedPlaylist>;
+
+struct ParsedClip {
+  QFileInfo m_file;
+  uint64_t m_size{};
+  qint64 m_modificationTime{};
+  mtx::bluray::clpi::parser_cptr m_clpi;
+};
+using ParsedClipPtr = std::shared_ptr<ParsedClip>;
+
+struct DiscCache {
+  QHash<QString, ParsedPlaylistPtr> m_playlists;
+  QHash<QString, ParsedClipPtr> m_clips;
+};
+
+QMutex s_cacheMutex;
+QHash<QString, DiscCache> s_discCaches;
+
+// Only the playlists & clips of the disc scanned last are kept so that
+// the cache doesn't grow with each disc scanned. Must be called with
+// s_cacheMutex locked.
+DiscCache &
+discCache(QString const &discKey) {
+  for (auto itr = s_discCaches.begin(); itr != s_discCaches.end();)
+    if (itr.key() != discKey)
+      itr = s_discCaches.erase(itr);
+    else
+      ++itr;
+
+  return s_discCaches[discKey];
+}
+
+QString
+clipKey(mtx::bluray::mpls::play_item_t const &item) {
+  return Q(fmt::format("{0}.{1}", item.clip_id, balg::to_lower_copy(item.codec_id)));
+}
+
+bool
+isCurrent(ParsedPlaylist const &parsed,
+          QFileInfo const &file,
+          bool keepLastChapter) {
+  return (parsed.m_fileSize         == file.size())
+      && (parsed.m_modificationTime == file.lastModified().toMSecsSinceEpoch())
+      && (parsed.m_keepLastChapter  == keepLastChapter);
+}
+
+// Discs mounted at the same place use the same clip names; therefore
+// cached clips are only used if the file is still the same.
+bool
+isCurrent(ParsedClip const &parsed) {
+  if (parsed.m_file.filePath().isEmpty())
+    return false;
+
+  auto file = QFileInfo{parsed.m_file.filePath()};
+
+  return (parsed.m_size             == static_cast<uint64_t>(file.size()))
+      && (parsed.m_modificationTime == file.lastModified().toMSecsSinceEpoch());
+}
+
+ParsedPlaylistPtr
+parsePlaylist(QFileInfo const &file,
+              bool keepLastChapter,
+              PlaylistScanner::AbortCallback const &aborted) {
+  auto parsed                = std::make_shared<ParsedPlaylist>();
+  parsed->m_fileSize         = file.size();
+  parsed->m_modificationTime = file.lastModified().toMSecsSinceEpoch();
+  parsed->m_keepLastChapter  = keepLastChapter;
+
+  if (aborted())
+    return parsed;
+
+  try {
+    mm_file_io_c in{to_utf8(file.filePath())};
+
+    auto parser = std::make_shared<mtx::bluray::mpls::parser_c>();
+    parser->enable_dropping_last_entry_if_at_end(!keepLastChapter);
+
+    if (parser->parse(in) && !parser->get_playlist().items.empty())
+      parsed->m_parser = parser;
+
+  } catch (mtx::mm_io::exception &) {
+  }
+
+  return parsed;
+}
+
+ParsedClipPtr
+parseClip(QString const &playlistFileName,
+          mtx::bluray::mpls::play_item_t const &item,
+          PlaylistScanner::AbortCallback const &aborted) {
+  auto parsed = std::make_shared<ParsedClip>();
+
+  if (aborted())
+    return parsed;
+
+  auto playlist = bfs::path{to_utf8(playlistFileName)};
+  auto file     = mtx::bluray::find_other_file(playlist, bfs::path{"STREAM"} / fmt::format("{0}.{1}", item.clip_id, balg::to_lower_copy(item.codec_id)));
+  if (file.empty())
+    return parsed;
+
+  parsed->m_file             = QFileInfo{to_qs(file.string())};
+  parsed->m_size             = parsed->m_file.size();
+  parsed->m_modificationTime = parsed->m_file.lastModified().toMSecsSinceEpoch();
+
+  auto clpiFile = mtx::bluray::find_other_file(playlist, bfs::path{"CLIPINF"} / fmt::format("{0}.clpi", item.clip_id));
+  if (clpiFile.empty())
+    return parsed;
+
+  auto clpi = std::make_shared<mtx::bluray::clpi::parser_c>(clpiFile.string());
+  if (clpi->parse())
+    parsed->m_clpi = clpi;
+
+  return parsed;
+}
+
+QString
+codecName(mtx::bluray::mpls::stream_coding_type_e codingType) {
+  using ct = mtx::bluray::mpls::stream_coding_type_e;
+
+  auto type = ct::mpeg2_video_primary_secondary     == codingType ? codec_c::type_e::V_MPEG12
+            : ct::mpeg4_avc_video_primary_secondary == codingType ? codec_c::type_e::V_MPEG4_P10
+            : ct::vc1_video_primary_secondary       == codingType ? codec_c::type_e::V_VC1
+            : ct::lpcm_audio_primary                == codingType ? codec_c::type_e::A_PCM
+            : ct::ac3_audio_primary                 == codingType ? codec_c::type_e::A_AC3
+            : ct::eac3_audio_primary                == codingType ? codec_c::type_e::A_AC3
+            : ct::eac3_audio_secondary              == codingType ? codec_c::type_e::A_AC3
+            : ct::truehd_audio_primary              == codingType ? codec_c::type_e::A_TRUEHD
+            : ct::dts_audio_primary                 == codingType ? codec_c::type_e::A_DTS
+            : ct::dts_hd_audio_primary              == codingType ? codec_c::type_e::A_DTS
+            : ct::dts_hd_xll_audio_primary          == codingType ? codec_c::type_e::A_DTS
+            : ct::dts_hd_audio_secondary            == codingType ? codec_c::type_e::A_DTS
+            : ct::presentation_graphics_subtitles   == codingType ? codec_c::type_e::S_HDMV_PGS
+            : ct::text_subtitles                    == codingType ? codec_c::type_e::S_HDMV_TEXTST
+            :                                                       codec_c::type_e::UNKNOWN;
+
+  return Q(codec_c::get_name(type, fmt::format("0x{0:02x}", static_cast<unsigned int>(codingType))));
+}
+
+QString
+languageFor(mtx::bluray::mpls::stream_t const &stream,
+            ParsedClip const &clip) {
+  auto language = stream.language;
+
+  if (language.empty() && clip.m_clpi)
+    for (auto const &program : clip.m_clpi->m_programs)
+      for (auto const &programStream : program->program_streams)
+        if (programStream->pid == stream.pid)
+          language = programStream->language;
+
+  auto languageIdx = map_to_iso639_2_code(language);
+
+  return -1 == languageIdx ? Q("und") : Q(g_iso639_languages[languageIdx].iso639_2_code);
+}
+
+void
+addTracks(SourceFile &file,
+          TrackType type,
+          std::vector<mtx::bluray::mpls::stream_t> const &streams,
+          ParsedClip const &clip) {
+  for (auto const &stream : streams) {
+    auto track        = std::make_shared<Track>(&file, type);
+    track->m_codec    = codecName(stream.coding_type);
+    track->m_language = languageFor(stream, clip);
+
+    file.m_tracks << track;
+  }
+}
+
+SourceFilePtr
+createSourceFile(QFileInfo const &playlistFile,
+                 mtx::bluray::mpls::parser_c const &parser,
+                 QHash<QString, ParsedClipPtr> const &clips) {
+  auto file                = std::make_shared<SourceFile>(playlistFile.filePath());
+  auto const &playlist     = parser.get_playlist();
+
+  file->m_type             = mtx::file_type_e::mpeg_ts;
+  file->m_isPlaylist       = true;
+  file->m_playlistDuration = playlist.duration.to_ns();
+  file->m_playlistChapters = parser.get_chapters().size();
+
+  for (auto const &item : playlist.items) {
+    auto clip = clips.value(clipKey(item));
+    if (!clip || clip->m_file.filePath().isEmpty())
+      continue;
+
+    file->m_playlistFiles << clip->m_file;
+    file->m_playlistSize  += clip->m_size;
+  }
+
+  if (file->m_playlistFiles.isEmpty())
+    return {};
+
+  auto const &firstItem = playlist.items.front();
+  auto firstClip        = clips.value(clipKey(firstItem));
+
+  if (firstClip) {
+    addTracks(*file, TrackType::Video,     firstItem.stn.video_streams, *firstClip);
+    addTracks(*file, TrackType::Audio,     firstItem.stn.audio_streams, *firstClip);
+    addTracks(*file, TrackType::Subtitles, firstItem.stn.pg_streams,    *firstClip);
+  }
+
+  return file;
+}
+
+} // anonymous namespace
+
+QList<SourceFilePtr>
+PlaylistScanner::scan(QFileInfoList const &files,
+                      ProgressCallback const &progress,
+                      AbortCallback const &aborted) {
+  auto numFiles        = files.count();
+  auto keepLastChapter = Util::Settings::get().m_defaultAdditionalMergeOptions.contains(Q("keep_last_chapter_in_mpls"));
+  auto playlists       = QVector<ParsedPlaylistPtr>(numFiles);
+  auto clips           = QHash<QString, ParsedClipPtr>{};
+  auto playlistFutures = QList<QPair<int, QFuture<ParsedPlaylistPtr>>>{};
+  auto clipFutures     = QList<QPair<QString, QFuture<ParsedClipPtr>>>{};
+
+  if (!numFiles)
+    return {};
+
+  auto discKey = files[0].absolutePath();
+
+  // Phase 1: parse all playlists that aren't cached yet in parallel.
+  {
+    QMutexLocker lock{&s_cacheMutex};
+    auto &cache = discCache(discKey);
+
+    for (auto idx = 0; idx < numFiles; ++idx) {
+      auto cached = cache.m_playlists.value(files[idx].absoluteFilePath());
+
+      if (cached && isCurrent(*cached, files[idx], keepLastChapter))
+        playlists[idx] = cached;
+      else
+        playlistFutures << qMakePair(idx, QtConcurrent::run(parsePlaylist, files[idx], keepLastChapter, aborted));
+    }
+  }
+
+  qDebug() << "PlaylistScanner::scan: number of playlists:" << numFiles << "cached:" << (numFiles - playlistFutures.count());
+
+  auto numScanned = numFiles - playlistFutures.count();
+  progress(numScanned);
+
+  for (auto &future : playlistFutures) {
+    playlists[future.first] = future.second.result();
+    progress(++numScanned);
+  }
+
+  if (aborted())
+    return {};
+
+  // Phase 2: parse each clip referenced by the playlists once.
+  {
+    QMutexLocker lock{&s_cacheMutex};
+    auto &cache = discCache(discKey);
+
+    for (auto idx = 0; idx < numFiles; ++idx) {
+      if (!playlists[idx]->m_parser)
+        continue;
+
+      cache.m_playlists[files[idx].absoluteFilePath()] = playlists[idx];
+
+      for (auto const &item : playlists[idx]->m_parser->get_playlist().items) {
+        auto key = clipKey(item);
+
+        if (clips.contains(key))
+          continue;
+
+        auto cached = cache.m_clips.value(key);
+        if (cached && isCurrent(*cached)) {
+          clips[key] = cached;
+          continue;
+        }
+
+        clips[key]   = ParsedClipPtr{};
+        clipFutures << qMakePair(key, QtConcurrent::run(parseClip, files[idx].filePath(), item, aborted));
+      }
+    }
+  }
+
+  qDebug() << "PlaylistScanner::scan: number of unique clips:" << clips.count() << "cached:" << (clips.count() - clipFutures.count());
+
+  for (auto &future : clipFutures)
+    clips[future.first] = future.second.result();
+
+  if (aborted())
+    return {};
+
+  {
+    QMutexLocker lock{&s_cacheMutex};
+    auto &cache = discCache(discKey);
+
+    for (auto &future : clipFutures)
+      cache.m_clips[future.first] = clips[future.first];
+  }
+
+  // Phase 3: create the source files.
+  QList<SourceFilePtr> scannedPlaylists;
+
+  for (auto idx = 0; idx < numFiles; ++idx) {
+    if (!playlists[idx]->m_parser)
+      continue;
+
+    auto file = createSourceFile(files[idx], *playlists[idx]->m_parser, clips);
+    if (file)
+      scannedPlaylists << file;
+  }
+
+  return scannedPlaylists;
+}
+
+}}}
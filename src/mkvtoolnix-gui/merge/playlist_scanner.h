@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <QFileInfo>
+#include <QList>
+
+#include "mkvtoolnix-gui/merge/source_file.h"
+
+namespace mtx { namespace gui { namespace Merge {
+
+// Scans Blu-ray playlists by parsing the MPLS & CLPI files directly
+// instead of identifying each of them with mkvmerge. The resulting
+// source files only contain the playlist information (duration, size,
+// chapters, files) and the tracks listed in the playlist's stream
+// table; the playlist the user selects must still be identified fully.
+//
+// Playlists and clips are parsed on the global thread pool. Clips
+// shared by several playlists are only parsed once, and the results are
+// cached per disc for as long as the files aren't modified.
+class PlaylistScanner {
+public:
+  using ProgressCallback = std::function<void(int numFilesScanned)>;
+  using AbortCallback    = std::function<bool()>;
+
+public:
+  static QList<SourceFilePtr> scan(QFileInfoList const &files, ProgressCallback const &progress, AbortCallback const &aborted);
+};
+
+}}}
@@ -13,6 +13,7 @@
 #include "mkvtoolnix-gui/main_window/update_checker.h"
 #include "mkvtoolnix-gui/merge/source_file.h"
 #include "mkvtoolnix-gui/util/installation_checker.h"
+#include "mkvtoolnix-gui/util/kax_info.h"
 #include "mkvtoolnix-gui/util/settings.h"
 #include "mkvtoolnix-gui/util/settings_names.h"
 
@@ -61,6 +62,7 @@ registerMetaTypes() {
 #endif  // HAVE_UPDATE_CHECK
   qRegisterMetaType<Util::InstallationChecker::Problems>("Util::InstallationChecker::Problems");
   qRegisterMetaType<mtx::kax_info_c::result_e>("mtx::kax_info_c::result_e");
+  qRegisterMetaType<QVector<Util::KaxInfo::Level1Element>>("QVector<mtx::gui::Util::KaxInfo::Level1Element>");
   qRegisterMetaType<int64_t>("int64_t");
   qRegisterMetaType<EbmlElement *>("EbmlElement *");
   qRegisterMetaType<boost::optional<int64_t>>("boost::optional<int64_t>");
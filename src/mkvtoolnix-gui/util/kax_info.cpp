@@ -33,6 +33,8 @@ using namespace libmatroska;
 
 namespace mtx { namespace gui { namespace Util {
 
+static int const s_level1ElementsBatchSize = 1000;
+
 class KaxInfoPrivate: public mtx::kax_info::private_c {
 public:
   KaxInfo::ScanType m_scanType{KaxInfo::ScanType::StartOfFile};
@@ -166,22 +168,42 @@ KaxInfo::doScanLevel1Elements() {
 
     p->m_in->setFilePointer(*p->m_firstLevel1ElementPosition);
 
+    // Hundreds of thousands of clusters are common. Neither the elements
+    // nor items for all of them are kept; only their positions & sizes
+    // are recorded and handed to the model in batches.
+    QVector<Level1Element> elements;
+    elements.reserve(s_level1ElementsBatchSize);
+
     while (!p->m_abort) {
       auto upper_lvl_el = 0;
-      auto l1           = std::shared_ptr<EbmlElement>(p->m_es->FindNextElement(EBML_CLASS_CONTEXT(KaxSegment), upper_lvl_el, 0xFFFFFFFFL, true));
+      auto l1           = std::unique_ptr<EbmlElement>(p->m_es->FindNextElement(EBML_CLASS_CONTEXT(KaxSegment), upper_lvl_el, 0xFFFFFFFFL, true));
 
       if (!l1)
         break;
 
-      retain_element(l1);
-      ui_show_element(*l1);
+      Level1Element element;
+      element.m_position   = l1->GetElementPosition();
+      element.m_size       = kax_file_c::get_element_size(*l1);
+      element.m_id         = EbmlId(*l1).GetValue();
+      element.m_finiteSize = l1->IsFiniteSize();
+      element.m_master     = !!dynamic_cast<EbmlMaster *>(l1.get());
+
+      elements << element;
+
+      if (elements.size() >= s_level1ElementsBatchSize) {
+        emit level1ElementsFound(elements);
+        elements.clear();
+      }
 
       if (upper_lvl_el && !kax_file_c::is_global_element_id(EbmlId(*l1)))
         break;
 
-      p->m_in->setFilePointer(l1->GetElementPosition() + kax_file_c::get_element_size(*l1));
+      p->m_in->setFilePointer(element.m_position + element.m_size);
     }
 
+    if (!elements.isEmpty())
+      emit level1ElementsFound(elements);
+
   } catch (mtx::mm_io::exception &ex) {
     ui_show_error(fmt::format("{0}: {1}", Y("Caught exception"), ex.what()));
     return result_e::failed;
@@ -16,6 +16,7 @@
 #include "common/common_pch.h"
 
 #include <QObject>
+#include <QVector>
 
 #include "common/kax_info.h"
 #include "mkvtoolnix-gui/util/runnable.h"
@@ -36,6 +37,14 @@ public:
     Level1Elements,
   };
 
+  // The level 1 elements following the first cluster are only indexed
+  // instead of being kept in memory; they're read on demand.
+  struct Level1Element {
+    uint64_t m_position{}, m_size{};
+    uint32_t m_id{};
+    bool m_finiteSize{}, m_master{};
+  };
+
 public:
   KaxInfo();
   KaxInfo(QString const &file_name);
@@ -63,6 +72,7 @@ public slots:
 signals:
   void elementInfoFound(int level, QString const &text, boost::optional<int64_t> position, boost::optional<int64_t> size);
   void elementFound(int level, EbmlElement *e, bool readFully);
+  void level1ElementsFound(QVector<mtx::gui::Util::KaxInfo::Level1Element> const &elements);
   void errorFound(const QString &message);
   void progressChanged(int percentage, const QString &text);
 
@@ -78,3 +88,4 @@ protected:
 }}}
 
 Q_DECLARE_METATYPE(::mtx::kax_info_c::result_e)
+Q_DECLARE_METATYPE(::mtx::gui::Util::KaxInfo::Level1Element)
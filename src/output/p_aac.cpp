@@ -34,6 +34,8 @@ aac_packetizer_c::aac_packetizer_c(generic_reader_c *p_reader,
 {
   set_track_type(track_audio);
 
+  m_parser.slice_data(true);
+
   if (m_ti.m_private_data && (0 < m_ti.m_private_data->get_size())) {
     auto parsed_config = mtx::aac::parse_audio_specific_config(m_ti.m_private_data->get_buffer(), m_ti.m_private_data->get_size());
     if (parsed_config)
@@ -112,7 +114,7 @@ aac_packetizer_c::process_headerless(packet_cptr packet) {
 }
 
 int
-aac_packetizer_c::process(packet_cptr packet) {
+aac_packetizer_c::process_impl(packet_cptr packet) {
   m_timestamp_calculator.add_timestamp(packet);
   m_discard_padding.add_maybe(packet->discard_padding);
 
@@ -125,9 +127,11 @@ aac_packetizer_c::process(packet_cptr packet) {
     return FILE_STATUS_MOREDATA;
 
   while (m_parser.frames_available()) {
-    auto frame = m_parser.get_frame();
+    auto frame  = m_parser.get_frame();
+    auto packet = std::make_shared<packet_t>();
 
-    process_headerless(std::make_shared<packet_t>(frame.m_data));
+    packet->set_data_slices({ frame.get_data_slice() });
+    process_headerless(packet);
 
     if (verbose && frame.m_garbage_size)
       mxwarn_tid(m_ti.m_fname, m_ti.m_id, fmt::format(Y("Skipping {0} bytes (no valid AAC header found). This might cause audio/video desynchronisation.\n"), frame.m_garbage_size));
@@ -27,7 +27,7 @@ public:
   alac_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, memory_cptr const &magic_cookie, unsigned int sample_rate, unsigned int channels);
   virtual ~alac_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
 
   virtual translatable_string_c get_format_name() const {
     return YT("ALAC");
@@ -27,7 +27,7 @@ protected:
 public:
   av1_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti);
 
-  virtual int process(packet_cptr packet) override;
+  virtual int process_impl(packet_cptr packet) override;
 
   virtual void set_is_unframed();
 
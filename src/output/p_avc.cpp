@@ -103,7 +103,7 @@ avc_video_packetizer_c::extract_aspect_ratio() {
 }
 
 int
-avc_video_packetizer_c::process(packet_cptr packet) {
+avc_video_packetizer_c::process_impl(packet_cptr packet) {
   if (VFT_PFRAMEAUTOMATIC == packet->bref) {
     packet->fref = -1;
     packet->bref = m_ref_timestamp;
@@ -111,11 +111,11 @@ avc_video_packetizer_c::process(packet_cptr packet) {
 
   m_ref_timestamp = packet->timestamp;
 
+  process_nalus(*packet->data);
+
   if (m_nalu_size_len_dst && (m_nalu_size_len_dst != m_nalu_size_len_src))
     change_nalu_size_len(packet);
 
-  process_nalus(*packet->data);
-
   add_packet(packet);
 
   return FILE_STATUS_MOREDATA;
@@ -154,91 +154,57 @@ avc_video_packetizer_c::setup_nalu_size_len_change() {
 
   m_nalu_size_len_dst = m_ti.m_nalu_size_length;
   private_data[4]     = (private_data[4] & 0xfc) | (m_nalu_size_len_dst - 1);
-  m_max_nalu_size     = 1ll << (8 * m_nalu_size_len_dst);
 
   set_codec_private(m_ti.m_private_data);
 
   mxverb(2, fmt::format("mpeg4_p10: Adjusting NALU size length from {0} to {1}\n", m_nalu_size_len_src, m_nalu_size_len_dst));
 }
 
+/* Shorter size fields are written in place. Longer ones require
+   copying the whole frame once. */
 void
 avc_video_packetizer_c::change_nalu_size_len(packet_cptr packet) {
-  unsigned char *src = packet->data->get_buffer();
-  int size           = packet->data->get_size();
-
-  if (!src || !size)
+  if (!packet->data->get_size())
     return;
 
-  std::vector<int> nalu_sizes;
-
-  int src_pos = 0;
-
-  // Find all NALU sizes in this packet.
-  while (src_pos < size) {
-    if ((size - src_pos) < m_nalu_size_len_src)
-      break;
-
-    int nalu_size = get_uint_be(&src[src_pos], m_nalu_size_len_src);
-    nalu_size     = std::min<int>(nalu_size, size - src_pos - m_nalu_size_len_src);
-
-    if (nalu_size > m_max_nalu_size)
-      mxerror_tid(m_ti.m_fname, m_ti.m_id, fmt::format(Y("The chosen NALU size length of {0} is too small. Try using '4'.\n"), m_nalu_size_len_dst));
-
-    src_pos += m_nalu_size_len_src + nalu_size;
-
-    nalu_sizes.push_back(nalu_size);
-  }
-
-  // Allocate memory if the new NALU size length is greater
-  // than the previous one. Otherwise reuse the existing memory.
-  if (m_nalu_size_len_dst > m_nalu_size_len_src) {
-    int new_size = size + nalu_sizes.size() * (m_nalu_size_len_dst - m_nalu_size_len_src);
-    packet->data = memory_c::alloc(new_size);
-  }
-
-  // Copy the NALUs and write the new sized length field.
-  unsigned char *dst = packet->data->get_buffer();
-  src_pos            = 0;
-  int dst_pos        = 0;
-
-  size_t i;
-  for (i = 0; nalu_sizes.size() > i; ++i) {
-    int nalu_size = nalu_sizes[i];
+  try {
+    if (m_nalu_size_len_dst < m_nalu_size_len_src)
+      mtx::mpeg::change_nalu_size_length_in_place(*packet->data, m_nalu_size_len_src, m_nalu_size_len_dst);
 
-    put_uint_be(&dst[dst_pos], nalu_size, m_nalu_size_len_dst);
+    else
+      packet->data = mtx::mpeg::change_nalu_size_length_copy(*packet->data, m_nalu_size_len_src, m_nalu_size_len_dst);
 
-    memmove(&dst[dst_pos + m_nalu_size_len_dst], &src[src_pos + m_nalu_size_len_src], nalu_size);
-
-    src_pos += m_nalu_size_len_src + nalu_size;
-    dst_pos += m_nalu_size_len_dst + nalu_size;
+  } catch (mtx::mpeg::nalu_size_length_x &) {
+    mxerror_tid(m_ti.m_fname, m_ti.m_id, fmt::format(Y("The chosen NALU size length of {0} is too small. Try using '4'.\n"), m_nalu_size_len_dst));
   }
-
-  packet->data->set_size(dst_pos);
 }
 
+/* Drops empty, filler data & access unit delimiter NALUs and rewrites
+   SPS NALUs if requested. The NALUs kept are moved towards the start
+   of the buffer in a single pass. */
 void
 avc_video_packetizer_c::process_nalus(memory_c &data)
   const {
+  auto const len  = static_cast<std::size_t>(m_nalu_size_len_src);
   auto ptr        = data.get_buffer();
   auto total_size = data.get_size();
-  auto idx        = 0u;
+  auto src_pos    = std::size_t{};
+  auto dst_pos    = std::size_t{};
 
-  while ((idx + m_nalu_size_len_dst) < total_size) {
-    auto nalu_size = get_uint_be(&ptr[idx], m_nalu_size_len_dst) + m_nalu_size_len_dst;
+  if (!len)
+    return;
 
-    if ((idx + nalu_size) > total_size)
-      break;
+  while ((src_pos + len) < total_size) {
+    auto nalu_size = static_cast<std::size_t>(get_uint_be(&ptr[src_pos], len)) + len;
 
-    if (static_cast<int>(nalu_size) < m_nalu_size_len_dst)
+    if ((src_pos + nalu_size) > total_size)
       break;
 
-    auto const nalu_type = ptr[idx + m_nalu_size_len_dst] & 0x1f;
+    auto const nalu_type = ptr[src_pos + len] & 0x1f;
 
-    if (   (static_cast<int>(nalu_size) == m_nalu_size_len_dst) // empty NALU?
+    if (   (nalu_size == len) // empty NALU?
         || mtx::included_in(nalu_type, NALU_TYPE_FILLER_DATA, NALU_TYPE_ACCESS_UNIT)) {
-      memory_c::splice(data, idx, nalu_size);
-      total_size -= nalu_size;
-      ptr         = data.get_buffer();
+      src_pos += nalu_size;
       continue;
     }
 
@@ -248,27 +214,50 @@ avc_video_packetizer_c::process_nalus(memory_c &data)
       mxdebug_if(m_debug_fix_bistream_timing_info, fmt::format("fix_bitstream_timing_info [NALU]: m_track_default_duration {0}\n", m_track_default_duration));
 
       mtx::avc::sps_info_t sps_info;
-      auto parsed_nalu = mtx::avc::parse_sps(mtx::mpeg::nalu_to_rbsp(memory_c::clone(&ptr[idx + m_nalu_size_len_dst], nalu_size - m_nalu_size_len_dst)), sps_info, true, true, m_track_default_duration);
+      auto parsed_nalu = mtx::avc::parse_sps(mtx::mpeg::nalu_to_rbsp(memory_c::clone(&ptr[src_pos + len], nalu_size - len)), sps_info, true, true, m_track_default_duration);
 
       if (parsed_nalu) {
-        parsed_nalu = mtx::mpeg::rbsp_to_nalu(parsed_nalu);
+        parsed_nalu   = mtx::mpeg::rbsp_to_nalu(parsed_nalu);
+        auto new_size = parsed_nalu->get_size() + len;
+
+        if (new_size <= nalu_size) {
+          put_uint_be(&ptr[dst_pos], parsed_nalu->get_size(), len);
+          std::memcpy(&ptr[dst_pos + len], parsed_nalu->get_buffer(), parsed_nalu->get_size());
 
-        memory_c::splice(data, idx + m_nalu_size_len_dst, nalu_size - m_nalu_size_len_dst, *parsed_nalu);
+        } else {
+          auto new_nalu = memory_c::alloc(new_size);
+          put_uint_be(new_nalu->get_buffer(), parsed_nalu->get_size(), len);
+          std::memcpy(new_nalu->get_buffer() + len, parsed_nalu->get_buffer(), parsed_nalu->get_size());
 
-        total_size = data.get_size();
-        ptr        = data.get_buffer();
+          memory_c::splice(data, dst_pos, src_pos + nalu_size - dst_pos, *new_nalu);
 
-        put_uint_be(&ptr[idx], parsed_nalu->get_size(), m_nalu_size_len_dst);
+          total_size = data.get_size();
+          ptr        = data.get_buffer();
+          src_pos    = dst_pos + new_size - nalu_size;
+        }
 
-        idx += parsed_nalu->get_size() + m_nalu_size_len_dst;
+        src_pos += nalu_size;
+        dst_pos += new_size;
         continue;
       }
     }
 
-    idx += nalu_size;
+    if (dst_pos != src_pos)
+      std::memmove(&ptr[dst_pos], &ptr[src_pos], nalu_size);
+
+    src_pos += nalu_size;
+    dst_pos += nalu_size;
   }
 
+  auto remaining = total_size - src_pos;
+
   // empty NALU at the end?
-  if (total_size == (idx + m_nalu_size_len_dst))
-    data.set_size(idx);
+  if (remaining == len)
+    remaining = 0;
+
+  if (remaining && (dst_pos != src_pos))
+    std::memmove(&ptr[dst_pos], &ptr[src_pos], remaining);
+
+  if ((dst_pos + remaining) != total_size)
+    data.set_size(dst_pos + remaining);
 }
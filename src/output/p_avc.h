@@ -20,12 +20,12 @@
 class avc_video_packetizer_c: public generic_video_packetizer_c {
 protected:
   int m_nalu_size_len_src{}, m_nalu_size_len_dst{};
-  int64_t m_max_nalu_size{}, m_track_default_duration{-1};
+  int64_t m_track_default_duration{-1};
   debugging_option_c m_debug_fix_bistream_timing_info;
 
 public:
   avc_video_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, double fps, int width, int height);
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual connection_result_e can_connect_to(generic_packetizer_c *src, std::string &error_message);
@@ -88,7 +88,7 @@ avc_es_video_packetizer_c::add_extra_data(memory_cptr data) {
 }
 
 int
-avc_es_video_packetizer_c::process(packet_cptr packet) {
+avc_es_video_packetizer_c::process_impl(packet_cptr packet) {
   try {
     if (packet->has_timestamp())
       m_parser.add_timestamp(packet->timestamp);
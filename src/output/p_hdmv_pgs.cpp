@@ -46,18 +46,21 @@ hdmv_pgs_packetizer_c::set_headers() {
 }
 
 int
-hdmv_pgs_packetizer_c::process(packet_cptr packet) {
+hdmv_pgs_packetizer_c::process_impl(packet_cptr packet) {
   if (!m_aggregate_packets) {
     dump_and_add_packet(packet);
     return FILE_STATUS_MOREDATA;
   }
 
-  if (!m_aggregated) {
+  // The segments are collected as slices instead of being appended to
+  // the first one's buffer.
+  packet->data->take_ownership();
+
+  if (!m_aggregated)
     m_aggregated = packet;
-    m_aggregated->data->take_ownership();
 
-  } else
-    m_aggregated->data->add(packet->data);
+  else
+    m_aggregated->append_data(packet->data);
 
   if (   (0                                     != packet->data->get_size())
       && (mtx::hdmv_pgs::END_OF_DISPLAY_SEGMENT == packet->data->get_buffer()[0])) {
@@ -71,7 +74,7 @@ hdmv_pgs_packetizer_c::process(packet_cptr packet) {
 void
 hdmv_pgs_packetizer_c::dump_and_add_packet(packet_cptr const &packet) {
   if (m_debug)
-    dump_packet(*packet->data);
+    dump_packet(!packet->data_slices.empty() ? *join_memory_slices(packet->data_slices) : *packet->data);
 
   add_packet(packet);
 }
@@ -78,7 +78,7 @@ textsubs_packetizer_c::set_line_ending_style(line_ending_style_e line_ending_sty
 }
 
 int
-textsubs_packetizer_c::process(packet_cptr packet) {
+textsubs_packetizer_c::process_impl(packet_cptr packet) {
   if (m_buffered_packet) {
     m_buffered_packet->duration = packet->timestamp - m_buffered_packet->timestamp;
     process_one_packet(m_buffered_packet);
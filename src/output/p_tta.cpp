@@ -51,7 +51,7 @@ tta_packetizer_c::set_headers() {
 }
 
 int
-tta_packetizer_c::process(packet_cptr packet) {
+tta_packetizer_c::process_impl(packet_cptr packet) {
   packet->timestamp = std::llround((double)m_samples_output * 1000000000 / m_sample_rate);
   if (-1 == packet->duration) {
     packet->duration  = m_htrack_default_duration;
@@ -28,7 +28,7 @@ public:
   vobbtn_packetizer_c(generic_reader_c *p_reader, track_info_c &p_ti, int width, int height);
   virtual ~vobbtn_packetizer_c();
 
-  virtual int process(packet_cptr packet);
+  virtual int process_impl(packet_cptr packet);
   virtual void set_headers();
 
   virtual translatable_string_c get_format_name() const {
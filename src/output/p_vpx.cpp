@@ -101,7 +101,7 @@ vpx_video_packetizer_c::vp9_determine_codec_private(memory_c const &mem) {
 }
 
 int
-vpx_video_packetizer_c::process(packet_cptr packet) {
+vpx_video_packetizer_c::process_impl(packet_cptr packet) {
   vp9_determine_codec_private(*packet->data);
 
   packet->bref         = ivf::is_keyframe(packet->data, m_codec) ? -1 : m_previous_timestamp;
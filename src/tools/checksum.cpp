@@ -10,6 +10,8 @@
 
 #include "common/common_pch.h"
 
+#include <chrono>
+
 #include "common/bswap.h"
 #include "common/checksums/crc.h"
 #include "common/command_line.h"
@@ -25,7 +27,7 @@ public:
   mtx::checksum::algorithm_e m_algorithm{mtx::checksum::algorithm_e::adler32};
   size_t m_chunk_size{4096};
   uint64_t m_initial_value{}, m_xor_result{};
-  bool m_result_in_le{};
+  bool m_result_in_le{}, m_benchmark{};
 };
 
 static void
@@ -61,6 +63,13 @@ setup_help_and_version_info() {
                              "  --result-in-le         Output the result in Little Endian (default:\n"
                              "                         Big Endian)\n"
                              "\n"
+                             "Benchmark options:\n"
+                             "\n"
+                             "  --benchmark            Measure the throughput of all algorithms instead\n"
+                             "                         of calculating a single checksum. Uses the file's\n"
+                             "                         content if a file name is given and 64 MiB of\n"
+                             "                         pseudo-random data otherwise.\n"
+                             "\n"
                              "General options:\n"
                              "\n"
                              "  -h, --help             This help text\n"
@@ -133,6 +142,9 @@ parse_args(std::vector<std::string> &args) {
     } else if (arg == "--result-in-le")
       options.m_result_in_le = true;
 
+    else if (arg == "--benchmark")
+      options.m_benchmark = true;
+
     else if (!options.m_file_name.empty())
       mxerror("More than one source file was given.\n");
 
@@ -140,7 +152,7 @@ parse_args(std::vector<std::string> &args) {
       options.m_file_name = arg;
   }
 
-  if (options.m_file_name.empty())
+  if (options.m_file_name.empty() && !options.m_benchmark)
     mxerror("No file name given\n");
 
   return options;
@@ -187,6 +199,77 @@ parse_file(cli_options_c const &options) {
   mxinfo(fmt::format("{0}  {1}\n", output, options.m_file_name));
 }
 
+static memory_cptr
+benchmark_data(cli_options_c const &options) {
+  if (!options.m_file_name.empty())
+    return mm_file_io_c::slurp(options.m_file_name);
+
+  auto data  = memory_c::alloc(64 * 1024 * 1024);
+  auto ptr   = data->get_buffer();
+  auto value = 0x12345678u;
+
+  for (auto idx = 0u, size = static_cast<unsigned int>(data->get_size()); idx < size; ++idx) {
+    value    = value * 1103515245u + 12345u;
+    ptr[idx] = value >> 24;
+  }
+
+  return data;
+}
+
+static void
+run_benchmark(cli_options_c const &options) {
+  using clock_t = std::chrono::steady_clock;
+
+  static std::vector<std::pair<std::string, mtx::checksum::algorithm_e>> const s_algorithms{
+    { "Adler-32",       mtx::checksum::algorithm_e::adler32       },
+    { "CRC-8 ATM",      mtx::checksum::algorithm_e::crc8_atm      },
+    { "CRC-16 ANSI",    mtx::checksum::algorithm_e::crc16_ansi    },
+    { "CRC-16 CCITT",   mtx::checksum::algorithm_e::crc16_ccitt   },
+    { "CRC-16 0x002d",  mtx::checksum::algorithm_e::crc16_002d    },
+    { "CRC-32 IEEE",    mtx::checksum::algorithm_e::crc32_ieee    },
+    { "CRC-32 IEEE LE", mtx::checksum::algorithm_e::crc32_ieee_le },
+    { "MD5",            mtx::checksum::algorithm_e::md5           },
+  };
+
+  auto data       = benchmark_data(options);
+  auto data_size  = data->get_size();
+  auto chunk_size = !options.m_chunk_size ? data_size : std::min<size_t>(data_size, options.m_chunk_size);
+
+  if (!data_size)
+    mxerror("The file is empty.\n");
+
+  mxinfo(fmt::format("Benchmarking with {0} bytes in chunks of {1} bytes\n", data_size, chunk_size));
+
+  for (auto const &algorithm : s_algorithms) {
+    auto num_rounds = 0u;
+    auto start      = clock_t::now();
+    auto elapsed    = clock_t::duration{};
+    std::string implementation;
+
+    // Repeat for at least one second in order to get stable numbers.
+    do {
+      auto worker = mtx::checksum::for_algorithm(algorithm.second);
+
+      for (auto offset = 0ull; offset < data_size; offset += chunk_size)
+        worker->add(data->get_buffer() + offset, std::min<size_t>(chunk_size, data_size - offset));
+
+      worker->finish();
+
+      auto crc_worker = dynamic_cast<mtx::checksum::crc_base_c *>(worker.get());
+      if (crc_worker)
+        implementation = crc_worker->get_implementation_name();
+
+      ++num_rounds;
+      elapsed = clock_t::now() - start;
+    } while (elapsed < std::chrono::seconds{1});
+
+    auto seconds       = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    auto gb_per_second = static_cast<double>(data_size) * num_rounds / seconds / 1000000000.0;
+
+    mxinfo(fmt::format("{0:<16} {1:>8.3f} GB/s{2}\n", algorithm.first, gb_per_second, implementation.empty() ? ""s : fmt::format(" ({0})", implementation)));
+  }
+}
+
 int
 main(int argc,
      char **argv) {
@@ -200,7 +283,10 @@ main(int argc,
   auto options = parse_args(args);
 
   try {
-    parse_file(options);
+    if (options.m_benchmark)
+      run_benchmark(options);
+    else
+      parse_file(options);
   } catch (mtx::mm_io::exception &) {
     mxerror("File not found\n");
   }
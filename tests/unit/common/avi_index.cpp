@@ -0,0 +1,303 @@
+#include "common/common_pch.h"
+
+#include "common/avi_index.h"
+#include "common/endian.h"
+#include "common/mm_mem_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// The 'movi' list of a file starting right after the RIFF header. The
+// data of all chunks is 'x'.
+class test_file_c {
+public:
+  std::string m_data;
+  std::vector<uint8_t> m_idx1;
+  uint64_t m_movi_start{};
+
+public:
+  test_file_c() {
+    m_data       = "RIFF\0\0\0\0AVI LIST\0\0\0\0movi"s;
+    m_movi_start = m_data.size();
+  }
+
+  // Returns the position of the chunk's header.
+  uint64_t
+  add_chunk(std::string const &tag,
+            uint32_t size) {
+    auto position = m_data.size();
+
+    m_data += tag;
+    add_uint32(size);
+    m_data += std::string(size + (size % 2), 'x');
+
+    return position;
+  }
+
+  void
+  add_uint16(uint16_t value) {
+    unsigned char buffer[2];
+    put_uint16_le(buffer, value);
+    m_data.append(reinterpret_cast<char *>(buffer), 2);
+  }
+
+  void
+  add_uint32(uint32_t value) {
+    unsigned char buffer[4];
+    put_uint32_le(buffer, value);
+    m_data.append(reinterpret_cast<char *>(buffer), 4);
+  }
+
+  void
+  add_uint64(uint64_t value) {
+    unsigned char buffer[8];
+    put_uint64_le(buffer, value);
+    m_data.append(reinterpret_cast<char *>(buffer), 8);
+  }
+
+  void
+  add_idx1_entry(std::string const &tag,
+                 uint32_t flags,
+                 uint32_t offset,
+                 uint32_t size) {
+    auto position = m_idx1.size();
+
+    m_idx1.resize(position + 16);
+    std::memcpy(&m_idx1[position], tag.c_str(), 4);
+    put_uint32_le(&m_idx1[position +  4], flags);
+    put_uint32_le(&m_idx1[position +  8], offset);
+    put_uint32_le(&m_idx1[position + 12], size);
+  }
+
+  // Adds an OpenDML standard index chunk; 'entries' are pairs of
+  // offsets relative to 'base_offset' & sizes including the key frame
+  // flag.
+  avisuperindex_entry
+  add_ix_chunk(std::string const &tag,
+               uint64_t base_offset,
+               std::vector<std::pair<uint64_t, uint32_t>> const &entries) {
+    auto position = m_data.size();
+
+    m_data += tag;
+    add_uint32(24 + entries.size() * 8);
+    add_uint16(2);
+    m_data += "\x00\x01"s;
+    add_uint32(entries.size());
+    m_data += "00dc";
+    add_uint64(base_offset);
+    add_uint32(0);
+
+    for (auto const &entry : entries) {
+      add_uint32(static_cast<uint32_t>(entry.first));
+      add_uint32(entry.second);
+    }
+
+    return { position, static_cast<uint32_t>(32 + entries.size() * 8), 0 };
+  }
+
+  void
+  set_up(avi_t &avi) {
+    avi.movi_start = m_movi_start;
+    avi.idx        = m_idx1.empty() ? nullptr : reinterpret_cast<uint8_t (*)[16]>(m_idx1.data());
+    avi.n_idx      = m_idx1.size() / 16;
+    avi.anum       = 1;
+
+    std::memcpy(avi.video_tag,          "00db", 4);
+    std::memcpy(avi.track[0].audio_tag, "01wb", 4);
+  }
+
+  unsigned char const *
+  get_buffer()
+    const {
+    return reinterpret_cast<unsigned char const *>(m_data.c_str());
+  }
+};
+
+TEST(AviIndex, ChunkIndex) {
+  mtx::avi::chunk_index_c index;
+
+  EXPECT_TRUE(index.empty());
+
+  index.add(100, 10, true);
+  index.add(200, 0,  false);
+  index.add(300, 0x80000000ull, false);
+
+  ASSERT_EQ(3u, index.size());
+  EXPECT_EQ(100u, index.get_position(0));
+  EXPECT_EQ(10u,  index.get_size(0));
+  EXPECT_TRUE(index.is_key(0));
+  EXPECT_EQ(0u,   index.get_size(1));
+  EXPECT_FALSE(index.is_key(1));
+
+  // Sizes are limited to 31 bits.
+  EXPECT_EQ(0x7fffffffu, index.get_size(2));
+  EXPECT_FALSE(index.is_key(2));
+  EXPECT_EQ(10u + 0x7fffffffu, index.get_total_size());
+}
+
+void
+test_idx1(bool relative_to_movi) {
+  test_file_c file;
+
+  auto video1 = file.add_chunk("00dc", 10);
+  auto audio1 = file.add_chunk("01wb", 4);
+  auto video2 = file.add_chunk("00dc", 0);
+  auto audio2 = file.add_chunk("01wb", 3);
+  auto video3 = file.add_chunk("00DB", 6);
+  auto offset = relative_to_movi ? file.m_movi_start - 4 : 0;
+
+  file.add_idx1_entry("00dc", 0x10, video1 - offset, 10);
+  file.add_idx1_entry("01wb", 0x10, audio1 - offset, 4);
+  file.add_idx1_entry("00dc", 0x00, video2 - offset, 0);
+  file.add_idx1_entry("01wb", 0x00, audio2 - offset, 3);
+  file.add_idx1_entry("00DB", 0x00, video3 - offset, 6);
+  file.add_idx1_entry("02tx", 0x00, video3 - offset, 6);
+
+  avi_t avi{};
+  file.set_up(avi);
+
+  mm_mem_io_c in{file.get_buffer(), file.m_data.size()};
+  mtx::avi::index_c index;
+
+  ASSERT_TRUE(index.load(in, avi));
+
+  auto const &video = index.get_video();
+  ASSERT_EQ(3u, video.size());
+  EXPECT_EQ(video1 + 8, video.get_position(0));
+  EXPECT_EQ(10u,        video.get_size(0));
+  EXPECT_TRUE(video.is_key(0));
+  EXPECT_EQ(video2 + 8, video.get_position(1));
+  EXPECT_EQ(0u,         video.get_size(1));
+  EXPECT_FALSE(video.is_key(1));
+  EXPECT_EQ(video3 + 8, video.get_position(2));
+  EXPECT_EQ(16u,        video.get_total_size());
+
+  auto const &audio = index.get_audio(0);
+  ASSERT_EQ(2u, audio.size());
+  EXPECT_EQ(audio1 + 8, audio.get_position(0));
+  EXPECT_EQ(4u,         audio.get_size(0));
+  EXPECT_EQ(audio2 + 8, audio.get_position(1));
+  EXPECT_EQ(3u,         audio.get_size(1));
+}
+
+TEST(AviIndex, Idx1RelativeToFile) {
+  test_idx1(false);
+}
+
+TEST(AviIndex, Idx1RelativeToMovi) {
+  test_idx1(true);
+}
+
+TEST(AviIndex, Idx1Unusable) {
+  test_file_c file;
+  avi_t avi{};
+  mtx::avi::index_c index;
+
+  // No index at all
+  file.add_chunk("00dc", 10);
+  file.set_up(avi);
+
+  mm_mem_io_c in{file.get_buffer(), file.m_data.size()};
+  EXPECT_FALSE(index.load(in, avi));
+
+  // Offsets pointing neither to a chunk relative to the file nor
+  // relative to the 'movi' list
+  file.add_idx1_entry("00dc", 0x10, 1, 10);
+  file.set_up(avi);
+
+  EXPECT_FALSE(index.load(in, avi));
+
+  // No video chunks
+  test_file_c audio_only;
+  audio_only.add_idx1_entry("01wb", 0x10, audio_only.add_chunk("01wb", 4), 4);
+  audio_only.set_up(avi);
+
+  mm_mem_io_c audio_only_in{audio_only.get_buffer(), audio_only.m_data.size()};
+  EXPECT_FALSE(index.load(audio_only_in, avi));
+}
+
+TEST(AviIndex, OpenDml) {
+  test_file_c file;
+
+  auto video1 = file.add_chunk("00dc", 10);
+  auto audio1 = file.add_chunk("01wb", 4);
+  auto video2 = file.add_chunk("00dc", 6);
+  auto video3 = file.add_chunk("00dc", 2);
+  auto base   = file.m_movi_start;
+
+  std::vector<avisuperindex_entry> video_ix_chunks, audio_ix_chunks;
+  video_ix_chunks.push_back(file.add_ix_chunk("ix00", base, { { video1 + 8 - base, 10 }, { 0, 0x80000000 }, { video2 + 8 - base, 0x80000006 } }));
+  video_ix_chunks.push_back(file.add_ix_chunk("ix00", 0,    { { video3 + 8,        2 } }));
+  audio_ix_chunks.push_back(file.add_ix_chunk("ix01", base, { { audio1 + 8 - base, 4 } }));
+
+  // Index chunks that cannot be read are ignored.
+  video_ix_chunks.push_back({ file.m_data.size() + 1000, 40, 0 });
+
+  avisuperindex_chunk video_superindex{}, audio_superindex{};
+  video_superindex.nEntriesInUse = video_ix_chunks.size();
+  video_superindex.aIndex        = video_ix_chunks.data();
+  audio_superindex.nEntriesInUse = audio_ix_chunks.size();
+  audio_superindex.aIndex        = audio_ix_chunks.data();
+
+  avi_t avi{};
+  file.set_up(avi);
+  avi.is_opendml                = 1;
+  avi.video_superindex          = &video_superindex;
+  avi.track[0].audio_superindex = &audio_superindex;
+
+  mm_mem_io_c in{file.get_buffer(), file.m_data.size()};
+  mtx::avi::index_c index;
+
+  ASSERT_TRUE(index.load(in, avi));
+
+  // Completely empty entries are ignored.
+  auto const &video = index.get_video();
+  ASSERT_EQ(3u, video.size());
+  EXPECT_EQ(video1 + 8, video.get_position(0));
+  EXPECT_EQ(10u,        video.get_size(0));
+  EXPECT_TRUE(video.is_key(0));
+  EXPECT_EQ(video2 + 8, video.get_position(1));
+  EXPECT_EQ(6u,         video.get_size(1));
+  EXPECT_FALSE(video.is_key(1));
+  EXPECT_EQ(video3 + 8, video.get_position(2));
+  EXPECT_EQ(2u,         video.get_size(2));
+  EXPECT_TRUE(video.is_key(2));
+
+  auto const &audio = index.get_audio(0);
+  ASSERT_EQ(1u, audio.size());
+  EXPECT_EQ(audio1 + 8, audio.get_position(0));
+  EXPECT_EQ(4u,         audio.get_size(0));
+
+  // Without video chunks avilib has to reconstruct the index.
+  video_superindex.nEntriesInUse = 0;
+  EXPECT_FALSE(index.load(in, avi));
+}
+
+TEST(AviIndex, Import) {
+  video_index_entry video_entries[] = { { 0x10, 100, 10 }, { 0, 200, 20 } };
+  audio_index_entry audio_entries[] = { { 150, 5, 0 } };
+
+  avi_t avi{};
+  avi.anum                  = 2;
+  avi.video_index           = video_entries;
+  avi.video_frames          = 2;
+  avi.track[0].audio_index  = audio_entries;
+  avi.track[0].audio_chunks = 1;
+
+  mtx::avi::index_c index;
+  index.import(avi);
+
+  auto const &video = index.get_video();
+  ASSERT_EQ(2u, video.size());
+  EXPECT_EQ(100u, video.get_position(0));
+  EXPECT_TRUE(video.is_key(0));
+  EXPECT_EQ(20u,  video.get_size(1));
+  EXPECT_FALSE(video.is_key(1));
+
+  ASSERT_EQ(1u, index.get_audio(0).size());
+  EXPECT_EQ(150u, index.get_audio(0).get_position(0));
+  EXPECT_TRUE(index.get_audio(1).empty());
+}
+
+}
@@ -1,6 +1,7 @@
 #include "common/common_pch.h"
 
 #include "common/bit_reader.h"
+#include "common/bit_writer.h"
 #include "common/endian.h"
 
 #include "gtest/gtest.h"
@@ -226,6 +227,33 @@ TEST(BitReader, GetBytes) {
   EXPECT_EQ(  28, b.get_bit_position());
 }
 
+TEST(BitReader, GetBytesAfterCachedBits) {
+  unsigned char value[16], target[8];
+  for (auto idx = 0u; idx < 16; ++idx)
+    value[idx] = 0x10 + idx;
+
+  // The bytes following the ones read with get_bits() are still in the
+  // cache at that point.
+  auto b = mtx::bits::reader_c{value, 16};
+
+  EXPECT_EQ(0x10, b.get_bits(8));
+  EXPECT_NO_THROW(b.get_bytes(target, 2));
+  EXPECT_EQ(0x11, target[0]);
+  EXPECT_EQ(0x12, target[1]);
+  EXPECT_EQ(  24, b.get_bit_position());
+
+  EXPECT_EQ(0x13, b.get_bits(8));
+  EXPECT_EQ(0x14, b.get_bits(8));
+  EXPECT_NO_THROW(b.get_bytes(target, 4));
+  EXPECT_EQ(0x15, target[0]);
+  EXPECT_EQ(0x18, target[3]);
+  EXPECT_EQ(0x19, b.get_bits(8));
+
+  std::memset(target, 0, 8);
+  EXPECT_THROW(b.get_bytes(target, 7), mtx::mm_io::end_of_file_x);
+  EXPECT_EQ(0x1a, target[0]);
+}
+
 TEST(BitReader, SkipBits) {
   unsigned char value[4];
   put_uint32_be(value, 0xf7234a81);
@@ -385,4 +413,108 @@ TEST(BitReader, RBSPMode5) {
   EXPECT_EQ(0x6e, b.get_bits(8));
 }
 
+TEST(BitReader, RBSPModePositionAtEmulationPreventionByte) {
+  unsigned char value[6] = { 0x08, 0x00, 0x00, 0x03, 0x00, 0x1f };
+  auto b = mtx::bits::reader_c{value, 6};
+  b.enable_rbsp_mode();
+
+  EXPECT_EQ(0x080000, b.get_bits(24));
+  EXPECT_EQ(32,       b.get_bit_position());
+  EXPECT_EQ(16,       b.get_remaining_bits());
+  EXPECT_EQ(0x001f,   b.peek_bits(16));
+  EXPECT_EQ(32,       b.get_bit_position());
+}
+
+TEST(BitReader, RBSPModeEnabledAfterReading) {
+  unsigned char value[7] = { 0xed, 0xbf, 0x49, 0x00, 0x00, 0x03, 0x01 };
+  auto b = mtx::bits::reader_c{value, 7};
+
+  EXPECT_EQ(0xed, b.get_bits(8));
+  b.enable_rbsp_mode();
+
+  EXPECT_EQ(8,            b.get_bit_position());
+  EXPECT_EQ(0xbf49000001, b.get_bits(40));
+  EXPECT_EQ(56,           b.get_bit_position());
+}
+
+TEST(BitReader, StripEmulationPreventionBytes) {
+  unsigned char value[9] = { 0x08, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x03, 0x1f };
+  auto b = mtx::bits::reader_c{value, 9};
+
+  EXPECT_EQ(0x00, b.get_bits(4));
+  b.strip_emulation_prevention_bytes();
+
+  EXPECT_EQ( 4, b.get_bit_position());
+  EXPECT_EQ(52, b.get_remaining_bits());
+  EXPECT_EQ(0x800000000031full, b.get_bits(52));
+  EXPECT_EQ( 0, b.get_remaining_bits());
+  EXPECT_THROW(b.get_bit(), mtx::mm_io::end_of_file_x);
+
+  auto b2 = mtx::bits::reader_c{value, 9};
+  b2.strip_emulation_prevention_bytes(4);
+  EXPECT_EQ(24,       b2.get_remaining_bits());
+  EXPECT_EQ(0x080000, b2.get_bits(24));
+  EXPECT_THROW(b2.get_bit(), mtx::mm_io::end_of_file_x);
+}
+
+TEST(BitReader, LongReadsAcrossRefills) {
+  unsigned char value[20];
+  for (auto idx = 0u; idx < 20; ++idx)
+    value[idx] = (idx * 0x11) & 0xff;
+
+  auto b = mtx::bits::reader_c{value, 20};
+
+  EXPECT_EQ(0x0,                   b.get_bits(4));
+  EXPECT_EQ(0x0112233445566778ull, b.get_bits(64));
+  EXPECT_EQ(0x899aabbccddeeff1ull, b.get_bits(64));
+  EXPECT_EQ(132,                   b.get_bit_position());
+  EXPECT_EQ(0x0,                   b.get_bits(4));
+
+  b.skip_bits(4);
+  EXPECT_EQ(0x1324, b.get_bits(16));
+  EXPECT_EQ(4,      b.get_remaining_bits());
+}
+
+TEST(BitReader, GetUnsignedGolombLongCodes) {
+  std::vector<uint64_t> values{ 0, 1, 2, 3, 254, 255, 65535, 0xffffffffull, 0xff00ff00ffull, 7 };
+  mtx::bits::writer_c w;
+
+  for (auto value : values) {
+    auto num_bits = 0u;
+    while ((value + 1) >> (num_bits + 1))
+      ++num_bits;
+
+    w.put_bits(num_bits, 0);
+    w.put_bits(num_bits + 1, value + 1);
+  }
+
+  auto buffer = w.get_buffer();
+  auto b      = mtx::bits::reader_c{*buffer};
+
+  for (auto value : values)
+    EXPECT_EQ(value, b.get_unsigned_golomb());
+
+  EXPECT_EQ(0x00, b.get_bits(b.get_remaining_bits()));
+  EXPECT_THROW(b.get_unsigned_golomb(), mtx::mm_io::end_of_file_x);
+}
+
+TEST(BitReader, GetUnsignedGolombTooLong) {
+  mtx::bits::writer_c w;
+
+  // The largest value that fits into 64 bits
+  w.put_bits(63, 0);
+  w.put_bits(64, 0xffffffffffffffffull);
+
+  // Too many leading zero bits
+  w.put_bits(64, 0);
+  w.put_bits(1,  1);
+  w.put_bits(64, 0);
+
+  auto buffer = w.get_buffer();
+  auto b      = mtx::bits::reader_c{*buffer};
+
+  EXPECT_EQ(0xfffffffffffffffeull, b.get_unsigned_golomb());
+  EXPECT_THROW(b.get_unsigned_golomb(), mtx::mm_io::end_of_file_x);
+}
+
 }
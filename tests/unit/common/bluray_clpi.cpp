@@ -0,0 +1,139 @@
+#include "common/common_pch.h"
+
+#include "common/bit_writer.h"
+#include "common/bluray/clpi.h"
+#include "common/mm_file_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace mtx::bluray::clpi;
+
+// A clip info file without program streams whose CPI contains an EP
+// map for one stream with two coarse & three fine entries. The coarse
+// entries carry bits that must be masked out.
+std::string
+create_clpi(bool truncate_fine_table) {
+  mtx::bits::writer_c w;
+
+  w.put_bits(32, CLPI_FILE_MAGIC);
+  w.put_bits(32, CLPI_FILE_MAGIC2A);
+  w.put_bits(32, 0);            // sequence info start
+  w.put_bits(32, 20);           // program info start
+  w.put_bits(32, 26);           // CPI start
+
+  // Program info
+  w.put_bits(32, 2);            // length
+  w.put_bits(8,  0);            // reserved
+  w.put_bits(8,  0);            // number of program streams
+
+  // CPI
+  w.put_bits(32, 1);            // length
+  w.put_bits(12, 0);            // reserved
+  w.put_bits(4,  1);            // CPI type: EP map
+
+  // EP map: the stream's tables start right after the stream info.
+  w.put_bits(8,  0);            // reserved
+  w.put_bits(8,  1);            // number of streams
+  w.put_bits(16, 0x1011);       // PID
+  w.put_bits(10, 0);            // reserved
+  w.put_bits(4,  1);            // stream type
+  w.put_bits(16, 2);            // number of coarse entries
+  w.put_bits(18, 3);            // number of fine entries
+  w.put_bits(32, 14);           // start address
+
+  // Coarse table: reference to the first fine entry, PTS & SPN
+  w.put_bits(32, 4 + 2 * 8);    // start of the fine table
+  w.put_bits(18, 0);
+  w.put_bits(14, 0x0005);
+  w.put_bits(32, 0x00021234);
+  w.put_bits(18, 2);
+  w.put_bits(14, 0x0006);
+  w.put_bits(32, 0x00040000);
+
+  // Fine table: angle change point & end position offset, PTS & SPN
+  auto fine_entries = std::vector<std::pair<unsigned int, unsigned int>>{ { 0x001, 0x00100 }, { 0x7ff, 0x1ffff }, { 0x010, 0x00005 } };
+
+  for (auto const &entry : fine_entries) {
+    w.put_bits(4,  0);
+    w.put_bits(11, entry.first);
+    w.put_bits(17, entry.second);
+  }
+
+  auto content = w.get_buffer();
+  auto size    = content->get_size() - (truncate_fine_table ? 2 : 0);
+
+  return std::string(reinterpret_cast<char const *>(content->get_buffer()), size);
+}
+
+std::string
+write_clpi(std::string const &content) {
+  auto file_name = (bfs::temp_directory_path() / "mkvtoolnix-unit-bluray-clpi.clpi").string();
+  mm_file_io_c out{file_name, MODE_CREATE};
+
+  out.write(content);
+
+  return file_name;
+}
+
+TEST(BlurayClpi, ParseEpMap) {
+  auto file_name = write_clpi(create_clpi(false));
+  parser_c parser{file_name};
+
+  ASSERT_TRUE(parser.parse());
+  bfs::remove(file_name);
+
+  EXPECT_TRUE(parser.m_programs.empty());
+  ASSERT_EQ(1u, parser.m_ep_maps.size());
+
+  auto const &ep_map = parser.m_ep_maps[0];
+
+  EXPECT_EQ(0x1011u, ep_map.pid);
+  EXPECT_EQ(1u,      ep_map.stream_type);
+  EXPECT_EQ(&ep_map, parser.find_ep_map(0x1011));
+  EXPECT_EQ(nullptr, parser.find_ep_map(0x1100));
+
+  // The PTS consists of the coarse entry's bits 1–13 & the fine entry's
+  // eleven bits; the SPN of the coarse entry's upper 15 bits & the
+  // fine entry's lower 17 bits.
+  ASSERT_EQ(3u, ep_map.entries.size());
+  EXPECT_EQ(timestamp_c::mpeg((4ull << 19) | (0x001 << 9)), ep_map.entries[0].pts);
+  EXPECT_EQ(timestamp_c::mpeg((4ull << 19) | (0x7ff << 9)), ep_map.entries[1].pts);
+  EXPECT_EQ(timestamp_c::mpeg((6ull << 19) | (0x010 << 9)), ep_map.entries[2].pts);
+  EXPECT_EQ(0x20100u, ep_map.entries[0].spn);
+  EXPECT_EQ(0x3ffffu, ep_map.entries[1].spn);
+  EXPECT_EQ(0x40005u, ep_map.entries[2].spn);
+}
+
+TEST(BlurayClpi, ParseTruncatedEpMap) {
+  auto file_name = write_clpi(create_clpi(true));
+  parser_c parser{file_name};
+
+  // Errors in the EP map only discard the EP map.
+  ASSERT_TRUE(parser.parse());
+  bfs::remove(file_name);
+
+  EXPECT_TRUE(parser.m_ep_maps.empty());
+  EXPECT_EQ(nullptr, parser.find_ep_map(0x1011));
+}
+
+TEST(BlurayClpi, EpMapFindEntryAtOrBefore) {
+  ep_map_t ep_map;
+
+  EXPECT_FALSE(ep_map.find_entry_at_or_before(timestamp_c::s(1)));
+
+  ep_map.entries.push_back({ timestamp_c::mpeg(90000),  100 });
+  ep_map.entries.push_back({ timestamp_c::mpeg(135000), 500 });
+  ep_map.entries.push_back({ timestamp_c::mpeg(180000), 900 });
+
+  EXPECT_FALSE(ep_map.find_entry_at_or_before(timestamp_c::mpeg(89999)));
+
+  EXPECT_EQ(100u, ep_map.find_entry_at_or_before(timestamp_c::mpeg(90000))->spn);
+  EXPECT_EQ(100u, ep_map.find_entry_at_or_before(timestamp_c::mpeg(134999))->spn);
+  EXPECT_EQ(500u, ep_map.find_entry_at_or_before(timestamp_c::mpeg(135000))->spn);
+  EXPECT_EQ(900u, ep_map.find_entry_at_or_before(timestamp_c::mpeg(180001))->spn);
+  EXPECT_EQ(900u, ep_map.find_entry_at_or_before(timestamp_c::s(3600))->spn);
+}
+
+}
@@ -0,0 +1,110 @@
+#include "common/common_pch.h"
+
+#include "common/bswap.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<unsigned char>
+create_data(std::size_t size) {
+  std::vector<unsigned char> data(size);
+  auto value = 0x2468aceu;
+
+  for (auto &byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte  = value >> 24;
+  }
+
+  return data;
+}
+
+std::vector<unsigned char>
+swap_reference(std::vector<unsigned char> const &src,
+               std::size_t word_length) {
+  auto dst = src;
+
+  for (auto idx = 0u; idx < dst.size(); idx += word_length)
+    std::reverse(&dst[idx], &dst[idx + word_length]);
+
+  return dst;
+}
+
+std::vector<unsigned char>
+remap_reference(std::vector<unsigned char> const &src,
+                std::size_t bytes_per_sample,
+                std::size_t num_input_channels,
+                std::vector<std::size_t> const &channel_map) {
+  std::vector<unsigned char> dst;
+  auto input_frame_size = bytes_per_sample * num_input_channels;
+
+  for (auto frame = 0u; (frame + 1) * input_frame_size <= src.size(); ++frame)
+    for (auto input_channel : channel_map)
+      for (auto byte = 0u; byte < bytes_per_sample; ++byte)
+        dst.push_back(src[frame * input_frame_size + input_channel * bytes_per_sample + byte]);
+
+  return dst;
+}
+
+TEST(Bswap, SwapBufferMatchesReference) {
+  for (auto word_length : { 1u, 2u, 3u, 4u, 5u, 8u }) {
+    for (auto num_words : { 0u, 1u, 3u, 5u, 6u, 7u, 8u, 15u, 16u, 17u, 33u, 1000u }) {
+      auto src      = create_data(word_length * num_words);
+      auto expected = swap_reference(src, word_length);
+      std::vector<unsigned char> dst(src.size());
+
+      mtx::bytes::swap_buffer(src.data(), dst.data(), src.size(), word_length);
+      EXPECT_EQ(expected, dst) << "word length " << word_length << " num words " << num_words;
+
+      mtx::bytes::swap_buffer(src.data(), src.data(), src.size(), word_length);
+      EXPECT_EQ(expected, src) << "in place: word length " << word_length << " num words " << num_words;
+    }
+  }
+}
+
+TEST(Bswap, SwapBufferInvalidSize) {
+  unsigned char buffer[5]{};
+
+  EXPECT_THROW(mtx::bytes::swap_buffer(buffer, buffer, 5, 2), std::invalid_argument);
+  EXPECT_THROW(mtx::bytes::swap_buffer(buffer, buffer, 5, 3), std::invalid_argument);
+}
+
+TEST(Bswap, RemapChannelsMatchesReference) {
+  std::vector<std::vector<std::size_t>> const channel_maps{
+    { 0 }, { 0, 1 }, { 1, 0 }, { 0, 1, 2 }, { 0, 1, 2, 3, 4 }, { 0, 1, 2, 3, 4, 5, 6 }, { 2, 0, 1, 5, 3 }, { 0, 0 },
+  };
+
+  for (auto bytes_per_sample : { 1u, 2u, 3u, 4u, 8u }) {
+    for (auto num_input_channels : { 2u, 4u, 6u, 8u }) {
+      for (auto const &channel_map : channel_maps) {
+        if (*std::max_element(channel_map.begin(), channel_map.end()) >= num_input_channels)
+          continue;
+
+        auto src      = create_data(bytes_per_sample * num_input_channels * 257 + bytes_per_sample);
+        auto expected = remap_reference(src, bytes_per_sample, num_input_channels, channel_map);
+        std::vector<unsigned char> dst(src.size() * 2);
+
+        auto num_written = mtx::bytes::remap_channels(src.data(), dst.data(), src.size(), bytes_per_sample, num_input_channels, channel_map);
+        dst.resize(num_written);
+        EXPECT_EQ(expected, dst) << "bytes per sample " << bytes_per_sample << " channels " << num_input_channels << " map size " << channel_map.size();
+
+        if (channel_map.size() > num_input_channels)
+          continue;
+
+        num_written = mtx::bytes::remap_channels(src.data(), src.data(), src.size(), bytes_per_sample, num_input_channels, channel_map);
+        src.resize(num_written);
+        EXPECT_EQ(expected, src) << "in place: bytes per sample " << bytes_per_sample << " channels " << num_input_channels << " map size " << channel_map.size();
+      }
+    }
+  }
+}
+
+TEST(Bswap, RemapChannelsInvalidParameters) {
+  unsigned char buffer[16]{};
+
+  EXPECT_THROW(mtx::bytes::remap_channels(buffer, buffer, 16, 2, 2, { 0, 2 }),       std::invalid_argument);
+  EXPECT_THROW(mtx::bytes::remap_channels(buffer, buffer, 16, 2, 2, { 0, 1, 0 }),    std::invalid_argument);
+  EXPECT_THROW(mtx::bytes::remap_channels(buffer, buffer, 16, 2, 0, {}),             std::invalid_argument);
+}
+
+}
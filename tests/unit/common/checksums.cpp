@@ -136,4 +136,32 @@ TEST_F(ChecksumTest, FileChunked1000) {
   EXPECT_EQ(*m_data_md5, *calculate_bin(mtx::checksum::algorithm_e::md5,                       1000));
 }
 
+TEST(Checksum, BlockwiseMatchesBytewise) {
+  std::vector<unsigned char> data(4096 + 17);
+  auto value = 0x12345678u;
+
+  for (auto &byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte  = value >> 24;
+  }
+
+  for (auto algorithm : { mtx::checksum::algorithm_e::crc8_atm,   mtx::checksum::algorithm_e::crc16_ansi, mtx::checksum::algorithm_e::crc16_ccitt,
+                          mtx::checksum::algorithm_e::crc16_002d, mtx::checksum::algorithm_e::crc32_ieee, mtx::checksum::algorithm_e::crc32_ieee_le }) {
+    for (auto initial_value : { 0x00u, 0xffu }) {
+      for (auto offset : { 0u, 1u, 3u, 7u }) {
+        for (auto size : { 0u, 1u, 7u, 8u, 15u, 16u, 17u, 63u, 64u, 65u, 79u, 80u, 127u, 128u, 1000u, 4096u }) {
+          auto bytewise = mtx::checksum::for_algorithm(algorithm, initial_value);
+
+          for (auto idx = 0u; idx < size; ++idx)
+            bytewise->add(&data[offset + idx], 1);
+
+          EXPECT_EQ(dynamic_cast<mtx::checksum::uint_result_c &>(*bytewise).get_result_as_uint(),
+                    mtx::checksum::calculate_as_uint(algorithm, &data[offset], size, initial_value))
+            << "algorithm " << static_cast<int>(algorithm) << " initial value " << initial_value << " offset " << offset << " size " << size;
+        }
+      }
+    }
+  }
+}
+
 }
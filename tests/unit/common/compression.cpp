@@ -0,0 +1,80 @@
+#include "common/common_pch.h"
+
+#include "common/compression.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+mem(std::string const &content) {
+  return memory_c::clone(content);
+}
+
+std::string
+joined(memory_slices_c const &slices) {
+  return join_memory_slices(slices)->to_string();
+}
+
+std::shared_ptr<header_removal_compressor_c>
+header_removal(std::string const &bytes) {
+  auto compressor = std::make_shared<header_removal_compressor_c>();
+  auto m_bytes    = mem(bytes);
+
+  compressor->set_bytes(m_bytes);
+
+  return compressor;
+}
+
+TEST(HeaderRemovalCompression, Contiguous) {
+  auto compressor = header_removal("\x0b\x77"s);
+
+  EXPECT_EQ("abc"s,             compressor->compress(mem("\x0b\x77" "abc"s))->to_string());
+  EXPECT_EQ("\x0b\x77" "abc"s, compressor->decompress(mem("abc"s))->to_string());
+
+  EXPECT_THROW(compressor->compress(mem("\x0b\x78" "abc"s)), mtx::compression_x);
+  EXPECT_THROW(compressor->compress(mem("\x0b"s)),            mtx::compression_x);
+}
+
+TEST(HeaderRemovalCompression, SlicesAreNotCopied) {
+  auto compressor = header_removal("ABCD"s);
+  auto first      = mem("xAB"s);
+  auto second     = mem("yCDEF"s);
+  memory_slices_c slices{ { first, 1, 2 }, { second, 1, 4 } };
+
+  compressor->compress(slices);
+
+  ASSERT_EQ(1u,           slices.size());
+  EXPECT_EQ(second.get(), slices[0].m_memory.get());
+  EXPECT_EQ(3u,           slices[0].m_offset);
+  EXPECT_EQ(2u,           slices[0].m_size);
+  EXPECT_EQ("EF"s,        joined(slices));
+
+  compressor->decompress(slices);
+
+  ASSERT_EQ(2u,           slices.size());
+  EXPECT_EQ("ABCDEF"s,    joined(slices));
+}
+
+TEST(HeaderRemovalCompression, SlicesMismatch) {
+  auto compressor = header_removal("ABCD"s);
+  memory_slices_c slices{ { mem("AB"s), 0, 2 }, { mem("CXEF"s), 0, 4 } };
+
+  EXPECT_THROW(compressor->compress(slices), mtx::compression_x);
+
+  memory_slices_c too_short{ { mem("AB"s), 0, 2 } };
+
+  EXPECT_THROW(compressor->compress(too_short), mtx::compression_x);
+}
+
+TEST(Compression, SlicesAreJoinedByDefault) {
+  auto compressor = std::make_shared<compressor_c>(COMPRESSION_NONE);
+  memory_slices_c slices{ { mem("AB"s), 0, 2 }, { mem("xCD"s), 1, 2 } };
+
+  compressor->compress(slices);
+
+  ASSERT_EQ(1u,     slices.size());
+  EXPECT_EQ("ABCD"s, joined(slices));
+}
+
+}
@@ -12,6 +12,25 @@
 
 namespace {
 
+using namespace mtxut;
+
+std::string
+convert(std::string const &file_name,
+        bool streaming,
+        ebml_master_cptr &result) {
+  mtx::xml::ebml_chapters_converter_c converter;
+  converter.enable_streaming(streaming);
+
+  try {
+    result = converter.to_ebml(file_name, "Chapters");
+
+  } catch (mtx::exception &ex) {
+    return ex.what();
+  }
+
+  return {};
+}
+
 TEST(EbmlChaptersConverter, ToXmlAndEbmlVoid) {
   libmatroska::KaxChapters chapters;
   chapters.PushElement(*new libebml::EbmlVoid);
@@ -67,4 +86,52 @@ TEST(EbmlChaptersConverter, FromXml) {
   EXPECT_THROW(mtx::xml::ebml_chapters_converter_c::parse_file(invalid_range, true),  mtx::xml::out_of_range_x);
 }
 
+TEST(EbmlChaptersConverter, FromXmlStreamed) {
+  std::vector<std::string> file_names{
+    "tests/unit/data/text/chapters-valid.xml",
+    "tests/unit/data/text/chapters-with-ebmlvoid.xml",
+    "tests/unit/data/text/chapters-invalid-child-node.xml",
+    "tests/unit/data/text/chapters-invalid-attribute.xml",
+    "tests/unit/data/text/chapters-invalid-atom-missing-start.xml",
+    "tests/unit/data/text/chapters-invalid-atom-start-twice.xml",
+    "tests/unit/data/text/chapters-invalid-malformed-data.xml",
+    "tests/unit/data/text/chapters-invalid-malformed-xml.xml",
+    "tests/unit/data/text/chapters-invalid-range.xml",
+  };
+
+  for (auto const &file_name : file_names) {
+    ebml_master_cptr streamed, whole;
+
+    // Errors must be reported with the same positions.
+    EXPECT_EQ(convert(file_name, false, whole), convert(file_name, true, streamed)) << file_name;
+    ASSERT_EQ(!!whole, !!streamed) << file_name;
+
+    if (whole) {
+      EXPECT_EBML_EQ(*whole, *streamed);
+    }
+  }
+}
+
+TEST(EbmlChaptersConverter, ToXmlStreamed) {
+  auto chapters = mtx::xml::ebml_chapters_converter_c::parse_file("tests/unit/data/text/chapters-valid.xml", true);
+  ASSERT_TRUE(!!chapters);
+
+  chapters->PushElement(*new libebml::EbmlVoid);
+
+  mm_mem_io_c mem_io{nullptr, 0, 1000};
+  ASSERT_NO_THROW(mtx::xml::ebml_chapters_converter_c::write_xml(*chapters, mem_io));
+
+  auto doc = std::make_shared<pugi::xml_document>();
+  doc->append_child(pugi::node_comment).set_value(" <!DOCTYPE Chapters SYSTEM \"matroskachapters.dtd\"> ");
+  mtx::xml::ebml_chapters_converter_c{}.to_xml(*chapters, doc);
+
+  std::stringstream expected_output;
+  expected_output << "\xEF\xBB\xBF";
+  doc->save(expected_output, "  ");
+
+  auto actual_output = mem_io.get_content();
+
+  ASSERT_EQ(actual_output, expected_output.str());
+}
+
 }
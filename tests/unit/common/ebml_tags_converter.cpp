@@ -7,10 +7,13 @@
 #include "tests/unit/util.h"
 
 #include "common/mm_io_x.h"
+#include "common/mm_mem_io.h"
 #include "common/xml/ebml_tags_converter.h"
 
 namespace {
 
+using namespace mtxut;
+
 TEST(EbmlTagsConverter, FromXml) {
   std::string const &valid              = "tests/unit/data/text/tags-valid.xml";
   std::string const &invalid_child_node = "tests/unit/data/text/tags-invalid-child-node.xml";
@@ -25,4 +28,32 @@ TEST(EbmlTagsConverter, FromXml) {
   EXPECT_THROW(mtx::xml::ebml_tags_converter_c::parse_file(invalid_child_node, true),  mtx::xml::invalid_child_node_x);
 }
 
+TEST(EbmlTagsConverter, StreamedAndWholeDocument) {
+  std::string const &valid = "tests/unit/data/text/tags-valid.xml";
+  mtx::xml::ebml_tags_converter_c streamed, whole;
+
+  whole.enable_streaming(false);
+
+  auto streamed_tags = streamed.to_ebml(valid, "Tags");
+  auto whole_tags    = whole.to_ebml(valid, "Tags");
+
+  ASSERT_TRUE(!!streamed_tags && !!whole_tags);
+  EXPECT_EBML_EQ(*whole_tags, *streamed_tags);
+
+  mm_mem_io_c mem_io{nullptr, 0, 1000};
+  ASSERT_NO_THROW(mtx::xml::ebml_tags_converter_c::write_xml(static_cast<libmatroska::KaxTags &>(*streamed_tags), mem_io));
+
+  auto doc = std::make_shared<pugi::xml_document>();
+  doc->append_child(pugi::node_comment).set_value(" <!DOCTYPE Tags SYSTEM \"matroskatags.dtd\"> ");
+  whole.to_xml(*whole_tags, doc);
+
+  std::stringstream expected_output;
+  expected_output << "\xEF\xBB\xBF";
+  doc->save(expected_output, "  ");
+
+  auto actual_output = mem_io.get_content();
+
+  ASSERT_EQ(actual_output, expected_output.str());
+}
+
 }
@@ -0,0 +1,61 @@
+#include "common/common_pch.h"
+
+#include "common/iso639.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+code_for(std::string const &s,
+         bool allow_short_english_names = false) {
+  auto idx = map_to_iso639_2_code(s, allow_short_english_names);
+  return -1 == idx ? "-1"s : g_iso639_languages[idx].iso639_2_code;
+}
+
+TEST(Iso639, MapToIso6392Code) {
+  EXPECT_EQ("ger"s, code_for("ger"));
+  EXPECT_EQ("ger"s, code_for("deu"));
+  EXPECT_EQ("ger"s, code_for("de"));
+  EXPECT_EQ("ger"s, code_for("German"));
+  EXPECT_EQ("ger"s, code_for("gERMAN"));
+  EXPECT_EQ("spa"s, code_for("Castilian"));
+  EXPECT_EQ("zza"s, code_for("kirdki"));
+
+  // Deprecated codes
+  EXPECT_EQ("heb"s, code_for("iw"));
+  EXPECT_EQ("rum"s, code_for("mol"));
+
+  // Codes are case sensitive.
+  EXPECT_EQ("-1"s,  code_for("GER"));
+
+  EXPECT_EQ("-1"s,  code_for(""));
+  EXPECT_EQ("-1"s,  code_for("qqqq"));
+  EXPECT_EQ("-1"s,  code_for("Germ"));
+  EXPECT_EQ("-1"s,  code_for("German; Deutsch"));
+}
+
+TEST(Iso639, MapToIso6392CodeShortEnglishNames) {
+  EXPECT_EQ("ger"s, code_for("Germ",  true));
+  EXPECT_EQ("ger"s, code_for("german", true));
+  EXPECT_EQ("-1"s,  code_for("Xyz",   true));
+
+  // The first language with a matching name is used.
+  auto idx = map_to_iso639_2_code("Ab", true);
+  ASSERT_NE(-1, idx);
+  EXPECT_EQ("Abkhazian"s, g_iso639_languages[idx].english_name);
+}
+
+TEST(Iso639, Iso6392Codes) {
+  EXPECT_TRUE(is_valid_iso639_2_code("ger"));
+  EXPECT_TRUE(is_valid_iso639_2_code("und"));
+  EXPECT_FALSE(is_valid_iso639_2_code("deu"));
+  EXPECT_FALSE(is_valid_iso639_2_code("de"));
+  EXPECT_FALSE(is_valid_iso639_2_code(""));
+
+  EXPECT_EQ("de"s, map_iso639_2_to_iso639_1("ger"));
+  EXPECT_EQ(""s,   map_iso639_2_to_iso639_1("ace"));
+  EXPECT_EQ(""s,   map_iso639_2_to_iso639_1("deu"));
+}
+
+}
@@ -0,0 +1,71 @@
+#include "common/common_pch.h"
+
+#include "common/json.h"
+#include "common/json_writer.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+write(std::function<void(mtx::json::writer_c &)> const &content,
+      int indentation = 2) {
+  std::string output;
+
+  {
+    mtx::json::writer_c writer{[&output](std::string const &chunk) { output += chunk; }, indentation, 16};
+    content(writer);
+  }
+
+  return output;
+}
+
+TEST(JsonWriter, SameOutputAsDump) {
+  auto json = nlohmann::json{
+    { "a_number",       -42                                        },
+    { "b_string",       "Hello \"world\"\\\n\t\x01 äöü"            },
+    { "c_bool",         true                                       },
+    { "d_empty_array",  nlohmann::json::array()                    },
+    { "e_empty_object", nlohmann::json::object()                   },
+    { "f_array",        { 1, 2, 3 }                                },
+    { "g_nested",       { { "x", { { "y", nlohmann::json::array({ "z" }) } } } } },
+  };
+
+  auto content = [](mtx::json::writer_c &writer) {
+    writer
+      .start_object()
+      .member("a_number",     -42)
+      .member("b_string",     "Hello \"world\"\\\n\t\x01 äöü")
+      .member("c_bool",       true)
+      .key("d_empty_array").start_array().end_array()
+      .key("e_empty_object").start_object().end_object()
+      .key("f_array").start_array().value(1).value(2u).value(3ll).end_array()
+      .member("g_nested",     nlohmann::json{ { "x", { { "y", nlohmann::json::array({ "z" }) } } } })
+      .end_object();
+  };
+
+  EXPECT_EQ(mtx::json::dump(json, 2),  write(content));
+  EXPECT_EQ(mtx::json::dump(json, -1), write(content, -1));
+}
+
+TEST(JsonWriter, TopLevelValues) {
+  EXPECT_EQ("42",      write([](mtx::json::writer_c &writer) { writer.value(42); }));
+  EXPECT_EQ("\"abc\"", write([](mtx::json::writer_c &writer) { writer.value("abc"); }));
+  EXPECT_EQ("[]",      write([](mtx::json::writer_c &writer) { writer.start_array().end_array(); }));
+}
+
+TEST(JsonWriter, InvalidUTF8IsFixed) {
+  auto invalid = std::string{"a\xff" "b"};
+
+  EXPECT_EQ(mtx::json::dump(nlohmann::json(invalid)), write([&invalid](mtx::json::writer_c &writer) { writer.value(invalid); }));
+}
+
+TEST(JsonWriter, Escaping) {
+  std::string output;
+
+  mtx::json::writer_c::escape(output, "\"\\\b\f\n\r\t\x1f/x");
+
+  EXPECT_EQ("\\\"\\\\\\b\\f\\n\\r\\t\\u001f/x", output);
+}
+
+}
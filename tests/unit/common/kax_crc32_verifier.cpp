@@ -0,0 +1,83 @@
+#include "common/common_pch.h"
+
+#include "common/checksums/base.h"
+#include "common/kax_crc32_verifier.h"
+#include "common/mm_mem_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+element(std::string const &id,
+        std::string const &content) {
+  std::string size{"\x01\x00\x00\x00\x00\x00\x00\x00", 8};
+
+  for (auto idx = 0u; idx < 7; ++idx)
+    size[7 - idx] = static_cast<char>((content.size() >> (idx * 8)) & 0xff);
+
+  return id + size + content;
+}
+
+std::string
+with_crc32(std::string const &content,
+           bool corrupt = false) {
+  auto crc = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc32_ieee_le, content.data(), content.size(), 0xffffffffu) ^ 0xffffffffu;
+
+  if (corrupt)
+    crc ^= 0x00010000;
+
+  std::string crc_element{"\xbf\x84"};
+  for (auto idx = 0u; idx < 4; ++idx)
+    crc_element += static_cast<char>((crc >> (idx * 8)) & 0xff);
+
+  return crc_element + content;
+}
+
+std::string const s_ebml_head{"\x1a\x45\xdf\xa3\x80", 5};
+std::string const s_segment_id{"\x18\x53\x80\x67"}, s_cluster_id{"\x1f\x43\xb6\x75"}, s_tracks_id{"\x16\x54\xae\x6b"};
+std::string const s_cluster_content{"\xe7\x81\x00\xa3\x86\x81\x00\x00\x80\x12\x34", 11};
+
+TEST(KaxCrc32Verifier, ChecksumsAndMismatches) {
+  auto tracks   = element(s_tracks_id,  "\xae\x83\xd7\x81\x01"s);
+  auto cluster1 = element(s_cluster_id, with_crc32(s_cluster_content));
+  auto cluster2 = element(s_cluster_id, with_crc32(s_cluster_content, true));
+  auto cluster3 = element(s_cluster_id, s_cluster_content);
+  auto file     = s_ebml_head + element(s_segment_id, tracks + cluster1 + cluster2 + cluster3);
+
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(file.data()), file.size()};
+  mtx::kax_crc32_verifier_c verifier{in, 2};
+  auto const &problems = verifier.verify();
+
+  EXPECT_EQ(2u,                            verifier.get_num_checked());
+  EXPECT_EQ(2 * s_cluster_content.size(),  verifier.get_num_bytes_covered());
+
+  ASSERT_EQ(1u, problems.size());
+
+  auto cluster2_position = s_ebml_head.size() + 12 + tracks.size() + cluster1.size();
+
+  EXPECT_EQ(mtx::kax_crc32_verifier_c::problem_e::crc_mismatch, problems[0].m_type);
+  EXPECT_EQ(0x1f43b675u,                                        problems[0].m_id);
+  EXPECT_EQ(cluster2_position,                                  problems[0].m_element_position);
+  EXPECT_EQ(cluster2_position + 12 + 6,                         problems[0].m_covered_start);
+  EXPECT_EQ(cluster2_position + cluster2.size(),                problems[0].m_covered_end);
+  EXPECT_EQ(problems[0].m_stored_crc ^ 0x00010000,              problems[0].m_calculated_crc);
+}
+
+TEST(KaxCrc32Verifier, UnknownSizedSegmentAndTruncation) {
+  auto cluster1 = element(s_cluster_id, with_crc32(s_cluster_content));
+  auto cluster2 = element(s_cluster_id, with_crc32(s_cluster_content));
+  auto file     = s_ebml_head + s_segment_id + "\x01\xff\xff\xff\xff\xff\xff\xff"s + cluster1 + cluster2.substr(0, cluster2.size() - 3);
+
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(file.data()), file.size()};
+  mtx::kax_crc32_verifier_c verifier{in};
+  auto const &problems = verifier.verify();
+
+  EXPECT_EQ(1u, verifier.get_num_checked());
+
+  ASSERT_EQ(1u, problems.size());
+  EXPECT_EQ(mtx::kax_crc32_verifier_c::problem_e::truncated, problems[0].m_type);
+  EXPECT_EQ(s_ebml_head.size() + 12 + cluster1.size(),       problems[0].m_element_position);
+}
+
+}
@@ -0,0 +1,110 @@
+#include "common/common_pch.h"
+
+#include "common/kax_info.h"
+#include "common/mm_file_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string
+element(std::string const &id,
+        std::string const &content) {
+  std::string size{"\x01\x00\x00\x00\x00\x00\x00\x00", 8};
+
+  for (auto idx = 0u; idx < 7; ++idx)
+    size[7 - idx] = static_cast<char>((content.size() >> (idx * 8)) & 0xff);
+
+  return id + size + content;
+}
+
+std::string
+uint_element(std::string const &id,
+             uint8_t value) {
+  return id + "\x81"s + static_cast<char>(value);
+}
+
+// A file with one audio track & 'num_clusters' clusters of known size
+// with a couple of simple blocks each. The last cluster is truncated so
+// that it's left to the sequential code.
+std::string
+create_file(unsigned int num_clusters) {
+  auto info     = element("\x15\x49\xa9\x66"s, "\x2a\xd7\xb1\x83\x0f\x42\x40"s);
+  auto track    = element("\xae"s, uint_element("\xd7"s, 1) + uint_element("\x73\xc5"s, 1) + uint_element("\x83"s, 2) + "\x86\x8d"s + "A_PCM/INT/LIT"s);
+  auto tracks   = element("\x16\x54\xae\x6b"s, track);
+  auto clusters = std::string{};
+
+  for (auto cluster_idx = 0u; cluster_idx < num_clusters; ++cluster_idx) {
+    auto content = uint_element("\xe7"s, cluster_idx % 200);
+
+    for (auto block_idx = 0u; block_idx < 3; ++block_idx)
+      content += element("\xa3"s, "\x81\x00"s + static_cast<char>(block_idx * 10) + "\x80"s + std::string(10 + cluster_idx % 7, 'x'));
+
+    clusters += element("\x1f\x43\xb6\x75"s, content);
+  }
+
+  auto segment = element("\x18\x53\x80\x67"s, info + tracks + clusters);
+
+  return "\x1a\x45\xdf\xa3\x80"s + segment.substr(0, segment.size() - 5);
+}
+
+// A file name in the temporary directory that is removed at the end
+// of the test.
+class temp_file_c {
+public:
+  std::string m_name;
+
+public:
+  temp_file_c(std::string const &id)
+    : m_name{(bfs::temp_directory_path() / fmt::format("mkvtoolnix-unit-kax-info-{0}.bin", id)).string()}
+  {
+  }
+
+  ~temp_file_c() {
+    boost::system::error_code ec;
+    bfs::remove(m_name, ec);
+  }
+};
+
+std::string
+run_kax_info(std::string const &file_name,
+             unsigned int num_threads,
+             int verbosity,
+             bool show_summary) {
+  temp_file_c output{fmt::format("output-{0}", num_threads)};
+  mtx::kax_info_c info;
+
+  info.set_num_threads(num_threads);
+  info.set_verbosity(verbosity);
+  info.set_show_summary(show_summary);
+  info.set_show_track_info(true);
+  info.set_destination_file_name(output.m_name);
+
+  EXPECT_EQ(mtx::kax_info_c::result_e::succeeded, info.open_and_process_file(file_name));
+
+  auto content = mm_file_io_c::slurp(output.m_name);
+
+  return { reinterpret_cast<char const *>(content->get_buffer()), content->get_size() };
+}
+
+TEST(KaxInfo, ParallelClustersMatchSequentialOutput) {
+  temp_file_c input{"input"};
+
+  {
+    mm_file_io_c out{input.m_name, MODE_CREATE};
+    out.write(create_file(300));
+  }
+
+  // The clusters are handled in several jobs with four threads.
+  for (auto verbosity : std::vector<int>{ 1, 2 }) {
+    for (auto show_summary : std::vector<bool>{ false, true }) {
+      auto sequential = run_kax_info(input.m_name, 1, verbosity, show_summary);
+      auto parallel   = run_kax_info(input.m_name, 4, verbosity, show_summary);
+
+      EXPECT_FALSE(sequential.empty());
+      EXPECT_EQ(sequential, parallel);
+    }
+  }
+}
+
+}
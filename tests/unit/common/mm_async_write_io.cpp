@@ -0,0 +1,215 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+#include "tests/unit/util.h"
+
+#include "common/mm_async_write_io.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+
+namespace {
+
+// A file name in the temporary directory that is removed at the end
+// of the test together with its temporary variants.
+class temp_file_c {
+public:
+  std::string m_name, m_temporary_name;
+
+public:
+  temp_file_c(std::string const &id)
+    : m_name{(bfs::temp_directory_path() / fmt::format("mkvtoolnix-unit-async-write-io-{0}.bin", id)).string()}
+    , m_temporary_name{m_name + ".tmp"}
+  {
+    remove();
+  }
+
+  ~temp_file_c() {
+    remove();
+  }
+
+  void
+  remove() {
+    boost::system::error_code ec;
+    bfs::remove(m_name,           ec);
+    bfs::remove(m_temporary_name, ec);
+  }
+
+  void
+  create(std::string const &content)
+    const {
+    mm_file_io_c out{m_name, MODE_CREATE};
+    out.write(content);
+  }
+};
+
+bool
+exists(std::string const &file_name) {
+  boost::system::error_code ec;
+  return bfs::exists(file_name, ec);
+}
+
+TEST(MmAsyncWriteIo, WriteSeekPositionAndSize) {
+  temp_file_c file{"write"};
+  mm_async_write_io_c out{file.m_name};
+
+  EXPECT_EQ(0u, out.getFilePointer());
+  EXPECT_EQ(0,  out.get_size());
+
+  out.write("abcdef"s);
+  EXPECT_EQ(6u, out.getFilePointer());
+  EXPECT_EQ(6,  out.get_size());
+
+  // Overwriting in the middle doesn't change the size.
+  out.setFilePointer(2);
+  out.write("XY"s);
+  EXPECT_EQ(4u, out.getFilePointer());
+  EXPECT_EQ(6,  out.get_size());
+
+  out.setFilePointer(-1, libebml::seek_end);
+  EXPECT_EQ(5u, out.getFilePointer());
+  out.write("Z"s);
+
+  out.setFilePointer(-2, libebml::seek_current);
+  EXPECT_EQ(4u, out.getFilePointer());
+
+  EXPECT_THROW(out.setFilePointer(-5, libebml::seek_current), mtx::mm_io::seek_x);
+  EXPECT_EQ(4u, out.getFilePointer());
+
+  // Writing beyond the end
+  out.setFilePointer(8);
+  out.write("gh"s);
+  EXPECT_EQ(10, out.get_size());
+
+  // Reading waits for all queued writes.
+  unsigned char buffer[6];
+  out.setFilePointer(0);
+  EXPECT_EQ(6u, out.read(buffer, 6));
+  EXPECT_EQ("abXYeZ"s, std::string(reinterpret_cast<char *>(buffer), 6));
+  EXPECT_EQ(6u, out.getFilePointer());
+
+  out.close();
+  ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+
+  auto content = mm_file_io_c::slurp(file.m_name);
+  EXPECT_EQ(10u, content->get_size());
+  EXPECT_EQ("abXYeZ"s, std::string(reinterpret_cast<char *>(content->get_buffer()), 6));
+  EXPECT_EQ("gh"s,     std::string(reinterpret_cast<char *>(content->get_buffer()) + 8, 2));
+}
+
+TEST(MmAsyncWriteIo, Close) {
+  temp_file_c file{"close"};
+
+  {
+    mm_async_write_io_c out{file.m_name};
+
+    out.write("chunky"s);
+    out.close();
+
+    EXPECT_THROW(out.write("bacon"s), mtx::mm_io::read_write_x);
+    EXPECT_NO_THROW(out.close());
+    EXPECT_NO_THROW(out.discard());
+  }
+
+  ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+  EXPECT_EQ("chunky"s, mm_file_io_c::slurp(file.m_name));
+
+  // The destructor closes the file, too.
+  {
+    mm_async_write_io_c out{file.m_name};
+    out.write("bacon"s);
+  }
+
+  ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+  EXPECT_EQ("bacon"s, mm_file_io_c::slurp(file.m_name));
+}
+
+TEST(MmAsyncWriteIo, Discard) {
+  temp_file_c file{"discard"};
+  mm_async_write_io_c out{file.m_name};
+
+  out.write("chunky bacon"s);
+  out.discard();
+
+  EXPECT_THROW(out.write("bacon"s), mtx::mm_io::read_write_x);
+
+  ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+  EXPECT_FALSE(exists(file.m_name));
+}
+
+TEST(MmAsyncWriteIo, TemporaryFileName) {
+  temp_file_c file{"temporary"};
+
+  // Existing files are left alone unless the new file is kept.
+  file.create("original"s);
+
+  for (auto discard : std::vector<bool>{ true, false }) {
+    mm_async_write_io_c out{file.m_name, file.m_temporary_name};
+
+    EXPECT_EQ(file.m_name, out.get_file_name());
+    out.write("new"s);
+
+    ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+    EXPECT_TRUE(exists(file.m_temporary_name));
+    EXPECT_EQ("original"s, mm_file_io_c::slurp(file.m_name));
+
+    if (discard)
+      out.discard();
+    else
+      out.close();
+
+    ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+    EXPECT_FALSE(exists(file.m_temporary_name));
+    EXPECT_EQ("original"s, mm_file_io_c::slurp(file.m_name));
+  }
+
+  // Kept files replace existing ones once they're closed.
+  {
+    mm_async_write_io_c out{file.m_name, file.m_temporary_name};
+
+    out.write("new"s);
+    out.keep();
+  }
+
+  ASSERT_NO_THROW(mm_async_write_io_c::wait_for_pending_operations());
+  EXPECT_FALSE(exists(file.m_temporary_name));
+  EXPECT_EQ("new"s, mm_file_io_c::slurp(file.m_name));
+}
+
+// Errors in the background thread are permanent. Therefore they're
+// tested in a process of their own.
+TEST(MmAsyncWriteIo, ErrorPropagation) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+  temp_file_c file{"error"};
+
+  // A regular file in place of a directory the file would be created in
+  file.create("not a directory"s);
+
+  EXPECT_EXIT({
+    auto ok = false;
+
+    {
+      mm_async_write_io_c out{file.m_name + "/file.bin"};
+
+      try {
+        mm_async_write_io_c::wait_for_pending_operations();
+      } catch (mtx::mm_io::exception &) {
+        ok = true;
+      }
+
+      // All further operations report the error, too.
+      try {
+        out.write("chunky bacon"s);
+        ok = false;
+      } catch (mtx::mm_io::exception &) {
+      }
+
+      // Closing doesn't throw.
+      out.close();
+    }
+
+    std::exit(ok ? 0 : 1);
+  }, ::testing::ExitedWithCode(0), "");
+}
+
+}
@@ -5,9 +5,26 @@
 
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
+#include "common/mm_mem_io.h"
 
 namespace {
 
+// Like stdin: seeking is silently ignored.
+class non_seekable_io_c: public mm_mem_io_c {
+public:
+  non_seekable_io_c(std::string const &content)
+    : mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.c_str()), content.size()}
+  {
+  }
+
+  virtual void setFilePointer(int64, libebml::seek_mode) override {
+  }
+
+  virtual bool is_seekable() override {
+    return false;
+  }
+};
+
 TEST(MmIo, Slurp) {
   memory_cptr m;
 
@@ -17,4 +34,30 @@ TEST(MmIo, Slurp) {
   ASSERT_THROW(mm_file_io_c::slurp("doesnotexist"), mtx::mm_io::exception);
 }
 
+TEST(MmIo, Getline) {
+  std::string content = "first\r\nsecond\n\nthird line that is longer than the maximum\nlast";
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(content.c_str()), content.size()};
+
+  EXPECT_EQ("first"s,      in.getline());
+  EXPECT_EQ(7u,            in.getFilePointer());
+  EXPECT_EQ("second"s,     in.getline());
+  EXPECT_EQ(""s,           in.getline());
+  EXPECT_EQ("third line"s, in.getline(10));
+  EXPECT_EQ(" that is longer than the maximum"s, in.getline());
+  EXPECT_EQ("last"s,       in.getline());
+  EXPECT_THROW(in.getline(), mtx::mm_io::end_of_file_x);
+}
+
+TEST(MmIo, GetlineNonSeekable) {
+  std::string content = "first\r\nsecond\n\nthird line\nlast";
+  non_seekable_io_c in{content};
+
+  EXPECT_EQ("first"s,      in.getline());
+  EXPECT_EQ("second"s,     in.getline());
+  EXPECT_EQ(""s,           in.getline());
+  EXPECT_EQ("third"s,      in.getline(5));
+  EXPECT_EQ(" line"s,      in.getline());
+  EXPECT_EQ("last"s,       in.getline());
+}
+
 }
@@ -55,4 +55,98 @@ TEST(MmTextIo, BomUtf32Be) {
   EXPECT_EQ("world"s, in.getline());
 }
 
+std::vector<std::string>
+read_all_lines(std::string const &content) {
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(content.c_str()), content.size())};
+  std::vector<std::string> lines;
+  std::string line;
+
+  while (in.getline2(line))
+    lines.push_back(line);
+
+  return lines;
+}
+
+TEST(MmTextIo, EolStyles) {
+  EXPECT_EQ((std::vector<std::string>{ "a", "b", "c" }),      read_all_lines("a\nb\nc"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "b", "c" }),      read_all_lines("a\nb\nc\n"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "", "b" }),       read_all_lines("a\r\n\r\nb"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "b" }),           read_all_lines("a\r\r\nb"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "", "b" }),       read_all_lines("a\r\rb\r"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "b\nc" }),        read_all_lines("a\rb\nc"));
+  EXPECT_EQ((std::vector<std::string>{ "a", "b", "c" }),      read_all_lines("a\nb\rc"));
+}
+
+TEST(MmTextIo, LinesSpanningBlocks) {
+  std::string content, expected_line;
+
+  for (auto idx = 0; idx < 30000; ++idx)
+    expected_line += "x\xc3\xa4y\xe2\x82\xac";
+
+  content = "\xef\xbb\xbf"s + expected_line + "\r\n"s + expected_line + "\r\nend"s;
+
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(content.c_str()), content.size())};
+
+  EXPECT_EQ(expected_line, in.getline());
+  EXPECT_EQ(expected_line, in.getline());
+  EXPECT_EQ("end"s,        in.getline());
+  EXPECT_TRUE(in.eof());
+  EXPECT_THROW(in.getline(), mtx::mm_io::end_of_file_x);
+}
+
+TEST(MmTextIo, MaxChars) {
+  std::string content = "\xef\xbb\xbf" "0123456789\xc3\xa4\xc3\xb6\xc3\xbc" "abc\nxyz";
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(content.c_str()), content.size())};
+
+  EXPECT_EQ("012"s,                   in.getline(3));
+  EXPECT_EQ("3456789\xc3\xa4\xc3\xb6"s, in.getline(9));
+  EXPECT_EQ("\xc3\xbc" "abc"s,        in.getline());
+  EXPECT_EQ("xyz"s,                   in.getline(100));
+}
+
+TEST(MmTextIo, Utf16WithNonAscii) {
+  unsigned char const text[] = { 0xff, 0xfe, 'a', 0, 0xe4, 0, 0xac, 0x20, '\r', 0, '\n', 0, 'b', 0 };
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(text, sizeof(text))};
+
+  EXPECT_EQ("a\xc3\xa4\xe2\x82\xac"s, in.getline());
+  EXPECT_EQ("b"s,                     in.getline());
+}
+
+TEST(MmTextIo, InvalidUtf8) {
+  std::string content = "\xef\xbb\xbf" "abc\xff" "def";
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(content.c_str()), content.size())};
+
+  EXPECT_THROW(in.getline(), mtx::mm_io::text::invalid_utf8_char_x);
+}
+
+TEST(MmTextIo, PositionsAndMixedReads) {
+  std::string content = "first line\nsecond line\nthird line\n";
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(content.c_str()), content.size())};
+
+  EXPECT_EQ("first line"s, in.getline());
+  EXPECT_EQ(11u,           in.getFilePointer());
+
+  char buffer[6];
+  ASSERT_EQ(6u, in.read(buffer, 6));
+  EXPECT_EQ("second"s, std::string(buffer, 6));
+  EXPECT_EQ(17u,       in.getFilePointer());
+
+  EXPECT_EQ(" line"s,     in.getline());
+  EXPECT_EQ("third line"s, in.getline());
+
+  in.setFilePointer(-5, libebml::seek_current);
+  EXPECT_EQ("line"s,       in.getline());
+
+  in.setFilePointer(0);
+  EXPECT_EQ("first line"s, in.getline());
+
+  in.save_pos(23);
+  EXPECT_EQ("third line"s, in.getline());
+  in.restore_pos();
+  EXPECT_EQ("second line"s, in.getline());
+
+  EXPECT_EQ(static_cast<int64_t>(content.size()), in.get_size());
+  EXPECT_EQ("third line"s, in.getline());
+}
+
 }
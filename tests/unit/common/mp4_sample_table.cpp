@@ -0,0 +1,157 @@
+#include "common/common_pch.h"
+
+#include "common/mp4_sample_table.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Expands the tables into one entry per sample the way the MP4 reader
+// used to; used as the reference.
+std::vector<mtx::mp4::sample_t>
+expand(std::vector<qt_chunk_t> const &chunks,
+       std::vector<uint32_t> const &sample_sizes,
+       uint32_t uniform_sample_size,
+       std::vector<qt_durmap_t> const &durations,
+       std::vector<qt_frame_offset_t> const &frame_offsets) {
+  std::vector<mtx::mp4::sample_t> samples;
+
+  if (sample_sizes.empty()) {
+    for (auto const &chunk : chunks)
+      for (auto idx = 0u; idx < chunk.size; ++idx)
+        samples.push_back({ 0, uniform_sample_size, 0, 0, 0 });
+
+  } else
+    for (auto size : sample_sizes)
+      samples.push_back({ 0, size, 0, 0, 0 });
+
+  auto s   = 0u;
+  auto pts = int64_t{};
+
+  for (auto const &duration : durations)
+    for (auto idx = 0u; (idx < duration.number) && (s < samples.size()); ++idx, ++s) {
+      samples[s].decoding_time  = pts;
+      samples[s].duration       = duration.duration;
+      pts                      += duration.duration;
+    }
+
+  samples.resize(s);
+
+  s = 0;
+  for (auto const &chunk : chunks) {
+    auto pos = chunk.pos;
+
+    for (auto idx = 0u; (idx < chunk.size) && (s < samples.size()); ++idx, ++s) {
+      samples[s].position  = pos;
+      pos                 += samples[s].size;
+    }
+  }
+
+  s = 0;
+  for (auto const &frame_offset : frame_offsets)
+    for (auto idx = 0u; (idx < frame_offset.count) && (s < samples.size()); ++idx, ++s)
+      samples[s].composition_offset = frame_offset.offset;
+
+  return samples;
+}
+
+void
+compare(std::vector<qt_chunk_t> const &chunks,
+        std::vector<uint32_t> const &sample_sizes,
+        uint32_t uniform_sample_size,
+        std::vector<qt_durmap_t> const &durations,
+        std::vector<qt_frame_offset_t> const &frame_offsets) {
+  auto expected = expand(chunks, sample_sizes, uniform_sample_size, durations, frame_offsets);
+  mtx::mp4::sample_cursor_c cursor{chunks, sample_sizes, uniform_sample_size, durations, frame_offsets};
+  mtx::mp4::sample_t sample;
+
+  ASSERT_EQ(expected.size(), cursor.get_num_samples());
+
+  for (auto idx = 0u; idx < expected.size(); ++idx) {
+    ASSERT_TRUE(cursor.get_next(sample));
+
+    EXPECT_EQ(expected[idx].position,           sample.position)           << "sample " << idx;
+    EXPECT_EQ(expected[idx].size,               sample.size)               << "sample " << idx;
+    EXPECT_EQ(expected[idx].duration,           sample.duration)           << "sample " << idx;
+    EXPECT_EQ(expected[idx].decoding_time,      sample.decoding_time)      << "sample " << idx;
+    EXPECT_EQ(expected[idx].composition_offset, sample.composition_offset) << "sample " << idx;
+  }
+
+  EXPECT_FALSE(cursor.get_next(sample));
+}
+
+TEST(Mp4SampleTable, VariableSampleSizes) {
+  std::vector<qt_chunk_t> chunks{ { 3, 1000 }, { 0, 2000 }, { 2, 3000 }, { 4, 5000 } };
+  std::vector<uint32_t> sizes{ 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+  std::vector<qt_durmap_t> durations{ { 4, 1001 }, { 0, 500 }, { 5, 2002 } };
+  std::vector<qt_frame_offset_t> frame_offsets{ { 1, 2002 }, { 2, -1001 }, { 0, 7 }, { 3, 0 }, { 3, 4004 } };
+
+  compare(chunks, sizes, 0, durations, frame_offsets);
+
+  mtx::mp4::sample_cursor_c cursor{chunks, sizes, 0, durations, frame_offsets};
+  mtx::mp4::sample_t sample;
+
+  for (auto idx = 0; idx < 4; ++idx)
+    cursor.get_next(sample);
+
+  EXPECT_EQ(3000u,       sample.position);
+  EXPECT_EQ(40u,         sample.size);
+  EXPECT_EQ(3 * 1001,    sample.decoding_time);
+  EXPECT_EQ(0,           sample.composition_offset);
+}
+
+TEST(Mp4SampleTable, UniformSampleSize) {
+  std::vector<qt_chunk_t> chunks{ { 5, 100 }, { 5, 1000 }, { 1, 2000 } };
+  std::vector<uint32_t> no_sizes;
+  std::vector<qt_durmap_t> durations{ { 11, 1024 } };
+  std::vector<qt_frame_offset_t> no_frame_offsets;
+
+  compare(chunks, no_sizes, 4, durations, no_frame_offsets);
+
+  mtx::mp4::sample_cursor_c cursor{chunks, no_sizes, 4, durations, no_frame_offsets};
+  EXPECT_EQ(11u, cursor.get_num_samples());
+}
+
+TEST(Mp4SampleTable, TablesOfDifferentLengths) {
+  // Fewer durations than sizes: the excessive samples are dropped.
+  compare({ { 4, 0 } }, { 1, 2, 3, 4 }, 0, { { 2, 10 } }, { { 4, 1 } });
+
+  // Fewer chunks than samples: the remaining samples are reported at
+  // position 0.
+  compare({ { 2, 100 } }, { 1, 2, 3, 4 }, 0, { { 4, 10 } }, {});
+
+  // No durations at all.
+  compare({ { 2, 100 } }, { 1, 2 }, 0, {}, {});
+
+  std::vector<qt_chunk_t> chunks{ { 4, 0 } };
+  std::vector<uint32_t> sizes{ 1, 2, 3, 4 };
+  std::vector<qt_durmap_t> durations{ { 2, 10 } };
+  std::vector<qt_frame_offset_t> no_frame_offsets;
+
+  mtx::mp4::sample_cursor_c cursor{chunks, sizes, 0, durations, no_frame_offsets};
+  EXPECT_EQ(2u, cursor.get_num_samples());
+  EXPECT_EQ(4u, cursor.get_num_samples_in_size_table());
+  EXPECT_EQ(2u, cursor.get_num_samples_in_duration_table());
+}
+
+TEST(Mp4SampleTable, OneChunkPerSample) {
+  // Layout created from fragments ('trun' atoms)
+  std::vector<qt_chunk_t> chunks;
+  std::vector<uint32_t> sizes;
+  std::vector<qt_durmap_t> durations;
+  std::vector<qt_frame_offset_t> frame_offsets;
+  auto position = uint64_t{4711};
+
+  for (auto idx = 0u; idx < 100; ++idx) {
+    sizes.push_back(100 + idx * 3);
+    chunks.emplace_back(1, position);
+    durations.emplace_back(1, 1000 + (idx % 3));
+    frame_offsets.emplace_back(1, static_cast<int64_t>(idx % 4) * 1000 - 1000);
+
+    position += sizes.back() + (idx % 2 ? 8 : 0);
+  }
+
+  compare(chunks, sizes, 0, durations, frame_offsets);
+}
+
+}
@@ -0,0 +1,120 @@
+#include "common/common_pch.h"
+
+#include <random>
+
+#include "common/endian.h"
+#include "common/mpeg.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+mem(std::vector<unsigned char> const &bytes) {
+  return memory_c::clone(bytes.data(), bytes.size());
+}
+
+std::vector<unsigned char>
+vec(memory_cptr const &buffer) {
+  return std::vector<unsigned char>(buffer->get_buffer(), buffer->get_buffer() + buffer->get_size());
+}
+
+// Straight-forward byte-by-byte implementations used as references.
+std::vector<unsigned char>
+reference_nalu_to_rbsp(std::vector<unsigned char> const &b) {
+  std::vector<unsigned char> d;
+
+  for (std::size_t pos = 0, size = b.size(); pos < size; ++pos) {
+    if (((pos + 2) < size) && !b[pos] && !b[pos + 1] && (3 == b[pos + 2])) {
+      d.push_back(0);
+      d.push_back(0);
+      pos += 2;
+    } else
+      d.push_back(b[pos]);
+  }
+
+  return d;
+}
+
+std::vector<unsigned char>
+reference_rbsp_to_nalu(std::vector<unsigned char> const &b) {
+  std::vector<unsigned char> d;
+
+  for (std::size_t pos = 0, size = b.size(); pos < size; ++pos) {
+    if (((pos + 2) < size) && !b[pos] && !b[pos + 1] && (3 >= b[pos + 2])) {
+      d.push_back(0);
+      d.push_back(0);
+      d.push_back(3);
+      ++pos;
+    } else
+      d.push_back(b[pos]);
+  }
+
+  return d;
+}
+
+TEST(Mpeg, NaluToRbsp) {
+  EXPECT_EQ((std::vector<unsigned char>{ }),                                  vec(mtx::mpeg::nalu_to_rbsp(mem({ }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0 }),                             vec(mtx::mpeg::nalu_to_rbsp(mem({ 0, 0, 3 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0x65, 0, 0, 1, 0x42 }),              vec(mtx::mpeg::nalu_to_rbsp(mem({ 0x65, 0, 0, 3, 1, 0x42 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 0, 0, 2 }),                    vec(mtx::mpeg::nalu_to_rbsp(mem({ 0, 0, 3, 0, 0, 3, 2 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0 }),  vec(mtx::mpeg::nalu_to_rbsp(mem({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 3 }))));
+
+  auto unchanged = mem({ 1, 0, 2, 0, 0, 4, 0, 0 });
+  EXPECT_EQ(unchanged.get(), mtx::mpeg::nalu_to_rbsp(unchanged).get());
+}
+
+TEST(Mpeg, RbspToNalu) {
+  EXPECT_EQ((std::vector<unsigned char>{ }),                            vec(mtx::mpeg::rbsp_to_nalu(mem({ }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0 }),                       vec(mtx::mpeg::rbsp_to_nalu(mem({ 0, 0 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 3, 1 }),                 vec(mtx::mpeg::rbsp_to_nalu(mem({ 0, 0, 1 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 3, 0, 0, 3, 0 }),        vec(mtx::mpeg::rbsp_to_nalu(mem({ 0, 0, 0, 0, 0 }))));
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 4 }),                    vec(mtx::mpeg::rbsp_to_nalu(mem({ 0, 0, 4 }))));
+}
+
+TEST(Mpeg, ConversionsMatchReference) {
+  std::mt19937 generator{42};
+
+  for (auto round = 0; round < 2000; ++round) {
+    // Lots of zeros & small values in order to trigger many matches.
+    auto size      = generator() % 200;
+    auto max_value = round % 2 ? 5 : 256;
+    std::vector<unsigned char> data(size);
+
+    for (auto &byte : data)
+      byte = generator() % 3 ? 0 : generator() % max_value;
+
+    EXPECT_EQ(reference_nalu_to_rbsp(data), vec(mtx::mpeg::nalu_to_rbsp(mem(data))));
+    EXPECT_EQ(reference_rbsp_to_nalu(data), vec(mtx::mpeg::rbsp_to_nalu(mem(data))));
+    EXPECT_EQ(data,                         vec(mtx::mpeg::nalu_to_rbsp(mtx::mpeg::rbsp_to_nalu(mem(data)))));
+  }
+}
+
+TEST(Mpeg, ChangeNaluSizeLengthInPlace) {
+  auto data = mem({ 0, 0, 0, 2, 0x65, 0x01, 0, 0, 0, 0, 0, 0, 0, 3, 0x41, 0x02, 0x03, 0, 0 });
+
+  mtx::mpeg::change_nalu_size_length_in_place(*data, 4, 2);
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 2, 0x65, 0x01, 0, 0, 0, 3, 0x41, 0x02, 0x03 }), vec(data));
+
+  mtx::mpeg::change_nalu_size_length_in_place(*data, 2, 1);
+  EXPECT_EQ((std::vector<unsigned char>{ 2, 0x65, 0x01, 0, 3, 0x41, 0x02, 0x03 }), vec(data));
+
+  auto too_big = memory_c::alloc(2 + 300);
+  std::memset(too_big->get_buffer(), 0, too_big->get_size());
+  put_uint16_be(too_big->get_buffer(), 300);
+
+  EXPECT_THROW(mtx::mpeg::change_nalu_size_length_in_place(*too_big, 2, 1), mtx::mpeg::nalu_size_length_x);
+}
+
+TEST(Mpeg, ChangeNaluSizeLengthCopy) {
+  // The last NALU's size field claims more bytes than are present.
+  auto data   = mem({ 2, 0x65, 0x01, 0, 5, 0x41, 0x02 });
+  auto result = mtx::mpeg::change_nalu_size_length_copy(*data, 1, 4);
+
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 0, 2, 0x65, 0x01, 0, 0, 0, 0, 0, 0, 0, 2, 0x41, 0x02 }), vec(result));
+
+  result = mtx::mpeg::change_nalu_size_length_copy(*mem({ 0, 1, 0x09, 0 }), 2, 3);
+  EXPECT_EQ((std::vector<unsigned char>{ 0, 0, 1, 0x09 }), vec(result));
+}
+
+}
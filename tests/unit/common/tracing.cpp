@@ -0,0 +1,60 @@
+#include "common/common_pch.h"
+
+#include "common/tracing.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Tracing, DisabledByDefault) {
+  debugging_c::request("tracing", false);
+
+  auto &stage = mtx::tracing::get_stage("test: disabled");
+
+  {
+    mtx::tracing::scope_c scope{stage};
+    scope.add_bytes(123);
+    scope.add_packets();
+  }
+
+  EXPECT_FALSE(mtx::tracing::is_enabled());
+  EXPECT_EQ(0, stage.m_num_calls);
+  EXPECT_EQ(0, stage.m_num_bytes);
+  EXPECT_EQ(0, stage.m_num_packets);
+}
+
+TEST(Tracing, CountersAndNesting) {
+  debugging_c::request("tracing");
+
+  auto &outer = mtx::tracing::get_stage("test: outer");
+  auto &inner = mtx::tracing::get_stage("test: inner");
+
+  EXPECT_EQ(&outer, &mtx::tracing::get_stage("test: outer"));
+
+  for (auto idx = 0; idx < 3; ++idx) {
+    mtx::tracing::scope_c outer_scope{outer};
+    outer_scope.add_packets(2);
+
+    mtx::tracing::scope_c inner_scope{inner};
+    inner_scope.add_bytes(100);
+  }
+
+  {
+    mtx::tracing::scope_c null_scope{static_cast<mtx::tracing::stage_c *>(nullptr)};
+    null_scope.add_bytes(1);
+  }
+
+  EXPECT_EQ(3, outer.m_num_calls);
+  EXPECT_EQ(6, outer.m_num_packets);
+  EXPECT_EQ(0, outer.m_num_bytes);
+  EXPECT_EQ(3, inner.m_num_calls);
+  EXPECT_EQ(300, inner.m_num_bytes);
+
+  EXPECT_EQ(inner.m_total_ns, inner.m_self_ns);
+  EXPECT_LE(outer.m_self_ns, outer.m_total_ns);
+  EXPECT_EQ(outer.m_total_ns - inner.m_total_ns, outer.m_self_ns);
+
+  debugging_c::request("tracing", false);
+}
+
+}
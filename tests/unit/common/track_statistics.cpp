@@ -0,0 +1,110 @@
+#include "common/common_pch.h"
+
+#include "common/track_statistics.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+int64_t const s_frame_duration = 40000000ll;
+
+detailed_track_statistics_c
+create_statistics() {
+  detailed_track_statistics_c statistics;
+
+  // 100 frames of 40ms each; every 12th frame is a key frame with
+  // 20000 bytes, all others have 1000 bytes.
+  for (auto idx = 0; idx < 100; ++idx)
+    statistics.account(idx * s_frame_duration, s_frame_duration, idx % 12 ? 1000 : 20000, !(idx % 12));
+
+  return statistics;
+}
+
+TEST(DetailedTrackStatistics, Totals) {
+  auto json = create_statistics().to_json();
+
+  EXPECT_EQ(100u,         json["num_frames"].get<uint64_t>());
+  EXPECT_EQ(271000u,      json["num_bytes"].get<uint64_t>());
+  EXPECT_EQ(4000000000ll, json["duration"].get<int64_t>());
+  EXPECT_EQ(542000u,      json["average_bits_per_second"].get<uint64_t>());
+}
+
+TEST(DetailedTrackStatistics, BitsPerSecond) {
+  auto json = create_statistics().to_json();
+
+  ASSERT_EQ(4u, json["bits_per_second"].size());
+  EXPECT_EQ(0u,      json["bits_per_second"][0]["second"].get<uint64_t>());
+  EXPECT_EQ(656000u, json["bits_per_second"][0]["bits"].get<uint64_t>());
+  EXPECT_EQ(504000u, json["bits_per_second"][1]["bits"].get<uint64_t>());
+  EXPECT_EQ(3u,      json["bits_per_second"][3]["second"].get<uint64_t>());
+  EXPECT_EQ(504000u, json["bits_per_second"][3]["bits"].get<uint64_t>());
+}
+
+TEST(DetailedTrackStatistics, BitsPerSecondWithGaps) {
+  detailed_track_statistics_c statistics;
+
+  // A jump of about a month & a frame out of order
+  statistics.account(0,                       s_frame_duration, 1000, true);
+  statistics.account(2'592'000'000'000'000ll, s_frame_duration, 2000, false);
+  statistics.account(-s_frame_duration,       s_frame_duration, 3000, false);
+
+  auto json = statistics.to_json()["bits_per_second"];
+
+  ASSERT_EQ(2u, json.size());
+  EXPECT_EQ(0u,          json[0]["second"].get<uint64_t>());
+  EXPECT_EQ(32000u,      json[0]["bits"].get<uint64_t>());
+  EXPECT_EQ(2'592'000u,  json[1]["second"].get<uint64_t>());
+  EXPECT_EQ(16000u,      json[1]["bits"].get<uint64_t>());
+}
+
+TEST(DetailedTrackStatistics, PeakBitrates) {
+  auto json = create_statistics().to_json();
+
+  ASSERT_EQ(2u, json["peak_bits_per_second"].size());
+  EXPECT_EQ(1000000000ll, json["peak_bits_per_second"][0]["window_length"].get<int64_t>());
+  EXPECT_EQ(656000u,      json["peak_bits_per_second"][0]["bits_per_second"].get<uint64_t>());
+  EXPECT_EQ(0,            json["peak_bits_per_second"][0]["start_timestamp"].get<int64_t>());
+}
+
+TEST(DetailedTrackStatistics, KeyFrames) {
+  auto json = create_statistics().to_json()["key_frames"];
+
+  EXPECT_EQ(9u,          json["count"].get<uint64_t>());
+  EXPECT_EQ(480000000ll, json["min_interval"].get<int64_t>());
+  EXPECT_EQ(480000000ll, json["max_interval"].get<int64_t>());
+  EXPECT_EQ(480000000ll, json["average_interval"].get<int64_t>());
+
+  ASSERT_EQ(1u,  json["distances"].size());
+  EXPECT_EQ(12u, json["distances"][0]["frames"].get<uint64_t>());
+  EXPECT_EQ(8u,  json["distances"][0]["count"].get<uint64_t>());
+}
+
+TEST(DetailedTrackStatistics, BlockSizes) {
+  detailed_track_statistics_c statistics;
+
+  statistics.account(0, 0, 0,    true);
+  statistics.account(0, 0, 1,    true);
+  statistics.account(0, 0, 1000, true);
+  statistics.account(0, 0, 1023, true);
+  statistics.account(0, 0, 1024, true);
+
+  auto json = statistics.to_json()["block_sizes"];
+
+  ASSERT_EQ(4u, json.size());
+
+  EXPECT_EQ(0u,    json[0]["min_size"].get<uint64_t>());
+  EXPECT_EQ(0u,    json[0]["max_size"].get<uint64_t>());
+  EXPECT_EQ(1u,    json[0]["count"].get<uint64_t>());
+
+  EXPECT_EQ(1u,    json[1]["min_size"].get<uint64_t>());
+  EXPECT_EQ(1u,    json[1]["max_size"].get<uint64_t>());
+
+  EXPECT_EQ(512u,  json[2]["min_size"].get<uint64_t>());
+  EXPECT_EQ(1023u, json[2]["max_size"].get<uint64_t>());
+  EXPECT_EQ(2u,    json[2]["count"].get<uint64_t>());
+
+  EXPECT_EQ(1024u, json[3]["min_size"].get<uint64_t>());
+  EXPECT_EQ(2047u, json[3]["max_size"].get<uint64_t>());
+}
+
+}
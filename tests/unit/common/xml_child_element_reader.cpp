@@ -0,0 +1,107 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+
+#include "common/mm_mem_io.h"
+#include "common/xml/child_element_reader.h"
+
+namespace {
+
+using result_e = mtx::xml::child_element_reader_c::result_e;
+
+std::vector<std::string>
+split(std::string const &text,
+      std::size_t block_size,
+      result_e expected_end = result_e::end_of_root) {
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(text.c_str()), text.size()};
+  mtx::xml::child_element_reader_c reader{in, block_size};
+  std::vector<std::string> elements;
+  std::string element;
+
+  if (reader.read_root(element) != result_e::element)
+    return { "unsupported" };
+
+  elements.push_back(element);
+
+  auto result = reader.read_next(element);
+  while (result == result_e::element) {
+    elements.push_back(element);
+    result = reader.read_next(element);
+  }
+
+  EXPECT_EQ(expected_end, result);
+
+  return elements;
+}
+
+TEST(XmlChildElementReader, Splitting) {
+  auto text = "\xef\xbb\xbf<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+              "<!-- <Tags> -->\n"
+              "<!DOCTYPE Tags SYSTEM \"matroskatags.dtd\">\n"
+              "<Tags attribute=\"a > b\">\n"
+              "  <Tag>\n"
+              "    <Simple><Name>a&gt;b</Name><String><![CDATA[</Tag>]]></String></Simple>\n"
+              "  </Tag>\n"
+              "  <!-- <Tag> -->\n"
+              "  <?pi </Tag> ?>\n"
+              "  <Tag attribute='/>'/>\n"
+              "  <Tag><Tag/><Tag></Tag></Tag>\n"
+              "</Tags>\n"
+              "<!-- the end -->\n"s;
+
+  std::vector<std::string> expected{
+    "<Tags attribute=\"a > b\"/>",
+    "<Tag>\n"
+    "    <Simple><Name>a&gt;b</Name><String><![CDATA[</Tag>]]></String></Simple>\n"
+    "  </Tag>",
+    "<Tag attribute='/>'/>",
+    "<Tag><Tag/><Tag></Tag></Tag>",
+  };
+
+  for (auto block_size : std::vector<std::size_t>{ 1, 2, 3, 7, 64, 1024 * 1024 })
+    EXPECT_EQ(expected, split(text, block_size)) << "block size " << block_size;
+}
+
+TEST(XmlChildElementReader, EmptyRoot) {
+  EXPECT_EQ(std::vector<std::string>{ "<Chapters/>" },  split("<Chapters/>", 4));
+  EXPECT_EQ(std::vector<std::string>{ "<Chapters />" }, split("  <Chapters />\n\n", 4));
+  EXPECT_EQ(std::vector<std::string>{ "<Chapters/>" },  split("<Chapters>\n</Chapters >", 4));
+}
+
+TEST(XmlChildElementReader, RootName) {
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>("<Tags\n/>"), 8};
+  mtx::xml::child_element_reader_c reader{in};
+  std::string element;
+
+  EXPECT_EQ(result_e::element, reader.read_root(element));
+  EXPECT_EQ("Tags"s,           reader.get_root_name());
+}
+
+TEST(XmlChildElementReader, Unsupported) {
+  std::vector<std::string> unsupported{ "unsupported" };
+
+  // Other encodings
+  EXPECT_EQ(unsupported, split("<?xml version=\"1.0\" encoding=\"ISO-8859-15\"?><Tags/>", 5));
+  EXPECT_EQ(unsupported, split("<?xml version='1.0' encoding='latin1'?><Tags/>", 5));
+  EXPECT_EQ(unsupported, split("\xff\xfe<\0T\0a\0g\0s\0/\0>\0"s, 5));
+
+  // The byte order mark takes precedence over the declaration.
+  EXPECT_EQ(std::vector<std::string>{ "<Tags/>" }, split("\xef\xbb\xbf<?xml version='1.0' encoding='latin1'?><Tags/>", 5));
+
+  // Internal DTD subsets may declare entities.
+  EXPECT_EQ(unsupported, split("<!DOCTYPE Tags [ <!ENTITY a \"b\"> ]><Tags>&a;</Tags>", 5));
+
+  // No root element
+  EXPECT_EQ(unsupported, split("", 5));
+  EXPECT_EQ(unsupported, split("<!-- nothing -->", 5));
+  EXPECT_EQ(unsupported, split("text", 5));
+
+  // Malformed documents
+  EXPECT_EQ((std::vector<std::string>{ "<Tags/>", "<Tag/>" }), split("<Tags><Tag/></Chapters>",         5, result_e::unsupported));
+  EXPECT_EQ((std::vector<std::string>{ "<Tags/>", "<Tag/>" }), split("<Tags><Tag/>",                     5, result_e::unsupported));
+  EXPECT_EQ((std::vector<std::string>{ "<Tags/>" }),           split("<Tags><Tag><Simple></Tag>",        5, result_e::unsupported));
+  EXPECT_EQ((std::vector<std::string>{ "<Tags/>", "<Tag/>" }), split("<Tags><Tag/></Tags><Chapters/>",   5, result_e::unsupported));
+  EXPECT_EQ((std::vector<std::string>{ "<Tags/>" }),           split("<Tags><!-- unterminated </Tags>", 5, result_e::unsupported));
+}
+
+}
@@ -0,0 +1,113 @@
+#include "common/common_pch.h"
+
+#include "input/chunk_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+create_block(std::size_t size,
+             unsigned char first_value) {
+  auto block = memory_c::alloc(size);
+
+  for (auto idx = 0u; idx < size; ++idx)
+    block->get_buffer()[idx] = first_value + idx;
+
+  return block;
+}
+
+TEST(ChunkCache, HitsAndMisses) {
+  chunk_cache_c cache{1000};
+  unsigned char buffer[10];
+
+  EXPECT_FALSE(cache.get(100, buffer, 1));
+
+  cache.add(100, create_block(100, 0));
+
+  // Ranges entirely within the block
+  ASSERT_TRUE(cache.get(100, buffer, 10));
+  EXPECT_EQ(0, buffer[0]);
+  EXPECT_EQ(9, buffer[9]);
+
+  ASSERT_TRUE(cache.get(190, buffer, 10));
+  EXPECT_EQ(90, buffer[0]);
+  EXPECT_EQ(99, buffer[9]);
+
+  // Ranges overlapping the block only partially or not at all
+  EXPECT_FALSE(cache.get(95,  buffer, 10));
+  EXPECT_FALSE(cache.get(191, buffer, 10));
+  EXPECT_FALSE(cache.get(200, buffer, 1));
+  EXPECT_FALSE(cache.get(0,   buffer, 10));
+
+  EXPECT_EQ(2u, cache.get_num_hits());
+  EXPECT_EQ(5u, cache.get_num_misses());
+}
+
+TEST(ChunkCache, RangesAcrossBlocks) {
+  chunk_cache_c cache{1000};
+  unsigned char buffer[10];
+
+  cache.add(0,  create_block(10, 0));
+  cache.add(10, create_block(10, 10));
+
+  // Each range must be contained in a single block.
+  EXPECT_TRUE(cache.get(0,  buffer, 10));
+  EXPECT_TRUE(cache.get(10, buffer, 10));
+  EXPECT_FALSE(cache.get(5, buffer, 10));
+
+  // Overlapping blocks: any block containing the whole range is used.
+  cache.add(5, create_block(10, 5));
+
+  ASSERT_TRUE(cache.get(5, buffer, 10));
+  EXPECT_EQ(5,  buffer[0]);
+  EXPECT_EQ(14, buffer[9]);
+}
+
+TEST(ChunkCache, LeastRecentlyUsedBlocksAreEvicted) {
+  chunk_cache_c cache{300};
+  unsigned char buffer[1];
+
+  cache.add(0,   create_block(100, 0));
+  cache.add(100, create_block(100, 0));
+  cache.add(200, create_block(100, 0));
+
+  // Use the first block so that the second one is the least recently
+  // used one.
+  EXPECT_TRUE(cache.get(0, buffer, 1));
+
+  cache.add(300, create_block(100, 0));
+
+  EXPECT_TRUE(cache.get(0,    buffer, 1));
+  EXPECT_FALSE(cache.get(100, buffer, 1));
+  EXPECT_TRUE(cache.get(200,  buffer, 1));
+  EXPECT_TRUE(cache.get(300,  buffer, 1));
+
+  // Adding a large block evicts as many blocks as necessary.
+  cache.add(400, create_block(200, 0));
+
+  EXPECT_FALSE(cache.get(0,   buffer, 1));
+  EXPECT_FALSE(cache.get(200, buffer, 1));
+  EXPECT_TRUE(cache.get(300,  buffer, 1));
+  EXPECT_TRUE(cache.get(400,  buffer, 1));
+}
+
+TEST(ChunkCache, BlocksLargerThanTheCache) {
+  chunk_cache_c cache{100};
+  unsigned char buffer[1];
+
+  cache.add(0,    create_block(50, 0));
+  cache.add(1000, create_block(200, 0));
+
+  // The block is kept anyway, but everything else is evicted.
+  EXPECT_FALSE(cache.get(0,   buffer, 1));
+  EXPECT_TRUE(cache.get(1100, buffer, 1));
+
+  // The next block replaces it.
+  cache.add(2000, create_block(10, 0));
+
+  EXPECT_FALSE(cache.get(1100, buffer, 1));
+  EXPECT_TRUE(cache.get(2000,  buffer, 1));
+}
+
+}
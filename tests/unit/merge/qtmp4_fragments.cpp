@@ -0,0 +1,228 @@
+#include "common/common_pch.h"
+
+#include "common/endian.h"
+#include "common/mm_mem_io.h"
+#include "input/qtmp4_atoms.h"
+#include "input/r_qtmp4.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+unsigned int const SAMPLE_SIZE = 4;
+
+// Fragmented files with two PCM tracks using a time scale of 1000. Each
+// fragment contains one run per track with explicit sample durations &
+// sizes.
+class fragmented_mp4_generator_c {
+public:
+  using durations_t = std::vector<uint32_t>;
+
+  std::string
+  generate(std::vector<std::pair<durations_t, durations_t>> const &fragments) {
+    auto data = atom("ftyp", "isom"s + be32(0) + "isom"s) + moov();
+
+    for (auto const &fragment : fragments) {
+      auto mdat_content = std::string{};
+      auto runs         = std::vector<std::pair<durations_t, std::size_t>>{};
+
+      for (auto const &durations : std::vector<durations_t>{ fragment.first, fragment.second }) {
+        runs.emplace_back(durations, mdat_content.size());
+        mdat_content += std::string(durations.size() * SAMPLE_SIZE, 'x');
+      }
+
+      // The data offsets are relative to the start of the 'moof' atom
+      // & therefore depend on its size.
+      auto moof_size = moof(runs, 0).size();
+
+      data += moof(runs, moof_size + 8) + atom("mdat", mdat_content);
+    }
+
+    return data;
+  }
+
+protected:
+  static std::string
+  be32(uint32_t value) {
+    auto s = std::string(4, '\0');
+    put_uint32_be(&s[0], value);
+    return s;
+  }
+
+  template<typename T>
+  static std::string
+  raw(T const &structure) {
+    return std::string(reinterpret_cast<char const *>(&structure), sizeof(T));
+  }
+
+  static std::string
+  atom(std::string const &fourcc,
+       std::string const &content) {
+    return be32(content.size() + 8) + fourcc + content;
+  }
+
+  static std::string
+  moov() {
+    mvhd_atom_t mvhd{};
+    put_uint32_be(&mvhd.time_scale, 1000);
+
+    auto content = atom("mvhd", raw(mvhd));
+    auto mvex    = std::string{};
+
+    for (auto track_id = 1u; track_id <= 2; ++track_id) {
+      content += atom("trak", tkhd(track_id) + atom("mdia", mdhd() + hdlr() + atom("minf", atom("stbl", stbl()))));
+      mvex    += atom("trex", be32(0) + be32(track_id) + be32(1) + be32(0) + be32(0) + be32(0));
+    }
+
+    return atom("moov", content + atom("mvex", mvex));
+  }
+
+  static std::string
+  tkhd(uint32_t track_id) {
+    tkhd_atom_t tkhd{};
+    put_uint32_be(&tkhd.track_id, track_id);
+
+    return atom("tkhd", raw(tkhd));
+  }
+
+  static std::string
+  mdhd() {
+    mdhd_atom_t mdhd{};
+    put_uint32_be(&mdhd.time_scale, 1000);
+    put_uint16_be(&mdhd.language,   0x55c4); // 'und'
+
+    return atom("mdhd", raw(mdhd));
+  }
+
+  static std::string
+  hdlr() {
+    hdlr_atom_t hdlr{};
+    std::memcpy(&hdlr.type,    "mhlr", 4);
+    std::memcpy(&hdlr.subtype, "soun", 4);
+
+    return atom("hdlr", raw(hdlr));
+  }
+
+  static std::string
+  stbl() {
+    sound_v0_stsd_atom_t sound{};
+    put_uint32_be(&sound.base.size,   sizeof(sound));
+    std::memcpy(sound.base.fourcc,    "sowt", 4);
+    put_uint16_be(&sound.channels,    2);
+    put_uint16_be(&sound.sample_size, 16);
+    put_uint32_be(&sound.sample_rate, 48000u << 16);
+
+    // Apart from the sample description the tables are empty; all
+    // samples are listed in the fragments.
+    return atom("stsd", be32(0) + be32(1) + raw(sound))
+         + atom("stts", be32(0) + be32(0))
+         + atom("stsc", be32(0) + be32(0))
+         + atom("stsz", be32(0) + be32(0) + be32(0))
+         + atom("stco", be32(0) + be32(0));
+  }
+
+  static std::string
+  moof(std::vector<std::pair<durations_t, std::size_t>> const &runs,
+       std::size_t mdat_data_offset) {
+    auto content  = atom("mfhd", be32(0) + be32(1));
+    auto track_id = 0u;
+
+    for (auto const &run : runs) {
+      auto trun = be32(QTMP4_TRUN_DATA_OFFSET | QTMP4_TRUN_SAMPLE_DURATION | QTMP4_TRUN_SAMPLE_SIZE) + be32(run.first.size()) + be32(mdat_data_offset + run.second);
+
+      for (auto duration : run.first)
+        trun += be32(duration) + be32(SAMPLE_SIZE);
+
+      content += atom("traf", atom("tfhd", be32(QTMP4_TFHD_DEFAULT_BASE_IS_MOOF) + be32(++track_id)) + atom("trun", trun));
+    }
+
+    return atom("moof", content);
+  }
+};
+
+class qtmp4_test_reader_c: public qtmp4_reader_c {
+public:
+  using qtmp4_reader_c::m_demuxers;
+  using qtmp4_reader_c::m_next_fragment_position;
+  using qtmp4_reader_c::parse_headers;
+  using qtmp4_reader_c::read_next_fragments;
+
+public:
+  qtmp4_test_reader_c(mm_io_cptr const &in)
+    : qtmp4_reader_c{track_info_c{}, in}
+  {
+  }
+};
+
+int64_t
+ms(int64_t value) {
+  return value * 1'000'000ll;
+}
+
+TEST(QtMp4Fragments, StreamingIndexesFragmentsWhileReading) {
+  auto data = memory_c::clone(fragmented_mp4_generator_c{}.generate({
+    { { 40, 40, 20 }, { 50, 50 } },
+    { { 30, 50 },     { 50, 50 } },
+    { { 20 },         { 50 }     },
+  }));
+
+  qtmp4_test_reader_c reader{std::make_shared<mm_mem_io_c>(*data)};
+  reader.parse_headers();
+
+  ASSERT_EQ(2u, reader.m_demuxers.size());
+  ASSERT_TRUE(!!reader.m_next_fragment_position);
+
+  // Only the first track is muxed.
+  auto &dmx    = *reader.m_demuxers[0];
+  auto &unused = *reader.m_demuxers[1];
+  dmx.ptzr     = 0;
+
+  // The first fragment is indexed while parsing the headers. The last
+  // sample's duration is taken from the 'trun' atom just like it is for
+  // the fragments indexed while reading.
+  ASSERT_EQ(3u, dmx.m_index.size());
+  EXPECT_EQ(ms(0),  dmx.m_index[0].timestamp);
+  EXPECT_EQ(ms(40), dmx.m_index[1].timestamp);
+  EXPECT_EQ(ms(80), dmx.m_index[2].timestamp);
+  EXPECT_EQ(ms(40), dmx.m_index[0].duration);
+  EXPECT_EQ(ms(40), dmx.m_index[1].duration);
+  EXPECT_EQ(ms(20), dmx.m_index[2].duration);
+
+  auto first_sample_pos = dmx.m_index[0].file_pos;
+  EXPECT_EQ(first_sample_pos + SAMPLE_SIZE, dmx.m_index[1].file_pos);
+
+  dmx.pos = dmx.m_index.size();
+  reader.read_next_fragments(dmx);
+
+  EXPECT_EQ(3u, dmx.m_num_dropped_index_entries);
+  EXPECT_EQ(0u, dmx.pos);
+  ASSERT_EQ(2u, dmx.m_index.size());
+  EXPECT_EQ(ms(100), dmx.m_index[0].timestamp);
+  EXPECT_EQ(ms(130), dmx.m_index[1].timestamp);
+  EXPECT_EQ(ms(30),  dmx.m_index[0].duration);
+  EXPECT_EQ(ms(50),  dmx.m_index[1].duration);
+  EXPECT_TRUE(dmx.m_index[0].is_keyframe);
+  EXPECT_EQ(dmx.m_index[0].file_pos + SAMPLE_SIZE, dmx.m_index[1].file_pos);
+  EXPECT_GT(dmx.m_index[0].file_pos, first_sample_pos);
+
+  // Nothing is kept for tracks that aren't muxed.
+  EXPECT_TRUE(unused.m_index.empty());
+  EXPECT_EQ(2u, unused.m_num_dropped_index_entries);
+
+  dmx.pos = dmx.m_index.size();
+  reader.read_next_fragments(dmx);
+
+  ASSERT_EQ(1u, dmx.m_index.size());
+  EXPECT_EQ(ms(180), dmx.m_index[0].timestamp);
+  EXPECT_EQ(ms(20),  dmx.m_index[0].duration);
+  EXPECT_TRUE(unused.m_index.empty());
+
+  // The end of the file has been reached.
+  dmx.pos = dmx.m_index.size();
+  reader.read_next_fragments(dmx);
+
+  EXPECT_TRUE(dmx.m_index.empty());
+  EXPECT_FALSE(reader.m_next_fragment_position);
+}
+
+}
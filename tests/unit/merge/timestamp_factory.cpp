@@ -0,0 +1,76 @@
+#include "common/common_pch.h"
+
+#include "common/mm_mem_io.h"
+#include "common/mm_text_io.h"
+#include "merge/packet.h"
+#include "merge/timestamp_factory.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using timestamp_and_duration_t = std::pair<int64_t, int64_t>;
+
+mm_io_cptr
+text_io(std::string const &text) {
+  return std::make_shared<mm_text_io_c>(std::make_shared<mm_mem_io_c>(reinterpret_cast<unsigned char const *>(text.c_str()), text.length()));
+}
+
+timestamp_and_duration_t
+next(timestamp_factory_c &factory) {
+  auto packet = std::make_shared<packet_t>();
+  factory.get_next(packet);
+
+  return { packet->assigned_timestamp, packet->duration };
+}
+
+TEST(TimestampFactory, V1FillsGapsWithDefaultFps) {
+  auto factory = timestamp_factory_v1_c{"test", "test", 0};
+  factory.parse(text_io("assume 25\n10,19,50\n# comment\n30,39,10\n"));
+
+  // Frames 0–9 at 25 FPS
+  EXPECT_EQ((timestamp_and_duration_t(0, 40000000)), next(factory));
+  for (auto idx = 1; idx < 10; ++idx)
+    next(factory);
+
+  // Frames 10–19 at 50 FPS
+  EXPECT_EQ((timestamp_and_duration_t(400000000, 20000000)), next(factory));
+  for (auto idx = 11; idx < 20; ++idx)
+    next(factory);
+
+  // Frames 20–29 at 25 FPS again
+  EXPECT_EQ((timestamp_and_duration_t(600000000, 40000000)), next(factory));
+  for (auto idx = 21; idx < 30; ++idx)
+    next(factory);
+
+  // Frames 30–39 at 10 FPS, afterwards 25 FPS
+  EXPECT_EQ((timestamp_and_duration_t(1000000000, 100000000)), next(factory));
+  for (auto idx = 31; idx < 40; ++idx)
+    next(factory);
+
+  EXPECT_EQ((timestamp_and_duration_t(2000000000, 40000000)), next(factory));
+}
+
+TEST(TimestampFactory, V2ReadsTimestampsOnDemand) {
+  // More entries than fit into a single window
+  std::string text;
+  for (auto idx = 0; idx < 5000; ++idx)
+    text += fmt::format("{0}\n", idx * 40 + (idx % 5 ? 0 : 1));
+
+  auto factory = timestamp_factory_v2_c{"test", "test", 0, 2};
+  factory.parse(text_io(text));
+
+  EXPECT_EQ(40000000.0, factory.get_default_duration(-1));
+
+  for (auto idx = 0; idx < 4999; ++idx) {
+    auto expected_timestamp = (idx * 40 + (idx % 5 ? 0 : 1)) * 1000000ll;
+    auto expected_next      = ((idx + 1) * 40 + ((idx + 1) % 5 ? 0 : 1)) * 1000000ll;
+
+    ASSERT_EQ((timestamp_and_duration_t(expected_timestamp, expected_next - expected_timestamp)), next(factory));
+  }
+
+  // The last frame gets the most common duration.
+  EXPECT_EQ((timestamp_and_duration_t(4999 * 40 * 1000000ll, 40000000)), next(factory));
+}
+
+}